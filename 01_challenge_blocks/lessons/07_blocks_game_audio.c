@@ -7,6 +7,14 @@
 *   Compile example using:
 *       gcc -o $(NAME_PART).exe $(FILE_NAME) -lraylib -lopengl32 -lgdi32 -Wall -std=c99
 *
+*   NOTE: Compile with -DSOAK_TEST to run a long soak test: an autoplay bot plays the game
+*       (use a virtual display like Xvfb on headless machines) while frame times, memory usage
+*       and VRAM counters are recorded into soak_stats.csv, regressions are flagged and
+*       reported in the exit code.
+*
+*   NOTE: Static screens (logo, title, ending), paused gameplay and minimized window run in idle
+*       mode at a reduced framerate; screens timing (logo time, text blinking) is time based.
+*
 *   This example has been created using raylib 2.0 (www.raylib.com)
 *   raylib is licensed under an unmodified zlib/libpng license (View raylib.h for details)
 *
@@ -16,6 +24,10 @@
 
 #include "raylib.h"
 
+#include <stdio.h>              // Required for: fopen(), fclose(), fprintf(), fgets()
+#include <stdlib.h>             // Required for: qsort(), atol()
+#include <string.h>             // Required for: strncmp()
+
 //----------------------------------------------------------------------------------
 // Useful values definitions 
 //----------------------------------------------------------------------------------
@@ -25,6 +37,19 @@
 
 #define BRICKS_POSITION_Y       50
 
+#define GAME_FPS                60          // Framerate while playing
+#define IDLE_FPS                15          // Framerate on static screens, paused game and minimized window
+
+// Frame stats: frame times, memory usage and VRAM counters
+#define FRAME_STATS_CAPACITY    4096        // Max frame times registered per sample
+#define FRAME_STATS_SAMPLE_TIME   60.0      // Stats sample period (in seconds)
+
+// Soak test: autoplay bot and regressions detection
+#define SOAK_TEST_DURATION      (4*3600)    // Soak test duration (in seconds)
+#define SOAK_WARMUP_SAMPLES     2           // Samples discarded before registering baseline
+#define SOAK_MEMORY_GROWTH      (16*1024*1024)  // Max memory growth over baseline (bytes)
+#define SOAK_FRAMETIME_DRIFT    1.5f        // Max p99 frame time growth over baseline (ratio)
+
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
 //----------------------------------------------------------------------------------
@@ -58,6 +83,28 @@ typedef struct Brick {
     bool active;
 } Brick;
 
+// Frame stats structure
+// NOTE: Frame times are registered along a sample period and reduced to percentiles at sample end
+typedef struct FrameStats {
+    float frameTimes[FRAME_STATS_CAPACITY]; // Frame times registered in current sample (ms)
+    int frameCount;                         // Frame times registered in current sample
+    double sampleStartTime;                 // Current sample start time (in seconds)
+    int sampleCount;                        // Samples completed
+    float p50, p95, p99, maxTime;           // Last sample frame time percentiles (ms)
+    long memoryUsage;                       // Last sample process memory usage, resident set (bytes)
+    long vramUsage;                         // Last sample VRAM used by loaded textures (bytes)
+} FrameStats;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static bool UpdateFrameStats(FrameStats *stats, float frameTime);   // Register frame time (ms), returns true at sample end
+static float GetFrameTimePercentile(float *times, int count, float percentile); // Get frame times percentile (sorts times)
+static long GetMemoryUsage(void);                                   // Get process memory usage, resident set size (bytes)
+static int CheckSoakRegressions(FrameStats stats, FrameStats baseline, FILE *file); // Record stats sample, returns regressions over baseline
+static Texture2D LoadTextureCounted(const char *fileName, long *vramUsage);  // Load texture and add its size to VRAM usage counter
+static void UnloadTextureCounted(Texture2D texture, long *vramUsage);       // Unload texture and remove its size from VRAM usage counter
+
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
@@ -67,6 +114,11 @@ int main()
     //--------------------------------------------------------------------------------------
     const int screenWidth = 800;
     const int screenHeight = 450;
+    
+    // Frame stats: frame times, memory usage and VRAM counters
+    // NOTE: VRAM usage is updated on every texture load/unload, considering 32bit per pixel
+    FrameStats frameStats = { 0 };
+    long vramUsage = 0;
 
     // LESSON 01: Window initialization and screens management
     InitWindow(screenWidth, screenHeight, "CHALLENGE 01: BLOCKS GAME");
@@ -74,13 +126,14 @@ int main()
     // NOTE: Load resources (textures, fonts, audio) after Window initialization
     
     // LESSON 05: Textures loading and drawing
-    Texture2D texLogo = LoadTexture("resources/raylib_logo.png");
-    Texture2D texBall = LoadTexture("resources/ball.png");
-    Texture2D texPaddle = LoadTexture("resources/paddle.png");
-    Texture2D texBrick = LoadTexture("resources/brick.png");
+    Texture2D texLogo = LoadTextureCounted("resources/raylib_logo.png", &vramUsage);
+    Texture2D texBall = LoadTextureCounted("resources/ball.png", &vramUsage);
+    Texture2D texPaddle = LoadTextureCounted("resources/paddle.png", &vramUsage);
+    Texture2D texBrick = LoadTextureCounted("resources/brick.png", &vramUsage);
     
     // LESSON 06: Fonts loading and text drawing
     Font font = LoadFont("resources/setback.png");
+    vramUsage += font.texture.width*font.texture.height*4;
     
     // LESSSON 07: Sounds and music loading and playing
     InitAudioDevice();              // Initialize audio system
@@ -92,11 +145,26 @@ int main()
     Music music = LoadMusicStream("resources/blockshock.mod");
     
     PlayMusicStream(music);         // Start music streaming
+    
+    // Soak test: autoplay bot plays the game, stats samples are checked against a baseline
+    bool autoplay = false;          // Autoplay bot controls the game instead of the player
+    float botAimOffset = 0.0f;      // Paddle offset used by autoplay bot to hit the ball (varies bounce angle)
+    FrameStats soakBaseline = { 0 };
+    FILE *soakFile = NULL;
+    int soakRegressions = 0;
+    
+#if defined(SOAK_TEST)
+    autoplay = true;
+    
+    soakFile = fopen("soak_stats.csv", "wt");
+    if (soakFile != NULL) fprintf(soakFile, "time,rss_bytes,vram_bytes,p50_ms,p95_ms,p99_ms,max_ms\n");
+#endif
 
     // Game required variables
     GameScreen screen = LOGO;       // Current game screen state
     
-    int framesCounter = 0;          // General pourpose frames counter
+    float screenTime = 0.0f;        // Time in current screen (seconds)
+    bool idleMode = false;          // Idle mode: nothing animated but blinking text, reduced framerate
     int gameResult = -1;            // Game result: 0 - Loose, 1 - Win, -1 - Not defined
     bool gamePaused = false;        // Game paused state toggle
     
@@ -129,7 +197,7 @@ int main()
         }
     }
         
-    SetTargetFPS(60);               // Set desired framerate (frames per second)
+    SetTargetFPS(GAME_FPS);         // Set desired framerate (frames per second)
     //--------------------------------------------------------------------------------------
     
     // Main game loop
@@ -143,12 +211,12 @@ int main()
             {
                 // Update LOGO screen data here!
                 
-                framesCounter++;
+                screenTime += GetFrameTime();
                 
-                if (framesCounter > 180) 
+                if (screenTime > 3.0f) 
                 {
                     screen = TITLE;    // Change to TITLE screen after 3 seconds
-                    framesCounter = 0;
+                    screenTime = 0.0f;
                 }
                 
             } break;
@@ -156,10 +224,10 @@ int main()
             {
                 // Update TITLE screen data here!
                 
-                framesCounter++;
+                screenTime += GetFrameTime();
                 
                 // LESSON 03: Inputs management (keyboard, mouse)
-                if (IsKeyPressed(KEY_ENTER))
+                if (IsKeyPressed(KEY_ENTER) || (autoplay && (screenTime > 1.0f)))
                 {
                     screen = GAMEPLAY;
                     PlaySound(fxStart);
@@ -178,8 +246,19 @@ int main()
                     // LESSON 03: Inputs management (keyboard, mouse)
                     
                     // Player movement logic
-                    if (IsKeyDown(KEY_LEFT)) player.position.x -= player.speed.x;
-                    if (IsKeyDown(KEY_RIGHT)) player.position.x += player.speed.x;
+                    if (autoplay)
+                    {
+                        // Autoplay bot: paddle tracks the ball position
+                        float paddleCenter = player.position.x + player.size.x/2;
+                        
+                        if ((ball.position.x + botAimOffset) < (paddleCenter - player.speed.x)) player.position.x -= player.speed.x;
+                        else if ((ball.position.x + botAimOffset) > (paddleCenter + player.speed.x)) player.position.x += player.speed.x;
+                    }
+                    else
+                    {
+                        if (IsKeyDown(KEY_LEFT)) player.position.x -= player.speed.x;
+                        if (IsKeyDown(KEY_RIGHT)) player.position.x += player.speed.x;
+                    }
                     
                     if ((player.position.x) <= 0) player.position.x = 0;
                     if ((player.position.x + player.size.x) >= screenWidth) player.position.x = screenWidth - player.size.x;
@@ -207,6 +286,9 @@ int main()
                             ball.speed.y *= -1;
                             ball.speed.x = (ball.position.x - (player.position.x + player.size.x/2))/player.size.x*5.0f;
                             PlaySound(fxBounce);
+                            
+                            // Autoplay bot hits next ball with a different paddle point
+                            if (autoplay) botAimOffset = (float)GetRandomValue(-40, 40);
                         }
                         
                         // Collision logic: ball vs bricks
@@ -240,7 +322,7 @@ int main()
                         {
                             screen = ENDING;
                             player.lifes = 5;
-                            framesCounter = 0;
+                            screenTime = 0.0f;
                         }
                     }
                     else
@@ -249,7 +331,7 @@ int main()
                         ball.position.x = player.position.x + player.size.x/2;
                         
                         // LESSON 03: Inputs management (keyboard, mouse)
-                        if (IsKeyPressed(KEY_SPACE))
+                        if (IsKeyPressed(KEY_SPACE) || autoplay)
                         {
                             // Activate ball logic
                             ball.active = true;
@@ -263,13 +345,14 @@ int main()
             {
                 // Update END screen data here!
                 
-                framesCounter++;
+                screenTime += GetFrameTime();
                 
                 // LESSON 03: Inputs management (keyboard, mouse)
-                if (IsKeyPressed(KEY_ENTER))
+                if (IsKeyPressed(KEY_ENTER) || (autoplay && (screenTime > 1.0f)))
                 {
                     // Replay / Exit game logic
                     screen = TITLE;
+                    screenTime = 0.0f;
                 }
                 
             } break;
@@ -279,6 +362,16 @@ int main()
         // LESSSON 07: Sounds and music loading and playing
         // NOTE: Music buffers must be refilled if consumed
         UpdateMusicStream(music);
+        
+        // Idle mode: static screens only change with blinking text or input, framerate is reduced
+        // NOTE: Music stream buffers still get refilled on time at idle framerate
+        bool idle = (screen != GAMEPLAY) || gamePaused || IsWindowMinimized();
+        
+        if (idle != idleMode)
+        {
+            SetTargetFPS(idle? IDLE_FPS : GAME_FPS);
+            idleMode = idle;
+        }
         //----------------------------------------------------------------------------------
         
         // Draw
@@ -304,7 +397,7 @@ int main()
                     // LESSON 06: Fonts loading and text drawing
                     DrawTextEx(font, "BLOCKS", (Vector2){ 100, 80 }, 160, 10, MAROON);   // Draw Title
 
-                    if ((framesCounter/30)%2 == 0) DrawText("PRESS [ENTER] to START", GetScreenWidth()/2 - MeasureText("PRESS [ENTER] to START", 20)/2, GetScreenHeight()/2 + 60, 20, DARKGRAY);
+                    if (((int)(screenTime*2.0f))%2 == 0) DrawText("PRESS [ENTER] to START", GetScreenWidth()/2 - MeasureText("PRESS [ENTER] to START", 20)/2, GetScreenHeight()/2 + 60, 20, DARKGRAY);
                     
                 } break;
                 case GAMEPLAY:
@@ -366,7 +459,7 @@ int main()
                     // Draw ending message
                     DrawTextEx(font, "GAME FINISHED", (Vector2){ 80, 100 }, 80, 6, MAROON);
 
-                    if ((framesCounter/30)%2 == 0) DrawText("PRESS [ENTER] TO PLAY AGAIN", GetScreenWidth()/2 - MeasureText("PRESS [ENTER] TO PLAY AGAIN", 20)/2, GetScreenHeight()/2 + 80, 20, GRAY);
+                    if (((int)(screenTime*2.0f))%2 == 0) DrawText("PRESS [ENTER] TO PLAY AGAIN", GetScreenWidth()/2 - MeasureText("PRESS [ENTER] TO PLAY AGAIN", 20)/2, GetScreenHeight()/2 + 80, 20, GRAY);
                     
                 } break;
                 default: break;
@@ -374,6 +467,24 @@ int main()
         
         EndDrawing();
         //----------------------------------------------------------------------------------
+        
+        // Frame stats update
+        // NOTE: Idle mode frames are not registered, their frame time is the idle framerate
+        //----------------------------------------------------------------------------------
+        if (!idleMode && UpdateFrameStats(&frameStats, GetFrameTime()*1000.0f))
+        {
+            frameStats.vramUsage = vramUsage;
+            
+            if (autoplay)
+            {
+                if (frameStats.sampleCount == SOAK_WARMUP_SAMPLES) soakBaseline = frameStats;
+                
+                soakRegressions += CheckSoakRegressions(frameStats, soakBaseline, soakFile);
+                
+                if (GetTime() > SOAK_TEST_DURATION) break;
+            }
+        }
+        //----------------------------------------------------------------------------------
     }
 
     // De-Initialization
@@ -382,11 +493,13 @@ int main()
     // NOTE: Unload any loaded resources (texture, fonts, audio)
     
     // LESSON 05: Textures loading and drawing
-    UnloadTexture(texBall);
-    UnloadTexture(texPaddle);
-    UnloadTexture(texBrick);
+    UnloadTextureCounted(texLogo, &vramUsage);
+    UnloadTextureCounted(texBall, &vramUsage);
+    UnloadTextureCounted(texPaddle, &vramUsage);
+    UnloadTextureCounted(texBrick, &vramUsage);
     
     // LESSON 06: Fonts loading and text drawing
+    vramUsage -= font.texture.width*font.texture.height*4;
     UnloadFont(font);
     
     // LESSSON 07: Sounds and music loading and playing
@@ -399,7 +512,160 @@ int main()
     CloseAudioDevice();         // Close audio device connection
     
     CloseWindow();              // Close window and OpenGL context
+    
+    TraceLog(LOG_INFO, "STATS: Frame time p50: %.2f ms, p99: %.2f ms, max: %.2f ms, memory: %li KB", 
+             frameStats.p50, frameStats.p99, frameStats.maxTime, GetMemoryUsage()/1024);
+    
+    if (autoplay)
+    {
+        if (soakFile != NULL) fclose(soakFile);
+        
+        TraceLog(LOG_INFO, "SOAK: Test finished, %i samples recorded, %i regressions detected", frameStats.sampleCount, soakRegressions);
+        
+        if (soakRegressions > 0) return 1;
+    }
     //--------------------------------------------------------------------------------------
     
     return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Register frame time (ms), reduce stats at sample end
+// NOTE: Returns true when a sample has been completed
+static bool UpdateFrameStats(FrameStats *stats, float frameTime)
+{
+    bool sampleCompleted = false;
+    
+    if (stats->frameCount < FRAME_STATS_CAPACITY) stats->frameTimes[stats->frameCount++] = frameTime;
+    
+    double time = GetTime();
+    
+    if ((time - stats->sampleStartTime) >= FRAME_STATS_SAMPLE_TIME)
+    {
+        stats->p50 = GetFrameTimePercentile(stats->frameTimes, stats->frameCount, 0.50f);
+        stats->p95 = GetFrameTimePercentile(stats->frameTimes, stats->frameCount, 0.95f);
+        stats->p99 = GetFrameTimePercentile(stats->frameTimes, stats->frameCount, 0.99f);
+        stats->maxTime = GetFrameTimePercentile(stats->frameTimes, stats->frameCount, 1.0f);
+        
+        stats->memoryUsage = GetMemoryUsage();
+        stats->sampleCount++;
+        
+        stats->frameCount = 0;
+        stats->sampleStartTime = time;
+        
+        sampleCompleted = true;
+    }
+    
+    return sampleCompleted;
+}
+
+// Compare function for frame times sorting
+static int CompareFrameTimes(const void *a, const void *b)
+{
+    float ta = *(const float *)a;
+    float tb = *(const float *)b;
+    
+    return (ta > tb) - (ta < tb);
+}
+
+// Get frame times percentile
+// NOTE: Provided times array is sorted in-place
+static float GetFrameTimePercentile(float *times, int count, float percentile)
+{
+    if (count == 0) return 0.0f;
+    
+    qsort(times, count, sizeof(float), CompareFrameTimes);
+    
+    int index = (int)(percentile*(count - 1) + 0.5f);
+    
+    return times[index];
+}
+
+// Get process memory usage, resident set size (bytes)
+// NOTE: Only supported on Linux (/proc filesystem), it returns 0 on other platforms
+static long GetMemoryUsage(void)
+{
+    long memoryUsage = 0;
+    
+    FILE *statusFile = fopen("/proc/self/status", "rt");
+    
+    if (statusFile != NULL)
+    {
+        char line[128] = { 0 };
+        
+        while (fgets(line, 128, statusFile) != NULL)
+        {
+            if (strncmp(line, "VmRSS:", 6) == 0) 
+            {
+                memoryUsage = atol(line + 6)*1024;  // Value is provided in KB
+                break;
+            }
+        }
+        
+        fclose(statusFile);
+    }
+    
+    return memoryUsage;
+}
+
+// Record stats sample and check it against baseline, returns regressions detected
+// NOTE: Memory growth and frame time drift over the baseline are flagged as regressions
+static int CheckSoakRegressions(FrameStats stats, FrameStats baseline, FILE *file)
+{
+    int regressions = 0;
+    
+    if (file != NULL)
+    {
+        fprintf(file, "%.0f,%li,%li,%.3f,%.3f,%.3f,%.3f\n", GetTime(), stats.memoryUsage, stats.vramUsage, 
+                stats.p50, stats.p95, stats.p99, stats.maxTime);
+        fflush(file);
+    }
+    
+    TraceLog(LOG_INFO, "SOAK: [%i] memory: %li KB, vram: %li KB, frame time p50: %.2f ms, p95: %.2f ms, p99: %.2f ms", 
+             stats.sampleCount, stats.memoryUsage/1024, stats.vramUsage/1024, stats.p50, stats.p95, stats.p99);
+    
+    if (stats.sampleCount > SOAK_WARMUP_SAMPLES)
+    {
+        if ((stats.memoryUsage - baseline.memoryUsage) > SOAK_MEMORY_GROWTH)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Memory usage regression: %li KB over baseline", (stats.memoryUsage - baseline.memoryUsage)/1024);
+            regressions++;
+        }
+        
+        if (stats.vramUsage > baseline.vramUsage)
+        {
+            TraceLog(LOG_WARNING, "SOAK: VRAM usage regression: %li KB over baseline", (stats.vramUsage - baseline.vramUsage)/1024);
+            regressions++;
+        }
+        
+        if (stats.p99 > baseline.p99*SOAK_FRAMETIME_DRIFT)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Frame time regression: p99 %.2f ms (baseline %.2f ms)", stats.p99, baseline.p99);
+            regressions++;
+        }
+    }
+    
+    return regressions;
+}
+
+// Load texture and add its size to VRAM usage counter
+// NOTE: Texture size is computed considering 32bit per pixel
+static Texture2D LoadTextureCounted(const char *fileName, long *vramUsage)
+{
+    Texture2D texture = LoadTexture(fileName);
+    
+    *vramUsage += texture.width*texture.height*4;
+    
+    return texture;
+}
+
+// Unload texture and remove its size from VRAM usage counter
+static void UnloadTextureCounted(Texture2D texture, long *vramUsage)
+{
+    *vramUsage -= texture.width*texture.height*4;
+    
+    UnloadTexture(texture);
 }
\ No newline at end of file
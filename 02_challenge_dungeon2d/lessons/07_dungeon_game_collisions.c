@@ -23,10 +23,65 @@
 *       gcc -o $(NAME_PART).exe $(FILE_NAME) -Iexternal -Iexternal/glfw/include \
 *           rglfw.o -lopengl32 -lgdi32 -Wall -std=c99
 *
+*   NOTE 4: Entities (pickups, monsters...) collisions use a sweep-and-prune broadphase,
+*       narrowphase tests 8 bounds at once when compiled with AVX support (-mavx).
+*       Compile with -DENTITIES_STRESS_TEST to add thousands of moving entities to the scene.
+*
+*   NOTE 5: Compile with -DSOAK_TEST to run a long soak test: a random-walk bot plays the game
+*       in a hidden window (use a virtual display like Xvfb on headless machines) while frame times,
+*       memory usage and VRAM counters are recorded into soak_stats.csv, regressions are flagged
+*       and reported in the exit code.
+*
+*   NOTE 6: 2D drawing is queued on a render queue, every quad carries a 64bit sort key
+*       (layer, shader, texture, depth); queue is radix-sorted at frame end and drawn with
+*       textures batches merged inside every layer, layers are drawn in ascending order.
+*
+*   NOTE 7: Compile with -DRENDER_THREAD (link with -lpthread) to draw on a dedicated render thread:
+*       game thread fills a render queue per frame (frame draw commands with snapshotted data) and
+*       hands it to render thread, that owns OpenGL context and draws it (and swaps buffers)
+*       while game thread updates next frame; two queues are used alternately (double-buffered).
+*
+*   NOTE 8: Tileset and player are 8bpp indexed BMPs: pixels are kept as palette indices on an R8 texture
+*       (4x less memory than R8G8B8A8) and a 256x1 palette texture is looked up on fragment shader,
+*       transparent index (magenta color key) is discarded; swapping palette texture recolors sprites.
+*
+*   NOTE 9: Compile with -DWORLD_STREAMING to play on a large world (tilemap repeated as connected rooms)
+*       exported once into a regions file (256x256 tiles regions with an index header); only regions
+*       around player are kept in memory, regions ahead of player movement are pre-fetched (regions file
+*       is memory mapped when available) and far regions are evicted; view scrolls following player.
+*
+*   NOTE 10: Long-distance tile paths use hierarchical pathfinding (HPA*): tiles grid is split in 16x16
+*       clusters with entrances on their borders and precomputed costs between them, paths are searched
+*       on entrances graph and refined into tiles lazily (segment by segment); tile changes only rebuild
+*       affected clusters. Compile with -DPATHFINDING_BENCHMARK to log queries per second against
+*       flat A* on a 2048x2048 tiles world (tilemap repeated as rooms) at startup. Pathfinding is only
+*       compiled along with its users: -DPATHFINDING_BENCHMARK or -DMONSTER_CROWD.
+*
+*   NOTE 11: Compile with -DMONSTER_CROWD (link with -lpthread) to add monsters chasing player: monsters
+*       steer around each other with reciprocal velocity obstacles (ORCA), neighbours are found on a uniform
+*       grid, tilemap walls are static obstacles; crowd is stepped at 30 Hz with agents solved in parallel
+*       by worker threads. Compile with -DCROWD_BENCHMARK to log 10k agents step time at startup.
+*
+*   NOTE 12: Moving entities and monsters AI are updated by a scheduler: entities on view update every frame,
+*       entities out of view every 4th frame (every 16th if far from player), updates get time elapsed since
+*       last one; updates stop once frame budget is spent and remaining ones are done first on next frame.
+*
+*   NOTE 13: Quality settings (window size, scene resolution scale, MSAA, vsync) are loaded from dungeon_settings.cfg;
+*       on first launch (no config file) a hardware probe draws the scene for up to one second with every preset,
+*       most expensive first, and the first one meeting the frame time target is selected and saved.
+*
 *   Copyright (c) 2017-2019 Ramon Santamaria (@raysan5)
 *
 ********************************************************************************************/
 
+#if defined(WORLD_STREAMING) && !defined(_WIN32)
+    #define _POSIX_C_SOURCE 200112L     // Required for: posix_madvise() on -std=c99 [Used on world regions streaming]
+#endif
+
+#if defined(CROWD_BENCHMARK) && !defined(MONSTER_CROWD)
+    #define MONSTER_CROWD               // Crowd benchmark requires crowd module
+#endif
+
 #define RLGL_STANDALONE
 #define RLGL_IMPLEMENTATION
 #include "rlgl.h"               // rlgl library: OpenGL 1.1 immediate-mode style coding
@@ -36,6 +91,21 @@
 #include <stdio.h>              // Standard input-output C library
 #include <stdlib.h>             // Memory management functions: malloc(), free()
 #include <string.h>             // String manipulation functions: strrchr(), strcmp()
+#include <float.h>              // Required for: FLT_MAX
+
+#if defined(__AVX__)
+    #include <immintrin.h>      // AVX intrinsics, used on entities collisions narrowphase
+#endif
+
+#if defined(RENDER_THREAD) || defined(MONSTER_CROWD)
+    #include <pthread.h>        // Required for: pthread_create(), pthread_join(), pthread_cond_wait() [Used on render thread and crowd workers]
+#endif
+
+#if defined(WORLD_STREAMING) && !defined(_WIN32)
+    #include <sys/mman.h>       // Required for: mmap(), munmap(), posix_madvise() [Used on world regions streaming]
+    #include <fcntl.h>          // Required for: open()
+    #include <unistd.h>         // Required for: close(), sysconf()
+#endif
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -48,24 +118,396 @@ typedef struct Image {
     Color *data;                // Image data (Color - 32 bpp - R8G8B8A8)
 } Image;
 
-// LESSON 06: Tile struct
+// Indexed image struct
+// NOTE: Image data is stored as palette indices, palette colors are looked up on drawing (shader)
+#define MAX_PALETTE_COLORS      256         // Max palette colors (8 bpp indices)
+
+typedef struct IndexedImage {
+    unsigned int width;         // Image width
+    unsigned int height;        // Image height
+    unsigned char *data;        // Image data (palette indices - 8 bpp)
+    Color palette[MAX_PALETTE_COLORS];  // Palette colors
+    int colorCount;             // Palette colors used
+    int transparentIndex;       // Palette index considered transparent (color key), -1 if none
+} IndexedImage;
+
+// LESSON 06: Tile struct, single tile fields (tilemaps store tiles packed by field)
 typedef struct Tile {
     int value;                  // Tile index value (in tileset)
-    bool collider;              // Tile collider (0 -> walkable)
-    Color color;                // Tile color (could be useful)
+    bool collider;              // Tile collider (0 -> solid, tile mask is tested)
 } Tile;
 
+// Packed tiles layers: tiles values and tiles colliders stored on separate arrays
+// NOTE: Every pass only touches the field it requires: drawing reads 16 bit values, collisions and
+// pathfinding read colliders bitplane (1 bit per tile, rows padded to 32 bit words)
+typedef struct TileLayers {
+    unsigned short *values;     // Tiles values (tileset index), NULL if not loaded
+    unsigned int *colliders;    // Tiles colliders bitplane, tile x is bit (x%32) of row word (x/32)
+    int width;                  // Tiles per row
+    int stride;                 // Colliders bitplane words per row
+} TileLayers;
+
+// Tile color, entry of tilemap sparse colors table
+typedef struct TileColor {
+    int index;                  // Tile index (y*tileCountX + x)
+    Color color;                // Tile color, tints tile drawing
+} TileColor;
+
 // LESSON 06: Tilemap struct
 typedef struct Tilemap {
-    Tile *tiles;                // Tiles data
+    TileLayers tiles;           // Tiles data (packed), not used by streamed tilemaps
+    TileColor *colors;          // Tiles colors (sparse, sorted by tile index), NULL if no tile is colored
+    int colorCount;             // Tiles colors count
     int tileCountX;             // Tiles counter X
     int tileCountY;             // Tiles counter Y
     int tileSize;               // Tile size (XY)
     Vector2 position;           // Tilemap position in screen
+    struct WorldStreamer *streamer;     // Tiles streamed by regions (NULL if all tiles are loaded)
 } Tilemap;
 
+#if defined(WORLD_STREAMING)
+// World region struct, resident piece of a streamed tilemap
+typedef struct WorldRegion {
+    int x;                      // Region position X (in regions)
+    int y;                      // Region position Y (in regions)
+    TileLayers tiles;           // Region tiles data (regionSize*regionSize), values NULL if slot is free
+    unsigned int lastUsed;      // Last streamer update region was required (eviction order)
+} WorldRegion;
+
+// World streamer struct, regions file access and resident regions
+// NOTE: Regions are loaded into a fixed number of slots, tiles are accessed through GetTilemapLayers()
+#define MAX_STREAM_REGIONS      16          // Max resident regions
+
+typedef struct WorldStreamer {
+    FILE *file;                 // Regions file, used to read regions data if it could not be memory mapped
+    unsigned char *mapped;      // Regions file memory mapped (NULL if not available)
+    long fileSize;              // Regions file size (bytes)
+    unsigned int *index;        // Regions data offsets in file (regionCountX*regionCountY), 0 means empty region
+    int regionSize;             // Region size (tiles per side)
+    int regionCountX;           // Regions count X
+    int regionCountY;           // Regions count Y
+    WorldRegion regions[MAX_STREAM_REGIONS];    // Resident regions slots
+    unsigned int frame;         // Streamer updates counter
+    int lastRegion;             // Last region slot accessed (tiles lookup cache)
+    int prefetchIndex;          // Last region pre-fetched (index), -1 if none
+} WorldStreamer;
+#endif
+
+// LESSON 07: Entity type
+typedef enum { ENTITY_PLAYER = 0, ENTITY_PICKUP, ENTITY_DUMMY } EntityType;
+
+// LESSON 07: Entity struct (player, pickups, monsters, projectiles...)
+typedef struct Entity {
+    Vector2 position;           // Entity position (collision bounds min)
+    Vector2 size;               // Entity size (collision bounds)
+    Vector2 speed;              // Entity movement speed
+    EntityType type;            // Entity type
+    int value;                  // Entity tile index value (in tileset)
+    bool active;                // Entity active state, inactive entities do not collide
+} Entity;
+
+// LESSON 07: Collision mask struct (1 bit per pixel)
+// NOTE: One 32bit word per mask row, bit x is set when pixel x of the row is solid,
+// masks are tested against each other with word-wide AND operations
+#define COLLISION_MASK_SIZE     32          // Max collision mask size (width and height)
+
+typedef struct CollisionMask {
+    unsigned int rows[COLLISION_MASK_SIZE]; // Mask rows bits
+    int width;                  // Mask width
+    int height;                 // Mask height
+} CollisionMask;
+
+// LESSON 07: Sweep-and-prune broadphase struct
+// NOTE: Entities are kept sorted along X axis from frame to frame and their bounds are
+// stored in sorted order as separate arrays, so narrowphase tests contiguous batches
+typedef struct SweepAndPrune {
+    int *order;                 // Entities indices, sorted by bounds min X
+    float *minX;                // Entities bounds min X (sorted order)
+    float *minY;                // Entities bounds min Y (sorted order)
+    float *maxX;                // Entities bounds max X (sorted order)
+    float *maxY;                // Entities bounds max Y (sorted order)
+    int count;                  // Entities registered
+    int capacity;               // Entities capacity
+    int *pairs;                 // Overlapping pairs found (two entities indices per pair)
+    int pairCount;              // Overlapping pairs found count
+    int pairCapacity;           // Overlapping pairs capacity
+} SweepAndPrune;
+
+// Hierarchical pathfinding: clusters are small, intra-cluster costs fit on 16 bit
+#define PATH_CLUSTER_SIZE       16          // Cluster size (tiles per side)
+#define MAX_CLUSTER_NODES       32          // Max entrances per cluster
+#define PATH_ENTRANCE_SPLIT     6           // Border walkable runs this long get an entrance on every end
+#define PATH_COST_UNREACHABLE   0xffff      // Intra-cluster cost of unreachable entrances
+
+// Hierarchical pathfinding: tiles grid split in clusters, cluster entrances form an abstract graph
+// NOTE: Entrances are tiles on cluster borders, every entrance is linked to the entrance facing it
+// on neighbour cluster (cost 1) and to its cluster entrances (precomputed costs)
+typedef struct PathCluster {
+    short nodeX[MAX_CLUSTER_NODES];     // Entrances tile position X
+    short nodeY[MAX_CLUSTER_NODES];     // Entrances tile position Y
+    unsigned char nodeSide[MAX_CLUSTER_NODES];  // Entrances border side: 0 - right, 1 - left, 2 - bottom, 3 - top
+    int nodeCount;              // Entrances count
+    unsigned short *costs;      // Intra-cluster costs between entrances (nodeCount*nodeCount)
+} PathCluster;
+
+// Path search heap entry
+typedef struct PathHeapNode {
+    int cost;                   // Entry estimated total cost (cost + heuristic)
+    int id;                     // Entry id (abstract node or tile index)
+} PathHeapNode;
+
+// Hierarchical pathfinding grid
+typedef struct PathGrid {
+    int width;                  // Grid width (tiles)
+    int height;                 // Grid height (tiles)
+    unsigned char *walkable;    // Tiles walkability (width*height)
+    int clusterCountX;          // Clusters count X
+    int clusterCountY;          // Clusters count Y
+    PathCluster *clusters;      // Clusters data
+    
+    int *costs;                 // Search scratch: entries cost
+    int *parents;               // Search scratch: entries parent
+    unsigned int *stamps;       // Search scratch: entries search stamp (entry valid if equal to stamp)
+    int scratchSize;            // Search scratch entries
+    unsigned int stamp;         // Current search stamp
+    PathHeapNode *heap;         // Search heap
+    int heapCount;              // Search heap entries
+    int heapCapacity;           // Search heap capacity
+    unsigned short *distances;  // Cluster search scratch: tiles distance (PATH_CLUSTER_SIZE*PATH_CLUSTER_SIZE)
+    int *queue;                 // Cluster search scratch: tiles queue
+} PathGrid;
+
+// Path found on pathfinding grid, refined lazily into tiles
+typedef struct Path {
+    int *points;                // Abstract path points (tile index: y*width + x), start to goal
+    int pointCount;             // Abstract path points count
+    int pointNext;              // Next abstract path point to refine
+    int *tiles;                 // Refined tiles of current path segment
+    int tileCount;              // Refined tiles count
+    int tileNext;               // Next refined tile
+    int length;                 // Path length (tiles steps), -1 if path not found
+} Path;
+
+#if defined(MONSTER_CROWD)
+// Crowd: monsters local avoidance (ORCA, optimal reciprocal collision avoidance)
+#define CROWD_MAX_THREADS       16          // Max crowd solver threads (calling thread included)
+
+// Crowd agent, moved with a collision-free velocity computed every crowd step
+typedef struct CrowdAgent {
+    Vector2 position;           // Agent position (center)
+    Vector2 velocity;           // Agent velocity (units per second)
+    Vector2 goal;               // Agent goal position, preferred velocity points to it
+    Vector2 newVelocity;        // Agent velocity computed on current step
+} CrowdAgent;
+
+// Crowd velocity constraint (half-plane), velocities on the right side of line are not allowed
+typedef struct CrowdLine {
+    Vector2 point;              // Line point
+    Vector2 direction;          // Line direction (normalized)
+} CrowdLine;
+
+// Crowd worker thread, solves a range of agents every crowd step
+typedef struct CrowdWorker {
+    pthread_t thread;           // Worker thread
+    struct Crowd *crowd;        // Crowd solved
+    int index;                  // Worker index (agents range)
+} CrowdWorker;
+
+// Crowd struct, agents steered with reciprocal velocity obstacles
+// NOTE: Neighbours are found on a uniform grid of cells (neighbour distance size), walls are
+// path grid blocked tiles; agents velocities are solved in parallel (worker threads and calling thread)
+typedef struct Crowd {
+    CrowdAgent *agents;         // Crowd agents
+    int count;                  // Agents count
+    int capacity;               // Agents capacity
+    float radius;               // Agents radius
+    float maxSpeed;             // Agents max speed (units per second)
+    float neighbourDistance;    // Max distance of neighbours taken into account
+    float timeHorizon;          // Agents velocities are safe for this time against other agents
+    float timeHorizonWalls;     // Agents velocities are safe for this time against walls
+    
+    PathGrid *grid;             // Walls: path grid blocked tiles
+    float tileSize;             // Path grid tile size (units)
+    Vector2 origin;             // Path grid position (units)
+    
+    int cellCountX;             // Neighbour cells count X
+    int cellCountY;             // Neighbour cells count Y
+    int *cellStart;             // Cells first agent (on cellAgents), cell agents end at next cell start
+    int *cellAgents;            // Agents indices sorted by cell
+    int *agentCells;            // Agents cell index
+    
+    float stepTime;             // Current step time
+    float accumulator;          // Time not simulated yet (fixed rate steps)
+    
+    CrowdWorker workers[CROWD_MAX_THREADS];     // Worker threads (first slot is calling thread)
+    int threadCount;            // Solver threads count (calling thread included)
+    pthread_mutex_t mutex;      // Protects steps hand-off state
+    pthread_cond_t cond;        // Signals steps hand-off state changes
+    unsigned int generation;    // Steps started, workers wait for it to change
+    int pending;                // Workers still solving current step
+    bool running;               // Workers running, cleared to stop them
+} Crowd;
+#endif
+
+// AI update scheduler: entities update rate depends on distance to player (update buckets)
+#define UPDATE_BUCKETS          3           // Update buckets: every frame, every 4th frame, every 16th frame
+#define UPDATE_LISTS            21          // Update lists: one per bucket phase (1 + 4 + 16)
+
+// Update list, entities of a bucket phase
+typedef struct UpdateList {
+    int *entities;              // Entities ids
+    int count;                  // Entities count
+    int capacity;               // Entities capacity
+} UpdateList;
+
+// AI update scheduler struct
+// NOTE: Entities in a bucket are spread on its phases (one list per phase), only lists of current
+// frame phase are visited, so cost depends on updated entities and not on registered ones
+typedef struct UpdateScheduler {
+    int *buckets;               // Entities update bucket, -1 if entity is not registered
+    int *slots;                 // Entities position on their update list
+    double *lastTimes;          // Entities last update time (delta time compensation)
+    bool *queued;               // Entities waiting for update (due or deferred)
+    int capacity;               // Entities ids capacity
+    UpdateList lists[UPDATE_LISTS];     // Update lists, bucket phases
+    int *queue;                 // Entities to update, deferred ones first
+    int queueCount;             // Entities to update count
+    int queueNext;              // Next entity to update on queue
+    unsigned int frame;         // Frames scheduled
+    double budget;              // Updates time budget per frame (seconds)
+    double frameEnd;            // Current frame updates time limit
+    long updates;               // Updates done (total)
+    long deferred;              // Updates deferred to next frame (total)
+} UpdateScheduler;
+
+// 2D render queue item, textured quad (rectangles use default white texture)
+typedef struct RenderItem {
+    unsigned int textureId;     // Texture id
+    int textureWidth;           // Texture width, required to compute texcoords
+    int textureHeight;          // Texture height, required to compute texcoords
+    Rectangle source;           // Source rectangle (texture part)
+    Rectangle dest;             // Destination rectangle (screen)
+    Vector2 origin;             // Rotation origin, relative to destination rectangle
+    float rotation;             // Rotation (degrees)
+    Color tint;                 // Tint color
+} RenderItem;
+
+// 2D render queue struct
+// NOTE: Sort key bits: layer (63..56), shader (55..48), texture id (47..32), depth (31..0),
+// depth is the submission order, so items sharing layer, shader and texture keep their order
+#define MAX_QUEUE_SHADERS       8           // Max shaders used in one render queue (default shader included)
+
+typedef struct RenderQueue {
+    RenderItem *items;          // Queued items (submission order)
+    unsigned long long *keys;   // Queued items sort keys
+    int *order;                 // Queued items indices, sorted by key at queue end
+    unsigned long long *tempKeys;   // Radix sort scratch keys
+    int *tempOrder;             // Radix sort scratch indices
+    int count;                  // Queued items count
+    int capacity;               // Queued items capacity (grows on demand)
+    int layer;                  // Layer for next queued items
+    int shader;                 // Shader (index) for next queued items
+    Vector2 offset;             // Drawing offset for next queued items (view scrolling)
+    Shader shaders[MAX_QUEUE_SHADERS];  // Shaders used, default shader at index 0
+    unsigned int palettes[MAX_QUEUE_SHADERS];   // Shaders palette texture (bound to texture unit 1), 0 if none
+    int shaderCount;            // Shaders used count
+    int batchCount;             // Batches (texture or shader changes) emitted on last queue end
+} RenderQueue;
+
+// Quality presets, ordered by rendering cost
+typedef enum {
+    QUALITY_LOW = 0,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH,
+    QUALITY_ULTRA
+} QualityPreset;
+
+// Quality settings, initialized from a preset and saved to config file (every value can be tuned by hand)
+// NOTE: Tileset and sprites are palette indexed textures, they are always sampled with GL_NEAREST
+typedef struct QualitySettings {
+    int screenWidth;            // Window width (not probed)
+    int screenHeight;           // Window height (not probed)
+    int preset;                 // Preset settings were initialized from (QualityPreset)
+    float resolutionScale;      // Scene render resolution, relative to window size (upscaled on window, sharp pixels)
+    int msaaSamples;            // Scene anti-aliasing samples (MSAA), 0 to disable
+    bool vsync;                 // Wait for vertical sync on buffers swap
+} QualitySettings;
+
+// Scene render target: scene is drawn at scaled resolution (and multisampled) and blitted to window
+// NOTE: Scene is drawn directly to window framebuffer if not scaled and not multisampled
+typedef struct SceneTarget {
+    unsigned int fbo;           // Scene framebuffer id, 0 if scene is drawn to window framebuffer
+    unsigned int colorRbo;      // Scene color renderbuffer id
+    unsigned int depthRbo;      // Scene depth renderbuffer id
+    unsigned int resolveFbo;    // Multisample resolve framebuffer id, 0 if scene is not multisampled
+    unsigned int resolveRbo;    // Multisample resolve color renderbuffer id
+    int width;                  // Scene render width
+    int height;                 // Scene render height
+    int samples;                // Scene multisample samples, 0 if not multisampled
+    QualitySettings settings;   // Quality settings target was loaded with (window size, scale, samples, vsync)
+    bool loaded;                // Target has been loaded (settings are valid)
+} SceneTarget;
+
+// Hardware probe: scene is drawn for a short time with every preset (most expensive first),
+// first preset meeting the frame time target is selected
+#define QUALITY_PROBE_MAX_FRAMES    256     // Max frame times registered per probed preset
+
+typedef struct QualityProbe {
+    bool active;                // Probe is running
+    int preset;                 // Preset being probed (QualityPreset)
+    int warmupFrames;           // Frames left before frame times are registered
+    float times[QUALITY_PROBE_MAX_FRAMES];  // Probed preset frame times (ms)
+    int frameCount;             // Probed preset frame times registered
+    float totalTime;            // Probed preset frame times sum (ms)
+} QualityProbe;
+
+#if defined(RENDER_THREAD)
+// Render thread struct, frames queues handed from game thread to render thread
+// NOTE: Game thread fills one queue while render thread draws the other one, a queue is
+// only reused by game thread once render thread has drawn it
+typedef struct RenderThread {
+    pthread_t thread;           // Render thread, owns OpenGL context while running
+    pthread_mutex_t mutex;      // Protects queues hand-off state and frame counters
+    pthread_cond_t cond;        // Signals queues hand-off state changes
+    RenderQueue queues[2];      // Frames render queues (double-buffered)
+    int writeIndex;             // Queue filled by game thread
+    RenderQueue *pending;       // Queue submitted and waiting to be drawn, NULL if none
+    RenderQueue *drawing;       // Queue being drawn by render thread, NULL if none
+    bool running;               // Render thread running, cleared to stop it (never set if thread could not be created)
+    int batchCount;             // Batches drawn on last frame
+    QualitySettings quality;    // Quality settings of submitted frame (scene target is updated by render thread)
+    bool memoryInfo;            // Driver reports available VRAM (NVX_gpu_memory_info)
+    int perfMessages;           // Driver performance messages received on frames drawn since last submission
+    int errorMessages;          // Driver error messages received on frames drawn since last submission
+    long vramUsage;             // VRAM usage after last frame drawn (bytes)
+    long vramAvailable;         // Driver reported available VRAM after last frame drawn (bytes), 0 if not supported
+} RenderThread;
+#endif
+
 #define WHITE   (Color){ 255, 255, 255, 255 }       // White color definition
 
+// Frame stats struct
+// NOTE: Frame times are registered along a sample period and reduced to percentiles at sample end
+#define FRAME_STATS_CAPACITY    4096        // Max frame times registered per sample
+#define FRAME_STATS_SAMPLE_TIME   60.0      // Stats sample period (in seconds)
+
+typedef struct FrameStats {
+    float frameTimes[FRAME_STATS_CAPACITY]; // Frame times registered in current sample (ms)
+    int frameCount;                         // Frame times registered in current sample
+    double sampleStartTime;                 // Current sample start time (in seconds)
+    int sampleCount;                        // Samples completed
+    float p50, p95, p99, maxTime;           // Last sample frame time percentiles (ms)
+    long memoryUsage;                       // Last sample process memory usage, resident set (bytes)
+    long vramUsage;                         // Last sample VRAM used by loaded textures (bytes)
+    long vramAvailable;                     // Last sample driver reported available VRAM (bytes), 0 if not supported
+    int perfMessageCount;                   // Driver performance messages received in current sample
+    int perfMessagePeak;                    // Driver performance messages peak per frame in current sample
+    int errorMessageCount;                  // Driver error messages received in current sample
+    int perfMessages;                       // Last sample driver performance messages (total)
+    int perfMessagesPeak;                   // Last sample driver performance messages (max per frame)
+    int errorMessages;                      // Last sample driver error messages (total)
+} FrameStats;
+
 //----------------------------------------------------------------------------------
 // Global Variables Declaration
 //----------------------------------------------------------------------------------
@@ -78,6 +520,12 @@ static double currentTime, previousTime;    // Used to track timmings
 static double frameTime = 0.0;              // Time measure for one frame
 static double targetTime = 0.0;             // Desired time for one frame, if 0 not applied
 
+// Idle mode: game is paused while window is unfocused or iconified, events are waited (no spin-wait)
+#define IDLE_WAIT_TIME_UNFOCUSED    0.25    // Max events wait time while window is unfocused (seconds)
+#define IDLE_WAIT_TIME_ICONIFIED    1.0     // Max events wait time while window is iconified (seconds)
+
+static bool windowRefresh = false;          // Window contents must be redrawn (window exposed or resized)
+
 // LESSON 03: Keyboard input management
 // Register keyboard states (current and previous)
 static char previousKeyState[512] = { 0 };  // Registers previous frame key state
@@ -109,7 +557,108 @@ static Rectangle tilesetRecs[TILESET_TILES] = {
 };
 
 // LESSON 07: Collision detection
-#define PLAYER_COLLISION_PADDING    12      // Player padding to detect collision with walls
+// NOTE: Tileset collision masks, one per tileset entry (tile value - 1), loaded from tileset colliders
+static CollisionMask tilesetMasks[TILESET_TILES] = { 0 };
+
+#define MAX_ENTITIES            32768       // Max entities supported (player included)
+#define SAP_BATCH_SIZE          8           // Bounds tested at once on narrowphase
+
+#if defined(ENTITIES_STRESS_TEST)
+#define STRESS_ENTITIES_COUNT   20000       // Moving entities added to the scene
+#endif
+
+#if defined(WORLD_STREAMING)
+// World regions streaming: tilemap rooms repeated into a large world, streamed by regions
+#define WORLD_REGIONS_FILE          "dungeon_world.rgn" // World regions file (exported on first run)
+#define WORLD_ROOMS_X               128         // World rooms count X
+#define WORLD_ROOMS_Y               192         // World rooms count Y
+
+#define REGION_FILE_VERSION         2           // Version 2: packed tiles (16 bit values, colliders bitplane)
+#define REGION_SIZE                 256         // Region size (tiles per side)
+#define STREAM_LOAD_RADIUS          24          // Tiles around player required to be resident (view and margin)
+#define STREAM_PREFETCH_DISTANCE    96          // Tiles ahead of player (movement direction) pre-fetched
+#define STREAM_EVICT_DISTANCE       1           // Regions further than this from player region (in regions) are evicted
+#endif
+
+#if defined(PATHFINDING_BENCHMARK)
+#define PATH_BENCHMARK_SIZE     2048        // Benchmark world size (tiles per side, tilemap repeated as rooms)
+#define PATH_BENCHMARK_QUERIES  200         // Benchmark path queries (random start and goal)
+#endif
+
+#if defined(MONSTER_CROWD)
+// Crowd: monsters chasing player, local avoidance solved at a fixed rate
+#define CROWD_AGENTS_COUNT      48          // Monsters added to the scene
+#define CROWD_THREADS           8           // Crowd solver threads (calling thread included)
+#define CROWD_SIMULATION_RATE   30          // Crowd steps per second
+#define CROWD_MAX_NEIGHBOURS    10          // Max neighbours taken into account per agent (closest ones)
+#define CROWD_MAX_LINES         64          // Max velocity constraints per agent (walls and neighbours)
+
+#define CROWD_PATH_LOOKAHEAD    3           // Monsters goal: tiles ahead on path to player
+#endif
+
+#if defined(CROWD_BENCHMARK)
+#define CROWD_BENCHMARK_AGENTS  10000       // Benchmark agents (tilemap repeated as rooms, ~60 agents per room)
+#define CROWD_BENCHMARK_STEPS   300         // Benchmark crowd steps (10 seconds simulated)
+#endif
+
+// AI update scheduler: entities visible update every frame, far ones every 16th frame
+#define UPDATE_FRAME_BUDGET     2.0         // Updates time budget per frame (ms), exceeding updates are deferred to next frame
+#define UPDATE_FAR_DISTANCE     1024.0f     // Entities not visible further than this from player update every 16th frame, nearer ones every 4th
+
+static const int updateIntervals[UPDATE_BUCKETS] = { 1, 4, 16 };    // Buckets update interval (frames)
+static const int updateListsOffset[UPDATE_BUCKETS] = { 0, 1, 5 };   // Buckets first update list
+
+// 2D render queue: queued drawing is sorted at frame end
+#define RENDER_QUEUE_CAPACITY   4096        // Initial render queue capacity (items)
+
+static RenderQueue *activeQueue = NULL;     // Render queue used by drawing functions, NULL if drawing directly
+
+// Quality settings: presets picked on first launch by a hardware probe, saved to config file
+#define QUALITY_SETTINGS_FILE       "dungeon_settings.cfg"  // Quality settings config file, probe runs again if missing
+#define QUALITY_PROBE_TIME          1000.0f     // Hardware probe max duration (ms), split among presets
+#define QUALITY_PROBE_FRAME_TIME    12.0f       // Probe frame time target (ms), headroom left for game update at 60 fps
+#define QUALITY_PROBE_WARMUP_FRAMES 3           // Frames drawn before frame times are registered (per preset)
+
+static QualitySettings quality = { 0 };     // Current quality settings
+static SceneTarget sceneTarget = { 0 };     // Scene render target (scaled, multisampled), only used by thread owning OpenGL context
+static int maxSamples = 0;                  // Max multisample samples supported
+
+// Frame stats: frame times, memory usage and VRAM counters
+static FrameStats frameStats = { 0 };
+static long vramUsage = 0;                  // VRAM used by loaded textures (bytes)
+
+// Debug output: driver debug messages and debug groups
+// NOTE: KHR_debug (OpenGL 4.3) is not provided by glad, required entry points are loaded on InitDebugOutput()
+#define MAX_DEBUG_MESSAGES_LOGGED   64      // Max driver debug messages logged (all of them are counted)
+
+#define GL_DEBUG_OUTPUT             0x92E0
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_TYPE_PUSH_GROUP    0x8269
+#define GL_DEBUG_TYPE_POP_GROUP     0x826A
+#define GL_CONTEXT_FLAG_DEBUG_BIT   0x00000002
+
+typedef void (APIENTRYP PFNDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROCARB callback, const void *userParam);
+typedef void (APIENTRYP PFNPUSHDEBUGGROUPPROC)(GLenum source, GLuint id, GLsizei length, const GLchar *message);
+typedef void (APIENTRYP PFNPOPDEBUGGROUPPROC)(void);
+
+static PFNPUSHDEBUGGROUPPROC pushDebugGroup = NULL;     // KHR_debug glPushDebugGroup(), NULL if not supported
+static PFNPOPDEBUGGROUPPROC popDebugGroup = NULL;       // KHR_debug glPopDebugGroup(), NULL if not supported
+static int debugPerfMessages = 0;           // Driver performance messages received in current frame
+static int debugErrorMessages = 0;          // Driver error messages received in current frame
+static int debugMessagesLogged = 0;         // Driver debug messages logged
+
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+#define SOAK_TEST_DURATION      (4*3600)    // Soak test duration (in seconds)
+#define SOAK_WARMUP_SAMPLES     2           // Samples discarded before registering baseline
+#define SOAK_MEMORY_GROWTH      (16*1024*1024)  // Max memory growth over baseline (bytes)
+#define SOAK_FRAMETIME_DRIFT    1.5f        // Max p99 frame time growth over baseline (ratio)
+
+static char botKeyState[512] = { 0 };       // Keys held down by autoplay bot
+static FrameStats soakBaseline = { 0 };     // Stats registered after warmup, used as reference
+static FILE *soakFile = NULL;               // Soak test stats output file (CSV)
+static int soakRegressions = 0;             // Regressions detected along the soak test
+#endif
 
 //----------------------------------------------------------------------------------
 // Module specific Functions Declaration
@@ -119,12 +668,15 @@ static Rectangle tilesetRecs[TILESET_TILES] = {
 //----------------------------------------------------------------------------------
 static void ErrorCallback(int error, const char* description);                              // GLFW3: Error callback function
 static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);   // GLFW3: Keyboard callback function
+static void WindowRefreshCallback(GLFWwindow *window);                                      // GLFW3: Window refresh callback function
 
 static void InitWindow(int width, int height);          // Initialize window and context
 static void InitGraphicsDevice(int width, int height);  // Initialize graphic device
 static void CloseWindow(void);                          // Close window and free resources
 static void SetTargetFPS(int fps);                      // Set target FPS (maximum)
 static void SyncFrame(void);                            // Synchronize to desired framerate
+static bool IsWindowIdle(void);                         // Check if window is unfocused or iconified (idle mode)
+static bool WaitIdleEvents(void);                       // Wait for window events while idle, returns true if a redraw is required
 
 // LESSON 03: Inputs management (keyboard and mouse)
 //----------------------------------------------------------------------------------
@@ -143,9 +695,14 @@ static void DrawRectangleRec(Rectangle rec, Color color);
 //----------------------------------------------------------------------------------
 static Image LoadImage(const char *fileName);       // Load image data to CPU memory (RAM)
 static void UnloadImage(Image image);               // Unload image data from CPU memory (RAM)
-static Texture2D LoadTextureFromImage(Image image); // Load texture from image data into GPU memory (VRAM)
 static void UnloadTexture(Texture2D texture);       // Unload texture data from GPU memory (VRAM)
 static Image LoadBMP(const char *fileName);         // Load BMP image file data
+static IndexedImage LoadIndexedImage(const char *fileName);         // Load indexed image data to CPU memory (RAM)
+static void UnloadIndexedImage(IndexedImage image);                 // Unload indexed image data from CPU memory (RAM)
+static Texture2D LoadTextureFromIndexedImage(IndexedImage image);   // Load texture from indexed image indices into GPU memory (VRAM - R8)
+static Texture2D LoadPaletteTexture(IndexedImage image);            // Load texture from indexed image palette into GPU memory (VRAM - 256x1)
+static Shader LoadPaletteShader(void);                              // Load palette lookup shader (indices on texture unit 0, palette on unit 1)
+static IndexedImage LoadBMPIndexed(const char *fileName);           // Load BMP image file data, 8bpp indexed
 
 static void DrawTexture(Texture2D texture, int posX, int posY, Color tint);   // Draw texture in screen position coordinates
 static void DrawTextureEx(Texture2D texture, Vector2 position, float rotation, float scale, Color tint);    // Draw a Texture2D with extended parameters
@@ -156,12 +713,178 @@ static void DrawTexturePro(Texture2D texture, Rectangle sourceRec, Rectangle des
 //----------------------------------------------------------------------------------
 static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap);// Load tilemap data from file
 static void UnloadTilemap(Tilemap map);                   // Unload tilemap data
-static void DrawTilemap(Tilemap map, Texture2D tileset);  // Draw tilemap using tileset
+static void DrawTilemapRec(Tilemap map, Texture2D tileset, Rectangle view);    // Draw tilemap tiles visible in view rectangle
+#if defined(WORLD_STREAMING) || defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK)
+static Tile GetTilemapTile(Tilemap map, int x, int y);    // Get tilemap tile (in tiles), empty tile if outside tilemap or not resident
+#endif
+static int GetTilemapValue(Tilemap map, int x, int y);    // Get tilemap tile value (in tiles), 0 if outside tilemap or not resident
+static bool GetTilemapCollider(Tilemap map, int x, int y);    // Get tilemap tile collider (in tiles), false if outside tilemap or not resident
+static bool GetTilemapLayers(Tilemap map, int *x, int *y, TileLayers *layers);    // Get packed tiles layers holding a tile, tile position is converted to layers position
+static void SetTilemapColor(Tilemap *map, int x, int y, Color color);  // Set tilemap tile color (sparse colors table)
+static Color GetTilemapColor(Tilemap map, int x, int y);  // Get tilemap tile color, WHITE if tile is not colored
+static void LoadTilemapColors(const char *colorsMap, Tilemap *map);  // Load tilemap tiles colors from file
+static TileLayers LoadTileLayers(int width, int height);  // Load packed tiles layers (empty tiles)
+static void UnloadTileLayers(TileLayers layers);          // Unload packed tiles layers
+static void SetTileLayersTile(TileLayers *layers, int x, int y, Tile tile);    // Set packed tiles layers tile
+#if defined(WORLD_STREAMING) || defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK)
+static Tile GetWorldRoomTile(Tilemap room, int x, int y, int roomsX, int roomsY);   // Get world tile (in tiles), world is tilemap repeated as rooms connected by corridors
+#endif
+
+#if defined(WORLD_STREAMING)
+// World regions streaming: regions file loading and resident regions management
+//----------------------------------------------------------------------------------
+static Tilemap LoadTilemapRegions(const char *fileName);  // Load tilemap from regions file for streaming (regions index only)
+static void ExportTilemapRegions(Tilemap room, const char *fileName, int roomsX, int roomsY);    // Export a world of repeated tilemap rooms into a regions file
+static void UpdateTilemapStreaming(Tilemap map, Vector2 position, Vector2 direction);           // Load regions around position, pre-fetch regions ahead, evict far regions
+static WorldRegion *LoadWorldRegion(WorldStreamer *streamer, int regionX, int regionY);        // Get resident region, region is loaded if required
+static void PrefetchWorldRegion(WorldStreamer *streamer, int regionX, int regionY);            // Pre-fetch region, so it's available when required
+#endif
 
 // LESSON 07: Collision detection
 //----------------------------------------------------------------------------------
 static bool CheckCollisionRecs(Rectangle rec1, Rectangle rec2); // Check collision between two rectangles
 
+static void LoadTilesetRecs(const char *idsMap, int tileCountX, int tileSize);                  // Load tileset rectangles from tileset ids file
+static void LoadTilesetMasks(const char *collidersMap, IndexedImage tileset, int tileSize);     // Load tileset collision masks from tileset colliders file and tileset image
+static CollisionMask GenCollisionMask(IndexedImage image, Rectangle rec, int emptyIndex);      // Generate collision mask from indexed image rectangle
+static CollisionMask GenCollisionMaskRec(int width, int height);                                // Generate collision mask for a rectangle (all pixels solid)
+static bool CheckCollisionTilemapMask(Tilemap map, CollisionMask mask, Vector2 position);       // Check collision between a collision mask and tilemap solid pixels
+
+static int LoadTilemapObjects(const char *objectsMap, Tilemap map, Entity *entities, int maxEntities); // Load tilemap objects as entities
+static void DrawEntities(Entity *entities, int count, Texture2D tileset);      // Draw entities using tileset
+
+static SweepAndPrune LoadSweepAndPrune(int capacity);   // Load sweep-and-prune broadphase data
+static void UnloadSweepAndPrune(SweepAndPrune sap);     // Unload sweep-and-prune broadphase data
+static void UpdateSweepAndPrune(SweepAndPrune *sap, Entity *entities, int count);  // Sort entities bounds and find overlapping pairs
+static int CheckCollisionBoundsBatch(SweepAndPrune *sap, int index, int first);    // Check collision between bounds and a batch of bounds
+
+#if defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK) || defined(MONSTER_CROWD)
+// Hierarchical pathfinding (HPA*): clusters entrances graph over tiles walkability
+//----------------------------------------------------------------------------------
+static PathGrid LoadPathGrid(int width, int height);    // Load pathfinding grid, all tiles blocked
+#if defined(MONSTER_CROWD)
+static PathGrid LoadPathGridFromTilemap(Tilemap map);   // Load pathfinding grid from tilemap colliders, clusters graph is built
+#endif
+static void UnloadPathGrid(PathGrid grid);              // Unload pathfinding grid data
+static void SetPathGridTile(PathGrid *grid, int x, int y, bool walkable);     // Set tile walkability, clusters graph is not updated
+static void BuildPathGrid(PathGrid *grid);              // Build all clusters entrances and intra-cluster costs
+#if defined(PATHFINDING_BENCHMARK)
+static void UpdatePathGridTile(PathGrid *grid, int x, int y, bool walkable);  // Update tile walkability and clusters graph (incremental)
+#endif
+static Path FindPath(PathGrid *grid, int startX, int startY, int goalX, int goalY);    // Find path between two tiles (abstract path)
+static bool GetPathNextTile(PathGrid *grid, Path *path, int *x, int *y);     // Get path next tile, path is refined lazily
+static void UnloadPath(Path path);                      // Unload path data
+#if defined(PATHFINDING_BENCHMARK)
+static int FindPathFlat(PathGrid *grid, int startX, int startY, int goalX, int goalY);  // Find path length with A* over all tiles, -1 if not found
+#endif
+
+static void BuildPathCluster(PathGrid *grid, int index);                     // Build cluster entrance nodes and intra-cluster costs
+static void SearchPathCluster(PathGrid *grid, int index, int startX, int startY);      // Compute tile steps from a tile to all cluster tiles
+static unsigned short GetPathClusterDistance(PathGrid *grid, int index, int x, int y); // Get tile distance from last cluster search start
+static void RefinePathSegment(PathGrid *grid, Path *path, int from, int to);  // Refine abstract path segment into tiles
+static bool IsPathTileWalkable(PathGrid *grid, int x, int y);                // Check if tile is walkable (tiles out of grid are not walkable)
+static void BeginPathSearch(PathGrid *grid, int entries);                    // Begin a search over entries, search scratch grows if required
+static void RelaxPathNode(PathGrid *grid, int id, int cost, int parent, int heuristic);    // Set entry cost and parent if cost improves
+static PathHeapNode PopPathHeap(PathGrid *grid);                             // Pop lowest cost entry from search heap
+#if defined(PATHFINDING_BENCHMARK)
+static void BenchmarkPathfinding(Tilemap room, int size, int queries);      // Measure hierarchical and flat pathfinding queries per second
+#endif
+#endif
+
+// AI update scheduler: distance-based update rate and per-frame time budget
+//----------------------------------------------------------------------------------
+static UpdateScheduler LoadUpdateScheduler(int capacity, float budget);   // Load update scheduler (entities ids capacity, budget in ms)
+static void UnloadUpdateScheduler(UpdateScheduler scheduler);             // Unload update scheduler data
+static void SetUpdateBucket(UpdateScheduler *scheduler, int id, int bucket);   // Set entity update bucket, entity is registered on first call
+static int GetUpdateBucket(Vector2 position, Vector2 viewer, Rectangle view);  // Get update bucket for a position (visible on view, near or far from viewer)
+static int BeginUpdates(UpdateScheduler *scheduler);                      // Begin frame updates, returns entities to update (deferred included)
+static bool NextUpdate(UpdateScheduler *scheduler, int *id, float *deltaTime); // Get next entity to update and its elapsed time, false when done or out of budget
+
+#if defined(MONSTER_CROWD)
+// Crowd: local avoidance (ORCA) with uniform grid neighbours and parallel solve
+//----------------------------------------------------------------------------------
+static void StartCrowd(Crowd *crowd, PathGrid *grid, float tileSize, Vector2 origin, int capacity, int threadCount);  // Load crowd data and start worker threads
+static void StopCrowd(Crowd *crowd);                    // Stop worker threads and unload crowd data
+static int AddCrowdAgent(Crowd *crowd, Vector2 position);   // Add crowd agent, returns agent index (-1 if crowd is full)
+static void UpdateCrowd(Crowd *crowd, float deltaTime); // Update crowd agents at fixed rate (CROWD_SIMULATION_RATE)
+static void StepCrowd(Crowd *crowd, float stepTime);    // Compute agents collision-free velocities and move agents
+static void DrawCrowd(Crowd *crowd, Color color);       // Draw crowd agents (interpolated between steps)
+static void SetCrowdAgentTarget(Crowd *crowd, int index, Vector2 target);  // Set agent goal towards target following a path around walls
+
+static void UpdateCrowdCells(Crowd *crowd);             // Sort agents into neighbour cells
+static void SolveCrowdAgents(Crowd *crowd, int first, int last);    // Compute agents range collision-free velocities
+static Vector2 SolveCrowdAgent(Crowd *crowd, int index);            // Compute agent collision-free velocity (constraints from walls and neighbours)
+static void *CrowdWorkerMain(void *arg);                // Crowd worker loop: solve its agents range on every step
+static bool CrowdLinearProgram1(const CrowdLine *lines, int lineNo, float radius, Vector2 optVelocity, bool directionOpt, Vector2 *result);  // Solve constraint line (1D)
+static int CrowdLinearProgram2(const CrowdLine *lines, int count, float radius, Vector2 optVelocity, bool directionOpt, Vector2 *result);    // Solve constraints (2D), returns first failed line
+static void CrowdLinearProgram3(const CrowdLine *lines, int count, int wallCount, int beginLine, float radius, Vector2 *result);            // Solve infeasible constraints, minimizing max violation
+#if defined(CROWD_BENCHMARK)
+static void BenchmarkCrowd(Tilemap room, int agents, int steps);    // Measure crowd step time on a dense world
+#endif
+#endif
+
+// 2D render queue: sort-key based drawing
+//----------------------------------------------------------------------------------
+static RenderQueue LoadRenderQueue(int capacity);       // Load render queue data
+static void UnloadRenderQueue(RenderQueue queue);       // Unload render queue data
+static void BeginRenderQueue(RenderQueue *queue);       // Begin queueing 2D drawing (textures and rectangles)
+#if !defined(RENDER_THREAD)
+static int EndRenderQueue(void);                        // Sort queued drawing and draw it in merged batches, returns batches
+#endif
+static int DrawRenderQueue(RenderQueue *queue);         // Sort queue items and draw them in merged batches, returns batches
+static void SetRenderQueueLayer(int layer);             // Set layer for next queued drawing [0..255], lower layers drawn first
+static void SetRenderQueueOffset(Vector2 offset);       // Set drawing offset for next queued drawing (view scrolling)
+static void SetRenderQueueShader(Shader shader, Texture2D palette);    // Set shader and palette texture (id 0 if not used) for next queued drawing
+static void QueueRenderItem(RenderItem item);           // Add item to active render queue
+static void SortRenderQueue(RenderQueue *queue);        // Sort queued items by key (LSD radix sort, 8 bits per pass)
+
+#if defined(RENDER_THREAD)
+// Render thread: frames drawn on a dedicated thread (double-buffered render queues)
+//----------------------------------------------------------------------------------
+static bool StartRenderThread(RenderThread *renderThread);  // Load frames queues and start render thread, OpenGL context is moved to it, returns false on failure
+static void StopRenderThread(RenderThread *renderThread);   // Stop render thread once last frame is drawn, OpenGL context is moved back
+static void BeginRenderFrame(RenderThread *renderThread);   // Begin queueing frame drawing, waits until next queue has been drawn
+static int SubmitRenderFrame(RenderThread *renderThread);   // End queueing frame drawing and hand queue to render thread, returns last frame drawn batches
+static int DrawRenderFrame(RenderQueue *queue, QualitySettings settings);   // Draw frame queue into scene target and swap buffers, returns batches
+static void *RenderThreadMain(void *arg);                   // Render thread loop: draw submitted queues and swap buffers
+static void UpdateRenderCounters(RenderThread *renderThread);   // Register drawn frame debug messages and VRAM counters (OpenGL context thread)
+#endif
+
+// Quality settings: presets, config file and hardware probe
+//----------------------------------------------------------------------------------
+static QualitySettings GetQualityPreset(int preset, int screenWidth, int screenHeight); // Get quality preset settings for a window size
+#if !defined(SOAK_TEST)
+static bool LoadQualitySettings(const char *fileName, QualitySettings *settings);  // Load quality settings from config file, returns false if not available
+#endif
+static void SaveQualitySettings(const char *fileName, QualitySettings settings);   // Save quality settings to config file
+static void SetQualitySettings(QualitySettings settings);   // Set quality settings, applied on next frame drawing
+static void UpdateSceneTarget(SceneTarget *target, QualitySettings settings);  // Reload scene render target and set vsync if settings changed
+static void UnloadSceneTarget(SceneTarget *target);         // Unload scene render target (VRAM)
+static void BeginSceneTarget(SceneTarget target);           // Begin drawing scene into render target
+static void EndSceneTarget(SceneTarget target);             // End drawing scene, resolve and upscale it to window
+static void StartQualityProbe(QualityProbe *probe);         // Start hardware probe, most expensive preset first
+static bool UpdateQualityProbe(QualityProbe *probe, float frameTime);   // Register probe frame time (ms), returns true if probed preset changed
+
+// Frame stats: frame times, memory usage and VRAM counters
+//----------------------------------------------------------------------------------
+static void UpdateFrameStats(float frameTime);      // Register frame time (ms), reduce stats at sample end
+static float GetFrameTimePercentile(float *times, int count, float percentile); // Get frame times percentile (sorts times)
+static long GetMemoryUsage(void);                   // Get process memory usage, resident set size (bytes)
+
+// Debug output: driver debug messages and debug groups
+//----------------------------------------------------------------------------------
+static void InitDebugOutput(void);                  // Install driver debug messages callback (debug context required)
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam); // Driver debug messages callback
+static void BeginDebugGroup(const char *name);      // Begin debug group, visible on graphics debuggers
+static void EndDebugGroup(void);                    // End debug group
+
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+//----------------------------------------------------------------------------------
+static void UpdateBot(bool blocked);                // Update random-walk bot keys, new direction if blocked
+static void CheckSoakRegressions(void);             // Record last stats sample and check it against baseline
+#endif
+
 //----------------------------------------------------------------------------------
 // Main Entry point
 //----------------------------------------------------------------------------------
@@ -169,8 +892,17 @@ int main(void)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
-    const int screenWidth = 800;
-    const int screenHeight = 450;
+    // Quality settings: loaded from config file, a hardware probe selects a preset on first launch
+    // NOTE: Window size is also read from config file (not probed)
+    QualitySettings settings = GetQualityPreset(QUALITY_HIGH, 800, 450);
+#if defined(SOAK_TEST)
+    bool probeRequired = false;     // Soak test runs with default settings, config file is not used
+#else
+    bool probeRequired = !LoadQualitySettings(QUALITY_SETTINGS_FILE, &settings);
+#endif
+    
+    const int screenWidth = settings.screenWidth;
+    const int screenHeight = settings.screenHeight;
     
     // LESSON 01: Window and graphic device initialization and management
     InitWindow(screenWidth, screenHeight);          // Initialize Window using GLFW3
@@ -178,9 +910,14 @@ int main(void)
     InitGraphicsDevice(screenWidth, screenHeight);  // Initialize graphic device (OpenGL)
        
     // Load player texture
-    Image imPlayer = LoadImage("resources/player.bmp");
-    Texture2D texPlayer = LoadTextureFromImage(imPlayer);
-    UnloadImage(imPlayer);
+    // NOTE: Indexed image: palette indices texture (R8) and palette texture, palette lookup on shader
+    IndexedImage imPlayer = LoadIndexedImage("resources/player_indexed.bmp");
+    Texture2D texPlayer = LoadTextureFromIndexedImage(imPlayer);
+    Texture2D texPlayerPalette = LoadPaletteTexture(imPlayer);
+    
+    // LESSON 07: Player collision mask, sprite pixels not transparent are solid
+    CollisionMask playerMask = GenCollisionMask(imPlayer, (Rectangle){ 0, 0, imPlayer.width, imPlayer.height }, imPlayer.transparentIndex);
+    UnloadIndexedImage(imPlayer);
     
     // LESSON 06: Load tilemap data: tile values (tileset index) and tile colliders
     Tilemap tilemap = LoadTilemap("resources/tilemap.txt", "resources/tilemap_colliders.txt");
@@ -189,77 +926,375 @@ int main(void)
     tilemap.position = (Vector2){ screenWidth/2 - tilemap.tileCountX*tilemap.tileSize/2, 
                                   screenHeight/2 - tilemap.tileCountY*tilemap.tileSize/2 };
 
+#if defined(PATHFINDING_BENCHMARK)
+    BenchmarkPathfinding(tilemap, PATH_BENCHMARK_SIZE, PATH_BENCHMARK_QUERIES);
+#endif
+#if defined(CROWD_BENCHMARK)
+    BenchmarkCrowd(tilemap, CROWD_BENCHMARK_AGENTS, CROWD_BENCHMARK_STEPS);
+#endif
+#if defined(MONSTER_CROWD)
+    // Monsters crowd: walls are tilemap colliders, monsters spawn on random walkable tiles
+    // NOTE: Monsters move on first room tiles (world origin), also on streamed worlds
+    PathGrid monstersGrid = LoadPathGridFromTilemap(tilemap);
+    Crowd crowd = { 0 };
+    
+    StartCrowd(&crowd, &monstersGrid, tilemap.tileSize, tilemap.position, CROWD_AGENTS_COUNT, CROWD_THREADS);
+    
+    for (int i = 0; i < CROWD_AGENTS_COUNT; i++)
+    {
+        int x, y;
+        
+        do { x = rand()%monstersGrid.width; y = rand()%monstersGrid.height; } while (!IsPathTileWalkable(&monstersGrid, x, y));
+        
+        AddCrowdAgent(&crowd, (Vector2){ tilemap.position.x + (x + 0.5f)*tilemap.tileSize, tilemap.position.y + (y + 0.5f)*tilemap.tileSize });
+    }
+#endif
+
+#if defined(WORLD_STREAMING)
+    // Large world: tilemap repeated as rooms connected by corridors, exported once into a regions file
+    // NOTE: Only regions around player are resident, view follows player (world origin at tilemap position)
+    // NOTE: Regions file is exported again if missing or not valid (i.e. previous file version)
+    Tilemap world = LoadTilemapRegions(WORLD_REGIONS_FILE);
+    
+    if (world.streamer == NULL)
+    {
+        ExportTilemapRegions(tilemap, WORLD_REGIONS_FILE, WORLD_ROOMS_X, WORLD_ROOMS_Y);
+        world = LoadTilemapRegions(WORLD_REGIONS_FILE);
+    }
+    
+    world.tileSize = 32;
+    world.position = tilemap.position;
+    
+    UnloadTilemap(tilemap);
+    tilemap = world;
+#endif
+
+    // LESSON 06: Load tiles colors (tile drawing tint), tiles not listed are not tinted
+    LoadTilemapColors("resources/tilemap_colors.txt", &tilemap);
+
     // Load tileset texture
-    Image imTileset = LoadImage("resources/tileset.bmp");
-    Texture2D texTileset = LoadTextureFromImage(imTileset);
-    UnloadImage(imTileset);
+    IndexedImage imTileset = LoadIndexedImage("resources/tileset_indexed.bmp");
+    Texture2D texTileset = LoadTextureFromIndexedImage(imTileset);
+    Texture2D texTilesetPalette = LoadPaletteTexture(imTileset);
+    
+    // LESSON 07: Load tileset index rectangles and tileset colliders (pixel-accurate collision masks)
+    LoadTilesetRecs("resources/tileset_ids.txt", imTileset.width/tilemap.tileSize, tilemap.tileSize);
+    LoadTilesetMasks("resources/tileset_colliders.txt", imTileset, tilemap.tileSize);
+    UnloadIndexedImage(imTileset);
     
-    // TODO: Load tileset index rectangles
-    // TODO: Load tileset colliders
+    // Palette lookup shader, used to draw indexed textures
+    Shader shdPalette = LoadPaletteShader();
+    
+    // Dummy entities collision mask (solid bounds)
+    CollisionMask entityMask = GenCollisionMaskRec(8, 8);
     
     // Init player position
-    Rectangle player = { tilemap.position.x + 1*tilemap.tileSize + 8, tilemap.position.y + 1*tilemap.tileSize + 8, 8, 8 };
+    // NOTE: Player bounds match player sprite, walls collision is tested with sprite mask
+    Rectangle player = { tilemap.position.x + 1*tilemap.tileSize + 8, tilemap.position.y + 1*tilemap.tileSize + 8, playerMask.width, playerMask.height };
     Rectangle oldPlayer = player;
+    
+    // LESSON 07: Load entities: player (first entity) and tilemap objects (pickups)
+    // NOTE: Player entity bounds are updated from player rectangle every frame
+    Entity *entities = (Entity *)calloc(MAX_ENTITIES, sizeof(Entity));
+    int entityCount = 1;
+    int pickupsCollected = 0;
+    
+    entities[0] = (Entity){ { player.x, player.y }, { player.width, player.height }, { 0, 0 }, ENTITY_PLAYER, 0, true };
+    entityCount += LoadTilemapObjects("resources/tilemap_objects.txt", tilemap, entities + entityCount, MAX_ENTITIES - entityCount);
+
+#if defined(ENTITIES_STRESS_TEST)
+    // Add moving dummy entities, bouncing on screen limits
+    for (int i = 0; (i < STRESS_ENTITIES_COUNT) && (entityCount < MAX_ENTITIES); i++, entityCount++)
+    {
+        entities[entityCount] = (Entity){ { rand()%(screenWidth - 8), rand()%(screenHeight - 8) }, { 8, 8 }, 
+                                          { (rand()%5 - 2)*0.5f, (rand()%5 - 2)*0.5f }, ENTITY_DUMMY, 0, true };
+    }
+#endif
+
+    // LESSON 07: Entities collision broadphase
+    SweepAndPrune sap = LoadSweepAndPrune(MAX_ENTITIES);
+    
+    // AI updates scheduler: ids are entities indices, monsters ids follow entities ones (MAX_ENTITIES + monster)
+    // NOTE: Moving entities start updating every frame, their bucket is set after every update
+#if defined(MONSTER_CROWD)
+    UpdateScheduler scheduler = LoadUpdateScheduler(MAX_ENTITIES + CROWD_AGENTS_COUNT, UPDATE_FRAME_BUDGET);
+    
+    for (int i = 0; i < crowd.count; i++) SetUpdateBucket(&scheduler, MAX_ENTITIES + i, 0);
+#else
+    UpdateScheduler scheduler = LoadUpdateScheduler(MAX_ENTITIES, UPDATE_FRAME_BUDGET);
+#endif
+    for (int i = 1; i < entityCount; i++) if (entities[i].type == ENTITY_DUMMY) SetUpdateBucket(&scheduler, i, 0);
+    
+    // 2D render queue, drawing is sorted by layer and merged by texture
+#if defined(RENDER_THREAD)
+    RenderThread renderThread = { 0 };
+    
+    // NOTE: OpenGL context is owned by render thread from now on, frames are drawn on this thread if it could not be started
+    bool renderThreaded = StartRenderThread(&renderThread);
+#else
+    RenderQueue renderQueue = LoadRenderQueue(RENDER_QUEUE_CAPACITY);
+#endif
+    int renderBatches = 0;
+    
+    // Apply quality settings, hardware probe starts drawing the scene with most expensive preset
+    QualityProbe probe = { 0 };
+    
+    if (probeRequired)
+    {
+        StartQualityProbe(&probe);
+        
+        settings = GetQualityPreset(probe.preset, screenWidth, screenHeight);
+        settings.vsync = false;     // Probe measures frame times without waiting for vertical sync
+    }
+    
+    SetQualitySettings(settings);
 
-    SetTargetFPS(60);
+    SetTargetFPS(probe.active? 0 : 60);     // Probe frames are not limited
+    
+#if defined(SOAK_TEST)
+    soakFile = fopen("soak_stats.csv", "wt");
+    if (soakFile != NULL) fprintf(soakFile, "time,rss_bytes,vram_bytes,vram_available_bytes,p50_ms,p95_ms,p99_ms,max_ms,perf_messages,perf_messages_peak,error_messages\n");
+#endif
     //--------------------------------------------------------------------------------------    
 
     // Main game loop    
     while (!glfwWindowShouldClose(window))
     {
+        // Idle mode: game is paused while window is unfocused or iconified, frames are only
+        // drawn (not updated) when window contents get damaged (exposed or resized)
+        bool idle = IsWindowIdle();
+        if (idle && !WaitIdleEvents()) continue;
+        
         // Update
         //----------------------------------------------------------------------------------
-        // Player movement logic
-        oldPlayer = player;
-        
-        if (IsKeyDown(GLFW_KEY_DOWN)) player.y += 2;
-        else if (IsKeyDown(GLFW_KEY_UP)) player.y -= 2;
+        // NOTE: Game is paused on idle frames, only view is computed for drawing
+        if (!idle)
+        {
+#if defined(SOAK_TEST)
+            // Random-walk bot drives player inputs, it changes direction when movement was undone
+            UpdateBot((player.x == oldPlayer.x) && (player.y == oldPlayer.y));
+#endif
+            // Player movement logic
+            oldPlayer = player;
+            
+            if (IsKeyDown(GLFW_KEY_DOWN)) player.y += 2;
+            else if (IsKeyDown(GLFW_KEY_UP)) player.y -= 2;
+            
+            if (IsKeyDown(GLFW_KEY_RIGHT)) player.x += 2;
+            else if (IsKeyDown(GLFW_KEY_LEFT)) player.x -= 2;
+            
+#if defined(WORLD_STREAMING)
+            // Stream regions around player (collisions and drawing), pre-fetch along movement direction
+            UpdateTilemapStreaming(tilemap, (Vector2){ player.x, player.y }, (Vector2){ player.x - oldPlayer.x, player.y - oldPlayer.y });
+#endif
+            // LESSON 7: Collision detection and resolution
+            // NOTE: Player sprite mask is tested against solid pixels of covered tiles only
+            if (CheckCollisionTilemapMask(tilemap, playerMask, (Vector2){ player.x, player.y }))
+            {
+                // Reset player position (undo player position update!)
+                player = oldPlayer;
+            }
+        }
         
-        if (IsKeyDown(GLFW_KEY_RIGHT)) player.x += 2;
-        else if (IsKeyDown(GLFW_KEY_LEFT)) player.x -= 2;
+        // View: screen area in tilemap coordinates, scrolled to follow player on streamed worlds
+        Rectangle view = { 0, 0, screenWidth, screenHeight };
+#if defined(WORLD_STREAMING)
+        view.x = (int)(player.x + player.width/2 - screenWidth/2);
+        view.y = (int)(player.y + player.height/2 - screenHeight/2);
+#endif
+        Vector2 playerCenter = { player.x + player.width/2, player.y + player.height/2 };
         
-        // LESSON 7: Collision detection and resolution
-        for (int y = 0; y < tilemap.tileCountY; y++)
+        if (!idle)
         {
-            for (int x = 0; x < tilemap.tileCountX; x++)
+            // LESSON 07: Entities movement and entity-vs-entity collision detection
+            entities[0].position = (Vector2){ player.x, player.y };
+            
+            // AI updates: entities due this frame (by update bucket) are updated while frame budget lasts
+            // NOTE: Entities move by time elapsed since their last update (delta time compensation)
+            BeginUpdates(&scheduler);
+            
+            int id = 0;
+            float deltaTime = 0.0f;
+            
+            while (NextUpdate(&scheduler, &id, &deltaTime))
             {
-                // TODO: Review player padding for a better collision with walls
-                if ((tilemap.tiles[y*tilemap.tileCountX + x].collider == 0) &&
-                    CheckCollisionRecs((Rectangle){ player.x + PLAYER_COLLISION_PADDING, player.y + PLAYER_COLLISION_PADDING, player.width, player.height }, 
-                                       (Rectangle){ tilemap.position.x + x*tilemap.tileSize + PLAYER_COLLISION_PADDING, tilemap.position.y + y*tilemap.tileSize + PLAYER_COLLISION_PADDING, tilemap.tileSize, tilemap.tileSize }))
+                Vector2 position = { 0 };
+                
+                if (id < MAX_ENTITIES)
+                {
+                    Vector2 oldPosition = entities[id].position;
+                    float frames = deltaTime*60.0f;     // Entities speed is given per frame at 60 fps
+                    
+                    entities[id].position.x += entities[id].speed.x*frames;
+                    entities[id].position.y += entities[id].speed.y*frames;
+                    
+                    // Bounce on tilemap walls, entities spawned inside walls move freely until they get out
+                    if (CheckCollisionTilemapMask(tilemap, entityMask, entities[id].position) && 
+                        !CheckCollisionTilemapMask(tilemap, entityMask, oldPosition))
+                    {
+                        entities[id].position = oldPosition;
+                        entities[id].speed.x *= -1;
+                        entities[id].speed.y *= -1;
+                    }
+                    
+                    if ((entities[id].position.x < 0) || ((entities[id].position.x + entities[id].size.x) > screenWidth)) entities[id].speed.x *= -1;
+                    if ((entities[id].position.y < 0) || ((entities[id].position.y + entities[id].size.y) > screenHeight)) entities[id].speed.y *= -1;
+                    
+                    position = entities[id].position;
+                }
+#if defined(MONSTER_CROWD)
+                else
                 {
-                    // Reset player position (undo player position update!)
-                    player = oldPlayer;
+                    // Monsters chase player, following a path around walls
+                    SetCrowdAgentTarget(&crowd, id - MAX_ENTITIES, playerCenter);
+                    position = crowd.agents[id - MAX_ENTITIES].position;
                 }
+#endif
+                SetUpdateBucket(&scheduler, id, GetUpdateBucket(position, playerCenter, view));
+            }
+            
+#if defined(MONSTER_CROWD)
+            UpdateCrowd(&crowd, (float)frameTime);  // Crowd steps at fixed rate, monsters steer to their goals
+#endif
+            
+            UpdateSweepAndPrune(&sap, entities, entityCount);
+            
+            for (int i = 0; i < sap.pairCount; i++)
+            {
+                Entity *entity1 = &entities[sap.pairs[i*2]];
+                Entity *entity2 = &entities[sap.pairs[i*2 + 1]];
+                
+                // Player collects pickups on contact
+                if ((entity1->type == ENTITY_PLAYER) && (entity2->type == ENTITY_PICKUP)) entity2->active = false;
+                else if ((entity2->type == ENTITY_PLAYER) && (entity1->type == ENTITY_PICKUP)) entity1->active = false;
+                else continue;
+                
+                pickupsCollected++;
+                TraceLog(LOG_INFO, "Pickup collected [%i]", pickupsCollected);
             }
         }
         //----------------------------------------------------------------------------------
 
         // Draw
         //----------------------------------------------------------------------------------
+#if defined(RENDER_THREAD)
+        BeginRenderFrame(&renderThread);    // Queue 2D drawing, drawn on render thread
+#else
+        UpdateSceneTarget(&sceneTarget, quality);   // Scene target is reloaded if quality settings changed
+        BeginSceneTarget(sceneTarget);      // Scene is drawn at quality settings resolution and anti-aliasing
+        
+        BeginDebugGroup("Clear");
         rlClearScreenBuffers();             // Clear current framebuffer
+        EndDebugGroup();
 
-        DrawTilemap(tilemap, texTileset);   // Draw tilemap using provide tileset
+        BeginRenderQueue(&renderQueue);     // Queue 2D drawing, sorted at queue end
+#endif
         
-        DrawTexture(texPlayer, player.x, player.y, WHITE); // Draw player texture
+            SetRenderQueueOffset((Vector2){ -view.x, -view.y });
+            SetRenderQueueShader(shdPalette, texTilesetPalette);    // Tileset indices looked up on tileset palette
+            
+            SetRenderQueueLayer(0);
+            DrawTilemapRec(tilemap, texTileset, view);  // Draw tilemap (tiles on view) using provide tileset
+            
+            SetRenderQueueLayer(1);
+            DrawEntities(entities, entityCount, texTileset);    // Draw entities (pickups) using tileset
+#if defined(MONSTER_CROWD)
+            SetRenderQueueShader(GetShaderDefault(), (Texture2D){ 0 });   // Monsters drawn without palette
+            DrawCrowd(&crowd, (Color){ 190, 33, 55, 255 });     // Draw monsters (solid rectangles)
+#endif
+            
+            SetRenderQueueShader(shdPalette, texPlayerPalette);     // Player indices looked up on player palette
+            
+            SetRenderQueueLayer(2);
+            DrawTexture(texPlayer, player.x, player.y, WHITE); // Draw player texture
+            
+#if defined(RENDER_THREAD)
+        renderBatches = SubmitRenderFrame(&renderThread);   // Render thread draws frame while next frame is updated
+        if (!renderThreaded && probe.active) glFinish();    // Probe frame time includes all GPU work of the frame
+#else
+        renderBatches = EndRenderQueue();   // Sort queued drawing and send it to rlgl in merged batches
         
+        // NOTE: rlgl batches 2D drawing, GPU work (tilemap, entities, player) is submitted here
+        BeginDebugGroup("Draw 2D batch");
         rlglDraw();                         // Internal buffers drawing (2D data)
+        EndDebugGroup();
+        
+        BeginDebugGroup("Resolve scene");
+        EndSceneTarget(sceneTarget);
+        EndDebugGroup();
 
         glfwSwapBuffers(window);            // Swap buffers: show back buffer into front
+        if (probe.active) glFinish();       // Probe frame time includes all GPU work of the frame
+#endif
         PollInputEvents();                  // Register input events (keyboard, mouse)
         SyncFrame();                        // Wait required time to target framerate
+        
+        // Hardware probe: presets are drawn from most expensive one until frame time target is met,
+        // selected preset is saved to config file and vsync and framerate limit are restored
+        // NOTE: With render thread, frame time is bounded by render thread drawing (one frame behind at most)
+        if (probe.active)
+        {
+            bool presetChanged = UpdateQualityProbe(&probe, (float)frameTime*1000.0f);
+            
+            if (presetChanged || !probe.active)
+            {
+                settings = GetQualityPreset(probe.preset, screenWidth, screenHeight);
+                settings.vsync = !probe.active;
+                
+                SetQualitySettings(settings);
+                
+                if (!probe.active)
+                {
+                    SaveQualitySettings(QUALITY_SETTINGS_FILE, settings);
+                    SetTargetFPS(60);
+                }
+            }
+        }
         //----------------------------------------------------------------------------------
     }
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+#if defined(RENDER_THREAD)
+    StopRenderThread(&renderThread);    // Last frame is drawn, OpenGL context is back on this thread
+#endif
     UnloadTexture(texPlayer);       // Unload player texture
+    UnloadTexture(texPlayerPalette);    // Unload player palette texture
     UnloadTexture(texTileset);      // Unload tileset texture
+    UnloadTexture(texTilesetPalette);   // Unload tileset palette texture
+    UnloadShader(shdPalette);       // Unload palette lookup shader
     UnloadTilemap(tilemap);         // Unload tilemap data
+#if defined(MONSTER_CROWD)
+    StopCrowd(&crowd);              // Stop crowd workers and unload crowd data
+    UnloadPathGrid(monstersGrid);   // Unload monsters walls grid
+#endif
+    
+    UnloadSweepAndPrune(sap);       // Unload entities collision broadphase data
+    UnloadUpdateScheduler(scheduler);   // Unload AI updates scheduler data
+#if !defined(RENDER_THREAD)
+    UnloadRenderQueue(renderQueue); // Unload 2D render queue data
+#endif
+    free(entities);                 // Unload entities data
     
     rlglClose();                    // Unload rlgl internal buffers and default shader/texture
     
     CloseWindow();                  // Close window and OpenGL context
+    
+    TraceLog(LOG_INFO, "STATS: Frame time p50: %.2f ms, p99: %.2f ms, max: %.2f ms, memory: %li KB", 
+             frameStats.p50, frameStats.p99, frameStats.maxTime, GetMemoryUsage()/1024);
+    TraceLog(LOG_INFO, "STATS: Driver performance messages: %i (peak %i per frame), errors: %i", 
+             frameStats.perfMessages, frameStats.perfMessagesPeak, frameStats.errorMessages);
+    TraceLog(LOG_INFO, "STATS: Render queue batches: %i (last frame)", renderBatches);
+    TraceLog(LOG_INFO, "STATS: AI updates: %.1f per frame, %li deferred to next frame", 
+             (scheduler.frame > 0)? (float)scheduler.updates/scheduler.frame : 0.0f, scheduler.deferred);
+    
+#if defined(SOAK_TEST)
+    if (soakFile != NULL) fclose(soakFile);
+    
+    TraceLog(LOG_INFO, "SOAK: Test finished, %i samples recorded, %i regressions detected", frameStats.sampleCount, soakRegressions);
+    
+    return (soakRegressions > 0)? 1 : 0;
+#endif
     //--------------------------------------------------------------------------------------
     
     return 0;
@@ -285,6 +1320,12 @@ static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, i
     else currentKeyState[key] = action;
 }
 
+// GLFW3: Window refresh callback, window contents damaged (exposed or resized)
+static void WindowRefreshCallback(GLFWwindow *window)
+{
+    windowRefresh = true;
+}
+
 // LESSON 01: Window creation and management
 //----------------------------------------------------------------------------------
 // Initialize window and context (OpenGL 3.3)
@@ -296,12 +1337,17 @@ static void InitWindow(int screenWidth, int screenHeight)
     if (!glfwInit()) TraceLog(LOG_WARNING, "GLFW3: Can not initialize GLFW");
     else TraceLog(LOG_INFO, "GLFW3: GLFW initialized successfully");
     
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_SAMPLES, 0);               // Anti-aliasing is applied on scene render target (quality settings)
     glfwWindowHint(GLFW_DEPTH_BITS, 16);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#if !defined(NDEBUG)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);     // Debug context, release builds (-DNDEBUG) use a regular context
+#endif
+#if defined(SOAK_TEST)
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);         // Soak test runs headless, window is never shown
+#endif
    
     window = glfwCreateWindow(screenWidth, screenHeight, "CHALLENGE 02: 2D DUNGEON GAME", NULL, NULL);
     
@@ -311,6 +1357,7 @@ static void InitWindow(int screenWidth, int screenHeight)
     glfwSetWindowPos(window, 200, 200);
     
     glfwSetKeyCallback(window, KeyCallback);
+    glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
     
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1);
@@ -319,6 +1366,8 @@ static void InitWindow(int screenWidth, int screenHeight)
 // Close window and free resources
 static void CloseWindow(void)
 {
+    UnloadSceneTarget(&sceneTarget);    // Unload scene render target
+    
     glfwDestroyWindow(window);      // Close window
     glfwTerminate();                // Free GLFW3 resources
 }
@@ -337,6 +1386,9 @@ static void SyncFrame(void)
     currentTime = glfwGetTime();
     frameTime = currentTime - previousTime;
     previousTime = currentTime;
+    
+    // Register frame time before waiting, it measures the frame work time
+    UpdateFrameStats((float)frameTime*1000.0f);
 
     // Wait for some milliseconds...
     if (frameTime < targetTime)
@@ -355,6 +1407,32 @@ static void SyncFrame(void)
     }
 }
 
+// Check if window is unfocused or iconified (idle mode)
+static bool IsWindowIdle(void)
+{
+#if defined(SOAK_TEST)
+    return false;       // Soak test window is hidden, it never gets focus
+#else
+    return (!glfwGetWindowAttrib(window, GLFW_FOCUSED) || glfwGetWindowAttrib(window, GLFW_ICONIFIED));
+#endif
+}
+
+// Wait for window events while idle, returns true if a redraw is required
+// NOTE: Thread sleeps until an event arrives or wait time ends, idle time is not registered as frame time
+static bool WaitIdleEvents(void)
+{
+    glfwWaitEventsTimeout(glfwGetWindowAttrib(window, GLFW_ICONIFIED)? IDLE_WAIT_TIME_ICONIFIED : IDLE_WAIT_TIME_UNFOCUSED);
+    
+    PollInputEvents();
+    
+    previousTime = glfwGetTime();
+    
+    bool redraw = windowRefresh && !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+    windowRefresh = false;
+    
+    return redraw;
+}
+
 // LESSON 02: Graphic device initialization and management
 //----------------------------------------------------------------------------------
 // Initialize graphic device (OpenGL 3.3)
@@ -362,9 +1440,15 @@ static void InitGraphicsDevice(int width, int height)
 {
     // Load OpenGL 3.3 supported extensions
     rlLoadExtensions(glfwGetProcAddress);
+    
+    // Install driver debug messages callback (debug context only)
+    InitDebugOutput();
 
     // Initialize OpenGL context (states and resources)
     rlglInit(width, height);
+    
+    // Get quality settings limits: multisample samples
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
 
     // Initialize viewport and internal projection/modelview matrices
     rlViewport(0, 0, width, height);
@@ -383,6 +1467,9 @@ static void InitGraphicsDevice(int width, int height)
 // Detect if a key is being pressed (key held down)
 static bool IsKeyDown(int key)
 {
+#if defined(SOAK_TEST)
+    if (botKeyState[key]) return true;      // Key held down by autoplay bot
+#endif
     return glfwGetKey(window, key);
 }
 
@@ -434,7 +1521,17 @@ static void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color)
 // Draw color-filled rectangle
 static void DrawRectangle(int posX, int posY, int width, int height, Color color)
 {
-#define TRIS_RECTANGLE
+    // NOTE: Queued rectangles are drawn as quads with default white texture
+    if (activeQueue != NULL)
+    {
+        Texture2D texture = GetTextureDefault();
+        
+        QueueRenderItem((RenderItem){ texture.id, texture.width, texture.height, (Rectangle){ 0, 0, 1, 1 }, 
+                                      (Rectangle){ posX, posY, width, height }, (Vector2){ 0, 0 }, 0.0f, color });
+        return;
+    }
+    
+#define TRIS_RECTANGLE
 #if defined(TRIS_RECTANGLE)
     // NOTE: We use rlgl OpenGL 1.1 style vertex definition
     rlBegin(RL_TRIANGLES);
@@ -500,28 +1597,14 @@ static void UnloadImage(Image image)
     if (image.data != NULL) free(image.data);
 }
 
-// Load texture from image data into GPU memory (VRAM)
-static Texture2D LoadTextureFromImage(Image image)
-{
-    #define UNCOMPRESSED_R8G8B8A8    7      // Texture format (must match image.data)
-    
-    Texture2D texture = { 0 };
-    
-    // NOTE: Texture2D struct is defined inside rlgl
-    texture.width = image.width;
-    texture.height = image.height;
-    texture.format = UNCOMPRESSED_R8G8B8A8;
-    texture.mipmaps = 1;
-
-    texture.id = rlLoadTexture(image.data, image.width, image.height, UNCOMPRESSED_R8G8B8A8, 1);
-
-    return texture;
-}
-
 // Unload texture data from GPU memory (VRAM)
 static void UnloadTexture(Texture2D texture)
 {
-    if (texture.id > 0) rlDeleteTextures(texture.id);
+    if (texture.id > 0) 
+    {
+        rlDeleteTextures(texture.id);
+        vramUsage -= texture.width*texture.height*((texture.format == UNCOMPRESSED_GRAYSCALE)? 1 : 4);
+    }
 }
 
 // Load bmp fileformat data
@@ -545,6 +1628,30 @@ static Image LoadBMP(const char *fileName)
 	fseek(bmpFile, 28, SEEK_SET);
 	fread(&imgBpp, 2, 1, bmpFile);          // Read bmp bit-per-pixel (usually 24bpp - B8G8R8)
 	
+    // NOTE: Indexed bmp (8bpp) pixels are expanded to palette colors, color key is kept
+    if (imgBpp == 8)
+    {
+        fclose(bmpFile);
+        
+        IndexedImage indexed = LoadBMPIndexed(fileName);
+        
+        if (indexed.data == NULL) return image;
+        
+        image.data = (Color *)malloc(indexed.width*indexed.height*sizeof(Color));
+        image.width = indexed.width;
+        image.height = indexed.height;
+        
+        for (int i = 0; i < indexed.width*indexed.height; i++)
+        {
+            image.data[i] = indexed.palette[indexed.data[i]];
+            if (indexed.data[i] == indexed.transparentIndex) image.data[i].a = 0;
+        }
+        
+        UnloadIndexedImage(indexed);
+        
+        return image;
+    }
+    
 	Color *imgData = (Color *)malloc(imgWidth*imgHeight*sizeof(Color));
 	
 	fseek(bmpFile, imgDataOffset, SEEK_SET);
@@ -599,6 +1706,213 @@ static Image LoadBMP(const char *fileName)
     return image;
 }
 
+// Load indexed image data to CPU memory (RAM)
+// NOTE: Only 8bpp indexed bmp files are supported
+static IndexedImage LoadIndexedImage(const char *fileName)
+{
+    IndexedImage image = { 0 };
+    const char *fileExt;
+    
+    image.transparentIndex = -1;
+    
+    if ((fileExt = strrchr(fileName, '.')) != NULL)
+    {
+        // Check if file extension is supported
+        if (strcmp(fileExt, ".bmp") == 0) image = LoadBMPIndexed(fileName);
+    }
+
+    return image;
+}
+
+// Unload indexed image data from CPU memory (RAM)
+static void UnloadIndexedImage(IndexedImage image)
+{
+    if (image.data != NULL) free(image.data);
+}
+
+// Load texture from indexed image indices into GPU memory (VRAM)
+// NOTE: Indices are uploaded as a single channel texture (R8), palette is uploaded separately
+static Texture2D LoadTextureFromIndexedImage(IndexedImage image)
+{
+    Texture2D texture = { 0 };
+    
+    if (image.data == NULL) return texture;
+    
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.format = UNCOMPRESSED_GRAYSCALE;
+    texture.mipmaps = 1;
+
+    // NOTE: Indices texture must be sampled with GL_NEAREST filtering (rlgl default),
+    // filtering indices would interpolate between unrelated palette entries
+    texture.id = rlLoadTexture(image.data, image.width, image.height, UNCOMPRESSED_GRAYSCALE, 1);
+    
+    if (texture.id > 0) vramUsage += texture.width*texture.height;   // Register VRAM usage (R8)
+
+    return texture;
+}
+
+// Load texture from indexed image palette into GPU memory (VRAM)
+// NOTE: Palette is uploaded as a 256x1 R8G8B8A8 texture, transparent index gets alpha 0
+static Texture2D LoadPaletteTexture(IndexedImage image)
+{
+    Texture2D texture = { 0 };
+    Color palette[MAX_PALETTE_COLORS] = { 0 };
+    
+    for (int i = 0; i < image.colorCount; i++) palette[i] = image.palette[i];
+    
+    if (image.transparentIndex >= 0) palette[image.transparentIndex].a = 0;
+    
+    texture.width = MAX_PALETTE_COLORS;
+    texture.height = 1;
+    texture.format = UNCOMPRESSED_R8G8B8A8;
+    texture.mipmaps = 1;
+
+    texture.id = rlLoadTexture(palette, MAX_PALETTE_COLORS, 1, UNCOMPRESSED_R8G8B8A8, 1);
+    
+    if (texture.id > 0) vramUsage += texture.width*texture.height*4;   // Register VRAM usage (R8G8B8A8)
+
+    return texture;
+}
+
+// Load palette lookup shader (default vertex shader)
+// NOTE: Index is read from texture0 red channel and used to fetch palette color, 
+// palette colors with alpha 0 (transparent index) are discarded
+static Shader LoadPaletteShader(void)
+{
+    char paletteFShaderStr[] =
+#if defined(GRAPHICS_API_OPENGL_21)
+    "#version 120                       \n"
+#elif defined(GRAPHICS_API_OPENGL_ES2)
+    "#version 100                       \n"
+    "precision mediump float;           \n"     // precision required for OpenGL ES2 (WebGL)
+#endif
+#if defined(GRAPHICS_API_OPENGL_ES2) || defined(GRAPHICS_API_OPENGL_21)
+    "varying vec2 fragTexCoord;         \n"
+    "varying vec4 fragColor;            \n"
+#elif defined(GRAPHICS_API_OPENGL_33)
+    "#version 330                       \n"
+    "in vec2 fragTexCoord;              \n"
+    "in vec4 fragColor;                 \n"
+    "out vec4 finalColor;               \n"
+#endif
+    "uniform sampler2D texture0;        \n"     // Palette indices (R8)
+    "uniform sampler2D palette;         \n"     // Palette colors (256x1)
+    "uniform vec4 colDiffuse;           \n"
+    "void main()                        \n"
+    "{                                  \n"
+#if defined(GRAPHICS_API_OPENGL_ES2) || defined(GRAPHICS_API_OPENGL_21)
+    "    float index = texture2D(texture0, fragTexCoord).r*255.0; \n"
+    "    vec4 texelColor = texture2D(palette, vec2((index + 0.5)/256.0, 0.5)); \n"
+    "    if (texelColor.a == 0.0) discard;                    \n"
+    "    gl_FragColor = texelColor*colDiffuse*fragColor;      \n"
+#elif defined(GRAPHICS_API_OPENGL_33)
+    "    int index = int(texture(texture0, fragTexCoord).r*255.0 + 0.5); \n"
+    "    vec4 texelColor = texelFetch(palette, ivec2(index, 0), 0); \n"
+    "    if (texelColor.a == 0.0) discard;                    \n"
+    "    finalColor = texelColor*colDiffuse*fragColor;        \n"
+#endif
+    "}                                  \n";
+    
+    Shader shader = LoadShaderCode(NULL, paletteFShaderStr);
+    
+    // Palette sampler reads from texture unit 1, texture unit 0 is used by rlgl batches
+    int paletteUnit = 1;
+    if (shader.id > 0) SetShaderValuei(shader, GetShaderLocation(shader, "palette"), &paletteUnit, 1);
+    
+    return shader;
+}
+
+// Load bmp fileformat data, 8bpp indexed
+// NOTE: Palette entries are B8G8R8X8, rows are bottom-up and padded to 4 bytes,
+// compressed bmp files (RLE8) are not supported
+static IndexedImage LoadBMPIndexed(const char *fileName)
+{
+    IndexedImage image = { 0 };
+    
+    image.transparentIndex = -1;
+    
+    int imgWidth = 0;
+    int imgHeight = 0;
+    short imgBpp = 0;
+    int imgDataOffset = 0;
+    int imgHeaderSize = 0;
+    int imgCompression = 0;
+    int imgColorsUsed = 0;
+    
+    FILE *bmpFile = fopen(fileName, "rb");
+    
+    if (bmpFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] BMP Image file could not be opened", fileName);
+        return image;
+    }
+    
+    fseek(bmpFile, 10, SEEK_SET);
+    fread(&imgDataOffset, 4, 1, bmpFile);   // Read bmp data offset
+    fread(&imgHeaderSize, 4, 1, bmpFile);   // Read bmp info header size (palette follows it)
+    fread(&imgWidth, 4, 1, bmpFile);        // Read bmp width
+    fread(&imgHeight, 4, 1, bmpFile);       // Read bmp height
+    fseek(bmpFile, 28, SEEK_SET);
+    fread(&imgBpp, 2, 1, bmpFile);          // Read bmp bit-per-pixel (8bpp - palette indices)
+    fread(&imgCompression, 4, 1, bmpFile);  // Read bmp compression (0 - uncompressed)
+    fseek(bmpFile, 46, SEEK_SET);
+    fread(&imgColorsUsed, 4, 1, bmpFile);   // Read bmp palette colors used (0 means all)
+    
+    if ((imgBpp != 8) || (imgCompression != 0) || (imgWidth <= 0) || (imgHeight == 0))
+    {
+        TraceLog(LOG_WARNING, "[%s] BMP Image format not supported (%ibpp), 8bpp uncompressed required", fileName, imgBpp);
+        fclose(bmpFile);
+        return image;
+    }
+    
+    if ((imgColorsUsed <= 0) || (imgColorsUsed > MAX_PALETTE_COLORS)) imgColorsUsed = MAX_PALETTE_COLORS;
+    
+    // Read palette colors
+    fseek(bmpFile, 14 + imgHeaderSize, SEEK_SET);
+    
+    for (int i = 0; i < imgColorsUsed; i++)
+    {
+        unsigned char entry[4] = { 0 };
+        fread(entry, 4, 1, bmpFile);
+        
+        image.palette[i] = (Color){ entry[2], entry[1], entry[0], 255 };
+        
+        // NOTE: We consider a color key: MAGENTA RGB{ 255, 0, 255 }, first index using it is transparent
+        if ((image.transparentIndex == -1) && (entry[2] == 255) && (entry[1] == 0) && (entry[0] == 255)) image.transparentIndex = i;
+    }
+    
+    image.colorCount = imgColorsUsed;
+    
+    // NOTE: Negative height means top-down rows
+    bool bottomUp = (imgHeight > 0);
+    if (!bottomUp) imgHeight = -imgHeight;
+    
+    int lineSize = (imgWidth + 3) & ~3;     // Lines are padded to 4 bytes
+    unsigned char *line = (unsigned char *)malloc(lineSize);
+    
+    image.data = (unsigned char *)malloc(imgWidth*imgHeight);
+    
+    // Read image data, flipped vertically if required
+    fseek(bmpFile, imgDataOffset, SEEK_SET);
+    
+    for (int j = 0; j < imgHeight; j++)
+    {
+        fread(line, lineSize, 1, bmpFile);
+        memcpy(image.data + (bottomUp? (imgHeight - 1 - j) : j)*imgWidth, line, imgWidth);
+    }
+    
+    free(line);
+    fclose(bmpFile);
+    
+    image.width = imgWidth;
+    image.height = imgHeight;
+    
+    TraceLog(LOG_INFO, "[%s] BMP Image loaded successfully (%ix%i - %i colors indexed)", fileName, imgWidth, imgHeight, imgColorsUsed);
+    
+    return image;
+}
+
 // NOTE: Multiple versions od DrawTexture() are provided with multiple options
 
 // Draw texture in screen position coordinates
@@ -635,6 +1949,12 @@ static void DrawTexturePro(Texture2D texture, Rectangle sourceRec, Rectangle des
     {
         if (sourceRec.width < 0) sourceRec.x -= sourceRec.width;
         if (sourceRec.height < 0) sourceRec.y -= sourceRec.height;
+        
+        if (activeQueue != NULL)
+        {
+            QueueRenderItem((RenderItem){ texture.id, texture.width, texture.height, sourceRec, destRec, origin, rotation, tint });
+            return;
+        }
 
         rlEnableTexture(texture.id);
 
@@ -696,15 +2016,16 @@ static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap)
             
             rewind(valuesFile);        // Return to the beginning of the file, to read again
 
-            map.tiles = (Tile *)malloc(counter*sizeof(Tile));
-            
             map.tileCountX = 12;
             map.tileCountY = 8;
+            map.tiles = LoadTileLayers(map.tileCountX, map.tileCountY);
             counter = 0;
 
-            while (!feof(valuesFile))
+            // NOTE: Values are stored as 16 bit, values out of tileset are drawn as empty tiles
+            while (!feof(valuesFile) && (counter < map.tileCountX*map.tileCountY))
             {
-                fscanf(valuesFile, "%i", &map.tiles[counter].value);
+                fscanf(valuesFile, "%i", &temp);
+                map.tiles.values[counter] = (unsigned short)temp;
                 counter++;
             }
             
@@ -717,10 +2038,10 @@ static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap)
             counter = 0;
             temp = 0;
             
-            while (!feof(collidersFile))
+            while (!feof(collidersFile) && (counter < map.tileCountX*map.tileCountY))
             {
                 fscanf(collidersFile, "%i", &temp);
-                map.tiles[counter].collider = temp;
+                SetTileLayersTile(&map.tiles, counter%map.tileCountX, counter/map.tileCountX, (Tile){ map.tiles.values[counter], temp });
 
                 counter++;
             }
@@ -732,7 +2053,7 @@ static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap)
             {
                 for (int i = 0; i < map.tileCountX; i++)
                 {
-                    printf("%i ", map.tiles[j*map.tileCountX + i].collider);
+                    printf("%i ", GetTilemapCollider(map, i, j));
                 }
                 
                 printf("\n");
@@ -745,11 +2066,14 @@ static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap)
             
             map.tileCountX = image.width;
             map.tileCountY = image.height;
+            map.tiles = LoadTileLayers(map.tileCountX, map.tileCountY);
             
             // TODO: Load tile data from image pixel data
             
             // NOTE: When using images to codify map data, 
             // lot of extra information can be codified in each pixel!
+            
+            UnloadImage(image);
         }
     }
 
@@ -759,35 +2083,3376 @@ static Tilemap LoadTilemap(const char *valuesMap, const char *collidersMap)
 // Unload tilemap data from memory
 static void UnloadTilemap(Tilemap map)
 {
-    if (map.tiles != NULL) free(map.tiles);
+    UnloadTileLayers(map.tiles);
+    free(map.colors);
+    
+#if defined(WORLD_STREAMING)
+    WorldStreamer *streamer = map.streamer;
+    
+    if (streamer != NULL)
+    {
+        for (int i = 0; i < MAX_STREAM_REGIONS; i++) UnloadTileLayers(streamer->regions[i].tiles);
+        
+    #if !defined(_WIN32)
+        if (streamer->mapped != NULL) munmap(streamer->mapped, streamer->fileSize);
+    #endif
+        if (streamer->file != NULL) fclose(streamer->file);
+        
+        free(streamer->index);
+        free(streamer);
+    }
+#endif
 }
 
-// Draw tilemap using tileset
-static void DrawTilemap(Tilemap map, Texture2D tileset)
+// Draw tilemap tiles visible in view rectangle
+// NOTE: Only tiles overlapping view are drawn, empty (value 0) and not resident tiles are skipped,
+// tiles colors are only looked up if any tile is colored
+static void DrawTilemapRec(Tilemap map, Texture2D tileset, Rectangle view)
 {
-    for (int y = 0; y < map.tileCountY; y++)
+    int minX = (int)floorf((view.x - map.position.x)/map.tileSize);
+    int minY = (int)floorf((view.y - map.position.y)/map.tileSize);
+    int maxX = (int)floorf((view.x + view.width - 1 - map.position.x)/map.tileSize);
+    int maxY = (int)floorf((view.y + view.height - 1 - map.position.y)/map.tileSize);
+    
+    if (minX < 0) minX = 0;
+    if (minY < 0) minY = 0;
+    if (maxX >= map.tileCountX) maxX = map.tileCountX - 1;
+    if (maxY >= map.tileCountY) maxY = map.tileCountY - 1;
+    
+    for (int y = minY; y <= maxY; y++)
     {
-        for (int x = 0; x < map.tileCountX; x++)
+        for (int x = minX; x <= maxX; x++)
         {
+            int value = GetTilemapValue(map, x, y);
+            
+            if ((value <= 0) || (value > TILESET_TILES)) continue;
+            
             // Draw each piece of the tileset in the right position to build map
-            DrawTextureRec(tileset, tilesetRecs[map.tiles[y*map.tileCountX + x].value - 1], 
-                          (Vector2){ map.position.x + x*map.tileSize, map.position.y + y*map.tileSize }, WHITE);
+            DrawTextureRec(tileset, tilesetRecs[value - 1], (Vector2){ map.position.x + x*map.tileSize, map.position.y + y*map.tileSize }, 
+                           (map.colorCount > 0)? GetTilemapColor(map, x, y) : WHITE);
         }
     }
+}
+
+#if defined(WORLD_STREAMING) || defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK)
+// Get tilemap tile (in tiles), empty tile if outside tilemap or not resident
+// NOTE: Only used to build worlds of repeated rooms
+static Tile GetTilemapTile(Tilemap map, int x, int y)
+{
+    TileLayers layers = { 0 };
     
+    if (!GetTilemapLayers(map, &x, &y, &layers)) return (Tile){ 0 };
+    
+    return (Tile){ layers.values[y*layers.width + x], (layers.colliders[y*layers.stride + x/32] >> (x%32)) & 1 };
 }
+#endif
 
-// LESSON 07: Collision detection
-//----------------------------------------------------------------------------------
-// Check collision between two rectangles
-static bool CheckCollisionRecs(Rectangle rec1, Rectangle rec2)
+// Get tilemap tile value (in tiles), 0 if outside tilemap or not resident
+static int GetTilemapValue(Tilemap map, int x, int y)
 {
-    bool collision = false;
+    TileLayers layers = { 0 };
+    
+    if (!GetTilemapLayers(map, &x, &y, &layers)) return 0;
+    
+    return layers.values[y*layers.width + x];
+}
 
-    int dx = abs((rec1.x + rec1.width/2) - (rec2.x + rec2.width/2));
-    int dy = abs((rec1.y + rec1.height/2) - (rec2.y + rec2.height/2));
+// Get tilemap tile collider (in tiles), false if outside tilemap or not resident
+static bool GetTilemapCollider(Tilemap map, int x, int y)
+{
+    TileLayers layers = { 0 };
+    
+    if (!GetTilemapLayers(map, &x, &y, &layers)) return false;
+    
+    return (layers.colliders[y*layers.stride + x/32] >> (x%32)) & 1;
+}
 
-    if ((dx <= (rec1.width/2 + rec2.width/2)) && ((dy <= (rec1.height/2 + rec2.height/2)))) collision = true;
+// Get packed tiles layers holding a tile, tile position is converted to layers position
+// NOTE: Streamed tilemaps tiles are looked up on resident regions (last region accessed is checked first)
+static bool GetTilemapLayers(Tilemap map, int *x, int *y, TileLayers *layers)
+{
+    if ((*x < 0) || (*y < 0) || (*x >= map.tileCountX) || (*y >= map.tileCountY)) return false;
+    
+#if defined(WORLD_STREAMING)
+    WorldStreamer *streamer = map.streamer;
+    
+    if (streamer != NULL)
+    {
+        int regionX = *x/streamer->regionSize;
+        int regionY = *y/streamer->regionSize;
+        WorldRegion *region = &streamer->regions[streamer->lastRegion];
+        
+        if ((region->tiles.values == NULL) || (region->x != regionX) || (region->y != regionY))
+        {
+            int i = 0;
+            
+            while ((i < MAX_STREAM_REGIONS) && ((streamer->regions[i].tiles.values == NULL) || 
+                   (streamer->regions[i].x != regionX) || (streamer->regions[i].y != regionY))) i++;
+            
+            if (i == MAX_STREAM_REGIONS) return false;
+            
+            streamer->lastRegion = i;
+            region = &streamer->regions[i];
+        }
+        
+        *x %= streamer->regionSize;
+        *y %= streamer->regionSize;
+        *layers = region->tiles;
+        
+        return true;
+    }
+#endif
 
-    return collision;
+    if (map.tiles.values == NULL) return false;
+    
+    *layers = map.tiles;
+    
+    return true;
+}
+
+// Set tilemap tile color (sparse colors table, kept sorted by tile index)
+static void SetTilemapColor(Tilemap *map, int x, int y, Color color)
+{
+    if ((x < 0) || (y < 0) || (x >= map->tileCountX) || (y >= map->tileCountY)) return;
+    
+    int index = y*map->tileCountX + x;
+    int i = 0;
+    
+    while ((i < map->colorCount) && (map->colors[i].index < index)) i++;
+    
+    if ((i == map->colorCount) || (map->colors[i].index != index))
+    {
+        map->colors = (TileColor *)realloc(map->colors, (map->colorCount + 1)*sizeof(TileColor));
+        memmove(&map->colors[i + 1], &map->colors[i], (map->colorCount - i)*sizeof(TileColor));
+        map->colorCount++;
+    }
+    
+    map->colors[i] = (TileColor){ index, color };
+}
+
+// Get tilemap tile color, WHITE if tile is not colored (binary search on sparse colors table)
+static Color GetTilemapColor(Tilemap map, int x, int y)
+{
+    int index = y*map.tileCountX + x;
+    int first = 0;
+    int last = map.colorCount - 1;
+    
+    while (first <= last)
+    {
+        int middle = (first + last)/2;
+        
+        if (map.colors[middle].index == index) return map.colors[middle].color;
+        else if (map.colors[middle].index < index) first = middle + 1;
+        else last = middle - 1;
+    }
+    
+    return WHITE;
+}
+
+// Load tilemap tiles colors from file
+// NOTE: Colors file stores one colored tile per line: tile position and color (x y r g b a)
+static void LoadTilemapColors(const char *colorsMap, Tilemap *map)
+{
+    int x = 0, y = 0;
+    int r = 0, g = 0, b = 0, a = 0;
+    
+    FILE *colorsFile = fopen(colorsMap, "rt");
+    
+    if (colorsFile == NULL) 
+    {
+        TraceLog(LOG_WARNING, "[%s] Tilemap colors file could not be opened", colorsMap);
+        return;
+    }
+    
+    while (fscanf(colorsFile, "%i %i %i %i %i %i", &x, &y, &r, &g, &b, &a) == 6)
+    {
+        SetTilemapColor(map, x, y, (Color){ r, g, b, a });
+    }
+    
+    fclose(colorsFile);
+    
+    TraceLog(LOG_INFO, "[%s] Tilemap colors loaded successfully (%i tiles colored)", colorsMap, map->colorCount);
+}
+
+// Load packed tiles layers (empty tiles: value 0, collider 0)
+static TileLayers LoadTileLayers(int width, int height)
+{
+    TileLayers layers = { 0 };
+    
+    layers.width = width;
+    layers.stride = (width + 31)/32;
+    layers.values = (unsigned short *)calloc(width*height, sizeof(unsigned short));
+    layers.colliders = (unsigned int *)calloc(layers.stride*height, sizeof(unsigned int));
+    
+    return layers;
+}
+
+// Unload packed tiles layers
+static void UnloadTileLayers(TileLayers layers)
+{
+    free(layers.values);
+    free(layers.colliders);
+}
+
+// Set packed tiles layers tile
+static void SetTileLayersTile(TileLayers *layers, int x, int y, Tile tile)
+{
+    layers->values[y*layers->width + x] = (unsigned short)tile.value;
+    
+    if (tile.collider) layers->colliders[y*layers->stride + x/32] |= (1u << (x%32));
+    else layers->colliders[y*layers->stride + x/32] &= ~(1u << (x%32));
+}
+
+#if defined(WORLD_STREAMING) || defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK)
+// Get world tile (in tiles), world is tilemap repeated as rooms connected by corridors
+// NOTE: Corridors open room walls at middle row (left, right) and middle column (top, bottom)
+static Tile GetWorldRoomTile(Tilemap room, int x, int y, int roomsX, int roomsY)
+{
+    int roomX = x/room.tileCountX;
+    int roomY = y/room.tileCountY;
+    int tileX = x%room.tileCountX;
+    int tileY = y%room.tileCountY;
+    int corridorX = room.tileCountX/2;
+    int corridorY = room.tileCountY/2 - 1;
+    
+    Tile tile = GetTilemapTile(room, tileX, tileY);
+    Tile floor = GetTilemapTile(room, room.tileCountX/2, room.tileCountY/2);
+    
+    if ((tileY == corridorY) && (((tileX == 0) && (roomX > 0)) || ((tileX == (room.tileCountX - 1)) && (roomX < (roomsX - 1))))) tile = floor;
+    if ((tileX == corridorX) && (((tileY == 0) && (roomY > 0)) || ((tileY == (room.tileCountY - 1)) && (roomY < (roomsY - 1))))) tile = floor;
+    
+    return tile;
+}
+#endif
+
+#if defined(WORLD_STREAMING)
+// World regions streaming: regions file loading and resident regions management
+//----------------------------------------------------------------------------------
+// Load tilemap from regions file for streaming
+// NOTE: Only regions index is loaded, tiles are loaded by regions on UpdateTilemapStreaming(),
+// regions file is memory mapped when available (regions data is paged in by the system)
+static Tilemap LoadTilemapRegions(const char *fileName)
+{
+    Tilemap map = { 0 };
+    
+    FILE *regionsFile = fopen(fileName, "rb");
+    
+    if (regionsFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Tilemap regions file could not be opened", fileName);
+        return map;
+    }
+    
+    char magic[4] = { 0 };
+    int header[4] = { 0 };      // Version, region size, regions count X, regions count Y
+    
+    fread(magic, 1, 4, regionsFile);
+    fread(header, sizeof(int), 4, regionsFile);
+    
+    if ((strncmp(magic, "DRGN", 4) != 0) || (header[0] != REGION_FILE_VERSION) || (header[1] <= 0) || (header[2] <= 0) || (header[3] <= 0))
+    {
+        TraceLog(LOG_WARNING, "[%s] Tilemap regions file not valid", fileName);
+        fclose(regionsFile);
+        return map;
+    }
+    
+    WorldStreamer *streamer = (WorldStreamer *)calloc(1, sizeof(WorldStreamer));
+    
+    streamer->regionSize = header[1];
+    streamer->regionCountX = header[2];
+    streamer->regionCountY = header[3];
+    streamer->prefetchIndex = -1;
+    streamer->index = (unsigned int *)malloc(streamer->regionCountX*streamer->regionCountY*sizeof(unsigned int));
+    
+    fread(streamer->index, sizeof(unsigned int), streamer->regionCountX*streamer->regionCountY, regionsFile);
+    
+    fseek(regionsFile, 0, SEEK_END);
+    streamer->fileSize = ftell(regionsFile);
+    
+#if !defined(_WIN32)
+    int fd = open(fileName, O_RDONLY);
+    
+    if (fd != -1)
+    {
+        void *data = mmap(NULL, streamer->fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        if (data != MAP_FAILED) streamer->mapped = (unsigned char *)data;
+        
+        close(fd);      // NOTE: Mapping keeps file referenced
+    }
+#endif
+
+    // NOTE: File is kept open to read regions data when it could not be mapped
+    if (streamer->mapped != NULL) fclose(regionsFile);
+    else streamer->file = regionsFile;
+    
+    map.tileCountX = streamer->regionCountX*streamer->regionSize;
+    map.tileCountY = streamer->regionCountY*streamer->regionSize;
+    map.streamer = streamer;
+    
+    TraceLog(LOG_INFO, "[%s] Tilemap regions loaded successfully (%ix%i regions, %ix%i tiles, %s)", fileName, 
+             streamer->regionCountX, streamer->regionCountY, map.tileCountX, map.tileCountY, (streamer->mapped != NULL)? "memory mapped" : "file reads");
+    
+    return map;
 }
+
+// Export a world of repeated tilemap rooms into a regions file
+// NOTE: Neighbour rooms are connected by corridors: room middle row and column border tiles
+// are replaced by room center tile (walkable), tiles out of world are empty (value 0)
+static void ExportTilemapRegions(Tilemap room, const char *fileName, int roomsX, int roomsY)
+{
+    int worldWidth = roomsX*room.tileCountX;
+    int worldHeight = roomsY*room.tileCountY;
+    int regionCountX = (worldWidth + REGION_SIZE - 1)/REGION_SIZE;
+    int regionCountY = (worldHeight + REGION_SIZE - 1)/REGION_SIZE;
+    int regionDataSize = REGION_SIZE*REGION_SIZE*2 + REGION_SIZE*((REGION_SIZE + 31)/32)*4;   // Packed tiles: values, colliders bitplane
+    
+    FILE *regionsFile = fopen(fileName, "wb");
+    
+    if (regionsFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Tilemap regions file could not be created", fileName);
+        return;
+    }
+    
+    int header[4] = { REGION_FILE_VERSION, REGION_SIZE, regionCountX, regionCountY };
+    
+    fwrite("DRGN", 1, 4, regionsFile);
+    fwrite(header, sizeof(int), 4, regionsFile);
+    
+    // Regions index: regions data is stored in index order
+    unsigned int offset = 4 + sizeof(header) + regionCountX*regionCountY*sizeof(unsigned int);
+    
+    for (int i = 0; i < regionCountX*regionCountY; i++, offset += regionDataSize) fwrite(&offset, sizeof(unsigned int), 1, regionsFile);
+    
+    TileLayers layers = LoadTileLayers(REGION_SIZE, REGION_SIZE);
+    
+    for (int ry = 0; ry < regionCountY; ry++)
+    {
+        for (int rx = 0; rx < regionCountX; rx++)
+        {
+            for (int j = 0; j < REGION_SIZE; j++)
+            {
+                for (int i = 0; i < REGION_SIZE; i++)
+                {
+                    int x = rx*REGION_SIZE + i;
+                    int y = ry*REGION_SIZE + j;
+                    Tile tile = { 0 };
+                    
+                    if ((x < worldWidth) && (y < worldHeight)) tile = GetWorldRoomTile(room, x, y, roomsX, roomsY);
+                    
+                    SetTileLayersTile(&layers, i, j, tile);
+                }
+            }
+            
+            // NOTE: Region data is stored as loaded in memory (packed tiles layers)
+            fwrite(layers.values, sizeof(unsigned short), REGION_SIZE*REGION_SIZE, regionsFile);
+            fwrite(layers.colliders, sizeof(unsigned int), REGION_SIZE*layers.stride, regionsFile);
+        }
+    }
+    
+    UnloadTileLayers(layers);
+    fclose(regionsFile);
+    
+    TraceLog(LOG_INFO, "[%s] Tilemap regions exported successfully (%ix%i rooms, %ix%i regions)", fileName, roomsX, roomsY, regionCountX, regionCountY);
+}
+
+// Update tilemap streaming: load regions around position, pre-fetch regions ahead, evict far regions
+// NOTE: Regions covering STREAM_LOAD_RADIUS tiles around position are loaded right away (drawing and
+// collisions require them), position and direction are given in tilemap coordinates (pixels)
+static void UpdateTilemapStreaming(Tilemap map, Vector2 position, Vector2 direction)
+{
+    WorldStreamer *streamer = map.streamer;
+    
+    if (streamer == NULL) return;
+    
+    streamer->frame++;
+    
+    int tileX = (int)floorf((position.x - map.position.x)/map.tileSize);
+    int tileY = (int)floorf((position.y - map.position.y)/map.tileSize);
+    int regionX = Clamp((float)tileX/streamer->regionSize, 0, streamer->regionCountX - 1);
+    int regionY = Clamp((float)tileY/streamer->regionSize, 0, streamer->regionCountY - 1);
+    
+    // Required regions: regions covering tiles around position
+    int minX = Clamp(floorf((float)(tileX - STREAM_LOAD_RADIUS)/streamer->regionSize), 0, streamer->regionCountX - 1);
+    int maxX = Clamp(floorf((float)(tileX + STREAM_LOAD_RADIUS)/streamer->regionSize), 0, streamer->regionCountX - 1);
+    int minY = Clamp(floorf((float)(tileY - STREAM_LOAD_RADIUS)/streamer->regionSize), 0, streamer->regionCountY - 1);
+    int maxY = Clamp(floorf((float)(tileY + STREAM_LOAD_RADIUS)/streamer->regionSize), 0, streamer->regionCountY - 1);
+    
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++) LoadWorldRegion(streamer, x, y);
+    }
+    
+    // Pre-fetch region ahead of position, along movement direction
+    if ((direction.x != 0.0f) || (direction.y != 0.0f))
+    {
+        float length = sqrtf(direction.x*direction.x + direction.y*direction.y);
+        
+        int aheadX = (int)floorf(tileX + direction.x/length*STREAM_PREFETCH_DISTANCE);
+        int aheadY = (int)floorf(tileY + direction.y/length*STREAM_PREFETCH_DISTANCE);
+        
+        if ((aheadX >= 0) && (aheadY >= 0) && (aheadX < map.tileCountX) && (aheadY < map.tileCountY)) 
+        {
+            PrefetchWorldRegion(streamer, aheadX/streamer->regionSize, aheadY/streamer->regionSize);
+        }
+    }
+    
+    // Evict regions far from position region, unless required or pre-fetched on this update
+    for (int i = 0; i < MAX_STREAM_REGIONS; i++)
+    {
+        WorldRegion *region = &streamer->regions[i];
+        
+        if ((region->tiles.values != NULL) && (region->lastUsed != streamer->frame) &&
+            ((abs(region->x - regionX) > STREAM_EVICT_DISTANCE) || (abs(region->y - regionY) > STREAM_EVICT_DISTANCE)))
+        {
+            TraceLog(LOG_DEBUG, "STREAM: Region [%i, %i] evicted", region->x, region->y);
+            
+            UnloadTileLayers(region->tiles);
+            region->tiles = (TileLayers){ 0 };
+        }
+    }
+}
+
+// Get resident region, region is loaded if required (least recently used region is evicted if no free slot)
+// NOTE: Returns NULL for empty regions (no data) or if all slots are required on this update
+static WorldRegion *LoadWorldRegion(WorldStreamer *streamer, int regionX, int regionY)
+{
+    WorldRegion *region = NULL;
+    
+    for (int i = 0; i < MAX_STREAM_REGIONS; i++)
+    {
+        if ((streamer->regions[i].tiles.values != NULL) && (streamer->regions[i].x == regionX) && (streamer->regions[i].y == regionY))
+        {
+            streamer->regions[i].lastUsed = streamer->frame;
+            return &streamer->regions[i];
+        }
+    }
+    
+    unsigned int offset = streamer->index[regionY*streamer->regionCountX + regionX];
+    int tileCount = streamer->regionSize*streamer->regionSize;
+    int colliderCount = streamer->regionSize*((streamer->regionSize + 31)/32);
+    
+    if ((offset == 0) || ((offset + tileCount*2 + colliderCount*4) > streamer->fileSize)) return NULL;
+    
+    // Find a free slot, or the least recently used one not required on this update
+    for (int i = 0; i < MAX_STREAM_REGIONS; i++)
+    {
+        WorldRegion *slot = &streamer->regions[i];
+        
+        if (slot->tiles.values == NULL) { region = slot; break; }
+        if ((slot->lastUsed != streamer->frame) && ((region == NULL) || (slot->lastUsed < region->lastUsed))) region = slot;
+    }
+    
+    if (region == NULL)
+    {
+        TraceLog(LOG_WARNING, "STREAM: Region [%i, %i] could not be loaded, all regions are required", regionX, regionY);
+        return NULL;
+    }
+    
+    if (region->tiles.values != NULL) TraceLog(LOG_DEBUG, "STREAM: Region [%i, %i] evicted", region->x, region->y);
+    else region->tiles = LoadTileLayers(streamer->regionSize, streamer->regionSize);
+    
+    double startTime = glfwGetTime();
+    
+    // Region tiles data is stored packed: values (16 bit per tile), colliders bitplane (1 bit per tile)
+    if (streamer->mapped != NULL)
+    {
+        memcpy(region->tiles.values, streamer->mapped + offset, tileCount*sizeof(unsigned short));
+        memcpy(region->tiles.colliders, streamer->mapped + offset + tileCount*2, colliderCount*sizeof(unsigned int));
+    }
+    else
+    {
+        fseek(streamer->file, offset, SEEK_SET);
+        fread(region->tiles.values, sizeof(unsigned short), tileCount, streamer->file);
+        fread(region->tiles.colliders, sizeof(unsigned int), colliderCount, streamer->file);
+    }
+    
+    region->x = regionX;
+    region->y = regionY;
+    region->lastUsed = streamer->frame;
+    
+    TraceLog(LOG_INFO, "STREAM: Region [%i, %i] loaded (%.2f ms)", regionX, regionY, (glfwGetTime() - startTime)*1000.0);
+    
+    return region;
+}
+
+// Pre-fetch region, so it's available when required
+// NOTE: Memory mapped regions data is requested to the system (paged in asynchronously),
+// otherwise region is loaded if a free slot is available
+static void PrefetchWorldRegion(WorldStreamer *streamer, int regionX, int regionY)
+{
+    int index = regionY*streamer->regionCountX + regionX;
+    
+    // Resident region is kept (not evicted on this update)
+    for (int i = 0; i < MAX_STREAM_REGIONS; i++)
+    {
+        if ((streamer->regions[i].tiles.values != NULL) && (streamer->regions[i].x == regionX) && (streamer->regions[i].y == regionY)) 
+        {
+            streamer->regions[i].lastUsed = streamer->frame;
+            return;
+        }
+    }
+    
+    if (streamer->mapped != NULL)
+    {
+        if (index == streamer->prefetchIndex) return;   // Already requested
+        
+        streamer->prefetchIndex = index;
+        
+        unsigned int offset = streamer->index[index];
+        
+        if (offset == 0) return;
+        
+#if !defined(_WIN32)
+        // NOTE: posix_madvise() requires a page-aligned address
+        long pageSize = sysconf(_SC_PAGESIZE);
+        long start = offset - offset%pageSize;
+        
+        long size = streamer->regionSize*streamer->regionSize*2 + streamer->regionSize*((streamer->regionSize + 31)/32)*4;
+        
+        posix_madvise(streamer->mapped + start, offset + size - start, POSIX_MADV_WILLNEED);
+#endif
+    }
+    else
+    {
+        for (int i = 0; i < MAX_STREAM_REGIONS; i++)
+        {
+            if (streamer->regions[i].tiles.values == NULL)
+            {
+                LoadWorldRegion(streamer, regionX, regionY);
+                break;
+            }
+        }
+    }
+}
+#endif
+
+// LESSON 07: Collision detection
+//----------------------------------------------------------------------------------
+// Check collision between two rectangles
+static bool CheckCollisionRecs(Rectangle rec1, Rectangle rec2)
+{
+    bool collision = false;
+
+    int dx = abs((rec1.x + rec1.width/2) - (rec2.x + rec2.width/2));
+    int dy = abs((rec1.y + rec1.height/2) - (rec2.y + rec2.height/2));
+
+    if ((dx <= (rec1.width/2 + rec2.width/2)) && ((dy <= (rec1.height/2 + rec2.height/2)))) collision = true;
+
+    return collision;
+}
+
+// Load tileset rectangles from tileset ids file
+// NOTE: Ids file stores one tileset id per tileset cell (tileCountX cells per row), 
+// it replaces default tilesetRecs[] rectangles
+static void LoadTilesetRecs(const char *idsMap, int tileCountX, int tileSize)
+{
+    int id = 0;
+    int count = 0;
+    
+    FILE *idsFile = fopen(idsMap, "rt");
+    
+    if (idsFile == NULL) 
+    {
+        TraceLog(LOG_WARNING, "[%s] Tileset ids file could not be opened", idsMap);
+        return;
+    }
+    
+    for (int i = 0; fscanf(idsFile, "%i", &id) == 1; i++)
+    {
+        if ((id > 0) && (id <= TILESET_TILES))
+        {
+            tilesetRecs[id - 1] = (Rectangle){ (i%tileCountX)*tileSize, (i/tileCountX)*tileSize, tileSize, tileSize };
+            count++;
+        }
+    }
+    
+    fclose(idsFile);
+    
+    TraceLog(LOG_INFO, "[%s] Tileset ids loaded successfully (%i tiles)", idsMap, count);
+}
+
+// Load tileset collision masks from tileset colliders file and tileset image
+// NOTE: Colliders file stores one value per tileset cell (same layout as ids file), 1 means walkable;
+// walkable tiles get an empty mask, solid tiles are solid on every pixel but floor pixels,
+// floor is the palette index most used by walkable tiles
+static void LoadTilesetMasks(const char *collidersMap, IndexedImage tileset, int tileSize)
+{
+    int tileCountX = tileset.width/tileSize;
+    int tileCountY = tileset.height/tileSize;
+    int *colliders = (int *)calloc(tileCountX*tileCountY, sizeof(int));
+    
+    FILE *collidersFile = fopen(collidersMap, "rt");
+    
+    if ((collidersFile == NULL) || (tileset.data == NULL)) 
+    {
+        TraceLog(LOG_WARNING, "[%s] Tileset colliders could not be loaded", collidersMap);
+        if (collidersFile != NULL) fclose(collidersFile);
+        free(colliders);
+        return;
+    }
+    
+    for (int i = 0; (i < tileCountX*tileCountY) && (fscanf(collidersFile, "%i", &colliders[i]) == 1); i++) { }
+    
+    fclose(collidersFile);
+    
+    // Find floor palette index: most used index on walkable tiles
+    int indexCount[MAX_PALETTE_COLORS] = { 0 };
+    int floorIndex = 0;
+    
+    for (int i = 0; i < TILESET_TILES; i++)
+    {
+        Rectangle rec = tilesetRecs[i];
+        
+        if (colliders[((int)rec.y/tileSize)*tileCountX + (int)rec.x/tileSize] == 0) continue;
+        
+        for (int y = rec.y; y < (rec.y + rec.height); y++)
+        {
+            for (int x = rec.x; x < (rec.x + rec.width); x++) indexCount[tileset.data[y*tileset.width + x]]++;
+        }
+    }
+    
+    for (int i = 1; i < MAX_PALETTE_COLORS; i++) if (indexCount[i] > indexCount[floorIndex]) floorIndex = i;
+    
+    // Generate tiles masks
+    int solidCount = 0;
+    
+    for (int i = 0; i < TILESET_TILES; i++)
+    {
+        Rectangle rec = tilesetRecs[i];
+        
+        if (colliders[((int)rec.y/tileSize)*tileCountX + (int)rec.x/tileSize] == 0) 
+        {
+            tilesetMasks[i] = GenCollisionMask(tileset, rec, floorIndex);
+            solidCount++;
+        }
+        else tilesetMasks[i] = (CollisionMask){ { 0 }, rec.width, rec.height };
+    }
+    
+    free(colliders);
+    
+    TraceLog(LOG_INFO, "[%s] Tileset colliders loaded successfully (%i solid tiles)", collidersMap, solidCount);
+}
+
+// Generate collision mask from indexed image rectangle, pixels not using emptyIndex are solid
+// NOTE: Masks are limited to COLLISION_MASK_SIZE pixels (width and height)
+static CollisionMask GenCollisionMask(IndexedImage image, Rectangle rec, int emptyIndex)
+{
+    CollisionMask mask = { 0 };
+    
+    mask.width = (rec.width < COLLISION_MASK_SIZE)? rec.width : COLLISION_MASK_SIZE;
+    mask.height = (rec.height < COLLISION_MASK_SIZE)? rec.height : COLLISION_MASK_SIZE;
+    
+    if (image.data == NULL) return mask;
+    
+    for (int y = 0; y < mask.height; y++)
+    {
+        for (int x = 0; x < mask.width; x++)
+        {
+            if (image.data[((int)rec.y + y)*image.width + (int)rec.x + x] != emptyIndex) mask.rows[y] |= (1u << x);
+        }
+    }
+    
+    return mask;
+}
+
+// Generate collision mask for a rectangle (all pixels solid)
+static CollisionMask GenCollisionMaskRec(int width, int height)
+{
+    CollisionMask mask = { 0 };
+    
+    mask.width = (width < COLLISION_MASK_SIZE)? width : COLLISION_MASK_SIZE;
+    mask.height = (height < COLLISION_MASK_SIZE)? height : COLLISION_MASK_SIZE;
+    
+    for (int y = 0; y < mask.height; y++) mask.rows[y] = (mask.width == 32)? 0xffffffff : ((1u << mask.width) - 1);
+    
+    return mask;
+}
+
+// Check collision between a collision mask (placed at position) and tilemap solid pixels
+// NOTE: Every mask row is shifted into the (up to two) tiles it covers and tested against
+// the tile mask row with a single AND, tiles are not scaled (tile size must match masks size)
+static bool CheckCollisionTilemapMask(Tilemap map, CollisionMask mask, Vector2 position)
+{
+    int posX = (int)floorf(position.x - map.position.x);    // Mask position, relative to tilemap
+    int posY = (int)floorf(position.y - map.position.y);
+    
+    if (map.tileSize != COLLISION_MASK_SIZE) return false;
+    
+    // Broad-phase: mask bounds outside tilemap bounds can not collide, per-row test is skipped
+    Rectangle maskBounds = { position.x, position.y, mask.width, mask.height };
+    Rectangle mapBounds = { map.position.x, map.position.y, map.tileCountX*map.tileSize, map.tileCountY*map.tileSize };
+    
+    if (!CheckCollisionRecs(maskBounds, mapBounds)) return false;
+    
+    int tileX = (posX >= 0)? posX/map.tileSize : -((map.tileSize - 1 - posX)/map.tileSize);
+    int offsetX = posX - tileX*map.tileSize;    // Mask offset inside first tile [0..tileSize - 1]
+    
+    for (int j = 0; j < mask.height; j++)
+    {
+        int y = posY + j;
+        
+        if ((mask.rows[j] == 0) || (y < 0) || (y >= map.tileCountY*map.tileSize)) continue;   // Nothing to test or outside tilemap
+        
+        // First tile: mask bits shifted to offset, bits over tile width belong to next tile
+        unsigned int bits[2] = { mask.rows[j] << offsetX, (offsetX > 0)? (mask.rows[j] >> (map.tileSize - offsetX)) : 0 };
+        
+        for (int k = 0; k < 2; k++)
+        {
+            // NOTE: Tiles set as walkable on colliders map are not tested (only colliders bitplane is read)
+            if ((bits[k] == 0) || GetTilemapCollider(map, tileX + k, y/map.tileSize)) continue;
+            
+            int value = GetTilemapValue(map, tileX + k, y/map.tileSize);
+            
+            if ((value > 0) && (value <= TILESET_TILES) && (tilesetMasks[value - 1].rows[y%map.tileSize] & bits[k])) return true;
+        }
+    }
+    
+    return false;
+}
+
+// Load tilemap objects as entities (pickups)
+// NOTE: Objects map stores one tileset index value per tile, -1 means no object
+static int LoadTilemapObjects(const char *objectsMap, Tilemap map, Entity *entities, int maxEntities)
+{
+    int count = 0;
+    int value = 0;
+    
+    FILE *objectsFile = fopen(objectsMap, "rt");
+    
+    if (objectsFile == NULL) 
+    {
+        TraceLog(LOG_WARNING, "[%s] Tilemap objects file could not be opened", objectsMap);
+        return 0;
+    }
+    
+    for (int i = 0; (i < map.tileCountX*map.tileCountY) && (fscanf(objectsFile, "%i", &value) == 1); i++)
+    {
+        if ((value > 0) && (count < maxEntities))
+        {
+            entities[count] = (Entity){ { map.position.x + (i%map.tileCountX)*map.tileSize, map.position.y + (i/map.tileCountX)*map.tileSize }, 
+                                        { map.tileSize, map.tileSize }, { 0, 0 }, ENTITY_PICKUP, value, true };
+            count++;
+        }
+    }
+    
+    fclose(objectsFile);
+    
+    TraceLog(LOG_INFO, "[%s] Tilemap objects loaded successfully (%i objects)", objectsMap, count);
+    
+    return count;
+}
+
+// Draw entities using tileset
+// NOTE: Only entities with a tile index value are drawn
+static void DrawEntities(Entity *entities, int count, Texture2D tileset)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (entities[i].active && (entities[i].value > 0))
+        {
+            DrawTextureRec(tileset, tilesetRecs[entities[i].value - 1], entities[i].position, WHITE);
+        }
+    }
+}
+
+// Load sweep-and-prune broadphase data
+// NOTE: Bounds arrays are padded with one extra batch, so narrowphase can always load full batches
+static SweepAndPrune LoadSweepAndPrune(int capacity)
+{
+    SweepAndPrune sap = { 0 };
+    
+    sap.capacity = capacity;
+    sap.order = (int *)malloc(capacity*sizeof(int));
+    sap.minX = (float *)malloc((capacity + SAP_BATCH_SIZE)*sizeof(float));
+    sap.minY = (float *)malloc((capacity + SAP_BATCH_SIZE)*sizeof(float));
+    sap.maxX = (float *)malloc((capacity + SAP_BATCH_SIZE)*sizeof(float));
+    sap.maxY = (float *)malloc((capacity + SAP_BATCH_SIZE)*sizeof(float));
+    
+    sap.pairCapacity = 1024;
+    sap.pairs = (int *)malloc(sap.pairCapacity*2*sizeof(int));
+    
+    return sap;
+}
+
+// Unload sweep-and-prune broadphase data
+static void UnloadSweepAndPrune(SweepAndPrune sap)
+{
+    free(sap.order);
+    free(sap.minX);
+    free(sap.minY);
+    free(sap.maxX);
+    free(sap.maxY);
+    free(sap.pairs);
+}
+
+// Sort entities bounds along X axis and find overlapping pairs
+// NOTE: Entities order is kept from previous frame, so insertion sort works on mostly-sorted
+// data (close to linear time); inactive entities are moved to the end of the list
+static void UpdateSweepAndPrune(SweepAndPrune *sap, Entity *entities, int count)
+{
+    if (count > sap->capacity) count = sap->capacity;
+    
+    // Register new entities at the end of the list (they get sorted into place)
+    for (int i = sap->count; i < count; i++) sap->order[i] = i;
+    sap->count = count;
+    
+    // Update entities bounds, in previous frame sorted order
+    for (int i = 0; i < count; i++)
+    {
+        Entity entity = entities[sap->order[i]];
+        
+        if (entity.active)
+        {
+            sap->minX[i] = entity.position.x;
+            sap->minY[i] = entity.position.y;
+            sap->maxX[i] = entity.position.x + entity.size.x;
+            sap->maxY[i] = entity.position.y + entity.size.y;
+        }
+        else
+        {
+            sap->minX[i] = FLT_MAX;
+            sap->minY[i] = FLT_MAX;
+            sap->maxX[i] = FLT_MAX;
+            sap->maxY[i] = FLT_MAX;
+        }
+    }
+    
+    // Padding batch never overlaps (required for last narrowphase batch)
+    for (int i = count; i < count + SAP_BATCH_SIZE; i++)
+    {
+        sap->minX[i] = FLT_MAX;
+        sap->minY[i] = FLT_MAX;
+        sap->maxX[i] = FLT_MAX;
+        sap->maxY[i] = FLT_MAX;
+    }
+    
+    // Insertion sort by bounds min X
+    for (int i = 1; i < count; i++)
+    {
+        if (sap->minX[i - 1] <= sap->minX[i]) continue;    // Already sorted, most common case
+        
+        int index = sap->order[i];
+        float minX = sap->minX[i], minY = sap->minY[i];
+        float maxX = sap->maxX[i], maxY = sap->maxY[i];
+        int j = i - 1;
+        
+        while ((j >= 0) && (sap->minX[j] > minX))
+        {
+            sap->order[j + 1] = sap->order[j];
+            sap->minX[j + 1] = sap->minX[j];
+            sap->minY[j + 1] = sap->minY[j];
+            sap->maxX[j + 1] = sap->maxX[j];
+            sap->maxY[j + 1] = sap->maxY[j];
+            j--;
+        }
+        
+        sap->order[j + 1] = index;
+        sap->minX[j + 1] = minX;
+        sap->minY[j + 1] = minY;
+        sap->maxX[j + 1] = maxX;
+        sap->maxY[j + 1] = maxY;
+    }
+    
+    // Sweep: bounds overlapping on X axis are contiguous after current one,
+    // they are tested on narrowphase in batches until min X goes over current max X
+    sap->pairCount = 0;
+    
+    for (int i = 0; (i < count) && (sap->minX[i] < FLT_MAX); i++)
+    {
+        for (int first = i + 1; sap->minX[first] <= sap->maxX[i]; first += SAP_BATCH_SIZE)
+        {
+            int mask = CheckCollisionBoundsBatch(sap, i, first);
+            
+            for (int k = 0; mask != 0; k++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    if (sap->pairCount >= sap->pairCapacity)
+                    {
+                        sap->pairCapacity *= 2;
+                        sap->pairs = (int *)realloc(sap->pairs, sap->pairCapacity*2*sizeof(int));
+                    }
+                    
+                    sap->pairs[sap->pairCount*2] = sap->order[i];
+                    sap->pairs[sap->pairCount*2 + 1] = sap->order[first + k];
+                    sap->pairCount++;
+                }
+            }
+        }
+    }
+}
+
+// Check collision between bounds and a batch of bounds (sorted order indices)
+// NOTE: Returns a bitmask with one bit per colliding bounds of the batch
+static int CheckCollisionBoundsBatch(SweepAndPrune *sap, int index, int first)
+{
+    int mask = 0;
+    
+#if defined(__AVX__)
+    __m256 minX = _mm256_loadu_ps(sap->minX + first);
+    __m256 minY = _mm256_loadu_ps(sap->minY + first);
+    __m256 maxX = _mm256_loadu_ps(sap->maxX + first);
+    __m256 maxY = _mm256_loadu_ps(sap->maxY + first);
+    
+    __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(minX, _mm256_set1_ps(sap->maxX[index]), _CMP_LE_OQ),
+                                    _mm256_cmp_ps(maxX, _mm256_set1_ps(sap->minX[index]), _CMP_GE_OQ));
+    __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(minY, _mm256_set1_ps(sap->maxY[index]), _CMP_LE_OQ),
+                                    _mm256_cmp_ps(maxY, _mm256_set1_ps(sap->minY[index]), _CMP_GE_OQ));
+    
+    mask = _mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY));
+#else
+    for (int k = 0; k < SAP_BATCH_SIZE; k++)
+    {
+        if ((sap->minX[first + k] <= sap->maxX[index]) && (sap->maxX[first + k] >= sap->minX[index]) &&
+            (sap->minY[first + k] <= sap->maxY[index]) && (sap->maxY[first + k] >= sap->minY[index])) mask |= (1 << k);
+    }
+#endif
+
+    return mask;
+}
+
+#if defined(PATHFINDING_BENCHMARK) || defined(CROWD_BENCHMARK) || defined(MONSTER_CROWD)
+// Hierarchical pathfinding (HPA*): clusters entrances graph over tiles walkability
+//----------------------------------------------------------------------------------
+// Load pathfinding grid, all tiles blocked
+// NOTE: Tiles walkability is set with SetPathGridTile() and clusters graph built with BuildPathGrid()
+static PathGrid LoadPathGrid(int width, int height)
+{
+    PathGrid grid = { 0 };
+    
+    grid.width = width;
+    grid.height = height;
+    grid.walkable = (unsigned char *)calloc(width*height, sizeof(unsigned char));
+    grid.clusterCountX = (width + PATH_CLUSTER_SIZE - 1)/PATH_CLUSTER_SIZE;
+    grid.clusterCountY = (height + PATH_CLUSTER_SIZE - 1)/PATH_CLUSTER_SIZE;
+    grid.clusters = (PathCluster *)calloc(grid.clusterCountX*grid.clusterCountY, sizeof(PathCluster));
+    grid.distances = (unsigned short *)malloc(PATH_CLUSTER_SIZE*PATH_CLUSTER_SIZE*sizeof(unsigned short));
+    grid.queue = (int *)malloc(PATH_CLUSTER_SIZE*PATH_CLUSTER_SIZE*sizeof(int));
+    
+    return grid;
+}
+
+#if defined(MONSTER_CROWD)
+// Load pathfinding grid from tilemap colliders (1 - walkable), clusters graph is built
+static PathGrid LoadPathGridFromTilemap(Tilemap map)
+{
+    PathGrid grid = LoadPathGrid(map.tileCountX, map.tileCountY);
+    
+    for (int y = 0; y < map.tileCountY; y++)
+    {
+        for (int x = 0; x < map.tileCountX; x++) SetPathGridTile(&grid, x, y, GetTilemapCollider(map, x, y));
+    }
+    
+    BuildPathGrid(&grid);
+    
+    return grid;
+}
+#endif
+
+// Unload pathfinding grid data
+static void UnloadPathGrid(PathGrid grid)
+{
+    for (int i = 0; i < grid.clusterCountX*grid.clusterCountY; i++) free(grid.clusters[i].costs);
+    
+    free(grid.walkable);
+    free(grid.clusters);
+    free(grid.distances);
+    free(grid.queue);
+    free(grid.costs);
+    free(grid.parents);
+    free(grid.stamps);
+    free(grid.heap);
+}
+
+// Set tile walkability, clusters graph is not updated
+static void SetPathGridTile(PathGrid *grid, int x, int y, bool walkable)
+{
+    if ((x >= 0) && (y >= 0) && (x < grid->width) && (y < grid->height)) grid->walkable[y*grid->width + x] = walkable;
+}
+
+// Build all clusters entrances and intra-cluster costs
+static void BuildPathGrid(PathGrid *grid)
+{
+    int nodeCount = 0;
+    
+    for (int i = 0; i < grid->clusterCountX*grid->clusterCountY; i++) 
+    {
+        BuildPathCluster(grid, i);
+        nodeCount += grid->clusters[i].nodeCount;
+    }
+    
+    TraceLog(LOG_INFO, "PATHFINDING: Grid built (%ix%i tiles, %ix%i clusters, %i entrance nodes)", 
+             grid->width, grid->height, grid->clusterCountX, grid->clusterCountY, nodeCount);
+}
+
+#if defined(PATHFINDING_BENCHMARK)
+// Update tile walkability and clusters graph (incremental)
+// NOTE: Tile cluster is rebuilt, neighbour clusters are also rebuilt when tile is on a border (shared entrances)
+static void UpdatePathGridTile(PathGrid *grid, int x, int y, bool walkable)
+{
+    if ((x < 0) || (y < 0) || (x >= grid->width) || (y >= grid->height) || (grid->walkable[y*grid->width + x] == walkable)) return;
+    
+    grid->walkable[y*grid->width + x] = walkable;
+    
+    int clusterX = x/PATH_CLUSTER_SIZE;
+    int clusterY = y/PATH_CLUSTER_SIZE;
+    int localX = x%PATH_CLUSTER_SIZE;
+    int localY = y%PATH_CLUSTER_SIZE;
+    
+    BuildPathCluster(grid, clusterY*grid->clusterCountX + clusterX);
+    
+    if ((localX == 0) && (clusterX > 0)) BuildPathCluster(grid, clusterY*grid->clusterCountX + clusterX - 1);
+    if ((localX == (PATH_CLUSTER_SIZE - 1)) && (clusterX < (grid->clusterCountX - 1))) BuildPathCluster(grid, clusterY*grid->clusterCountX + clusterX + 1);
+    if ((localY == 0) && (clusterY > 0)) BuildPathCluster(grid, (clusterY - 1)*grid->clusterCountX + clusterX);
+    if ((localY == (PATH_CLUSTER_SIZE - 1)) && (clusterY < (grid->clusterCountY - 1))) BuildPathCluster(grid, (clusterY + 1)*grid->clusterCountX + clusterX);
+}
+#endif
+
+// Find path between two tiles (abstract path), path tiles are refined on GetPathNextTile()
+// NOTE: Start and goal are connected to their clusters entrances, abstract graph is searched with A*
+// (intra-cluster edges with precomputed costs, inter-cluster edges with cost 1); path length is -1 if not found
+static Path FindPath(PathGrid *grid, int startX, int startY, int goalX, int goalY)
+{
+    Path path = { 0 };
+    
+    path.length = -1;
+    
+    if (!IsPathTileWalkable(grid, startX, startY) || !IsPathTileWalkable(grid, goalX, goalY)) return path;
+    
+    int nodeCount = grid->clusterCountX*grid->clusterCountY*MAX_CLUSTER_NODES;
+    int startId = nodeCount;
+    int goalId = nodeCount + 1;
+    int startCluster = (startY/PATH_CLUSTER_SIZE)*grid->clusterCountX + startX/PATH_CLUSTER_SIZE;
+    int goalCluster = (goalY/PATH_CLUSTER_SIZE)*grid->clusterCountX + goalX/PATH_CLUSTER_SIZE;
+    
+    // Start and goal costs to their clusters entrances (and direct cost if they share cluster)
+    unsigned short startCosts[MAX_CLUSTER_NODES] = { 0 };
+    unsigned short goalCosts[MAX_CLUSTER_NODES] = { 0 };
+    unsigned short directCost = PATH_COST_UNREACHABLE;
+    
+    SearchPathCluster(grid, startCluster, startX, startY);
+    
+    for (int i = 0; i < grid->clusters[startCluster].nodeCount; i++) startCosts[i] = GetPathClusterDistance(grid, startCluster, grid->clusters[startCluster].nodeX[i], grid->clusters[startCluster].nodeY[i]);
+    if (goalCluster == startCluster) directCost = GetPathClusterDistance(grid, startCluster, goalX, goalY);
+    
+    SearchPathCluster(grid, goalCluster, goalX, goalY);
+    
+    for (int i = 0; i < grid->clusters[goalCluster].nodeCount; i++) goalCosts[i] = GetPathClusterDistance(grid, goalCluster, grid->clusters[goalCluster].nodeX[i], grid->clusters[goalCluster].nodeY[i]);
+    
+    // Abstract graph A* search
+    BeginPathSearch(grid, nodeCount + 2);
+    RelaxPathNode(grid, startId, 0, -1, abs(goalX - startX) + abs(goalY - startY));
+    
+    while (grid->heapCount > 0)
+    {
+        PathHeapNode top = PopPathHeap(grid);
+        int id = top.id;
+        
+        if (id == goalId) break;
+        
+        int cost = grid->costs[id];
+        int x = startX;
+        int y = startY;
+        
+        if (id != startId)
+        {
+            PathCluster *cluster = &grid->clusters[id/MAX_CLUSTER_NODES];
+            x = cluster->nodeX[id%MAX_CLUSTER_NODES];
+            y = cluster->nodeY[id%MAX_CLUSTER_NODES];
+        }
+        
+        if ((cost + abs(goalX - x) + abs(goalY - y)) < top.cost) continue;     // Outdated heap entry
+        
+        if (id == startId)
+        {
+            PathCluster *cluster = &grid->clusters[startCluster];
+            
+            for (int i = 0; i < cluster->nodeCount; i++)
+            {
+                if (startCosts[i] != PATH_COST_UNREACHABLE) RelaxPathNode(grid, startCluster*MAX_CLUSTER_NODES + i, startCosts[i], id, abs(goalX - cluster->nodeX[i]) + abs(goalY - cluster->nodeY[i]));
+            }
+            
+            if (directCost != PATH_COST_UNREACHABLE) RelaxPathNode(grid, goalId, directCost, id, 0);
+            
+            continue;
+        }
+        
+        int clusterIndex = id/MAX_CLUSTER_NODES;
+        int node = id%MAX_CLUSTER_NODES;
+        PathCluster *cluster = &grid->clusters[clusterIndex];
+        
+        // Intra-cluster edges
+        for (int i = 0; i < cluster->nodeCount; i++)
+        {
+            unsigned short edgeCost = cluster->costs[node*cluster->nodeCount + i];
+            
+            if ((i != node) && (edgeCost != PATH_COST_UNREACHABLE)) RelaxPathNode(grid, clusterIndex*MAX_CLUSTER_NODES + i, cost + edgeCost, id, abs(goalX - cluster->nodeX[i]) + abs(goalY - cluster->nodeY[i]));
+        }
+        
+        // Inter-cluster edge: entrance node on the other side of the border
+        int side = cluster->nodeSide[node];
+        int neighbourX = x + ((side == 0)? 1 : (side == 1)? -1 : 0);
+        int neighbourY = y + ((side == 2)? 1 : (side == 3)? -1 : 0);
+        int neighbourIndex = (neighbourY/PATH_CLUSTER_SIZE)*grid->clusterCountX + neighbourX/PATH_CLUSTER_SIZE;
+        PathCluster *neighbour = &grid->clusters[neighbourIndex];
+        
+        for (int i = 0; i < neighbour->nodeCount; i++)
+        {
+            if ((neighbour->nodeX[i] == neighbourX) && (neighbour->nodeY[i] == neighbourY) && (neighbour->nodeSide[i] == (side ^ 1)))
+            {
+                RelaxPathNode(grid, neighbourIndex*MAX_CLUSTER_NODES + i, cost + 1, id, abs(goalX - neighbourX) + abs(goalY - neighbourY));
+                break;
+            }
+        }
+        
+        // Goal edge
+        if ((clusterIndex == goalCluster) && (goalCosts[node] != PATH_COST_UNREACHABLE)) RelaxPathNode(grid, goalId, cost + goalCosts[node], id, 0);
+    }
+    
+    if (grid->stamps[goalId] != grid->stamp) return path;     // Goal not reached
+    
+    // Abstract path points, from goal to start (points sharing position are merged)
+    int count = 0;
+    
+    for (int id = goalId; id != -1; id = grid->parents[id]) count++;
+    
+    path.points = (int *)malloc(count*sizeof(int));
+    path.tiles = (int *)malloc(PATH_CLUSTER_SIZE*PATH_CLUSTER_SIZE*sizeof(int));
+    path.length = grid->costs[goalId];
+    
+    for (int id = goalId; id != -1; id = grid->parents[id])
+    {
+        int point = goalY*grid->width + goalX;
+        
+        if (id == startId) point = startY*grid->width + startX;
+        else if (id != goalId) 
+        {
+            PathCluster *cluster = &grid->clusters[id/MAX_CLUSTER_NODES];
+            point = cluster->nodeY[id%MAX_CLUSTER_NODES]*grid->width + cluster->nodeX[id%MAX_CLUSTER_NODES];
+        }
+        
+        if ((path.pointCount == 0) || (path.points[path.pointCount - 1] != point)) path.points[path.pointCount++] = point;
+    }
+    
+    for (int i = 0; i < path.pointCount/2; i++)
+    {
+        int temp = path.points[i];
+        path.points[i] = path.points[path.pointCount - 1 - i];
+        path.points[path.pointCount - 1 - i] = temp;
+    }
+    
+    path.pointNext = 1;     // First point is start tile
+    
+    return path;
+}
+
+// Get path next tile, path is refined lazily: one abstract segment (inside a cluster) at a time
+// NOTE: Returns false once goal tile has been returned or if path was not found
+static bool GetPathNextTile(PathGrid *grid, Path *path, int *x, int *y)
+{
+    while (path->tileNext >= path->tileCount)
+    {
+        if (path->pointNext >= path->pointCount) return false;
+        
+        RefinePathSegment(grid, path, path->points[path->pointNext - 1], path->points[path->pointNext]);
+        path->pointNext++;
+    }
+    
+    *x = path->tiles[path->tileNext]%grid->width;
+    *y = path->tiles[path->tileNext]/grid->width;
+    path->tileNext++;
+    
+    return true;
+}
+
+// Unload path data
+static void UnloadPath(Path path)
+{
+    free(path.points);
+    free(path.tiles);
+}
+
+#if defined(PATHFINDING_BENCHMARK)
+// Find path length between two tiles with A* over all tiles (flat search), -1 if not found
+// NOTE: Used as reference for hierarchical search, costs are optimal (4-connected tiles)
+static int FindPathFlat(PathGrid *grid, int startX, int startY, int goalX, int goalY)
+{
+    if (!IsPathTileWalkable(grid, startX, startY) || !IsPathTileWalkable(grid, goalX, goalY)) return -1;
+    
+    int goal = goalY*grid->width + goalX;
+    
+    BeginPathSearch(grid, grid->width*grid->height);
+    RelaxPathNode(grid, startY*grid->width + startX, 0, -1, abs(goalX - startX) + abs(goalY - startY));
+    
+    while (grid->heapCount > 0)
+    {
+        PathHeapNode top = PopPathHeap(grid);
+        
+        if (top.id == goal) return grid->costs[goal];
+        
+        int x = top.id%grid->width;
+        int y = top.id/grid->width;
+        int cost = grid->costs[top.id];
+        
+        if ((cost + abs(goalX - x) + abs(goalY - y)) < top.cost) continue;     // Outdated heap entry
+        
+        static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        
+        for (int k = 0; k < 4; k++)
+        {
+            int nx = x + offsets[k][0];
+            int ny = y + offsets[k][1];
+            
+            if (IsPathTileWalkable(grid, nx, ny)) RelaxPathNode(grid, ny*grid->width + nx, cost + 1, top.id, abs(goalX - nx) + abs(goalY - ny));
+        }
+    }
+    
+    return -1;
+}
+#endif
+
+// Build cluster entrance nodes (from walkability of its borders) and intra-cluster costs
+// NOTE: Every walkable run along a border (walkable tiles on both sides) gets one entrance on its middle,
+// or two on its ends if longer than PATH_ENTRANCE_SPLIT; both sides compute the same runs
+static void BuildPathCluster(PathGrid *grid, int index)
+{
+    PathCluster *cluster = &grid->clusters[index];
+    int originX = (index%grid->clusterCountX)*PATH_CLUSTER_SIZE;
+    int originY = (index/grid->clusterCountX)*PATH_CLUSTER_SIZE;
+    int sizeX = ((originX + PATH_CLUSTER_SIZE) <= grid->width)? PATH_CLUSTER_SIZE : (grid->width - originX);
+    int sizeY = ((originY + PATH_CLUSTER_SIZE) <= grid->height)? PATH_CLUSTER_SIZE : (grid->height - originY);
+    
+    cluster->nodeCount = 0;
+    
+    // Borders sides: 0 - right, 1 - left, 2 - bottom, 3 - top
+    for (int side = 0; side < 4; side++)
+    {
+        int dx = (side == 0)? 1 : (side == 1)? -1 : 0;
+        int dy = (side == 2)? 1 : (side == 3)? -1 : 0;
+        int edgeX = (side == 0)? (originX + sizeX - 1) : originX;
+        int edgeY = (side == 2)? (originY + sizeY - 1) : originY;
+        int length = (side < 2)? sizeY : sizeX;
+        int runStart = -1;
+        
+        for (int i = 0; i <= length; i++)
+        {
+            int x = (side < 2)? edgeX : (originX + i);
+            int y = (side < 2)? (originY + i) : edgeY;
+            bool open = (i < length) && IsPathTileWalkable(grid, x, y) && IsPathTileWalkable(grid, x + dx, y + dy);
+            
+            if (open && (runStart == -1)) runStart = i;
+            else if (!open && (runStart != -1))
+            {
+                int entrances[2] = { (runStart + i - 1)/2, -1 };
+                
+                if ((i - runStart) >= PATH_ENTRANCE_SPLIT) { entrances[0] = runStart; entrances[1] = i - 1; }
+                
+                for (int k = 0; (k < 2) && (entrances[k] != -1); k++)
+                {
+                    if (cluster->nodeCount == MAX_CLUSTER_NODES)
+                    {
+                        TraceLog(LOG_WARNING, "PATHFINDING: Cluster [%i] entrances limit reached", index);
+                        break;
+                    }
+                    
+                    cluster->nodeX[cluster->nodeCount] = (side < 2)? edgeX : (originX + entrances[k]);
+                    cluster->nodeY[cluster->nodeCount] = (side < 2)? (originY + entrances[k]) : edgeY;
+                    cluster->nodeSide[cluster->nodeCount] = side;
+                    cluster->nodeCount++;
+                }
+                
+                runStart = -1;
+            }
+        }
+    }
+    
+    // Intra-cluster costs between entrances (paths inside cluster only)
+    cluster->costs = (unsigned short *)realloc(cluster->costs, (cluster->nodeCount*cluster->nodeCount + 1)*sizeof(unsigned short));
+    
+    for (int i = 0; i < cluster->nodeCount; i++)
+    {
+        SearchPathCluster(grid, index, cluster->nodeX[i], cluster->nodeY[i]);
+        
+        for (int j = 0; j < cluster->nodeCount; j++) cluster->costs[i*cluster->nodeCount + j] = GetPathClusterDistance(grid, index, cluster->nodeX[j], cluster->nodeY[j]);
+    }
+}
+
+// Compute tile steps from a tile to all cluster tiles (breadth-first search inside cluster)
+// NOTE: Distances are stored on grid distances scratch (PATH_CLUSTER_SIZE stride), read them with GetPathClusterDistance()
+static void SearchPathCluster(PathGrid *grid, int index, int startX, int startY)
+{
+    int originX = (index%grid->clusterCountX)*PATH_CLUSTER_SIZE;
+    int originY = (index/grid->clusterCountX)*PATH_CLUSTER_SIZE;
+    int sizeX = ((originX + PATH_CLUSTER_SIZE) <= grid->width)? PATH_CLUSTER_SIZE : (grid->width - originX);
+    int sizeY = ((originY + PATH_CLUSTER_SIZE) <= grid->height)? PATH_CLUSTER_SIZE : (grid->height - originY);
+    
+    for (int i = 0; i < PATH_CLUSTER_SIZE*PATH_CLUSTER_SIZE; i++) grid->distances[i] = PATH_COST_UNREACHABLE;
+    
+    if (!IsPathTileWalkable(grid, startX, startY)) return;
+    
+    int head = 0;
+    int tail = 0;
+    
+    grid->distances[(startY - originY)*PATH_CLUSTER_SIZE + (startX - originX)] = 0;
+    grid->queue[tail++] = (startY - originY)*PATH_CLUSTER_SIZE + (startX - originX);
+    
+    while (head < tail)
+    {
+        int local = grid->queue[head++];
+        int x = local%PATH_CLUSTER_SIZE;
+        int y = local/PATH_CLUSTER_SIZE;
+        
+        static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        
+        for (int k = 0; k < 4; k++)
+        {
+            int nx = x + offsets[k][0];
+            int ny = y + offsets[k][1];
+            int next = ny*PATH_CLUSTER_SIZE + nx;
+            
+            if ((nx >= 0) && (ny >= 0) && (nx < sizeX) && (ny < sizeY) && (grid->distances[next] == PATH_COST_UNREACHABLE) &&
+                grid->walkable[(originY + ny)*grid->width + originX + nx])
+            {
+                grid->distances[next] = grid->distances[local] + 1;
+                grid->queue[tail++] = next;
+            }
+        }
+    }
+}
+
+// Get tile distance from last cluster search start (tile must be inside searched cluster)
+static unsigned short GetPathClusterDistance(PathGrid *grid, int index, int x, int y)
+{
+    return grid->distances[(y - (index/grid->clusterCountX)*PATH_CLUSTER_SIZE)*PATH_CLUSTER_SIZE + (x - (index%grid->clusterCountX)*PATH_CLUSTER_SIZE)];
+}
+
+// Refine abstract path segment into tiles (path tiles are replaced)
+// NOTE: Segment points are neighbour tiles (inter-cluster edge) or share a cluster (intra-cluster edge)
+static void RefinePathSegment(PathGrid *grid, Path *path, int from, int to)
+{
+    int fromX = from%grid->width;
+    int fromY = from/grid->width;
+    int toX = to%grid->width;
+    int toY = to/grid->width;
+    
+    path->tileCount = 0;
+    path->tileNext = 0;
+    
+    if ((abs(toX - fromX) + abs(toY - fromY)) == 1)
+    {
+        path->tiles[path->tileCount++] = to;
+        return;
+    }
+    
+    // Search from segment end, path is followed from segment start down to distance 0
+    int index = (fromY/PATH_CLUSTER_SIZE)*grid->clusterCountX + fromX/PATH_CLUSTER_SIZE;
+    
+    SearchPathCluster(grid, index, toX, toY);
+    
+    int x = fromX;
+    int y = fromY;
+    unsigned short distance = GetPathClusterDistance(grid, index, x, y);
+    
+    if (distance == PATH_COST_UNREACHABLE) return;      // NOTE: Cluster changed since path was found
+    
+    static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    
+    while (distance > 0)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            int nx = x + offsets[k][0];
+            int ny = y + offsets[k][1];
+            
+            if (((nx/PATH_CLUSTER_SIZE) == (fromX/PATH_CLUSTER_SIZE)) && ((ny/PATH_CLUSTER_SIZE) == (fromY/PATH_CLUSTER_SIZE)) && 
+                IsPathTileWalkable(grid, nx, ny) && (GetPathClusterDistance(grid, index, nx, ny) == (distance - 1)))
+            {
+                x = nx;
+                y = ny;
+                break;
+            }
+        }
+        
+        distance--;
+        path->tiles[path->tileCount++] = y*grid->width + x;
+    }
+}
+
+// Check if tile is walkable (tiles out of grid are not walkable)
+static bool IsPathTileWalkable(PathGrid *grid, int x, int y)
+{
+    return (x >= 0) && (y >= 0) && (x < grid->width) && (y < grid->height) && grid->walkable[y*grid->width + x];
+}
+
+// Begin a search over entries (abstract nodes or tiles), search scratch grows if required
+// NOTE: Entries are reset by stamp increment, no clear required
+static void BeginPathSearch(PathGrid *grid, int entries)
+{
+    if (entries > grid->scratchSize)
+    {
+        free(grid->costs);
+        free(grid->parents);
+        free(grid->stamps);
+        
+        grid->costs = (int *)malloc(entries*sizeof(int));
+        grid->parents = (int *)malloc(entries*sizeof(int));
+        grid->stamps = (unsigned int *)calloc(entries, sizeof(unsigned int));
+        grid->scratchSize = entries;
+        grid->stamp = 0;
+    }
+    
+    grid->stamp++;
+    grid->heapCount = 0;
+}
+
+// Set entry cost and parent if cost improves, entry is pushed into search heap
+static void RelaxPathNode(PathGrid *grid, int id, int cost, int parent, int heuristic)
+{
+    if ((grid->stamps[id] == grid->stamp) && (grid->costs[id] <= cost)) return;
+    
+    grid->stamps[id] = grid->stamp;
+    grid->costs[id] = cost;
+    grid->parents[id] = parent;
+    
+    if (grid->heapCount == grid->heapCapacity)
+    {
+        grid->heapCapacity = (grid->heapCapacity > 0)? grid->heapCapacity*2 : 1024;
+        grid->heap = (PathHeapNode *)realloc(grid->heap, grid->heapCapacity*sizeof(PathHeapNode));
+    }
+    
+    // Binary heap push (sift up)
+    int i = grid->heapCount++;
+    
+    while ((i > 0) && (grid->heap[(i - 1)/2].cost > (cost + heuristic)))
+    {
+        grid->heap[i] = grid->heap[(i - 1)/2];
+        i = (i - 1)/2;
+    }
+    
+    grid->heap[i] = (PathHeapNode){ cost + heuristic, id };
+}
+
+// Pop lowest cost entry from search heap
+static PathHeapNode PopPathHeap(PathGrid *grid)
+{
+    PathHeapNode top = grid->heap[0];
+    PathHeapNode last = grid->heap[--grid->heapCount];
+    
+    // Binary heap pop (sift down)
+    int i = 0;
+    
+    while ((2*i + 1) < grid->heapCount)
+    {
+        int child = 2*i + 1;
+        
+        if (((child + 1) < grid->heapCount) && (grid->heap[child + 1].cost < grid->heap[child].cost)) child++;
+        if (grid->heap[child].cost >= last.cost) break;
+        
+        grid->heap[i] = grid->heap[child];
+        i = child;
+    }
+    
+    grid->heap[i] = last;
+    
+    return top;
+}
+
+#if defined(PATHFINDING_BENCHMARK)
+// Measure hierarchical and flat pathfinding queries per second
+// NOTE: World is tilemap repeated as rooms (size*size tiles), hierarchical paths are fully refined and
+// checked (tiles steps and walkability), flat A* gives optimal lengths to compare with
+static void BenchmarkPathfinding(Tilemap room, int size, int queries)
+{
+    int roomsX = size/room.tileCountX;
+    int roomsY = size/room.tileCountY;
+    PathGrid grid = LoadPathGrid(roomsX*room.tileCountX, roomsY*room.tileCountY);
+    
+    for (int y = 0; y < grid.height; y++)
+    {
+        for (int x = 0; x < grid.width; x++) SetPathGridTile(&grid, x, y, GetWorldRoomTile(room, x, y, roomsX, roomsY).collider != 0);
+    }
+    
+    double startTime = glfwGetTime();
+    BuildPathGrid(&grid);
+    double buildTime = glfwGetTime() - startTime;
+    
+    // Random walkable start and goal tiles
+    int *points = (int *)malloc(queries*4*sizeof(int));
+    
+    for (int i = 0; i < queries*2; i++)
+    {
+        do
+        {
+            points[i*2] = rand()%grid.width;
+            points[i*2 + 1] = rand()%grid.height;
+        } while (!IsPathTileWalkable(&grid, points[i*2], points[i*2 + 1]));
+    }
+    
+    int *lengths = (int *)malloc(queries*sizeof(int));
+    long long hierarchicalLength = 0;
+    long long flatLength = 0;
+    int invalidPaths = 0;
+    
+    startTime = glfwGetTime();
+    
+    for (int i = 0; i < queries; i++)
+    {
+        int *query = &points[i*4];
+        Path path = FindPath(&grid, query[0], query[1], query[2], query[3]);
+        
+        int x = query[0];
+        int y = query[1];
+        int nextX = 0;
+        int nextY = 0;
+        int steps = 0;
+        
+        while (GetPathNextTile(&grid, &path, &nextX, &nextY))
+        {
+            if (((abs(nextX - x) + abs(nextY - y)) != 1) || !IsPathTileWalkable(&grid, nextX, nextY)) invalidPaths++;
+            
+            x = nextX;
+            y = nextY;
+            steps++;
+        }
+        
+        if ((path.length == -1) || (x != query[2]) || (y != query[3]) || (steps != path.length)) invalidPaths++;
+        
+        lengths[i] = path.length;
+        UnloadPath(path);
+    }
+    
+    double hierarchicalTime = glfwGetTime() - startTime;
+    
+    startTime = glfwGetTime();
+    
+    for (int i = 0; i < queries; i++)
+    {
+        int *query = &points[i*4];
+        int length = FindPathFlat(&grid, query[0], query[1], query[2], query[3]);
+        
+        if ((length != -1) && (lengths[i] != -1))
+        {
+            hierarchicalLength += lengths[i];
+            flatLength += length;
+        }
+    }
+    
+    double flatTime = glfwGetTime() - startTime;
+    
+    // Incremental updates: toggle random tiles walkability (every tile is toggled twice, grid is restored)
+    int updates = 1000;
+    
+    startTime = glfwGetTime();
+    
+    for (int i = 0; i < updates; i++)
+    {
+        int x = points[(i%(queries*2))*2];
+        int y = points[(i%(queries*2))*2 + 1];
+        
+        UpdatePathGridTile(&grid, x, y, !grid.walkable[y*grid.width + x]);
+        UpdatePathGridTile(&grid, x, y, !grid.walkable[y*grid.width + x]);
+    }
+    
+    double updateTime = glfwGetTime() - startTime;
+    
+    TraceLog(LOG_INFO, "PATHFINDING: Benchmark world %ix%i tiles, grid built in %.2f ms", grid.width, grid.height, buildTime*1000.0);
+    TraceLog(LOG_INFO, "PATHFINDING: Hierarchical: %.0f queries/s (refined), flat A*: %.0f queries/s (%.1fx)", 
+             queries/hierarchicalTime, queries/flatTime, flatTime/hierarchicalTime);
+    TraceLog(LOG_INFO, "PATHFINDING: Hierarchical paths length %.1f%% of optimal, %i invalid paths", 
+             (hierarchicalLength > 0)? 100.0*hierarchicalLength/flatLength : 0.0, invalidPaths);
+    TraceLog(LOG_INFO, "PATHFINDING: Tile update %.3f ms", updateTime*1000.0/(updates*2));
+    
+    free(points);
+    free(lengths);
+    UnloadPathGrid(grid);
+}
+#endif
+#endif
+
+// AI update scheduler: distance-based update rate and per-frame time budget
+//----------------------------------------------------------------------------------
+// Load update scheduler (entities ids capacity, budget in ms)
+static UpdateScheduler LoadUpdateScheduler(int capacity, float budget)
+{
+    UpdateScheduler scheduler = { 0 };
+    
+    scheduler.buckets = (int *)malloc(capacity*sizeof(int));
+    scheduler.slots = (int *)malloc(capacity*sizeof(int));
+    scheduler.lastTimes = (double *)malloc(capacity*sizeof(double));
+    scheduler.queued = (bool *)calloc(capacity, sizeof(bool));
+    scheduler.queue = (int *)malloc(capacity*sizeof(int));
+    scheduler.capacity = capacity;
+    scheduler.budget = budget/1000.0;
+    
+    for (int i = 0; i < capacity; i++) scheduler.buckets[i] = -1;
+    
+    return scheduler;
+}
+
+// Unload update scheduler data
+static void UnloadUpdateScheduler(UpdateScheduler scheduler)
+{
+    for (int i = 0; i < UPDATE_LISTS; i++) free(scheduler.lists[i].entities);
+    
+    free(scheduler.buckets);
+    free(scheduler.slots);
+    free(scheduler.lastTimes);
+    free(scheduler.queued);
+    free(scheduler.queue);
+}
+
+// Set entity update bucket, entity is registered on first call
+// NOTE: Entity phase on its bucket is its id, so bucket entities updates are spread over frames
+static void SetUpdateBucket(UpdateScheduler *scheduler, int id, int bucket)
+{
+    int previous = scheduler->buckets[id];
+    
+    if (previous == bucket) return;
+    
+    // Remove from previous list (swap with last entity)
+    if (previous != -1)
+    {
+        UpdateList *list = &scheduler->lists[updateListsOffset[previous] + id%updateIntervals[previous]];
+        int last = list->entities[--list->count];
+        
+        list->entities[scheduler->slots[id]] = last;
+        scheduler->slots[last] = scheduler->slots[id];
+    }
+    else scheduler->lastTimes[id] = glfwGetTime();
+    
+    UpdateList *list = &scheduler->lists[updateListsOffset[bucket] + id%updateIntervals[bucket]];
+    
+    if (list->count == list->capacity)
+    {
+        list->capacity = (list->capacity > 0)? list->capacity*2 : 256;
+        list->entities = (int *)realloc(list->entities, list->capacity*sizeof(int));
+    }
+    
+    scheduler->slots[id] = list->count;
+    scheduler->buckets[id] = bucket;
+    list->entities[list->count++] = id;
+}
+
+// Get update bucket for a position: visible on view (0), near viewer (1) or far from viewer (2)
+static int GetUpdateBucket(Vector2 position, Vector2 viewer, Rectangle view)
+{
+    if ((position.x >= view.x) && (position.y >= view.y) && (position.x < (view.x + view.width)) && (position.y < (view.y + view.height))) return 0;
+    
+    float dx = position.x - viewer.x;
+    float dy = position.y - viewer.y;
+    
+    return ((dx*dx + dy*dy) < (UPDATE_FAR_DISTANCE*UPDATE_FAR_DISTANCE))? 1 : 2;
+}
+
+// Begin frame updates, returns entities to update (deferred included)
+// NOTE: Entities deferred on previous frame are updated first, so no entity is starved
+static int BeginUpdates(UpdateScheduler *scheduler)
+{
+    int count = 0;
+    
+    for (int i = scheduler->queueNext; i < scheduler->queueCount; i++) scheduler->queue[count++] = scheduler->queue[i];
+    
+    scheduler->deferred += count;
+    
+    for (int b = 0; b < UPDATE_BUCKETS; b++)
+    {
+        UpdateList *list = &scheduler->lists[updateListsOffset[b] + scheduler->frame%updateIntervals[b]];
+        
+        for (int i = 0; i < list->count; i++)
+        {
+            int id = list->entities[i];
+            
+            if (!scheduler->queued[id])
+            {
+                scheduler->queued[id] = true;
+                scheduler->queue[count++] = id;
+            }
+        }
+    }
+    
+    scheduler->queueCount = count;
+    scheduler->queueNext = 0;
+    scheduler->frame++;
+    scheduler->frameEnd = glfwGetTime() + scheduler->budget;
+    
+    return count;
+}
+
+// Get next entity to update and its elapsed time since last update, false when done or out of budget
+// NOTE: Entities not updated once budget is exhausted stay queued for next frame
+static bool NextUpdate(UpdateScheduler *scheduler, int *id, float *deltaTime)
+{
+    if (scheduler->queueNext >= scheduler->queueCount) return false;
+    
+    double time = glfwGetTime();
+    
+    if (time > scheduler->frameEnd) return false;
+    
+    *id = scheduler->queue[scheduler->queueNext++];
+    *deltaTime = (float)(time - scheduler->lastTimes[*id]);
+    
+    scheduler->lastTimes[*id] = time;
+    scheduler->queued[*id] = false;
+    scheduler->updates++;
+    
+    return true;
+}
+
+#if defined(MONSTER_CROWD)
+// Crowd: local avoidance (ORCA) with uniform grid neighbours and parallel solve
+//----------------------------------------------------------------------------------
+// Load crowd data and start worker threads
+// NOTE: Walls are path grid blocked tiles (grid must outlive crowd), agents settings are monsters defaults
+static void StartCrowd(Crowd *crowd, PathGrid *grid, float tileSize, Vector2 origin, int capacity, int threadCount)
+{
+    crowd->agents = (CrowdAgent *)calloc(capacity, sizeof(CrowdAgent));
+    crowd->count = 0;
+    crowd->capacity = capacity;
+    crowd->radius = 6.0f;
+    crowd->maxSpeed = 60.0f;
+    crowd->neighbourDistance = 32.0f;
+    crowd->timeHorizon = 1.0f;
+    crowd->timeHorizonWalls = 0.5f;
+    
+    crowd->grid = grid;
+    crowd->tileSize = tileSize;
+    crowd->origin = origin;
+    
+    crowd->cellCountX = (int)ceilf(grid->width*tileSize/crowd->neighbourDistance);
+    crowd->cellCountY = (int)ceilf(grid->height*tileSize/crowd->neighbourDistance);
+    crowd->cellStart = (int *)malloc((crowd->cellCountX*crowd->cellCountY + 1)*sizeof(int));
+    crowd->cellAgents = (int *)malloc(capacity*sizeof(int));
+    crowd->agentCells = (int *)malloc(capacity*sizeof(int));
+    
+    crowd->stepTime = 1.0f/CROWD_SIMULATION_RATE;
+    crowd->accumulator = 0.0f;
+    
+    pthread_mutex_init(&crowd->mutex, NULL);
+    pthread_cond_init(&crowd->cond, NULL);
+    
+    crowd->generation = 0;
+    crowd->pending = 0;
+    crowd->running = true;
+    crowd->threadCount = 1;
+    
+    if (threadCount > CROWD_MAX_THREADS) threadCount = CROWD_MAX_THREADS;
+    
+    // NOTE: First worker slot is calling thread, it solves its range while waiting for workers
+    for (int i = 1; i < threadCount; i++)
+    {
+        crowd->workers[i].crowd = crowd;
+        crowd->workers[i].index = i;
+        
+        if (pthread_create(&crowd->workers[i].thread, NULL, CrowdWorkerMain, &crowd->workers[i]) != 0)
+        {
+            TraceLog(LOG_WARNING, "CROWD: Worker thread could not be created, using %i threads", crowd->threadCount);
+            break;
+        }
+        
+        crowd->threadCount++;
+    }
+    
+    TraceLog(LOG_INFO, "CROWD: Crowd started (%i agents capacity, %i threads)", capacity, crowd->threadCount);
+}
+
+// Stop worker threads and unload crowd data
+static void StopCrowd(Crowd *crowd)
+{
+    pthread_mutex_lock(&crowd->mutex);
+    crowd->running = false;
+    pthread_cond_broadcast(&crowd->cond);
+    pthread_mutex_unlock(&crowd->mutex);
+    
+    for (int i = 1; i < crowd->threadCount; i++) pthread_join(crowd->workers[i].thread, NULL);
+    
+    pthread_cond_destroy(&crowd->cond);
+    pthread_mutex_destroy(&crowd->mutex);
+    
+    free(crowd->agents);
+    free(crowd->cellStart);
+    free(crowd->cellAgents);
+    free(crowd->agentCells);
+}
+
+// Add crowd agent, returns agent index (-1 if crowd is full)
+static int AddCrowdAgent(Crowd *crowd, Vector2 position)
+{
+    if (crowd->count == crowd->capacity) return -1;
+    
+    crowd->agents[crowd->count] = (CrowdAgent){ position, { 0.0f, 0.0f }, position, { 0.0f, 0.0f } };
+    
+    return crowd->count++;
+}
+
+// Update crowd agents at fixed rate (CROWD_SIMULATION_RATE)
+// NOTE: Steps are skipped if simulation falls behind more than 3 steps (slow frames)
+static void UpdateCrowd(Crowd *crowd, float deltaTime)
+{
+    float stepTime = 1.0f/CROWD_SIMULATION_RATE;
+    
+    crowd->accumulator += deltaTime;
+    
+    if (crowd->accumulator > 3*stepTime) crowd->accumulator = 3*stepTime;
+    
+    while (crowd->accumulator >= stepTime)
+    {
+        StepCrowd(crowd, stepTime);
+        crowd->accumulator -= stepTime;
+    }
+}
+
+// Compute agents collision-free velocities and move agents
+// NOTE: Agents are split in equal ranges, one per solver thread; velocities are applied once all are solved
+static void StepCrowd(Crowd *crowd, float stepTime)
+{
+    crowd->stepTime = stepTime;
+    
+    UpdateCrowdCells(crowd);
+    
+    pthread_mutex_lock(&crowd->mutex);
+    crowd->generation++;
+    crowd->pending = crowd->threadCount - 1;
+    pthread_cond_broadcast(&crowd->cond);
+    pthread_mutex_unlock(&crowd->mutex);
+    
+    SolveCrowdAgents(crowd, 0, crowd->count/crowd->threadCount);
+    
+    pthread_mutex_lock(&crowd->mutex);
+    while (crowd->pending > 0) pthread_cond_wait(&crowd->cond, &crowd->mutex);
+    pthread_mutex_unlock(&crowd->mutex);
+    
+    for (int i = 0; i < crowd->count; i++)
+    {
+        CrowdAgent *agent = &crowd->agents[i];
+        
+        agent->velocity = agent->newVelocity;
+        agent->position.x += agent->velocity.x*stepTime;
+        agent->position.y += agent->velocity.y*stepTime;
+    }
+}
+
+// Draw crowd agents (interpolated between steps)
+static void DrawCrowd(Crowd *crowd, Color color)
+{
+    int size = (int)(crowd->radius*2);
+    
+    for (int i = 0; i < crowd->count; i++)
+    {
+        CrowdAgent *agent = &crowd->agents[i];
+        
+        DrawRectangle((int)(agent->position.x + agent->velocity.x*crowd->accumulator - crowd->radius), 
+                      (int)(agent->position.y + agent->velocity.y*crowd->accumulator - crowd->radius), size, size, color);
+    }
+}
+
+// Set agent goal towards target following a path around walls (hierarchical pathfinding on walls grid)
+// NOTE: Goal is path tile CROWD_PATH_LOOKAHEAD tiles ahead, target itself if it is nearer or unreachable
+static void SetCrowdAgentTarget(Crowd *crowd, int index, Vector2 target)
+{
+    CrowdAgent *agent = &crowd->agents[index];
+    int startX = (int)floorf((agent->position.x - crowd->origin.x)/crowd->tileSize);
+    int startY = (int)floorf((agent->position.y - crowd->origin.y)/crowd->tileSize);
+    int goalX = (int)floorf((target.x - crowd->origin.x)/crowd->tileSize);
+    int goalY = (int)floorf((target.y - crowd->origin.y)/crowd->tileSize);
+    
+    Path path = FindPath(crowd->grid, startX, startY, goalX, goalY);
+    
+    agent->goal = target;
+    
+    if (path.length > CROWD_PATH_LOOKAHEAD)
+    {
+        int x = startX;
+        int y = startY;
+        
+        for (int i = 0; i < CROWD_PATH_LOOKAHEAD; i++) GetPathNextTile(crowd->grid, &path, &x, &y);
+        
+        agent->goal = (Vector2){ crowd->origin.x + (x + 0.5f)*crowd->tileSize, crowd->origin.y + (y + 0.5f)*crowd->tileSize };
+    }
+    
+    UnloadPath(path);
+}
+
+// Sort agents into neighbour cells (counting sort)
+static void UpdateCrowdCells(Crowd *crowd)
+{
+    int cellCount = crowd->cellCountX*crowd->cellCountY;
+    
+    for (int i = 0; i <= cellCount; i++) crowd->cellStart[i] = 0;
+    
+    for (int i = 0; i < crowd->count; i++)
+    {
+        int cellX = (int)((crowd->agents[i].position.x - crowd->origin.x)/crowd->neighbourDistance);
+        int cellY = (int)((crowd->agents[i].position.y - crowd->origin.y)/crowd->neighbourDistance);
+        
+        cellX = (cellX < 0)? 0 : (cellX >= crowd->cellCountX)? (crowd->cellCountX - 1) : cellX;
+        cellY = (cellY < 0)? 0 : (cellY >= crowd->cellCountY)? (crowd->cellCountY - 1) : cellY;
+        
+        crowd->agentCells[i] = cellY*crowd->cellCountX + cellX;
+        crowd->cellStart[crowd->agentCells[i] + 1]++;
+    }
+    
+    for (int i = 0; i < cellCount; i++) crowd->cellStart[i + 1] += crowd->cellStart[i];
+    
+    // NOTE: Cells start is used as insertion cursor and restored afterwards
+    for (int i = 0; i < crowd->count; i++) crowd->cellAgents[crowd->cellStart[crowd->agentCells[i]]++] = i;
+    for (int i = cellCount; i > 0; i--) crowd->cellStart[i] = crowd->cellStart[i - 1];
+    
+    crowd->cellStart[0] = 0;
+}
+
+// Compute agents range collision-free velocities (agents new velocity)
+static void SolveCrowdAgents(Crowd *crowd, int first, int last)
+{
+    for (int i = first; i < last; i++) crowd->agents[i].newVelocity = SolveCrowdAgent(crowd, i);
+}
+
+// Compute agent collision-free velocity, closest to its preferred velocity (towards goal)
+// NOTE: Walls constraints are hard ones: they are kept if constraints are infeasible (agents squeezed)
+static Vector2 SolveCrowdAgent(Crowd *crowd, int index)
+{
+    CrowdAgent *agent = &crowd->agents[index];
+    CrowdLine lines[CROWD_MAX_LINES];
+    int lineCount = 0;
+    
+    // Walls: blocked tiles in reach, a half-plane constraint per tile (closest tile point)
+    float reach = crowd->radius + crowd->maxSpeed*crowd->timeHorizonWalls;
+    int minTileX = (int)floorf((agent->position.x - reach - crowd->origin.x)/crowd->tileSize);
+    int minTileY = (int)floorf((agent->position.y - reach - crowd->origin.y)/crowd->tileSize);
+    int maxTileX = (int)floorf((agent->position.x + reach - crowd->origin.x)/crowd->tileSize);
+    int maxTileY = (int)floorf((agent->position.y + reach - crowd->origin.y)/crowd->tileSize);
+    
+    for (int y = minTileY; y <= maxTileY; y++)
+    {
+        for (int x = minTileX; x <= maxTileX; x++)
+        {
+            if (IsPathTileWalkable(crowd->grid, x, y) || (lineCount == CROWD_MAX_LINES)) continue;
+            
+            Vector2 tileMin = { crowd->origin.x + x*crowd->tileSize, crowd->origin.y + y*crowd->tileSize };
+            Vector2 closest = { Clamp(agent->position.x, tileMin.x, tileMin.x + crowd->tileSize), 
+                                Clamp(agent->position.y, tileMin.y, tileMin.y + crowd->tileSize) };
+            Vector2 relativePosition = Vector2Subtract(closest, agent->position);
+            float distance = Vector2Length(relativePosition);
+            
+            if (distance >= reach) continue;
+            
+            // Agent center inside wall: pushed out towards tile center opposite side
+            if (distance < 0.0001f) 
+            {
+                relativePosition = Vector2Subtract((Vector2){ tileMin.x + crowd->tileSize/2, tileMin.y + crowd->tileSize/2 }, agent->position);
+                distance = -Vector2Length(relativePosition);
+                relativePosition = Vector2Scale(relativePosition, -1.0f);
+            }
+            
+            Vector2 normal = Vector2Scale(relativePosition, 1.0f/distance);
+            
+            // Velocity towards wall limited to reach its surface at time horizon (or to leave it this step if overlapping)
+            float speed = (distance > crowd->radius)? (distance - crowd->radius)/crowd->timeHorizonWalls : (distance - crowd->radius)/crowd->stepTime;
+            
+            lines[lineCount].point = Vector2Scale(normal, speed);
+            lines[lineCount].direction = (Vector2){ -normal.y, normal.x };
+            lineCount++;
+        }
+    }
+    
+    int wallCount = lineCount;
+    
+    // Neighbours: closest agents in neighbour distance, found on 3x3 cells around agent cell
+    int neighbours[CROWD_MAX_NEIGHBOURS];
+    float neighboursDistance[CROWD_MAX_NEIGHBOURS];
+    int neighbourCount = 0;
+    float rangeSq = crowd->neighbourDistance*crowd->neighbourDistance;
+    int cellX = crowd->agentCells[index]%crowd->cellCountX;
+    int cellY = crowd->agentCells[index]/crowd->cellCountX;
+    
+    for (int y = cellY - 1; y <= cellY + 1; y++)
+    {
+        for (int x = cellX - 1; x <= cellX + 1; x++)
+        {
+            if ((x < 0) || (y < 0) || (x >= crowd->cellCountX) || (y >= crowd->cellCountY)) continue;
+            
+            int cell = y*crowd->cellCountX + x;
+            
+            for (int k = crowd->cellStart[cell]; k < crowd->cellStart[cell + 1]; k++)
+            {
+                int other = crowd->cellAgents[k];
+                Vector2 offset = Vector2Subtract(crowd->agents[other].position, agent->position);
+                float distanceSq = offset.x*offset.x + offset.y*offset.y;
+                
+                if ((other == index) || (distanceSq >= rangeSq)) continue;
+                
+                // Insertion into neighbours sorted by distance, farthest dropped when full
+                int i = (neighbourCount < CROWD_MAX_NEIGHBOURS)? neighbourCount++ : CROWD_MAX_NEIGHBOURS;
+                
+                while ((i > 0) && (neighboursDistance[i - 1] > distanceSq))
+                {
+                    if (i < CROWD_MAX_NEIGHBOURS) { neighbours[i] = neighbours[i - 1]; neighboursDistance[i] = neighboursDistance[i - 1]; }
+                    i--;
+                }
+                
+                if (i < CROWD_MAX_NEIGHBOURS) { neighbours[i] = other; neighboursDistance[i] = distanceSq; }
+            }
+        }
+    }
+    
+    // Agents: reciprocal velocity obstacles, each agent takes half of the avoidance effort
+    float invTimeHorizon = 1.0f/crowd->timeHorizon;
+    float combinedRadius = crowd->radius*2;
+    float combinedRadiusSq = combinedRadius*combinedRadius;
+    
+    for (int n = 0; (n < neighbourCount) && (lineCount < CROWD_MAX_LINES); n++)
+    {
+        CrowdAgent *other = &crowd->agents[neighbours[n]];
+        Vector2 relativePosition = Vector2Subtract(other->position, agent->position);
+        Vector2 relativeVelocity = Vector2Subtract(agent->velocity, other->velocity);
+        float distanceSq = neighboursDistance[n];
+        Vector2 direction = { 0 };
+        Vector2 u = { 0 };
+        
+        if (distanceSq > combinedRadiusSq)
+        {
+            // No collision: vector from cutoff center to relative velocity
+            Vector2 w = Vector2Subtract(relativeVelocity, Vector2Scale(relativePosition, invTimeHorizon));
+            float wLengthSq = w.x*w.x + w.y*w.y;
+            float dotProduct = Vector2DotProduct(w, relativePosition);
+            
+            if ((dotProduct < 0.0f) && ((dotProduct*dotProduct) > (combinedRadiusSq*wLengthSq)))
+            {
+                // Project on cutoff circle
+                float wLength = sqrtf(wLengthSq);
+                Vector2 unitW = Vector2Scale(w, 1.0f/wLength);
+                
+                direction = (Vector2){ unitW.y, -unitW.x };
+                u = Vector2Scale(unitW, combinedRadius*invTimeHorizon - wLength);
+            }
+            else
+            {
+                // Project on legs
+                float leg = sqrtf(distanceSq - combinedRadiusSq);
+                
+                if ((relativePosition.x*w.y - relativePosition.y*w.x) > 0.0f)
+                {
+                    direction = (Vector2){ (relativePosition.x*leg - relativePosition.y*combinedRadius)/distanceSq, 
+                                           (relativePosition.x*combinedRadius + relativePosition.y*leg)/distanceSq };
+                }
+                else
+                {
+                    direction = (Vector2){ -(relativePosition.x*leg + relativePosition.y*combinedRadius)/distanceSq, 
+                                           -(-relativePosition.x*combinedRadius + relativePosition.y*leg)/distanceSq };
+                }
+                
+                u = Vector2Subtract(Vector2Scale(direction, Vector2DotProduct(relativeVelocity, direction)), relativeVelocity);
+            }
+        }
+        else
+        {
+            // Collision: project on cutoff circle of time step
+            float invTimeStep = 1.0f/crowd->stepTime;
+            Vector2 w = Vector2Subtract(relativeVelocity, Vector2Scale(relativePosition, invTimeStep));
+            float wLength = Vector2Length(w);
+            Vector2 unitW = (wLength > 0.0f)? Vector2Scale(w, 1.0f/wLength) : (Vector2){ (index < neighbours[n])? -1.0f : 1.0f, 0.0f };
+            
+            direction = (Vector2){ unitW.y, -unitW.x };
+            u = Vector2Scale(unitW, combinedRadius*invTimeStep - wLength);
+        }
+        
+        lines[lineCount].point = Vector2Add(agent->velocity, Vector2Scale(u, 0.5f));
+        lines[lineCount].direction = direction;
+        lineCount++;
+    }
+    
+    // Preferred velocity: towards goal at max speed, slowing down on arrival
+    Vector2 preferred = Vector2Subtract(agent->goal, agent->position);
+    float goalDistance = Vector2Length(preferred);
+    
+    if (goalDistance > crowd->maxSpeed) preferred = Vector2Scale(preferred, crowd->maxSpeed/goalDistance);
+    
+    Vector2 result = { 0 };
+    int lineFail = CrowdLinearProgram2(lines, lineCount, crowd->maxSpeed, preferred, false, &result);
+    
+    if (lineFail < lineCount) CrowdLinearProgram3(lines, lineCount, wallCount, lineFail, crowd->maxSpeed, &result);
+    
+    return result;
+}
+
+// Crowd worker loop: solve its agents range on every step
+static void *CrowdWorkerMain(void *arg)
+{
+    CrowdWorker *worker = (CrowdWorker *)arg;
+    Crowd *crowd = worker->crowd;
+    unsigned int generation = 0;
+    
+    pthread_mutex_lock(&crowd->mutex);
+    
+    while (true)
+    {
+        while (crowd->running && (crowd->generation == generation)) pthread_cond_wait(&crowd->cond, &crowd->mutex);
+        
+        if (!crowd->running) break;
+        
+        generation = crowd->generation;
+        pthread_mutex_unlock(&crowd->mutex);
+        
+        SolveCrowdAgents(crowd, crowd->count*worker->index/crowd->threadCount, crowd->count*(worker->index + 1)/crowd->threadCount);
+        
+        pthread_mutex_lock(&crowd->mutex);
+        crowd->pending--;
+        if (crowd->pending == 0) pthread_cond_broadcast(&crowd->cond);
+    }
+    
+    pthread_mutex_unlock(&crowd->mutex);
+    
+    return NULL;
+}
+
+// Solve constraint line (1D): closest point to optimization velocity on line, inside speed circle and previous lines
+static bool CrowdLinearProgram1(const CrowdLine *lines, int lineNo, float radius, Vector2 optVelocity, bool directionOpt, Vector2 *result)
+{
+    CrowdLine line = lines[lineNo];
+    float dotProduct = Vector2DotProduct(line.point, line.direction);
+    float discriminant = dotProduct*dotProduct + radius*radius - Vector2DotProduct(line.point, line.point);
+    
+    if (discriminant < 0.0f) return false;      // Speed circle invalidates line
+    
+    float tLeft = -dotProduct - sqrtf(discriminant);
+    float tRight = -dotProduct + sqrtf(discriminant);
+    
+    for (int i = 0; i < lineNo; i++)
+    {
+        float denominator = line.direction.x*lines[i].direction.y - line.direction.y*lines[i].direction.x;
+        float numerator = lines[i].direction.x*(line.point.y - lines[i].point.y) - lines[i].direction.y*(line.point.x - lines[i].point.x);
+        
+        if (fabsf(denominator) <= 0.00001f)
+        {
+            // Lines are (almost) parallel
+            if (numerator < 0.0f) return false;
+            else continue;
+        }
+        
+        float t = numerator/denominator;
+        
+        if (denominator >= 0.0f) tRight = fminf(tRight, t);
+        else tLeft = fmaxf(tLeft, t);
+        
+        if (tLeft > tRight) return false;
+    }
+    
+    float t = 0.0f;
+    
+    if (directionOpt) t = (Vector2DotProduct(optVelocity, line.direction) > 0.0f)? tRight : tLeft;
+    else t = Clamp(Vector2DotProduct(line.direction, Vector2Subtract(optVelocity, line.point)), tLeft, tRight);
+    
+    *result = Vector2Add(line.point, Vector2Scale(line.direction, t));
+    
+    return true;
+}
+
+// Solve constraints (2D): closest velocity to optimization velocity (or furthest along direction) satisfying all lines
+// NOTE: Returns constraints count on success, failed line index otherwise (result satisfies previous lines)
+static int CrowdLinearProgram2(const CrowdLine *lines, int count, float radius, Vector2 optVelocity, bool directionOpt, Vector2 *result)
+{
+    if (directionOpt) *result = Vector2Scale(optVelocity, radius);
+    else if (Vector2DotProduct(optVelocity, optVelocity) > (radius*radius)) *result = Vector2Scale(optVelocity, radius/Vector2Length(optVelocity));
+    else *result = optVelocity;
+    
+    for (int i = 0; i < count; i++)
+    {
+        // Result does not satisfy constraint, new result is on constraint line
+        if ((lines[i].direction.x*(lines[i].point.y - result->y) - lines[i].direction.y*(lines[i].point.x - result->x)) > 0.0f)
+        {
+            Vector2 previous = *result;
+            
+            if (!CrowdLinearProgram1(lines, i, radius, optVelocity, directionOpt, result))
+            {
+                *result = previous;
+                return i;
+            }
+        }
+    }
+    
+    return count;
+}
+
+// Solve infeasible constraints: agents constraints are relaxed minimizing max violation, walls constraints are kept
+static void CrowdLinearProgram3(const CrowdLine *lines, int count, int wallCount, int beginLine, float radius, Vector2 *result)
+{
+    CrowdLine projected[CROWD_MAX_LINES];
+    float distance = 0.0f;
+    
+    for (int i = beginLine; i < count; i++)
+    {
+        if ((lines[i].direction.x*(lines[i].point.y - result->y) - lines[i].direction.y*(lines[i].point.x - result->x)) > distance)
+        {
+            // Result does not satisfy constraint i, projected constraints are built on line i
+            int projectedCount = wallCount;
+            
+            for (int j = 0; j < wallCount; j++) projected[j] = lines[j];
+            
+            for (int j = wallCount; j < i; j++)
+            {
+                CrowdLine line = { 0 };
+                float determinant = lines[i].direction.x*lines[j].direction.y - lines[i].direction.y*lines[j].direction.x;
+                
+                if (fabsf(determinant) <= 0.00001f)
+                {
+                    // Lines are parallel: same direction lines are skipped
+                    if (Vector2DotProduct(lines[i].direction, lines[j].direction) > 0.0f) continue;
+                    
+                    line.point = Vector2Scale(Vector2Add(lines[i].point, lines[j].point), 0.5f);
+                }
+                else 
+                {
+                    float t = (lines[j].direction.x*(lines[i].point.y - lines[j].point.y) - lines[j].direction.y*(lines[i].point.x - lines[j].point.x))/determinant;
+                    line.point = Vector2Add(lines[i].point, Vector2Scale(lines[i].direction, t));
+                }
+                
+                line.direction = Vector2Normalize(Vector2Subtract(lines[j].direction, lines[i].direction));
+                projected[projectedCount++] = line;
+            }
+            
+            Vector2 previous = *result;
+            
+            // NOTE: Should not fail, it can only happen because of floating point errors
+            if (CrowdLinearProgram2(projected, projectedCount, radius, (Vector2){ -lines[i].direction.y, lines[i].direction.x }, true, result) < projectedCount) *result = previous;
+            
+            distance = lines[i].direction.x*(lines[i].point.y - result->y) - lines[i].direction.y*(lines[i].point.x - result->x);
+        }
+    }
+}
+
+#if defined(CROWD_BENCHMARK)
+// Measure crowd step time on a dense world (tilemap repeated as rooms), with one thread and CROWD_THREADS threads
+// NOTE: Agents wander inside their rooms (random goals), so rooms stay crowded; overlaps are counted at the end
+static void BenchmarkCrowd(Tilemap room, int agents, int steps)
+{
+    int roomsX = 10;
+    int roomsY = (agents/60 + roomsX - 1)/roomsX;
+    float tileSize = 32.0f;
+    PathGrid grid = LoadPathGrid(roomsX*room.tileCountX, roomsY*room.tileCountY);
+    
+    // NOTE: Crowd only requires walkability, clusters graph is not built
+    for (int y = 0; y < grid.height; y++)
+    {
+        for (int x = 0; x < grid.width; x++) SetPathGridTile(&grid, x, y, GetWorldRoomTile(room, x, y, roomsX, roomsY).collider != 0);
+    }
+    
+    int threadCounts[2] = { 1, CROWD_THREADS };
+    
+    for (int t = 0; t < 2; t++)
+    {
+        Crowd crowd = { 0 };
+        StartCrowd(&crowd, &grid, tileSize, (Vector2){ 0, 0 }, agents, threadCounts[t]);
+        
+        srand(1);
+        
+        for (int i = 0; i < agents; i++)
+        {
+            int x, y;
+            
+            do { x = rand()%grid.width; y = rand()%grid.height; } while (!IsPathTileWalkable(&grid, x, y));
+            
+            AddCrowdAgent(&crowd, (Vector2){ (x + 0.5f)*tileSize + rand()%9 - 4, (y + 0.5f)*tileSize + rand()%9 - 4 });
+        }
+        
+        double totalTime = 0.0;
+        double maxTime = 0.0;
+        
+        for (int n = 0; n < steps; n++)
+        {
+            // New goals for agents close to their goal, random walkable tile in same room
+            for (int i = 0; i < crowd.count; i++)
+            {
+                CrowdAgent *agent = &crowd.agents[i];
+                
+                if (Vector2Length(Vector2Subtract(agent->goal, agent->position)) > tileSize) continue;
+                
+                int roomX = (int)(agent->position.x/tileSize)/room.tileCountX;
+                int roomY = (int)(agent->position.y/tileSize)/room.tileCountY;
+                int x, y;
+                
+                do 
+                { 
+                    x = roomX*room.tileCountX + rand()%room.tileCountX; 
+                    y = roomY*room.tileCountY + rand()%room.tileCountY; 
+                } while (!IsPathTileWalkable(&grid, x, y));
+                
+                agent->goal = (Vector2){ (x + 0.5f)*tileSize, (y + 0.5f)*tileSize };
+            }
+            
+            double startTime = glfwGetTime();
+            StepCrowd(&crowd, 1.0f/CROWD_SIMULATION_RATE);
+            double stepTime = glfwGetTime() - startTime;
+            
+            totalTime += stepTime;
+            if (stepTime > maxTime) maxTime = stepTime;
+        }
+        
+        // Overlaps: agents deeper than half radius into walls or into other agents
+        int wallOverlaps = 0;
+        int agentOverlaps = 0;
+        
+        UpdateCrowdCells(&crowd);
+        
+        for (int i = 0; i < crowd.count; i++)
+        {
+            CrowdAgent *agent = &crowd.agents[i];
+            float inset = crowd.radius/2;
+            
+            if (!IsPathTileWalkable(&grid, (int)floorf((agent->position.x - inset)/tileSize), (int)floorf((agent->position.y - inset)/tileSize)) ||
+                !IsPathTileWalkable(&grid, (int)floorf((agent->position.x + inset)/tileSize), (int)floorf((agent->position.y + inset)/tileSize))) wallOverlaps++;
+            
+            int cell = crowd.agentCells[i];
+            
+            for (int k = crowd.cellStart[cell]; k < crowd.cellStart[cell + 1]; k++)
+            {
+                int other = crowd.cellAgents[k];
+                
+                if ((other > i) && (Vector2Length(Vector2Subtract(crowd.agents[other].position, agent->position)) < crowd.radius)) agentOverlaps++;
+            }
+        }
+        
+        TraceLog(LOG_INFO, "CROWD: Benchmark %i agents, %i threads: %.2f ms per step (max %.2f ms, %i Hz budget %.2f ms)", 
+                 crowd.count, crowd.threadCount, totalTime*1000.0/steps, maxTime*1000.0, CROWD_SIMULATION_RATE, 1000.0/CROWD_SIMULATION_RATE);
+        TraceLog(LOG_INFO, "CROWD: Overlaps after %i steps: %i agents into walls, %i agents pairs (same cell)", steps, wallOverlaps, agentOverlaps);
+        
+        StopCrowd(&crowd);
+    }
+    
+    UnloadPathGrid(grid);
+}
+#endif
+#endif
+
+// 2D render queue: sort-key based drawing
+//----------------------------------------------------------------------------------
+// Load render queue data
+static RenderQueue LoadRenderQueue(int capacity)
+{
+    RenderQueue queue = { 0 };
+    
+    queue.capacity = capacity;
+    queue.items = (RenderItem *)malloc(capacity*sizeof(RenderItem));
+    queue.keys = (unsigned long long *)malloc(capacity*sizeof(unsigned long long));
+    queue.order = (int *)malloc(capacity*sizeof(int));
+    queue.tempKeys = (unsigned long long *)malloc(capacity*sizeof(unsigned long long));
+    queue.tempOrder = (int *)malloc(capacity*sizeof(int));
+    
+    queue.shaders[0] = GetShaderDefault();
+    queue.shaderCount = 1;
+    
+    return queue;
+}
+
+// Unload render queue data
+static void UnloadRenderQueue(RenderQueue queue)
+{
+    free(queue.items);
+    free(queue.keys);
+    free(queue.order);
+    free(queue.tempKeys);
+    free(queue.tempOrder);
+}
+
+// Begin queueing 2D drawing (textures and rectangles)
+// NOTE: Drawing functions add items to queue until EndRenderQueue()
+static void BeginRenderQueue(RenderQueue *queue)
+{
+    queue->count = 0;
+    queue->layer = 0;
+    queue->shader = 0;
+    queue->offset = (Vector2){ 0.0f, 0.0f };
+    
+    activeQueue = queue;
+}
+
+#if !defined(RENDER_THREAD)
+// Sort queued drawing and draw it in merged batches
+static int EndRenderQueue(void)
+{
+    RenderQueue *queue = activeQueue;
+    
+    if (queue == NULL) return 0;
+    
+    activeQueue = NULL;
+    
+    return DrawRenderQueue(queue);
+}
+#endif
+
+// Sort queue items and draw them in merged batches, returns batches
+// NOTE: Items are sent to rlgl in key order, rlgl starts a new draw call only when texture changes
+static int DrawRenderQueue(RenderQueue *queue)
+{
+    SortRenderQueue(queue);
+    
+    int currentShader = -1;
+    unsigned int currentTexture = 0;
+    
+    queue->batchCount = 0;
+    
+    for (int i = 0; i < queue->count; i++)
+    {
+        RenderItem *item = &queue->items[queue->order[i]];
+        int shader = (int)((queue->keys[i] >> 48) & 0xff);
+        
+        if (shader != currentShader)
+        {
+            // NOTE: Palette texture is bound to texture unit 1 (not managed by rlgl),
+            // pending batch is drawn before binding it, it could use previous palette
+            if (queue->palettes[shader] != 0)
+            {
+                rlglDraw();
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, queue->palettes[shader]);
+                glActiveTexture(GL_TEXTURE0);
+            }
+            
+            BeginShaderMode(queue->shaders[shader]);    // NOTE: Shader change forces a draw call
+            currentShader = shader;
+            currentTexture = 0;
+        }
+        
+        if (item->textureId != currentTexture)
+        {
+            currentTexture = item->textureId;
+            queue->batchCount++;
+        }
+        
+        // Quad corners: destination rectangle rotated around origin
+        Vector2 corners[4] = { { 0.0f, 0.0f }, { 0.0f, (float)item->dest.height }, 
+                               { (float)item->dest.width, (float)item->dest.height }, { (float)item->dest.width, 0.0f } };
+        
+        float sinRotation = sinf(item->rotation*DEG2RAD);
+        float cosRotation = cosf(item->rotation*DEG2RAD);
+        
+        for (int k = 0; k < 4; k++)
+        {
+            float x = corners[k].x - item->origin.x;
+            float y = corners[k].y - item->origin.y;
+            
+            corners[k].x = item->dest.x + x*cosRotation - y*sinRotation;
+            corners[k].y = item->dest.y + x*sinRotation + y*cosRotation;
+        }
+        
+        float left = (float)item->source.x/item->textureWidth;
+        float right = (float)(item->source.x + item->source.width)/item->textureWidth;
+        float top = (float)item->source.y/item->textureHeight;
+        float bottom = (float)(item->source.y + item->source.height)/item->textureHeight;
+        
+        // NOTE: rlEnableTexture() only starts a new draw when texture changes,
+        // it's called per item because rlgl resets current texture when internal buffers get full
+        rlEnableTexture(item->textureId);
+        
+        rlBegin(RL_QUADS);
+            rlColor4ub(item->tint.r, item->tint.g, item->tint.b, item->tint.a);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+            
+            rlTexCoord2f(left, top);
+            rlVertex2f(corners[0].x, corners[0].y);
+            
+            rlTexCoord2f(left, bottom);
+            rlVertex2f(corners[1].x, corners[1].y);
+            
+            rlTexCoord2f(right, bottom);
+            rlVertex2f(corners[2].x, corners[2].y);
+            
+            rlTexCoord2f(right, top);
+            rlVertex2f(corners[3].x, corners[3].y);
+        rlEnd();
+        
+        rlDisableTexture();
+    }
+    
+    if (currentShader > 0) EndShaderMode();
+    
+    return queue->batchCount;
+}
+
+// Set layer for next queued drawing
+static void SetRenderQueueLayer(int layer)
+{
+    if (activeQueue == NULL) return;
+    
+    if (layer < 0) layer = 0;
+    else if (layer > 255) layer = 255;
+    
+    activeQueue->layer = layer;
+}
+
+// Set drawing offset for next queued drawing (view scrolling)
+static void SetRenderQueueOffset(Vector2 offset)
+{
+    if (activeQueue == NULL) return;
+    
+    activeQueue->offset = offset;
+}
+
+// Set shader and palette texture (id 0 if not used) for next queued drawing
+// NOTE: Shaders are registered on first use, up to MAX_QUEUE_SHADERS per queue,
+// same shader with a different palette is registered as a different shader (palette swap)
+static void SetRenderQueueShader(Shader shader, Texture2D palette)
+{
+    if (activeQueue == NULL) return;
+    
+    int index = 0;
+    
+    while ((index < activeQueue->shaderCount) && 
+           ((activeQueue->shaders[index].id != shader.id) || (activeQueue->palettes[index] != palette.id))) index++;
+    
+    if (index == activeQueue->shaderCount)
+    {
+        if (activeQueue->shaderCount == MAX_QUEUE_SHADERS)
+        {
+            TraceLog(LOG_WARNING, "Render queue shaders limit reached, using default shader");
+            index = 0;
+        }
+        else
+        {
+            activeQueue->shaders[activeQueue->shaderCount] = shader;
+            activeQueue->palettes[activeQueue->shaderCount] = palette.id;
+            activeQueue->shaderCount++;
+        }
+    }
+    
+    activeQueue->shader = index;
+}
+
+// Add item to active render queue
+// NOTE: Queue capacity is doubled when required
+static void QueueRenderItem(RenderItem item)
+{
+    RenderQueue *queue = activeQueue;
+    
+    if (queue->count >= queue->capacity)
+    {
+        queue->capacity *= 2;
+        queue->items = (RenderItem *)realloc(queue->items, queue->capacity*sizeof(RenderItem));
+        queue->keys = (unsigned long long *)realloc(queue->keys, queue->capacity*sizeof(unsigned long long));
+        queue->order = (int *)realloc(queue->order, queue->capacity*sizeof(int));
+        queue->tempKeys = (unsigned long long *)realloc(queue->tempKeys, queue->capacity*sizeof(unsigned long long));
+        queue->tempOrder = (int *)realloc(queue->tempOrder, queue->capacity*sizeof(int));
+    }
+    
+    item.dest.x += queue->offset.x;
+    item.dest.y += queue->offset.y;
+    
+    queue->items[queue->count] = item;
+    queue->keys[queue->count] = ((unsigned long long)queue->layer << 56) | 
+                                ((unsigned long long)queue->shader << 48) | 
+                                ((unsigned long long)(item.textureId & 0xffff) << 32) | 
+                                (unsigned long long)queue->count;
+    queue->order[queue->count] = queue->count;
+    queue->count++;
+}
+
+// Sort queued items by key (LSD radix sort, 8 bits per pass)
+// NOTE: All passes histograms are computed at once, passes where all keys share the same byte are skipped
+static void SortRenderQueue(RenderQueue *queue)
+{
+    static int counts[8][256];
+    
+    memset(counts, 0, sizeof(counts));
+    
+    for (int i = 0; i < queue->count; i++)
+    {
+        for (int pass = 0; pass < 8; pass++) counts[pass][(queue->keys[i] >> (pass*8)) & 0xff]++;
+    }
+    
+    for (int pass = 0; pass < 8; pass++)
+    {
+        int shift = pass*8;
+        
+        if ((queue->count == 0) || (counts[pass][(queue->keys[0] >> shift) & 0xff] == queue->count)) continue;
+        
+        // Counts to offsets
+        int offset = 0;
+        
+        for (int b = 0; b < 256; b++)
+        {
+            int count = counts[pass][b];
+            counts[pass][b] = offset;
+            offset += count;
+        }
+        
+        for (int i = 0; i < queue->count; i++)
+        {
+            int dst = counts[pass][(queue->keys[i] >> shift) & 0xff]++;
+            
+            queue->tempKeys[dst] = queue->keys[i];
+            queue->tempOrder[dst] = queue->order[i];
+        }
+        
+        // Swap buffers, sorted data becomes current data
+        unsigned long long *keys = queue->keys;
+        queue->keys = queue->tempKeys;
+        queue->tempKeys = keys;
+        
+        int *order = queue->order;
+        queue->order = queue->tempOrder;
+        queue->tempOrder = order;
+    }
+}
+
+#if defined(RENDER_THREAD)
+// Render thread: frames drawn on a dedicated thread (double-buffered render queues)
+//----------------------------------------------------------------------------------
+// Load frames queues and start render thread, OpenGL context is moved to it
+// NOTE: Resources (textures, shaders) must be loaded before, only render thread can use OpenGL;
+// if thread can not be created, context is kept on calling thread and frames are drawn on submission
+static bool StartRenderThread(RenderThread *renderThread)
+{
+    pthread_mutex_init(&renderThread->mutex, NULL);
+    pthread_cond_init(&renderThread->cond, NULL);
+    
+    renderThread->queues[0] = LoadRenderQueue(RENDER_QUEUE_CAPACITY);
+    renderThread->queues[1] = LoadRenderQueue(RENDER_QUEUE_CAPACITY);
+    renderThread->writeIndex = 0;
+    renderThread->pending = NULL;
+    renderThread->drawing = NULL;
+    renderThread->running = true;
+    renderThread->memoryInfo = glfwExtensionSupported("GL_NVX_gpu_memory_info");
+    
+    glfwMakeContextCurrent(NULL);       // Context can only be current on one thread
+    
+    if (pthread_create(&renderThread->thread, NULL, RenderThreadMain, renderThread) != 0)
+    {
+        TraceLog(LOG_WARNING, "Render thread could not be created, frames drawn on game thread");
+        
+        renderThread->running = false;
+        glfwMakeContextCurrent(window);
+        
+        return false;
+    }
+    
+    TraceLog(LOG_INFO, "Render thread started");
+    
+    return true;
+}
+
+// Stop render thread once last frame is drawn, OpenGL context is moved back
+static void StopRenderThread(RenderThread *renderThread)
+{
+    if (renderThread->running)
+    {
+        pthread_mutex_lock(&renderThread->mutex);
+        renderThread->running = false;
+        pthread_cond_broadcast(&renderThread->cond);
+        pthread_mutex_unlock(&renderThread->mutex);
+        
+        pthread_join(renderThread->thread, NULL);
+        
+        glfwMakeContextCurrent(window);
+    }
+    
+    UnloadRenderQueue(renderThread->queues[0]);
+    UnloadRenderQueue(renderThread->queues[1]);
+    
+    pthread_cond_destroy(&renderThread->cond);
+    pthread_mutex_destroy(&renderThread->mutex);
+}
+
+// Begin queueing frame drawing, waits until next queue has been drawn
+// NOTE: Wait only happens if render thread is more than one frame behind game thread
+static void BeginRenderFrame(RenderThread *renderThread)
+{
+    RenderQueue *queue = &renderThread->queues[renderThread->writeIndex];
+    
+    pthread_mutex_lock(&renderThread->mutex);
+    while ((renderThread->pending == queue) || (renderThread->drawing == queue)) pthread_cond_wait(&renderThread->cond, &renderThread->mutex);
+    pthread_mutex_unlock(&renderThread->mutex);
+    
+    BeginRenderQueue(queue);
+}
+
+// End queueing frame drawing and hand queue to render thread, returns last frame drawn batches
+// NOTE: Batches, debug messages and VRAM counters are read under lock, render thread updates them after
+// every frame; frame stats are only written by game thread
+static int SubmitRenderFrame(RenderThread *renderThread)
+{
+    RenderQueue *queue = activeQueue;
+    int batchCount = 0;
+    
+    if (queue == NULL) return 0;
+    
+    activeQueue = NULL;
+    
+    pthread_mutex_lock(&renderThread->mutex);
+    
+    if (renderThread->running)
+    {
+        // Previous frame must have been taken by render thread, frames are never dropped
+        while (renderThread->pending != NULL) pthread_cond_wait(&renderThread->cond, &renderThread->mutex);
+        
+        renderThread->pending = queue;
+        renderThread->quality = quality;
+        batchCount = renderThread->batchCount;
+        pthread_cond_broadcast(&renderThread->cond);
+        
+        renderThread->writeIndex = 1 - renderThread->writeIndex;
+    }
+    else
+    {
+        batchCount = DrawRenderFrame(queue, quality);   // No render thread, frame drawn here
+        UpdateRenderCounters(renderThread);
+    }
+    
+    int perfMessages = renderThread->perfMessages;
+    int errorMessages = renderThread->errorMessages;
+    renderThread->perfMessages = 0;
+    renderThread->errorMessages = 0;
+    
+    frameStats.vramUsage = renderThread->vramUsage;
+    frameStats.vramAvailable = renderThread->vramAvailable;
+    
+    pthread_mutex_unlock(&renderThread->mutex);
+    
+    frameStats.perfMessageCount += perfMessages;
+    frameStats.errorMessageCount += errorMessages;
+    if (perfMessages > frameStats.perfMessagePeak) frameStats.perfMessagePeak = perfMessages;
+    
+    return batchCount;
+}
+
+// Draw frame queue into scene target and swap buffers, returns batches
+static int DrawRenderFrame(RenderQueue *queue, QualitySettings settings)
+{
+    UpdateSceneTarget(&sceneTarget, settings);  // Scene target is reloaded if quality settings changed
+    BeginSceneTarget(sceneTarget);
+    
+    BeginDebugGroup("Clear");
+    rlClearScreenBuffers();             // Clear current framebuffer
+    EndDebugGroup();
+    
+    int batchCount = DrawRenderQueue(queue);    // Sort queued drawing and send it to rlgl in merged batches
+    
+    BeginDebugGroup("Draw 2D batch");
+    rlglDraw();                         // Internal buffers drawing (2D data)
+    EndDebugGroup();
+    
+    BeginDebugGroup("Resolve scene");
+    EndSceneTarget(sceneTarget);
+    EndDebugGroup();
+    
+    glfwSwapBuffers(window);            // Swap buffers: show back buffer into front
+    
+    return batchCount;
+}
+
+// Render thread loop: draw submitted queues and swap buffers
+// NOTE: Queues submitted before stop request are drawn before thread exits
+static void *RenderThreadMain(void *arg)
+{
+    RenderThread *renderThread = (RenderThread *)arg;
+    
+    glfwMakeContextCurrent(window);
+    
+    pthread_mutex_lock(&renderThread->mutex);
+    
+    while (true)
+    {
+        while (renderThread->running && (renderThread->pending == NULL)) pthread_cond_wait(&renderThread->cond, &renderThread->mutex);
+        
+        if (renderThread->pending == NULL) break;       // Stop requested and no frames left
+        
+        RenderQueue *queue = renderThread->pending;
+        QualitySettings settings = renderThread->quality;
+        renderThread->drawing = queue;
+        renderThread->pending = NULL;
+        pthread_cond_broadcast(&renderThread->cond);
+        pthread_mutex_unlock(&renderThread->mutex);
+        
+        int batchCount = DrawRenderFrame(queue, settings);
+        
+        pthread_mutex_lock(&renderThread->mutex);
+        renderThread->drawing = NULL;
+        renderThread->batchCount = batchCount;
+        UpdateRenderCounters(renderThread);
+        pthread_cond_broadcast(&renderThread->cond);
+    }
+    
+    pthread_mutex_unlock(&renderThread->mutex);
+    
+    glfwMakeContextCurrent(NULL);
+    
+    return NULL;
+}
+
+// Register drawn frame debug messages and VRAM counters (OpenGL context thread)
+// NOTE: Debug messages are received on thread issuing OpenGL calls (synchronous debug output),
+// VRAM usage changes on scene target reloads (render thread)
+static void UpdateRenderCounters(RenderThread *renderThread)
+{
+    renderThread->perfMessages += debugPerfMessages;
+    renderThread->errorMessages += debugErrorMessages;
+    renderThread->vramUsage = vramUsage;
+    
+    debugPerfMessages = 0;
+    debugErrorMessages = 0;
+    
+    // NOTE: Driver reported VRAM also tracks memory not allocated by us (rlgl buffers, driver internals)
+    if (renderThread->memoryInfo)
+    {
+        int availableKB = 0;
+        glGetIntegerv(0x9049, &availableKB);    // GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+        renderThread->vramAvailable = (long)availableKB*1024;
+    }
+}
+#endif
+
+// Quality settings: presets, config file and hardware probe
+//----------------------------------------------------------------------------------
+// Get quality preset settings for a window size
+static QualitySettings GetQualityPreset(int preset, int screenWidth, int screenHeight)
+{
+    // Presets: resolution scale, MSAA samples
+    // NOTE: 2D scene costs are fill rate ones, resolution is only reduced on lowest preset
+    static const QualitySettings presets[4] = {
+        { 0, 0, QUALITY_LOW, 0.5f, 0, true },
+        { 0, 0, QUALITY_MEDIUM, 1.0f, 0, true },
+        { 0, 0, QUALITY_HIGH, 1.0f, 4, true },
+        { 0, 0, QUALITY_ULTRA, 1.0f, 8, true }
+    };
+    
+    if (preset < QUALITY_LOW) preset = QUALITY_LOW;
+    else if (preset > QUALITY_ULTRA) preset = QUALITY_ULTRA;
+    
+    QualitySettings settings = presets[preset];
+    settings.screenWidth = screenWidth;
+    settings.screenHeight = screenHeight;
+    
+    return settings;
+}
+
+#if !defined(SOAK_TEST)
+// Load quality settings from config file, returns false if not available
+// NOTE: Config file lines are "key = value" (lines starting with '#' are comments), preset is read first
+// and settings found override preset values; window size not found is kept from provided settings
+static bool LoadQualitySettings(const char *fileName, QualitySettings *settings)
+{
+    FILE *configFile = fopen(fileName, "rt");
+    
+    if (configFile == NULL) return false;
+    
+    char line[256] = { 0 };
+    char key[64] = { 0 };
+    float value = 0.0f;
+    int preset = -1;
+    
+    while (fgets(line, 256, configFile) != NULL)
+    {
+        if ((sscanf(line, " %63[a-z_] = %f", key, &value) == 2) && (strcmp(key, "preset") == 0)) preset = (int)value;
+    }
+    
+    if (preset < 0)
+    {
+        TraceLog(LOG_WARNING, "[%s] Quality settings preset not found", fileName);
+        fclose(configFile);
+        return false;
+    }
+    
+    QualitySettings loaded = GetQualityPreset(preset, settings->screenWidth, settings->screenHeight);
+    
+    rewind(configFile);
+    
+    while (fgets(line, 256, configFile) != NULL)
+    {
+        if (sscanf(line, " %63[a-z_] = %f", key, &value) != 2) continue;
+        
+        if ((strcmp(key, "screen_width") == 0) && (value > 0.0f)) loaded.screenWidth = (int)value;
+        else if ((strcmp(key, "screen_height") == 0) && (value > 0.0f)) loaded.screenHeight = (int)value;
+        else if (strcmp(key, "resolution_scale") == 0) loaded.resolutionScale = Clamp(value, 0.25f, 2.0f);
+        else if (strcmp(key, "msaa_samples") == 0) loaded.msaaSamples = (int)value;
+        else if (strcmp(key, "vsync") == 0) loaded.vsync = (value != 0.0f);
+    }
+    
+    fclose(configFile);
+    
+    *settings = loaded;
+    
+    TraceLog(LOG_INFO, "[%s] Quality settings loaded successfully (preset %i)", fileName, loaded.preset);
+    
+    return true;
+}
+#endif
+
+// Save quality settings to config file
+static void SaveQualitySettings(const char *fileName, QualitySettings settings)
+{
+    FILE *configFile = fopen(fileName, "wt");
+    
+    if (configFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Quality settings could not be saved", fileName);
+        return;
+    }
+    
+    fprintf(configFile, "# Quality settings, delete this file to run hardware probe again on next launch\n");
+    fprintf(configFile, "# preset: 0 - low, 1 - medium, 2 - high, 3 - ultra (settings below override preset values)\n");
+    fprintf(configFile, "preset = %i\n", settings.preset);
+    fprintf(configFile, "screen_width = %i\n", settings.screenWidth);
+    fprintf(configFile, "screen_height = %i\n", settings.screenHeight);
+    fprintf(configFile, "resolution_scale = %.2f\n", settings.resolutionScale);
+    fprintf(configFile, "msaa_samples = %i\n", settings.msaaSamples);
+    fprintf(configFile, "vsync = %i\n", settings.vsync? 1 : 0);
+    
+    fclose(configFile);
+    
+    TraceLog(LOG_INFO, "[%s] Quality settings saved successfully (preset %i)", fileName, settings.preset);
+}
+
+// Set quality settings, applied on next frame drawing
+// NOTE: Scene target and vsync are updated by the thread owning OpenGL context (render thread if enabled)
+static void SetQualitySettings(QualitySettings settings)
+{
+    quality = settings;
+    
+    TraceLog(LOG_INFO, "QUALITY: Preset %i set (scale %.2f, MSAA %ix, vsync %s)", settings.preset, 
+             settings.resolutionScale, settings.msaaSamples, settings.vsync? "on" : "off");
+}
+
+// Reload scene render target and set vsync if settings changed
+// NOTE: Multisampled scene is resolved on a same size framebuffer before upscaling (blits can't do both),
+// not scaled and not multisampled scene requires no render target
+static void UpdateSceneTarget(SceneTarget *target, QualitySettings settings)
+{
+    if (target->loaded && (target->settings.screenWidth == settings.screenWidth) && (target->settings.screenHeight == settings.screenHeight) &&
+        (target->settings.resolutionScale == settings.resolutionScale) && (target->settings.msaaSamples == settings.msaaSamples) && 
+        (target->settings.vsync == settings.vsync)) return;
+    
+    UnloadSceneTarget(target);
+    
+    glfwSwapInterval(settings.vsync? 1 : 0);
+    
+    target->settings = settings;
+    target->loaded = true;
+    target->width = (int)(settings.screenWidth*settings.resolutionScale);
+    target->height = (int)(settings.screenHeight*settings.resolutionScale);
+    target->samples = (settings.msaaSamples < maxSamples)? settings.msaaSamples : maxSamples;
+    
+    if (target->width < 1) target->width = 1;
+    if (target->height < 1) target->height = 1;
+    if (target->samples < 0) target->samples = 0;
+    
+    bool scaled = (target->width != settings.screenWidth) || (target->height != settings.screenHeight);
+    
+    if (!scaled && (target->samples == 0)) return;
+    
+    glGenFramebuffers(1, &target->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+    
+    glGenRenderbuffers(1, &target->colorRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->colorRbo);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target->samples, GL_RGBA8, target->width, target->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target->colorRbo);
+    
+    glGenRenderbuffers(1, &target->depthRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->depthRbo);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target->samples, GL_DEPTH_COMPONENT24, target->width, target->height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depthRbo);
+    
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    
+    if (complete && scaled && (target->samples > 0))
+    {
+        glGenFramebuffers(1, &target->resolveFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, target->resolveFbo);
+        
+        glGenRenderbuffers(1, &target->resolveRbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, target->resolveRbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, target->width, target->height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target->resolveRbo);
+        
+        complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    }
+    
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    // NOTE: VRAM usage is registered as 4 bytes per sample (color and depth)
+    vramUsage += target->width*target->height*8*((target->samples > 0)? target->samples : 1);
+    if (target->resolveFbo != 0) vramUsage += target->width*target->height*4;
+    
+    if (!complete)
+    {
+        TraceLog(LOG_WARNING, "Scene render target could not be created (%ix%i, MSAA %ix), scene drawn to window", target->width, target->height, target->samples);
+        
+        UnloadSceneTarget(target);
+        
+        target->settings = settings;
+        target->loaded = true;
+        target->width = settings.screenWidth;
+        target->height = settings.screenHeight;
+    }
+    else TraceLog(LOG_INFO, "Scene render target created successfully (%ix%i, MSAA %ix)", target->width, target->height, target->samples);
+}
+
+// Unload scene render target (VRAM)
+static void UnloadSceneTarget(SceneTarget *target)
+{
+    if (target->fbo != 0)
+    {
+        glDeleteFramebuffers(1, &target->fbo);
+        glDeleteRenderbuffers(1, &target->colorRbo);
+        glDeleteRenderbuffers(1, &target->depthRbo);
+        
+        vramUsage -= target->width*target->height*8*((target->samples > 0)? target->samples : 1);
+        
+        if (target->resolveFbo != 0)
+        {
+            glDeleteFramebuffers(1, &target->resolveFbo);
+            glDeleteRenderbuffers(1, &target->resolveRbo);
+            
+            vramUsage -= target->width*target->height*4;
+        }
+    }
+    
+    *target = (SceneTarget){ 0 };
+}
+
+// Begin drawing scene into render target
+// NOTE: Projection is not changed, scene is drawn in window coordinates scaled by viewport
+static void BeginSceneTarget(SceneTarget target)
+{
+    if (target.fbo == 0) return;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, target.width, target.height);
+}
+
+// End drawing scene, resolve and upscale it to window
+// NOTE: Upscaling uses nearest filtering (sharp pixels), window framebuffer is fully covered (not cleared)
+static void EndSceneTarget(SceneTarget target)
+{
+    if (target.fbo == 0) return;
+    
+    unsigned int source = target.fbo;
+    
+    if (target.resolveFbo != 0)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target.fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.resolveFbo);
+        glBlitFramebuffer(0, 0, target.width, target.height, 0, 0, target.width, target.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        
+        source = target.resolveFbo;
+    }
+    
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target.width, target.height, 0, 0, target.settings.screenWidth, target.settings.screenHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, target.settings.screenWidth, target.settings.screenHeight);
+}
+
+// Start hardware probe, most expensive preset first
+static void StartQualityProbe(QualityProbe *probe)
+{
+    *probe = (QualityProbe){ 0 };
+    
+    probe->active = true;
+    probe->preset = QUALITY_ULTRA;
+    probe->warmupFrames = QUALITY_PROBE_WARMUP_FRAMES;
+    
+    TraceLog(LOG_INFO, "QUALITY: Hardware probe started, frame time target: %.1f ms", QUALITY_PROBE_FRAME_TIME);
+}
+
+// Register probe frame time (ms), returns true if probed preset changed
+// NOTE: Every preset is drawn for its share of probe time (less if clearly slower than target), preset is
+// selected if frame times median meets target; lowest preset is selected if none of them does
+static bool UpdateQualityProbe(QualityProbe *probe, float frameTime)
+{
+    if (!probe->active) return false;
+    
+    if (probe->warmupFrames > 0)
+    {
+        probe->warmupFrames--;
+        return false;
+    }
+    
+    if (probe->frameCount < QUALITY_PROBE_MAX_FRAMES) probe->times[probe->frameCount++] = frameTime;
+    probe->totalTime += frameTime;
+    
+    // NOTE: Frame times order is not required, times are sorted in-place
+    float median = GetFrameTimePercentile(probe->times, probe->frameCount, 0.5f);
+    bool slow = (probe->frameCount >= 2) && (median > 2.0f*QUALITY_PROBE_FRAME_TIME);
+    
+    if ((probe->totalTime < QUALITY_PROBE_TIME/(QUALITY_ULTRA + 1)) && !slow) return false;
+    
+    TraceLog(LOG_INFO, "QUALITY: Preset %i probed, frame time median: %.2f ms (%i frames)", probe->preset, median, probe->frameCount);
+    
+    if ((median <= QUALITY_PROBE_FRAME_TIME) || (probe->preset == QUALITY_LOW))
+    {
+        probe->active = false;
+        
+        TraceLog(LOG_INFO, "QUALITY: Hardware probe finished, preset %i selected", probe->preset);
+        
+        return false;
+    }
+    
+    probe->preset--;
+    probe->warmupFrames = QUALITY_PROBE_WARMUP_FRAMES;
+    probe->frameCount = 0;
+    probe->totalTime = 0.0f;
+    
+    return true;
+}
+
+// Frame stats: frame times, memory usage and VRAM counters
+//----------------------------------------------------------------------------------
+// Register frame time (ms), reduce stats at sample end
+static void UpdateFrameStats(float frameTime)
+{
+    if (frameStats.frameCount < FRAME_STATS_CAPACITY) frameStats.frameTimes[frameStats.frameCount++] = frameTime;
+    
+#if !defined(RENDER_THREAD)
+    // Register driver debug messages received along the frame
+    // NOTE: With render thread, debug messages and VRAM counters are registered on frames submission
+    frameStats.perfMessageCount += debugPerfMessages;
+    frameStats.errorMessageCount += debugErrorMessages;
+    if (debugPerfMessages > frameStats.perfMessagePeak) frameStats.perfMessagePeak = debugPerfMessages;
+    
+    debugPerfMessages = 0;
+    debugErrorMessages = 0;
+#endif
+    
+    double time = glfwGetTime();
+    
+    if ((time - frameStats.sampleStartTime) >= FRAME_STATS_SAMPLE_TIME)
+    {
+        frameStats.p50 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.50f);
+        frameStats.p95 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.95f);
+        frameStats.p99 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.99f);
+        frameStats.maxTime = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 1.0f);
+        
+        frameStats.memoryUsage = GetMemoryUsage();
+#if !defined(RENDER_THREAD)
+        frameStats.vramUsage = vramUsage;
+        
+        // NOTE: Driver reported VRAM also tracks memory not allocated by us (rlgl buffers, driver internals)
+        if (glfwExtensionSupported("GL_NVX_gpu_memory_info"))
+        {
+            int availableKB = 0;
+            glGetIntegerv(0x9049, &availableKB);    // GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+            frameStats.vramAvailable = (long)availableKB*1024;
+        }
+#endif
+        
+        frameStats.perfMessages = frameStats.perfMessageCount;
+        frameStats.perfMessagesPeak = frameStats.perfMessagePeak;
+        frameStats.errorMessages = frameStats.errorMessageCount;
+        
+        frameStats.sampleCount++;
+        
+#if defined(SOAK_TEST)
+        CheckSoakRegressions();
+#endif
+        frameStats.frameCount = 0;
+        frameStats.perfMessageCount = 0;
+        frameStats.perfMessagePeak = 0;
+        frameStats.errorMessageCount = 0;
+        frameStats.sampleStartTime = time;
+    }
+}
+
+// Compare function for frame times sorting
+static int CompareFrameTimes(const void *a, const void *b)
+{
+    float ta = *(const float *)a;
+    float tb = *(const float *)b;
+    
+    return (ta > tb) - (ta < tb);
+}
+
+// Get frame times percentile
+// NOTE: Provided times array is sorted in-place
+static float GetFrameTimePercentile(float *times, int count, float percentile)
+{
+    if (count == 0) return 0.0f;
+    
+    qsort(times, count, sizeof(float), CompareFrameTimes);
+    
+    int index = (int)(percentile*(count - 1) + 0.5f);
+    
+    return times[index];
+}
+
+// Get process memory usage, resident set size (bytes)
+// NOTE: Only supported on Linux (/proc filesystem), it returns 0 on other platforms
+static long GetMemoryUsage(void)
+{
+    long memoryUsage = 0;
+    
+    FILE *statusFile = fopen("/proc/self/status", "rt");
+    
+    if (statusFile != NULL)
+    {
+        char line[128] = { 0 };
+        
+        while (fgets(line, 128, statusFile) != NULL)
+        {
+            if (strncmp(line, "VmRSS:", 6) == 0) 
+            {
+                memoryUsage = atol(line + 6)*1024;  // Value is provided in KB
+                break;
+            }
+        }
+        
+        fclose(statusFile);
+    }
+    
+    return memoryUsage;
+}
+
+// Debug output: driver debug messages and debug groups
+//----------------------------------------------------------------------------------
+// Install driver debug messages callback
+// NOTE: Debug output requires a debug context, it uses KHR_debug (core on OpenGL 4.3)
+// if available or ARB_debug_output (messages only, no debug groups) as fallback
+static void InitDebugOutput(void)
+{
+    int contextFlags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+    
+    if (!(contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT))
+    {
+        TraceLog(LOG_INFO, "GL: Debug output not available (no debug context)");
+        return;
+    }
+    
+    int versionMajor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR);
+    int versionMinor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MINOR);
+    
+    PFNDEBUGMESSAGECALLBACKPROC debugMessageCallback = NULL;
+    
+    if ((versionMajor > 4) || ((versionMajor == 4) && (versionMinor >= 3)) || glfwExtensionSupported("GL_KHR_debug"))
+    {
+        debugMessageCallback = (PFNDEBUGMESSAGECALLBACKPROC)glfwGetProcAddress("glDebugMessageCallback");
+        pushDebugGroup = (PFNPUSHDEBUGGROUPPROC)glfwGetProcAddress("glPushDebugGroup");
+        popDebugGroup = (PFNPOPDEBUGGROUPPROC)glfwGetProcAddress("glPopDebugGroup");
+        
+        if ((pushDebugGroup == NULL) || (popDebugGroup == NULL)) pushDebugGroup = NULL, popDebugGroup = NULL;
+        
+        glEnable(GL_DEBUG_OUTPUT);
+    }
+    
+    if ((debugMessageCallback == NULL) && GLAD_GL_ARB_debug_output) debugMessageCallback = glDebugMessageCallbackARB;
+    
+    if (debugMessageCallback != NULL)
+    {
+        // NOTE: Synchronous output makes messages to be received on the frame (and thread) generating them
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB);
+        debugMessageCallback(DebugMessageCallback, NULL);
+        
+        TraceLog(LOG_INFO, "GL: Debug output enabled (%s)", (pushDebugGroup != NULL)? "KHR_debug" : "ARB_debug_output");
+    }
+    else TraceLog(LOG_WARNING, "GL: Debug output not supported");
+}
+
+// Driver debug messages callback
+// NOTE: All messages are counted (performance and errors are registered on frame stats)
+// but only first MAX_DEBUG_MESSAGES_LOGGED messages are logged
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
+{
+    if ((type == GL_DEBUG_TYPE_PUSH_GROUP) || (type == GL_DEBUG_TYPE_POP_GROUP)) return;
+    
+    if (type == GL_DEBUG_TYPE_PERFORMANCE_ARB) debugPerfMessages++;
+    else if (type == GL_DEBUG_TYPE_ERROR_ARB) debugErrorMessages++;
+    
+    if (debugMessagesLogged < MAX_DEBUG_MESSAGES_LOGGED)
+    {
+        // NOTE: LOG_ERROR is not used, it exits the program
+        TraceLog((type == GL_DEBUG_TYPE_ERROR_ARB)? LOG_WARNING : LOG_DEBUG, "GL: [%s %i] %s", 
+                 (type == GL_DEBUG_TYPE_PERFORMANCE_ARB)? "PERFORMANCE" : (type == GL_DEBUG_TYPE_ERROR_ARB)? "ERROR" : "OTHER", id, message);
+        
+        debugMessagesLogged++;
+        
+        if (debugMessagesLogged == MAX_DEBUG_MESSAGES_LOGGED) TraceLog(LOG_DEBUG, "GL: Debug messages log limit reached, next messages are only counted");
+    }
+}
+
+// Begin debug group, visible on graphics debuggers
+// NOTE: Without KHR_debug support, only an event marker is inserted
+static void BeginDebugGroup(const char *name)
+{
+    if (pushDebugGroup != NULL) pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+    else rlSetDebugMarker(name);        // Fallback to event marker (EXT_debug_marker), if supported
+}
+
+// End debug group
+static void EndDebugGroup(void)
+{
+    if (popDebugGroup != NULL) popDebugGroup();
+}
+
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+//----------------------------------------------------------------------------------
+// Update random-walk bot keys, new direction if blocked
+static void UpdateBot(bool blocked)
+{
+    static const int botKeys[4] = { GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT };
+    static int botDirection = 0;
+    static int framesCounter = 0;
+    static int framesTarget = 0;
+    
+    framesCounter++;
+    
+    // Choose a new random direction when blocked by a wall or after some random time walking
+    if (blocked || (framesCounter >= framesTarget))
+    {
+        botKeyState[botKeys[botDirection]] = 0;
+        botDirection = rand()%4;
+        botKeyState[botKeys[botDirection]] = 1;
+        
+        framesCounter = 0;
+        framesTarget = 30 + rand()%90;
+    }
+    
+    if (glfwGetTime() > SOAK_TEST_DURATION) glfwSetWindowShouldClose(window, GL_TRUE);
+}
+
+// Record last stats sample and check it against baseline
+// NOTE: Memory growth and frame time drift over the baseline are flagged as regressions
+static void CheckSoakRegressions(void)
+{
+    if (soakFile != NULL)
+    {
+        fprintf(soakFile, "%.0f,%li,%li,%li,%.3f,%.3f,%.3f,%.3f,%i,%i,%i\n", glfwGetTime(), frameStats.memoryUsage, frameStats.vramUsage, 
+                frameStats.vramAvailable, frameStats.p50, frameStats.p95, frameStats.p99, frameStats.maxTime, 
+                frameStats.perfMessages, frameStats.perfMessagesPeak, frameStats.errorMessages);
+        fflush(soakFile);
+    }
+    
+    TraceLog(LOG_INFO, "SOAK: [%i] memory: %li KB, vram: %li KB, frame time p50: %.2f ms, p95: %.2f ms, p99: %.2f ms", 
+             frameStats.sampleCount, frameStats.memoryUsage/1024, frameStats.vramUsage/1024, frameStats.p50, frameStats.p95, frameStats.p99);
+    
+    if (frameStats.sampleCount == SOAK_WARMUP_SAMPLES) soakBaseline = frameStats;
+    else if (frameStats.sampleCount > SOAK_WARMUP_SAMPLES)
+    {
+        if ((frameStats.memoryUsage - soakBaseline.memoryUsage) > SOAK_MEMORY_GROWTH)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Memory usage regression: %li KB over baseline", (frameStats.memoryUsage - soakBaseline.memoryUsage)/1024);
+            soakRegressions++;
+        }
+        
+        if (frameStats.vramUsage > soakBaseline.vramUsage)
+        {
+            TraceLog(LOG_WARNING, "SOAK: VRAM usage regression: %li KB over baseline", (frameStats.vramUsage - soakBaseline.vramUsage)/1024);
+            soakRegressions++;
+        }
+        
+        if (frameStats.p99 > soakBaseline.p99*SOAK_FRAMETIME_DRIFT)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Frame time regression: p99 %.2f ms (baseline %.2f ms)", frameStats.p99, soakBaseline.p99);
+            soakRegressions++;
+        }
+        
+        if (frameStats.errorMessages > 0)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Driver reported %i errors", frameStats.errorMessages);
+            soakRegressions++;
+        }
+    }
+}
+#endif
@@ -16,6 +16,38 @@
 *       gcc -o $(NAME_PART).exe $(FILE_NAME) -Iexternal -Iexternal/glfw/include \
 *           rglfw.o -lopengl32 -lgdi32 -Wall -std=c99
 *
+*   NOTE: Images are decoded in parallel on worker threads (pthreads), link with -lpthread.
+*       PNG images (8bit, non-interlaced) are decoded by a built-in fast path: inflate with 64bit
+*       bit-buffer refills and two-level Huffman tables, SSE2 scanlines unfiltering; other formats
+*       and PNG variants are decoded with stb_image.
+*       Compile with -DIMAGE_DECODE_BENCHMARK to measure image decoding throughput (MB/s)
+*       with stb_image only, sequentially and in parallel, results are logged and program exits.
+*
+*   NOTE: Compile with -DSOAK_TEST to run a long soak test: a random-walk bot plays the game
+*       in a hidden window (use a virtual display like Xvfb on headless machines) while frame times,
+*       memory usage and VRAM counters are recorded into soak_stats.csv, regressions are flagged
+*       and reported in the exit code.
+*
+*   NOTE: Compile with -DCULLING_BENCHMARK to measure instances frustum culling time (100k bounding
+*       spheres, AVX batches of 8 when compiled with -mavx), results are logged and program exits.
+*
+*   NOTE: Compile with -DCLUSTER_BENCHMARK to measure mesh clusters culling on a dense sphere (64k triangles,
+*       tower model is below clustering threshold), frustum and normal cone culled clusters are counted from
+*       several view positions, results are logged and program exits.
+*
+*   NOTE: Compile with -DRENDER_THREAD to draw on a dedicated render thread: game thread builds a scene
+*       frame per frame (camera matrices, frustum and props culling results, quality settings) and hands it
+*       to render thread, that owns OpenGL context, draws the scene, streams textures and swaps buffers
+*       while game thread updates next frame; one frame can be queued while another one is drawn.
+*
+*   NOTE: Compile with -DVOXEL_MAZE to build the maze as a 3D voxel grid from a stack of layer images
+*       (one image per grid level, bottom to top), meshed by 16x16x16 chunks; collisions are 3D.
+*
+*   NOTE: Quality settings (window size, scene resolution scale, MSAA, textures filter, anisotropy and mipmap
+*       bias, draw distance, vsync) are loaded from maze_settings.cfg; on first launch (no config file) a hardware
+*       probe draws the scene for up to one second with every preset, most expensive first, and the first one
+*       meeting the frame time target is selected and saved. Delete the config file to probe again.
+*
 *   Copyright (c) 2017-2018 Ramon Santamaria (@raysan5)
 *
 ********************************************************************************************/
@@ -34,6 +66,18 @@
 #include "stb_image.h"          // Multiple image fileformats loading functions
 
 #include <stdarg.h>             // Required for TraceLog()
+#include <pthread.h>            // Required for: pthread_create(), pthread_join() [Used on images parallel loading]
+#include <float.h>              // Required for: FLT_MAX [Used on scene ray casts]
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>      // SSE2 intrinsics, used on pixel format converters
+#endif
+#if defined(__SSSE3__)
+    #include <tmmintrin.h>      // SSSE3 intrinsics (bytes shuffle), used on R8G8B8 converter
+#endif
+#if defined(__AVX__)
+    #include <immintrin.h>      // AVX/AVX2 intrinsics, used on instances culling and 16bit pixel format converters
+#endif
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -101,6 +145,21 @@ typedef struct Texture2D {
     int format;             // Data format (TextureFormat)
 } Texture2D;
 
+// Streamed texture, mipmap levels are uploaded progressively (mip tail first)
+// NOTE: Levels data is kept in RAM (R8G8B8A8) until uploaded, then freed; levels are generated on
+// a loader thread while a placeholder mip tail is resident
+#define MAX_STREAM_MIP_LEVELS   16          // Max mipmap levels per streamed texture
+
+typedef struct StreamTexture {
+    Texture2D texture;                      // Texture (storage for all levels allocated on load)
+    unsigned char *levels[MAX_STREAM_MIP_LEVELS];   // Mipmap levels data not uploaded yet (NULL if uploaded)
+    int residentLevel;                      // Highest detail level uploaded (0 when fully resident)
+    float minLod;                           // Current GL_TEXTURE_MIN_LOD, fades new resident levels in
+    float priority;                         // Streaming priority, from on-screen usage and distance to camera
+    bool loading;                           // Levels being generated on a loader thread (placeholder mip tail resident)
+    bool loaded;                            // Levels generated by loader thread (accessed under loader mutex)
+} StreamTexture;
+
 // LESSON 03: Shader type (default shader)
 typedef struct Shader {
     unsigned int id;        // Shader program id
@@ -111,23 +170,192 @@ typedef struct Shader {
     int normalLoc;          // Normal attribute location point    (default-location = 2)
     
     // Uniform locations
-    int mvpLoc;             // ModelView-Projection matrix uniform location point (vertex shader)
+    int modelLoc;           // Model matrix uniform location point (vertex shader)
     int colorLoc;           // Diffuse color uniform location point (fragment shader)
     int mapTextureLoc;      // Map texture uniform location point (default-texture-unit = 0)
 
 } Shader;
 
+// Bounding box type
+typedef struct BoundingBox {
+    Vector3 min;            // Minimum vertex box-corner
+    Vector3 max;            // Maximum vertex box-corner
+} BoundingBox;
+
+// Ray type, used on scene ray casts (picking)
+typedef struct Ray {
+    Vector3 position;       // Ray origin
+    Vector3 direction;      // Ray direction (normalized)
+} Ray;
+
+// Mesh chunk type
+// NOTE: Chunk vertices are stored contiguously in mesh buffers, every chunk can be drawn independently
+typedef struct MeshChunk {
+    int firstVertex;        // First chunk vertex in mesh buffers (first index if mesh is indexed)
+    int vertexCount;        // Number of vertices in chunk (indices if mesh is indexed)
+    BoundingBox bounds;     // Chunk bounding box (model space)
+} MeshChunk;
+
+// Mesh cluster type (meshlet), small group of neighbour triangles culled independently
+// NOTE: Cluster is back-facing for any view position where dot(center - view, coneAxis) >= coneCutoff*distance + radius
+typedef struct MeshCluster {
+    int firstIndex;         // First cluster index in mesh indices
+    int triangleCount;      // Number of triangles in cluster
+    Vector3 center;         // Bounding sphere center (model space)
+    float radius;           // Bounding sphere radius
+    Vector3 coneAxis;       // Normal cone axis, average of triangles normals
+    float coneCutoff;       // Normal cone cutoff, sine of cone half-angle (1.0f if cone can't be culled)
+} MeshCluster;
+
+// Draw arrays indirect command (OpenGL 4.3 layout, read by GPU from draw indirect buffer)
+typedef struct DrawArraysIndirectCommand {
+    unsigned int count;         // Number of vertices to draw
+    unsigned int instanceCount; // Number of instances to draw
+    unsigned int first;         // First vertex to draw
+    unsigned int baseInstance;  // Base instance (must be 0 on OpenGL 4.3)
+} DrawArraysIndirectCommand;
+
+// Draw elements indirect command (OpenGL 4.3 layout, read by GPU from draw indirect buffer)
+typedef struct DrawElementsIndirectCommand {
+    unsigned int count;         // Number of indices to draw
+    unsigned int instanceCount; // Number of instances to draw
+    unsigned int firstIndex;    // First index to draw
+    int baseVertex;             // Value added to indices
+    unsigned int baseInstance;  // Base instance (must be 0 on OpenGL 4.3)
+} DrawElementsIndirectCommand;
+
+// Instances bounding spheres (world space), stored as structure of arrays
+// NOTE: Arrays capacity is padded to a multiple of 8, culled in batches of 8 instances
+typedef struct InstanceBounds {
+    int count;              // Number of instances
+    int capacity;           // Arrays capacity (multiple of 8)
+    float *x;               // Spheres centers X
+    float *y;               // Spheres centers Y
+    float *z;               // Spheres centers Z
+    float *radius;          // Spheres radius
+} InstanceBounds;
+
+// Dynamic AABB tree node
+// NOTE: Leaves store objects fat boxes, internal nodes store the union of their children boxes;
+// free nodes are linked by parent index and have height -1
+typedef struct AABBTreeNode {
+    BoundingBox box;        // Node bounding box (fat box on leaves)
+    int parent;             // Parent node index (next free node if node is free)
+    int left;               // Left child node index (AABB_TREE_NULL_NODE on leaves)
+    int right;              // Right child node index (AABB_TREE_NULL_NODE on leaves)
+    int height;             // Node height, 0 on leaves
+    int userData;           // Object id (leaves only)
+} AABBTreeNode;
+
+// Dynamic AABB tree, incrementally updated and balanced by rotations (AVL)
+typedef struct AABBTree {
+    AABBTreeNode *nodes;    // Nodes pool, grown on demand
+    int nodeCount;          // Nodes in use
+    int capacity;           // Nodes pool capacity
+    int root;               // Root node index
+    int freeList;           // First free node index
+} AABBTree;
+
+// Frustum type, defined by 6 planes: left, right, bottom, top, near, far
+// NOTE: Planes equations (a, b, c, d), a point is inside when a*x + b*y + c*z + d >= 0
+typedef struct Frustum {
+    float planes[6][4];
+} Frustum;
+
+// Occlusion query type, bounding box proxy tested with GL_ANY_SAMPLES_PASSED queries
+// NOTE: Two queries are used alternately, previous frame result is read while current frame one is issued
+typedef struct OcclusionQuery {
+    unsigned int ids[2];    // OpenGL query objects ids
+    bool issued[2];         // Query issued and result not read yet
+    int frame;              // Frames counter, selects current query
+    bool visible;           // Last visibility result read
+    BoundingBox bounds;     // Proxy bounding box (world space)
+} OcclusionQuery;
+
 // LESSON 04: Vertex data defining a mesh
 typedef struct Mesh {
     int vertexCount;        // number of vertices stored in arrays
     float *vertices;        // vertex position (XYZ - 3 components per vertex) (shader-location = 0)
     float *texcoords;       // vertex texture coordinates (UV - 2 components per vertex) (shader-location = 1)
     float *normals;         // vertex normals (XYZ - 3 components per vertex) (shader-location = 2)
+    
+    int triangleCount;      // number of triangles stored (indexed meshes)
+    unsigned int *indices;  // vertex indices (3 per triangle), NULL if mesh is not indexed
 
     unsigned int vaoId;     // OpenGL Vertex Array Object id
-    unsigned int vboId[3];  // OpenGL Vertex Buffer Objects id (3 types of vertex data supported)
+    unsigned int vboId[4];  // OpenGL Vertex Buffer Objects id (3 types of vertex data supported + indices)
+    
+    int chunkCount;         // Number of mesh chunks (0 if mesh is not chunked)
+    MeshChunk *chunks;      // Mesh chunks: vertex ranges with bounds
+    unsigned int indirectId;    // OpenGL draw indirect buffer id (chunked meshes, OpenGL 4.3 required)
+    
+    int clusterCount;       // Number of mesh clusters (0 if mesh is not clustered)
+    MeshCluster *clusters;  // Mesh clusters: index ranges with bounding sphere and normal cone
+    
+    BoundingBox bounds;     // Mesh bounding box (model space), computed on upload
+    Vector3 sphereCenter;   // Mesh bounding sphere center (model space), computed on upload
+    float sphereRadius;     // Mesh bounding sphere radius
 } Mesh;
 
+// Voxel map chunk, cells of a 16x16x16 block of the map
+// NOTE: Uniform chunks (all cells empty or all solid) don't store cells, only their value
+typedef struct VoxelChunk {
+    unsigned char *cells;   // Chunk cells values (x, z, y order), NULL if chunk is uniform
+    unsigned char value;    // Cells value if chunk is uniform
+} VoxelChunk;
+
+// Voxel map, 3D cells grid split in chunks
+// NOTE: Cell (x, y, z) occupies [x - 0.5, x + 0.5]x[y, y + 1]x[z - 0.5, z + 0.5] (scaled by cube size),
+// same layout used by cubicmap; cells outside the map are considered solid
+typedef struct VoxelMap {
+    int width;              // Map cells along X axis
+    int height;             // Map cells along Y axis (levels)
+    int depth;              // Map cells along Z axis
+    int chunkCountX;        // Map chunks along X axis
+    int chunkCountY;        // Map chunks along Y axis
+    int chunkCountZ;        // Map chunks along Z axis
+    VoxelChunk *chunks;     // Map chunks (x, z, y order)
+} VoxelMap;
+
+// Images loader, decodes multiple images in parallel on worker threads
+// NOTE: Worker threads take the next image to decode from a shared counter, streamed textures
+// mipmap levels are generated on worker threads too
+#define MAX_IMAGE_LOADER_THREADS    4       // Max worker threads used to decode images
+
+typedef struct ImageLoader {
+    const char **fileNames;     // Images file names to load
+    Image *images;              // Loaded images (same order as file names), NULL when loading streamed textures
+    StreamTexture *streams;     // Streamed textures to generate levels for (same order as file names), NULL if not required
+    int count;                  // Number of images to load
+    int next;                   // Next image to be loaded by a worker thread
+    pthread_mutex_t mutex;      // Mutex protecting next image counter
+    pthread_t threads[MAX_IMAGE_LOADER_THREADS];    // Worker threads
+    int threadCount;            // Number of worker threads running
+} ImageLoader;
+
+// Inflate bit reader, input bits are consumed from a 64bit buffer (least significant bit first)
+// NOTE: Buffer is refilled with a single unaligned 8 bytes load (at least 56 bits available after refill),
+// input is zero-filled past its end and overrun bytes are checked once the stream ends
+typedef struct BitReader {
+    const unsigned char *next;  // Next input byte not loaded into bit buffer
+    const unsigned char *end;   // Input data end
+    unsigned long long buffer;  // Bit buffer
+    int count;                  // Bits available in bit buffer
+    int overrun;                // Zero bytes loaded past input end
+} BitReader;
+
+// Inflate Huffman decoding table, two levels
+// NOTE: Codes up to HUFFMAN_FAST_BITS long are decoded with a single lookup, longer codes use a subtable;
+// entries store (symbol << 16) | code length, subtable links store (offset << 16) | HUFFMAN_SUBTABLE | subtable bits
+#define HUFFMAN_FAST_BITS       10      // Bits resolved by first level lookup
+#define HUFFMAN_MAX_BITS        15      // Max code length (DEFLATE)
+#define HUFFMAN_SUBTABLE        0x100   // Entry links to a second level subtable
+#define HUFFMAN_TABLE_SIZE      ((1 << HUFFMAN_FAST_BITS) + 288*(1 << (HUFFMAN_MAX_BITS - HUFFMAN_FAST_BITS)))
+
+typedef struct HuffmanTable {
+    unsigned int entries[HUFFMAN_TABLE_SIZE];   // First level entries followed by subtables
+} HuffmanTable;
+
 // LESSON 04: Material type
 typedef struct Material {
     Shader shader;          // Default shader
@@ -143,6 +371,28 @@ typedef struct Model {
     Material material;      // Shader and textures data
 } Model;
 
+// Frame stats struct
+// NOTE: Frame times are registered along a sample period and reduced to percentiles at sample end
+#define FRAME_STATS_CAPACITY    4096        // Max frame times registered per sample
+#define FRAME_STATS_SAMPLE_TIME   60.0      // Stats sample period (in seconds)
+
+typedef struct FrameStats {
+    float frameTimes[FRAME_STATS_CAPACITY]; // Frame times registered in current sample (ms)
+    int frameCount;                         // Frame times registered in current sample
+    double sampleStartTime;                 // Current sample start time (in seconds)
+    int sampleCount;                        // Samples completed
+    float p50, p95, p99, maxTime;           // Last sample frame time percentiles (ms)
+    long memoryUsage;                       // Last sample process memory usage, resident set (bytes)
+    long vramUsage;                         // Last sample VRAM used by loaded textures and meshes (bytes)
+    long vramAvailable;                     // Last sample driver reported available VRAM (bytes), 0 if not supported
+    int perfMessageCount;                   // Driver performance messages received in current sample
+    int perfMessagePeak;                    // Driver performance messages peak per frame in current sample
+    int errorMessageCount;                  // Driver error messages received in current sample
+    int perfMessages;                       // Last sample driver performance messages (total)
+    int perfMessagesPeak;                   // Last sample driver performance messages (max per frame)
+    int errorMessages;                      // Last sample driver error messages (total)
+} FrameStats;
+
 // LESSON 06: Camera move modes (first person)
 typedef enum { 
     MOVE_FRONT = 0, 
@@ -153,6 +403,110 @@ typedef enum {
     MOVE_DOWN 
 } CameraMove;
 
+// Quality presets, ordered by rendering cost
+typedef enum {
+    QUALITY_LOW = 0,
+    QUALITY_MEDIUM,
+    QUALITY_HIGH,
+    QUALITY_ULTRA
+} QualityPreset;
+
+// Textures filter modes
+typedef enum {
+    FILTER_POINT = 0,       // No pixels interpolation, nearest mipmap levels blended (required by streaming fade in)
+    FILTER_BILINEAR,        // Linear pixels interpolation, nearest mipmap level
+    FILTER_TRILINEAR        // Linear pixels interpolation, mipmap levels blended
+} TextureFilterMode;
+
+// Quality settings, initialized from a preset and saved to config file (every value can be tuned by hand)
+typedef struct QualitySettings {
+    int screenWidth;                // Window width (not probed)
+    int screenHeight;               // Window height (not probed)
+    int preset;                     // Preset settings were initialized from (QualityPreset)
+    float resolutionScale;          // Scene render resolution, relative to window size (upscaled on window)
+    int msaaSamples;                // Scene anti-aliasing samples (MSAA), 0 to disable
+    int textureFilter;              // Textures filter mode (TextureFilterMode)
+    int textureAnisotropy;          // Textures max anisotropy (anisotropic filtering), 1 to disable
+    float textureLodBias;           // Textures mipmap level bias, lower detail levels sampled on positive bias
+    float drawDistance;             // Camera far plane distance (world units), farther chunks are culled
+    bool vsync;                     // Wait for vertical sync on buffers swap
+} QualitySettings;
+
+// Scene render target: scene is drawn at scaled resolution (and multisampled) and blitted to window
+// NOTE: Scene is drawn directly to window framebuffer if not scaled and not multisampled
+typedef struct SceneTarget {
+    unsigned int fbo;               // Scene framebuffer id, 0 if scene is drawn to window framebuffer
+    unsigned int colorRbo;          // Scene color renderbuffer id
+    unsigned int depthRbo;          // Scene depth renderbuffer id
+    unsigned int resolveFbo;        // Multisample resolve framebuffer id, 0 if scene is not multisampled
+    unsigned int resolveRbo;        // Multisample resolve color renderbuffer id
+    int width;                      // Scene render width
+    int height;                     // Scene render height
+    int samples;                    // Scene multisample samples, 0 if not multisampled
+    int screenWidth;                // Window framebuffer width
+    int screenHeight;               // Window framebuffer height
+} SceneTarget;
+
+// Hardware probe: scene is drawn for a short time with every preset (most expensive first),
+// first preset meeting the frame time target is selected
+#define QUALITY_PROBE_MAX_FRAMES    256         // Max frame times registered per probed preset
+
+typedef struct QualityProbe {
+    bool active;                    // Probe is running
+    int preset;                     // Preset being probed (QualityPreset)
+    int warmupFrames;               // Frames left before frame times are registered
+    float times[QUALITY_PROBE_MAX_FRAMES];  // Probed preset frame times (ms)
+    int frameCount;                 // Probed preset frame times registered
+    float totalTime;                // Probed preset frame times sum (ms)
+} QualityProbe;
+
+// Scene frame: data required to draw a frame, snapshotted after game update
+// NOTE: Frame is drawn directly or handed to render thread, it does not reference game state
+typedef struct SceneFrame {
+    Matrix view;                    // Camera view matrix
+    Matrix projection;              // Camera projection matrix
+    Vector3 viewPosition;           // Camera position
+    Frustum frustum;                // Camera frustum, maze chunks and tower clusters are culled with it
+    float time;                     // Frame time (seconds), shaders time uniform
+    bool towerInFrustum;            // Tower passed props instances culling
+    QualitySettings quality;        // Quality settings, applied before drawing if changed
+    bool finish;                    // Wait for frame GPU work to finish after swap (hardware probe)
+} SceneFrame;
+
+// Scene resources drawn every frame
+// NOTE: With render thread, resources are only accessed by render thread while it runs
+typedef struct SceneResources {
+    Model *modelMap;                // Maze model (chunked)
+    Vector3 mapPosition;            // Maze model position
+    Model *modelTower;              // Tower model (clustered if large enough)
+    Vector3 towerPosition;          // Tower model position
+    float towerScale;               // Tower model scale
+    OcclusionQuery *towerQuery;     // Tower occlusion query
+    StreamTexture *streams;         // Streamed textures: tower, map atlas
+    int streamCount;                // Streamed textures count
+    ImageLoader *streamLoader;      // Streamed textures levels loader
+} SceneResources;
+
+#if defined(RENDER_THREAD)
+// Render thread struct, scene frames handed from game thread to render thread
+// NOTE: Submitted frame is copied by render thread before drawing it, so game thread can submit next
+// frame while previous one is drawn (double-buffered); frames are never dropped
+typedef struct RenderThread {
+    pthread_t thread;               // Render thread, owns OpenGL context while running
+    pthread_mutex_t mutex;          // Protects frame hand-off state and frame counters
+    pthread_cond_t cond;            // Signals frame hand-off state changes
+    SceneFrame frame;               // Submitted frame
+    bool pending;                   // Submitted frame waiting to be drawn
+    bool running;                   // Render thread running, cleared to stop it (never set if thread could not be created)
+    SceneResources scene;           // Scene resources, drawn by render thread
+    bool memoryInfo;                // Driver reports available VRAM (NVX_gpu_memory_info)
+    int perfMessages;               // Driver performance messages received on frames drawn since last submission
+    int errorMessages;              // Driver error messages received on frames drawn since last submission
+    long vramUsage;                 // VRAM usage after last frame drawn (bytes)
+    long vramAvailable;             // Driver reported available VRAM after last frame drawn (bytes), 0 if not supported
+} RenderThread;
+#endif
+
 //----------------------------------------------------------------------------------
 // Global Variables Declaration
 //----------------------------------------------------------------------------------
@@ -165,6 +519,12 @@ static double currentTime, previousTime;    // Used to track timmings
 static double frameTime = 0.0;              // Time measure for one frame
 static double targetTime = 0.0;             // Desired time for one frame, if 0 not applied
 
+// Idle mode: game is paused while window is unfocused or iconified, events are waited (no spin-wait)
+#define IDLE_WAIT_TIME_UNFOCUSED    0.25    // Max events wait time while window is unfocused (seconds)
+#define IDLE_WAIT_TIME_ICONIFIED    1.0     // Max events wait time while window is iconified (seconds)
+
+static bool windowRefresh = false;          // Window contents must be redrawn (window exposed or resized)
+
 // LESSON 02: Keyboard/mouse input management
 // Register keyboard/mouse states (current and previous)
 static char previousKeyState[512] = { 0 };  // Registers previous frame key state
@@ -176,9 +536,115 @@ static char currentMouseState[3] = { 0 };   // Registers current mouse button st
 static Shader shdrDefault;                  // Default shader to draw (vertex and fragment processing)
 static unsigned int quadId;                 // Quad VAO id to be used on texture drawing
 
+// Per-frame uniform data: view, projection, view-projection matrices and time
+// NOTE: Uniform buffer (std140 layout) is updated once per frame and shared by all shaders,
+// so only the model matrix is uploaded per draw
+#define FRAME_DATA_BINDING      0           // Uniform buffer binding point for per-frame data
+#define FRAME_DATA_SIZE         (16*3 + 4)*sizeof(float)    // Per-frame data size, std140 layout (3 mat4 + float padded to vec4)
+
+static unsigned int frameDataUbo = 0;       // Per-frame uniform buffer id
+
+// Chunked meshes: frustum culling and multi-draw indirect submission
+// NOTE: glMultiDrawArraysIndirect() (OpenGL 4.3) is not provided by glad, it's loaded on InitGraphicsDevice()
+#define MAX_MESH_CHUNKS         1024        // Max chunks per mesh
+#define MESH_CHUNK_SIZE         4.0f        // Mesh chunk size along X and Z axis (world units)
+
+#define GL_DRAW_INDIRECT_BUFFER     0x8F3F
+
+typedef void (APIENTRYP PFNMULTIDRAWARRAYSINDIRECTPROC)(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+static PFNMULTIDRAWARRAYSINDIRECTPROC multiDrawArraysIndirect = NULL;  // NULL if not supported (OpenGL 3.3)
+static PFNMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect = NULL;  // NULL if not supported (OpenGL 3.3)
+
+// Mesh optimization: triangles reordered for post-transform vertex cache and overdraw
+#define VERTEX_CACHE_SIZE       32          // Vertex cache size used on triangles scoring (Forsyth, LRU)
+#define VERTEX_CACHE_SIM_SIZE   16          // Vertex cache size simulated to report ACMR/ATVR (FIFO)
+#define OVERDRAW_CLUSTER_SIZE   32          // Min triangles per cluster on overdraw ordering
+
+// Scene queries: dynamic AABB tree for props and moving objects, grid ray casts for maze walls
+#define AABB_TREE_NULL_NODE     -1
+#define AABB_TREE_FAT_MARGIN    0.1f        // Leaves boxes margin (broad phase tolerance)
+#define AABB_TREE_STACK_SIZE    256         // Max traversal stack size on queries
+#define PICKING_DISTANCE        20.0f       // Max picking ray distance (world units)
+
+// Mesh clusters: large meshes split in small triangles groups, frustum and back-face culled on CPU
+#define MESH_CLUSTER_MIN_TRIANGLES  4096    // Meshes with less triangles are not clustered
+#define MESH_CLUSTER_MAX_TRIANGLES  124     // Max triangles per cluster
+#define MESH_CLUSTER_MAX_VERTICES   64      // Max unique vertices per cluster
+
+// Voxel maps: 3D cells grid, chunked meshing and collisions
+#define VOXEL_CHUNK_SIZE        16          // Voxel chunk size (cells per side)
+#define VOXEL_EMPTY             0           // Empty cell value
+#define VOXEL_SOLID             1           // Solid cell value
+
+// Occlusion culling: models bounding box proxies tested with occlusion queries
+static unsigned int occlusionBoxVao = 0;    // Unit cube proxy VAO id
+static unsigned int occlusionBoxVbo = 0;    // Unit cube proxy VBO id (positions)
+
+// Textures streaming: placeholder mip tail uploaded on load, replaced once levels are generated on loader
+// threads, higher levels streamed by priority
+// NOTE: Not resident levels are hidden by GL_TEXTURE_BASE_LEVEL clamping
+#define STREAM_MIP_TAIL_SIZE        32          // Levels up to this size (width and height) are uploaded together
+#define STREAM_UPLOAD_BUDGET        (256*1024)  // Max bytes uploaded per frame (one level is always uploaded)
+#define STREAM_FADE_STEP            0.125f      // GL_TEXTURE_MIN_LOD decrement per frame on new resident levels
+
+// Quality settings: presets picked on first launch by a hardware probe, saved to config file
+// NOTE: Anisotropic filtering (EXT/ARB_texture_filter_anisotropic) is not provided by glad
+#define QUALITY_SETTINGS_FILE       "maze_settings.cfg"     // Quality settings config file, probe runs again if missing
+#define QUALITY_PROBE_TIME          1000.0f     // Hardware probe max duration (ms), split among presets
+#define QUALITY_PROBE_FRAME_TIME    12.0f       // Probe frame time target (ms), headroom left for game update at 60 fps
+#define QUALITY_PROBE_WARMUP_FRAMES 3           // Frames drawn before frame times are registered (per preset)
+
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT       0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT   0x84FF
+
+static QualitySettings quality = { 0 };     // Current quality settings
+static SceneTarget sceneTarget = { 0 };     // Scene render target (scaled, multisampled)
+static float maxAnisotropy = 1.0f;          // Max textures anisotropy supported, 1.0f if not supported
+static int maxSamples = 0;                  // Max multisample samples supported
+
 // LESSON 06: Camera system management
 static Vector2 cameraAngle = { 0.0f, 0.0f };
 
+// Frame stats: frame times, memory usage and VRAM counters
+static FrameStats frameStats = { 0 };
+static long vramUsage = 0;                  // VRAM used by loaded textures and meshes (bytes)
+
+// Debug output: driver debug messages and debug groups
+// NOTE: KHR_debug (OpenGL 4.3) is not provided by glad, required entry points are loaded on InitDebugOutput()
+#define MAX_DEBUG_MESSAGES_LOGGED   64      // Max driver debug messages logged (all of them are counted)
+
+#define GL_DEBUG_OUTPUT             0x92E0
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_TYPE_PUSH_GROUP    0x8269
+#define GL_DEBUG_TYPE_POP_GROUP     0x826A
+#define GL_CONTEXT_FLAG_DEBUG_BIT   0x00000002
+
+typedef void (APIENTRYP PFNDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROCARB callback, const void *userParam);
+typedef void (APIENTRYP PFNPUSHDEBUGGROUPPROC)(GLenum source, GLuint id, GLsizei length, const GLchar *message);
+typedef void (APIENTRYP PFNPOPDEBUGGROUPPROC)(void);
+
+static PFNPUSHDEBUGGROUPPROC pushDebugGroup = NULL;     // KHR_debug glPushDebugGroup(), NULL if not supported
+static PFNPOPDEBUGGROUPPROC popDebugGroup = NULL;       // KHR_debug glPopDebugGroup(), NULL if not supported
+static int debugPerfMessages = 0;           // Driver performance messages received in current frame
+static int debugErrorMessages = 0;          // Driver error messages received in current frame
+static int debugMessagesLogged = 0;         // Driver debug messages logged
+
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+#define SOAK_TEST_DURATION      (4*3600)    // Soak test duration (in seconds)
+#define SOAK_WARMUP_SAMPLES     2           // Samples discarded before registering baseline
+#define SOAK_MEMORY_GROWTH      (16*1024*1024)  // Max memory growth over baseline (bytes)
+#define SOAK_FRAMETIME_DRIFT    1.5f        // Max p99 frame time growth over baseline (ratio)
+
+static char botKeyState[512] = { 0 };       // Keys held down by autoplay bot
+static Vector2 botMousePosition = { 0.0f, 0.0f };   // Virtual mouse moved by autoplay bot
+static FrameStats soakBaseline = { 0 };     // Stats registered after warmup, used as reference
+static FILE *soakFile = NULL;               // Soak test stats output file (CSV)
+static int soakRegressions = 0;             // Regressions detected along the soak test
+#endif
+
 //----------------------------------------------------------------------------------
 // Module specific Functions Declaration
 //----------------------------------------------------------------------------------
@@ -188,6 +654,7 @@ static void ErrorCallback(int error, const char* description);
 static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 static void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
 static void MouseCursorPosCallback(GLFWwindow *window, double x, double y);
+static void WindowRefreshCallback(GLFWwindow *window);
 
 void TraceLog(int msgType, const char *text, ...);      // Show trace log messages (LOG_INFO, LOG_WARNING, LOG_ERROR, LOG_DEBUG)
 
@@ -198,6 +665,8 @@ static void InitGraphicsDevice(int width, int height);  // Initialize graphic de
 static void CloseWindow(void);                          // Close window and free resources
 static void SetTargetFPS(int fps);                      // Set target FPS (maximum)
 static void SyncFrame(void);                            // Synchronize to desired framerate
+static bool IsWindowIdle(void);                         // Check if window is unfocused or iconified (idle mode)
+static bool WaitIdleEvents(void);                       // Wait for window events while idle, returns true if a redraw is required
 
 // LESSON 02: Inputs management (keyboard and mouse)
 //----------------------------------------------------------------------------------
@@ -212,16 +681,54 @@ static void PollInputEvents(void);                  // Poll (store) all input ev
 //----------------------------------------------------------------------------------
 static unsigned int LoadQuad(float width, float height); // Load quad vertex data and return id
 static Shader LoadShaderDefault(void);              // Load default shader (basic shader)
+static void InitFrameData(void);                    // Load per-frame uniform buffer and bind it to binding point
+static void UpdateFrameData(Matrix view, Matrix projection, float time);   // Update per-frame uniform buffer data (once per frame)
 static Image LoadImage(const char *fileName);       // Load image data to CPU memory (RAM)
 static void UnloadImage(Image image);               // Unload image data from CPU memory (RAM)
+static void BeginLoadImages(ImageLoader *loader, const char **fileNames, Image *images, int count);    // Start decoding images on worker threads
+static void EndLoadImages(ImageLoader *loader);     // Wait for all images to be decoded
+static void *LoadImagesWorker(void *data);          // Image loader worker thread: decode images until none left
+static void BeginLoadTextureStreams(ImageLoader *loader, const char **fileNames, StreamTexture *streams, int count);  // Load streamed textures with placeholder mip tail, start levels generation on worker threads
+static void UpdateLoadTextureStreams(ImageLoader *loader);  // Upload mip tail of streamed textures with levels already generated
+#if defined(IMAGE_DECODE_BENCHMARK)
+static void BenchmarkImageDecoding(const char **fileNames, int count, int iterations);  // Measure images decoding throughput (MB/s)
+#endif
 static Color *GetImageData(Image image);            // Get pixel data from image as Color array
-static Texture2D LoadTexture(unsigned char *data, int width, int height, int format);          // Load texture data in GPU memory (VRAM)
+static Color *GetImageDataView(Image image);        // Get pixel data from image as Color array, no copy if not required
+static void UnloadImageDataView(Image image, Color *pixels);    // Unload pixel data returned by GetImageDataView()
 static void UnloadTexture(Texture2D texture);       // Unload texture data from GPU memory (VRAM)
+static StreamTexture LoadTextureStream(int width, int height);  // Load texture storage in GPU memory with placeholder mip tail
+static void GenTextureStreamLevels(StreamTexture *stream, Image image);    // Generate streamed texture mipmap levels from image (RAM)
+static void UnloadTextureStream(StreamTexture *stream); // Unload streamed texture levels not uploaded yet (RAM)
+static int UpdateTextureStreaming(StreamTexture *streams, int count, int budget);  // Upload next levels by priority, returns bytes uploaded
 
 static void DrawTexture(Texture2D texture, Vector2 position, Color tint);   // Draw texture in screen position coordinates
 
+// Pixel format converters to R8G8B8A8 (Color), one kernel per format
+// NOTE: Lower bit-depth channels are expanded by bit replication: (x << 3) | (x >> 2) for 5 bit
+static void ConvertGrayscale(const unsigned char *src, Color *dst, int count);     // Convert UNCOMPRESSED_GRAYSCALE pixels
+static void ConvertGrayAlpha(const unsigned char *src, Color *dst, int count);     // Convert UNCOMPRESSED_GRAY_ALPHA pixels
+static void ConvertR5G6B5(const unsigned char *src, Color *dst, int count);        // Convert UNCOMPRESSED_R5G6B5 pixels
+static void ConvertR8G8B8(const unsigned char *src, Color *dst, int count);        // Convert UNCOMPRESSED_R8G8B8 pixels
+static void ConvertR5G5B5A1(const unsigned char *src, Color *dst, int count);      // Convert UNCOMPRESSED_R5G5B5A1 pixels
+static void ConvertR4G4B4A4(const unsigned char *src, Color *dst, int count);      // Convert UNCOMPRESSED_R4G4B4A4 pixels
+
 #define WHITE   (Color){ 255, 255, 255, 255 }
 
+// PNG decoding: fast inflate and SIMD scanlines unfiltering
+//----------------------------------------------------------------------------------
+static Image LoadImagePNG(const unsigned char *fileData, int dataSize);    // Load PNG image from memory (8bit, non-interlaced), returns empty image if not supported
+static int Inflate(const unsigned char *src, int srcSize, unsigned char *dst, int dstSize);   // Decompress zlib stream, returns decompressed size (-1 on error)
+static bool BuildHuffmanTable(HuffmanTable *table, const unsigned char *lengths, int count);  // Build Huffman decoding table from code lengths
+static void UnfilterScanline(unsigned char *dst, const unsigned char *src, const unsigned char *prior, int size, int bpp, int filter);  // Reconstruct PNG filtered scanline
+static void RefillBits(BitReader *reader);                                  // Refill inflate bit buffer (at least 56 bits available)
+static unsigned int ReadBits(BitReader *reader, int count);                 // Read bits from inflate bit buffer
+static int DecodeSymbol(BitReader *reader, const HuffmanTable *table);     // Decode Huffman symbol from inflate bit buffer, returns -1 on invalid code
+#if defined(__SSE2__)
+static __m128i LoadPixel4(const unsigned char *data);                       // Load 4 bytes into SSE2 register lowest lane
+static void StorePixel4(unsigned char *data, __m128i pixel);                // Store SSE2 register lowest lane (4 bytes)
+#endif
+
 // LESSON 04: Model loading, vertex buffer creation
 //----------------------------------------------------------------------------------
 static Mesh LoadOBJ(const char *fileName);                  // Load static mesh from OBJ file
@@ -231,9 +738,83 @@ static void UnloadModel(Model model);                       // Unload model data
 
 static void DrawModel(Model model, Vector3 position, float scale, Color tint);  // Draw model in screen
 
+// Mesh optimization: vertex cache and overdraw triangles ordering
+//----------------------------------------------------------------------------------
+static void OptimizeMesh(Mesh *mesh);                       // Index mesh vertices and reorder triangles for vertex cache and overdraw (before upload)
+static void OptimizeVertexCache(unsigned int *indices, int triangleCount, int vertexCount);  // Reorder triangles for vertex cache locality (Forsyth)
+static void OptimizeOverdraw(unsigned int *indices, int triangleCount, const float *vertices);  // Reorder triangles clusters, outer facing clusters first
+static float GetForsythVertexScore(int cachePosition, int remainingValence);    // Get vertex score from cache position and triangles left
+static float GetVertexCacheMissRatio(const unsigned int *indices, int triangleCount, int cacheSize);  // Get ACMR, vertex cache misses per triangle (FIFO)
+
+// Mesh clusters: partitioning and cone culling
+//----------------------------------------------------------------------------------
+static void GenMeshClusters(Mesh *mesh);                    // Split large indexed mesh into clusters with bounds and normal cone (before upload)
+static bool CheckFrustumSphere(Frustum frustum, Vector3 center, float radius);  // Check if a sphere is (partially) inside frustum
+static bool CheckClusterVisible(MeshCluster cluster, Vector3 position, float scale, Frustum frustum, Vector3 viewPosition);  // Check if cluster is inside frustum and not back-facing
+static int DrawModelClusters(Model model, Vector3 position, float scale, Color tint, Frustum frustum, Vector3 viewPosition); // Draw model visible clusters, returns clusters drawn
+
 // LESSON 05: Cubicmap generation, loading and drawing
 //----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
 static Mesh GenMeshCubicmap(Image cubicmap, float cubeSize); // Generate cubicmap mesh from image data
+#endif
+
+#if defined(VOXEL_MAZE)
+// Voxel maps: 3D cells grid, chunked meshing and collisions
+//----------------------------------------------------------------------------------
+static VoxelMap LoadVoxelMap(Image *layers, int layerCount);    // Load voxel map from layer images (bottom to top), white pixels are solid
+static void UnloadVoxelMap(VoxelMap map);                   // Unload voxel map data
+static unsigned char GetVoxel(VoxelMap map, int x, int y, int z);   // Get voxel map cell value (solid outside map)
+static Mesh GenMeshVoxelMap(VoxelMap map, float cubeSize);  // Generate voxel map mesh, one mesh chunk per voxel chunk
+static int GenVoxelChunkFaces(VoxelMap map, int chunkX, int chunkY, int chunkZ, float cubeSize, float *vertices, float *texcoords, float *normals); // Generate chunk visible faces, returns vertices count
+static bool CheckCollisionVoxelMap(VoxelMap map, float cubeSize, BoundingBox box);  // Check collision between voxel map solid cells and a bounding box
+#endif
+
+// Chunked meshes: frustum culling and multi-draw indirect submission
+//----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
+static void GenMeshChunks(Mesh *mesh, float chunkSize);     // Sort mesh triangles into chunks along XZ plane (before upload)
+#endif
+static Frustum ExtractFrustum(Matrix viewProjection);       // Extract frustum planes from view-projection matrix
+static bool CheckFrustumBox(Frustum frustum, BoundingBox box);  // Check if a bounding box is (partially) inside frustum
+static BoundingBox GetMeshBoundingBox(Mesh mesh);           // Compute mesh bounding box (model space)
+static int DrawModelChunks(Model model, Vector3 position, float scale, Color tint, Frustum frustum); // Draw model visible chunks, returns chunks drawn
+
+// Instances culling: bounding spheres frustum culling (SoA, AVX)
+//----------------------------------------------------------------------------------
+static InstanceBounds LoadInstanceBounds(int count);        // Load instances bounds arrays (RAM)
+static void UnloadInstanceBounds(InstanceBounds instances); // Unload instances bounds arrays
+static void SetInstanceBounds(InstanceBounds *instances, int index, Mesh mesh, Vector3 position, float scale);  // Set instance bounds from mesh bounding sphere and transform
+static int CullInstances(InstanceBounds instances, Frustum frustum, int *visible);  // Cull instances against frustum, returns visible instances (indices in visible)
+#if defined(CULLING_BENCHMARK)
+static void BenchmarkInstanceCulling(int count, int iterations);    // Measure instances culling time (ms)
+#endif
+#if defined(CLUSTER_BENCHMARK)
+static Mesh GenMeshSphere(float radius, int rings, int slices);     // Generate UV sphere mesh (non-indexed)
+static void BenchmarkClusterCulling(int rings, int slices, int iterations); // Measure mesh clusters culling time (ms) and culled clusters
+#endif
+
+// Scene queries: dynamic AABB tree and grid ray casts
+//----------------------------------------------------------------------------------
+static AABBTree LoadAABBTree(int capacity);                 // Load dynamic AABB tree with initial nodes capacity
+static void UnloadAABBTree(AABBTree tree);                  // Unload dynamic AABB tree nodes
+static int CreateAABBTreeProxy(AABBTree *tree, BoundingBox box, int userData);  // Insert object box in tree, returns proxy id
+static int QueryAABBTreeBox(AABBTree tree, BoundingBox box, int *results, int maxResults);  // Get objects overlapping box, returns objects count
+static int RaycastAABBTree(AABBTree tree, Ray ray, float maxDistance, float *hitDistance);  // Get nearest object hit by ray, returns object id (-1 if none)
+static float GetRayCubicmapDistance(Ray ray, Color *mapPixels, int mapWidth, int mapHeight, Vector3 mapPosition, float cubeSize, float maxDistance, int *cellX, int *cellY); // Get ray distance to first cubicmap wall (grid DDA), -1 if none
+static float GetRayBoxDistance(Ray ray, BoundingBox box);   // Get ray distance to box (slabs), -1 if box is not hit
+static BoundingBox GetBoxUnion(BoundingBox box1, BoundingBox box2);  // Get box containing two boxes
+static float GetBoxSurfaceArea(BoundingBox box);            // Get box surface area, used as insertion cost
+static int AllocateAABBTreeNode(AABBTree *tree);            // Get node from pool (pool may be reallocated)
+static void InsertAABBTreeLeaf(AABBTree *tree, int leaf);   // Insert leaf next to its best sibling, balance up to root
+static int BalanceAABBTree(AABBTree *tree, int node);       // Rotate node if children heights differ more than 1, returns subtree root
+
+// Occlusion culling: bounding box proxies and occlusion queries
+//----------------------------------------------------------------------------------
+static void InitOcclusionProxy(void);                       // Load unit cube proxy vertex data (VRAM)
+static OcclusionQuery LoadOcclusionQuery(BoundingBox bounds);   // Load occlusion query for a bounding box (world space)
+static void UnloadOcclusionQuery(OcclusionQuery query);     // Unload occlusion query
+static bool DrawModelOccluded(Model model, Vector3 position, float scale, Color tint, OcclusionQuery *query, Frustum frustum, Vector3 viewPosition); // Draw model if not occluded, returns true if drawn
 
 // LESSON 06: Camera system management (1st person)
 //----------------------------------------------------------------------------------
@@ -241,7 +822,57 @@ static void UpdateCamera(Camera *camera);                   // Update camera for
 
 // LESSON 07: Collision detection and resolution
 //----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
 static bool CheckCollisionCircleRec(Vector2 center, float radius, Rectangle rec);   // Check collision between circle and rectangle
+#endif
+static bool CheckCollisionBoxes(BoundingBox box1, BoundingBox box2);    // Check collision between two boxes
+
+// Scene frame drawing: frames drawn on game thread or on a dedicated render thread
+//----------------------------------------------------------------------------------
+static void DrawSceneFrame(SceneResources scene, SceneFrame frame);     // Draw scene frame, stream textures and swap buffers
+#if defined(RENDER_THREAD)
+static void StartRenderThread(RenderThread *renderThread, SceneResources scene);  // Start render thread, OpenGL context is moved to it
+static void StopRenderThread(RenderThread *renderThread);   // Stop render thread once last frame is drawn, OpenGL context is moved back
+static void SubmitRenderFrame(RenderThread *renderThread, SceneFrame frame);    // Hand frame to render thread, waits until previous frame has been taken
+static void *RenderThreadMain(void *arg);                   // Render thread loop: draw submitted frames
+static void UpdateRenderCounters(RenderThread *renderThread);   // Register drawn frame debug messages and VRAM counters (OpenGL context thread)
+#endif
+
+// Quality settings: presets, config file and hardware probe
+//----------------------------------------------------------------------------------
+static QualitySettings GetQualityPreset(int preset, int screenWidth, int screenHeight); // Get quality preset settings for a window size
+#if !defined(SOAK_TEST)
+static bool LoadQualitySettings(const char *fileName, QualitySettings *settings);  // Load quality settings from config file, returns false if not available
+#endif
+static void SaveQualitySettings(const char *fileName, QualitySettings settings);   // Save quality settings to config file
+static void SetQualitySettings(QualitySettings settings, StreamTexture *streams, int count);   // Apply quality settings: scene target, vsync and textures sampling
+static SceneTarget LoadSceneTarget(int screenWidth, int screenHeight, float scale, int samples);  // Load scene render target (scaled, multisampled)
+static void UnloadSceneTarget(SceneTarget target);          // Unload scene render target (VRAM)
+static void BeginSceneTarget(SceneTarget target);           // Begin drawing scene into render target
+static void EndSceneTarget(SceneTarget target);             // End drawing scene, resolve and upscale it to window
+static void SetTextureFilter(Texture2D texture, int filter, int anisotropy, float lodBias);    // Set texture filter mode, anisotropy and mipmap level bias
+static void StartQualityProbe(QualityProbe *probe);         // Start hardware probe, most expensive preset first
+static bool UpdateQualityProbe(QualityProbe *probe, float frameTime);   // Register probe frame time (ms), returns true if probed preset changed
+
+// Frame stats: frame times, memory usage and VRAM counters
+//----------------------------------------------------------------------------------
+static void UpdateFrameStats(float frameTime);      // Register frame time (ms), reduce stats at sample end
+static float GetFrameTimePercentile(float *times, int count, float percentile); // Get frame times percentile (sorts times)
+static long GetMemoryUsage(void);                   // Get process memory usage, resident set size (bytes)
+
+// Debug output: driver debug messages and debug groups
+//----------------------------------------------------------------------------------
+static void InitDebugOutput(void);                  // Install driver debug messages callback (debug context required)
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam); // Driver debug messages callback
+static void BeginDebugGroup(const char *name);      // Begin debug group, visible on graphics debuggers
+static void EndDebugGroup(void);                    // End debug group
+
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+//----------------------------------------------------------------------------------
+static void UpdateBot(bool blocked);                // Update random-walk bot keys and mouse, new direction if blocked
+static void CheckSoakRegressions(void);             // Record last stats sample and check it against baseline
+#endif
 
 //----------------------------------------------------------------------------------
 // Main Entry point
@@ -250,16 +881,50 @@ int main(void)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
-    const int screenWidth = 800;
-    const int screenHeight = 450;
+    // Quality settings: loaded from config file, a hardware probe selects a preset on first launch
+    // NOTE: Window size is also read from config file (not probed)
+    QualitySettings settings = GetQualityPreset(QUALITY_HIGH, 800, 450);
+#if defined(SOAK_TEST)
+    bool probeRequired = false;     // Soak test runs with default settings, config file is not used
+#else
+    bool probeRequired = !LoadQualitySettings(QUALITY_SETTINGS_FILE, &settings);
+#endif
+    
+    const int screenWidth = settings.screenWidth;
+    const int screenHeight = settings.screenHeight;
     
     // LESSON 02: Window and graphic device initialization and management
     InitWindow(screenWidth, screenHeight);          // Initialize Window using GLFW3
     
     InitGraphicsDevice(screenWidth, screenHeight);  // Initialize graphic device (OpenGL)
     
+    // Start decoding all required images on worker threads, while the rest of resources are loaded
+    // NOTE: Streamed textures (tower, map atlas) are drawn with a placeholder mip tail until their levels
+    // are generated on worker threads, map image is waited for before map mesh generation
+    const char *imageFileNames[3] = { "resources/tower.png", "resources/cubemap_atlas01.png", "resources/map04.png" };
+
+#if defined(IMAGE_DECODE_BENCHMARK)
+    BenchmarkImageDecoding(imageFileNames, 3, 20);
+    CloseWindow();
+    return 0;
+#endif
+
+    Image imMap = { 0 };
+    ImageLoader mapLoader = { 0 };
+    BeginLoadImages(&mapLoader, &imageFileNames[2], &imMap, 1);
+    
+    StreamTexture texStreams[2] = { 0 };   // Streamed textures: tower, map atlas
+    ImageLoader streamLoader = { 0 };
+    BeginLoadTextureStreams(&streamLoader, imageFileNames, texStreams, 2);
+    
     // LESSON 03: Init default Shader (customized for GL 3.3 and ES2)
     shdrDefault = LoadShaderDefault();
+    
+    // Load per-frame uniform buffer (shared by all shaders)
+    InitFrameData();
+    
+    // Load bounding box proxy used on occlusion queries
+    InitOcclusionProxy();
 
     // Define our camera
     Camera camera;
@@ -273,111 +938,287 @@ int main(void)
     //matModelview = MatrixIdentity();
 
     // LESSON 04: Calculate 3D projection matrix (from perspective) and view matrix from camera look at
-    matProjection = MatrixPerspective(camera.fovy*DEG2RAD, (double)screenWidth/(double)screenHeight, 0.01, 1000.0);
+    // NOTE: Projection far plane is the draw distance from quality settings
+    matProjection = MatrixPerspective(camera.fovy*DEG2RAD, (double)screenWidth/(double)screenHeight, 0.01, settings.drawDistance);
     matModelview = MatrixLookAt(camera.position, camera.target, camera.up);
 
+#if defined(CULLING_BENCHMARK)
+    BenchmarkInstanceCulling(100000, 1000);
+    CloseWindow();
+    return 0;
+#endif
+
+#if defined(CLUSTER_BENCHMARK)
+    BenchmarkClusterCulling(128, 256, 1000);
+    CloseWindow();
+    return 0;
+#endif
+
     // LESSON 04: Load 3d model
     Mesh meshTower = LoadOBJ("resources/tower.obj");     // Load mesh data from OBJ file
+    OptimizeMesh(&meshTower);                            // Index mesh and reorder triangles for vertex cache and overdraw
+    GenMeshClusters(&meshTower);                         // Split mesh into clusters if large enough, culled independently
     UploadMeshData(&meshTower);                          // Upload mesh data to GPU memory (VRAM)
     
     // LESSON 04: Load model diffuse texture
-    Image imTower = LoadImage("resources/tower.png");
-    Texture2D texTower = LoadTexture(imTower.data, imTower.width, imTower.height, imTower.format);
-    UnloadImage(imTower);
+    // NOTE: Textures are streamed, mip tail is uploaded once generated and higher levels along next frames
+    Model modelTower = LoadModel(meshTower, texStreams[0].texture);
+    
+    Vector3 towerPosition = { 3.0f, 0.0f, 3.0f };
+    float towerScale = 0.1f;
+    BoundingBox towerBounds = modelTower.mesh.bounds;
+    towerBounds.min = Vector3Add(Vector3Scale(towerBounds.min, towerScale), towerPosition);
+    towerBounds.max = Vector3Add(Vector3Scale(towerBounds.max, towerScale), towerPosition);
+    
+    OcclusionQuery towerQuery = LoadOcclusionQuery(towerBounds);    // Tower is not drawn when hidden by maze walls
+    
+    // Props instances bounds, frustum culled together every frame
+    // NOTE: Tower is the only prop instance (index 0), any number of instances can be added
+    InstanceBounds propInstances = LoadInstanceBounds(1);
+    SetInstanceBounds(&propInstances, 0, modelTower.mesh, towerPosition, towerScale);
+    
+    int *visibleProps = (int *)malloc(propInstances.capacity*sizeof(int));
+    BoundingBox propBounds[1] = { towerBounds };    // Props instances boxes (world space), used on collisions
     
-    Model modelTower = LoadModel(meshTower, texTower);
+    // Scene tree for props queries (picking, player collisions)
+    // NOTE: Object ids stored in tree are props instances indices
+    AABBTree sceneTree = LoadAABBTree(16);
+    CreateAABBTreeProxy(&sceneTree, towerBounds, 0);
     
     // LESSON 05: Cubicmap generation
-    Image imMap = LoadImage("resources/map04.png");
+    EndLoadImages(&mapLoader);          // Wait for map image decoding
+    
+#if defined(VOXEL_MAZE)
+    // Voxel maze: cells grid from layer images, meshed by chunks with hidden faces removed
+    // NOTE: Map image is used for the two grid levels, any stack of same size images can be used
+    Image mapLayers[2] = { imMap, imMap };
+    VoxelMap voxelMap = LoadVoxelMap(mapLayers, 2);
+    Mesh meshMap = GenMeshVoxelMap(voxelMap, 1.0f);
+#else
     Mesh meshMap = GenMeshCubicmap(imMap, 1.0f);
+    GenMeshChunks(&meshMap, MESH_CHUNK_SIZE);           // Split map mesh into chunks, culled independently
+#endif
+    OptimizeMesh(&meshMap);                             // Index mesh and reorder chunks triangles for vertex cache
     UploadMeshData(&meshMap);
     
     // LESSON 07: Get map image data to be used for collision detection
-    Color *mapPixels = GetImageData(imMap);
-    UnloadImage(imMap);
+    // NOTE: Map image is kept loaded, pixel data is a view over image data (no copy)
+    Color *mapPixels = GetImageDataView(imMap);
     
-    // LESSON 05: Load cubicmap texture
-    Image imMapAtlas = LoadImage("resources/cubemap_atlas01.png");
-    Texture2D texMapAtlas = LoadTexture(imMapAtlas.data, imMapAtlas.width, imMapAtlas.height, imMapAtlas.format);
-    UnloadImage(imMapAtlas);
-    
-    Model modelMap = LoadModel(meshMap, texMapAtlas);
+    // LESSON 05: Load cubicmap texture (streamed)
+    Model modelMap = LoadModel(meshMap, texStreams[1].texture);
     
     Vector3 position = Vector3Zero();   // Model position on screen
+    
+    // Apply quality settings, hardware probe starts drawing the scene with most expensive preset
+    QualityProbe probe = { 0 };
+    
+    if (probeRequired)
+    {
+        StartQualityProbe(&probe);
+        
+        settings = GetQualityPreset(probe.preset, screenWidth, screenHeight);
+        settings.vsync = false;     // Probe measures frame times without waiting for vertical sync
+    }
+    
+    SetQualitySettings(settings, texStreams, 2);
+    matProjection = MatrixPerspective(camera.fovy*DEG2RAD, (double)screenWidth/(double)screenHeight, 0.01, settings.drawDistance);
 
-    SetTargetFPS(60);
+    SetTargetFPS(probe.active? 0 : 60);     // Probe frames are not limited
+    
+    // Scene resources drawn every frame
+    SceneResources scene = { &modelMap, position, &modelTower, towerPosition, towerScale, &towerQuery, texStreams, 2, &streamLoader };
+    
+#if defined(RENDER_THREAD)
+    // NOTE: OpenGL context is owned by render thread from now on, frames are drawn on this thread if it could not be started
+    RenderThread renderThread = { 0 };
+    StartRenderThread(&renderThread, scene);
+#endif
+    
+#if defined(SOAK_TEST)
+    soakFile = fopen("soak_stats.csv", "wt");
+    if (soakFile != NULL) fprintf(soakFile, "time,rss_bytes,vram_bytes,vram_available_bytes,p50_ms,p95_ms,p99_ms,max_ms,perf_messages,perf_messages_peak,error_messages\n");
+#endif
     //--------------------------------------------------------------------------------------    
 
     // Main game loop     
     while (!glfwWindowShouldClose(window))
     {
+        // Idle mode: game is paused while window is unfocused or iconified, frames are only
+        // drawn (not updated) when window contents get damaged (exposed or resized)
+        bool idle = IsWindowIdle();
+        if (idle && !WaitIdleEvents()) continue;
+        
         // Update
         //----------------------------------------------------------------------------------
-        Vector3 oldCamPos = camera.position;
-        
-        // LESSON 06: Camera update and modelview matrix update
-        UpdateCamera(&camera);
-        matModelview = MatrixLookAt(camera.position, camera.target, camera.up);
-        
-        // LESSON 07: Collisions detection and resolution
-        // Check player collision (we simplify to 2D collision detection)
-        Vector2 playerPos = { camera.position.x, camera.position.z };
-        float playerRadius = 0.1f;  // Collision radius (player is modelled as a cilinder for collision)
-        
-        int playerCellX = (int)(playerPos.x - position.x + 0.5f);
-        int playerCellY = (int)(playerPos.y - position.z + 0.5f);
-
-        // Out-of-limits security check
-        if (playerCellX < 0) playerCellX = 0;
-        else if (playerCellX >= imMap.width) playerCellX = imMap.width - 1;
-        
-        if (playerCellY < 0) playerCellY = 0;
-        else if (playerCellY >= imMap.height) playerCellY = imMap.height - 1;
-        
-        // Check map collisions using image data and player position
-        for (int y = 0; y < imMap.height; y++)
+        // NOTE: Game is paused on idle frames, last camera view is drawn
+        if (!idle)
         {
-            for (int x = 0; x < imMap.width; x++)
+            Vector3 oldCamPos = camera.position;
+            
+            // LESSON 06: Camera update and modelview matrix update
+            UpdateCamera(&camera);
+            matModelview = MatrixLookAt(camera.position, camera.target, camera.up);
+            
+            // LESSON 07: Collisions detection and resolution
+#if defined(VOXEL_MAZE)
+            // Check player collision against voxel map cells overlapped by player bounds (3D)
+            // NOTE: Player is modelled as a box from above the ground to over the eyes
+            BoundingBox playerBounds = { { camera.position.x - position.x - 0.1f, camera.position.y - position.y - 0.5f, camera.position.z - position.z - 0.1f }, 
+                                         { camera.position.x - position.x + 0.1f, camera.position.y - position.y + 0.1f, camera.position.z - position.z + 0.1f } };
+            
+            if (CheckCollisionVoxelMap(voxelMap, 1.0f, playerBounds)) camera.position = oldCamPos;
+#else
+            // Check player collision (we simplify to 2D collision detection)
+            Vector2 playerPos = { camera.position.x, camera.position.z };
+            float playerRadius = 0.1f;  // Collision radius (player is modelled as a cilinder for collision)
+            
+            int playerCellX = (int)(playerPos.x - position.x + 0.5f);
+            int playerCellY = (int)(playerPos.y - position.z + 0.5f);
+
+            // Out-of-limits security check
+            if (playerCellX < 0) playerCellX = 0;
+            else if (playerCellX >= imMap.width) playerCellX = imMap.width - 1;
+            
+            if (playerCellY < 0) playerCellY = 0;
+            else if (playerCellY >= imMap.height) playerCellY = imMap.height - 1;
+            
+            // Check map collisions using image data and player position
+            for (int y = 0; y < imMap.height; y++)
             {
-                if ((mapPixels[y*imMap.width + x].r == 255) &&          // Collider (white pixel)
-                    (CheckCollisionCircleRec(playerPos, playerRadius, 
-                    (Rectangle){ position.x + 0.5f + x*1.0f, position.y + 0.5f + y*1.0f, 1.0f, 1.0f })))
+                for (int x = 0; x < imMap.width; x++)
                 {
-                    // Collision detected, reset camera position
-                    camera.position = oldCamPos;
+                    if ((mapPixels[y*imMap.width + x].r == 255) &&          // Collider (white pixel)
+                        (CheckCollisionCircleRec(playerPos, playerRadius, 
+                        (Rectangle){ position.x + 0.5f + x*1.0f, position.y + 0.5f + y*1.0f, 1.0f, 1.0f })))
+                    {
+                        // Collision detected, reset camera position
+                        camera.position = oldCamPos;
+                    }
                 }
             }
+            
+            // TODO: Improvement: Just check player surrounding cells for collision
+            // NOTE: Be careful with map limits!
+            //for (int y = playerCellY - 1; y < playerCellX + 1; y++)
+            //    for (int x = playerCellX - 1; x < playerCellX + 1; x++)
+#endif
+            
+            // Check player collision against props: scene tree query for nearby props, then props boxes
+            // NOTE: Player is modelled as a box from above the ground to over the eyes
+            BoundingBox playerBox = { { camera.position.x - 0.1f, camera.position.y - 0.5f, camera.position.z - 0.1f }, 
+                                      { camera.position.x + 0.1f, camera.position.y + 0.1f, camera.position.z + 0.1f } };
+            int nearProps[8] = { 0 };
+            int nearPropCount = QueryAABBTreeBox(sceneTree, playerBox, nearProps, 8);
+            
+            for (int i = 0; i < nearPropCount; i++)
+            {
+                if (CheckCollisionBoxes(playerBox, propBounds[nearProps[i]])) camera.position = oldCamPos;
+            }
+            
+            // Picking: prop or maze wall under screen center (crosshair)
+            // NOTE: Maze walls are ray casted on map grid, only props nearer than hit wall are considered
+            if (IsMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT))
+            {
+                Ray ray = { camera.position, Vector3Normalize(Vector3Subtract(camera.target, camera.position)) };
+                
+                int cellX = 0, cellY = 0;
+                float wallDistance = GetRayCubicmapDistance(ray, mapPixels, imMap.width, imMap.height, position, 1.0f, PICKING_DISTANCE, &cellX, &cellY);
+                
+                float propDistance = 0.0f;
+                int prop = RaycastAABBTree(sceneTree, ray, (wallDistance >= 0.0f)? wallDistance : PICKING_DISTANCE, &propDistance);
+                
+                if (prop != -1) TraceLog(LOG_INFO, "PICKING: Prop %i picked (distance: %.2f)", prop, propDistance);
+                else if (wallDistance >= 0.0f) TraceLog(LOG_INFO, "PICKING: Wall cell [%i, %i] picked (distance: %.2f)", cellX, cellY, wallDistance);
+            }
+            
+#if defined(SOAK_TEST)
+            // Random-walk bot drives player inputs, it changes direction when movement was undone
+            UpdateBot((camera.position.x == oldCamPos.x) && (camera.position.z == oldCamPos.z));
+#endif
         }
-        
-        // TODO: Improvement: Just check player surrounding cells for collision
-        // NOTE: Be careful with map limits!
-        //for (int y = playerCellY - 1; y < playerCellX + 1; y++)
-        //    for (int x = playerCellX - 1; x < playerCellX + 1; x++)
         //----------------------------------------------------------------------------------
 
         // Draw
         //----------------------------------------------------------------------------------
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);         // Clear used buffers: Color and Depth (Depth is used for 3D)
+        // Props instances frustum culling, visible props are occlusion culled when drawn
+        Frustum frustum = ExtractFrustum(MatrixMultiply(matModelview, matProjection));
+        
+        int visiblePropCount = CullInstances(propInstances, frustum, visibleProps);
+        bool towerInFrustum = false;
         
-        // LESSON 03: Draw loaded texture on screen
-        //DrawTexture(texture, position, WHITE);
+        for (int i = 0; i < visiblePropCount; i++) if (visibleProps[i] == 0) towerInFrustum = true;
         
-        // LESSON 04: Draw loaded 3d models
-        DrawModel(modelMap, position, 1.0f, WHITE);
-        DrawModel(modelTower, (Vector3){ 3, 0, 3 }, 0.1f, WHITE);
+        SceneFrame frame = { matModelview, matProjection, camera.position, frustum, (float)glfwGetTime(), towerInFrustum, settings, probe.active };
         
-        glfwSwapBuffers(window);            // Swap buffers: show back buffer into front
+#if defined(RENDER_THREAD)
+        SubmitRenderFrame(&renderThread, frame);    // Render thread draws frame while next frame is updated
+#else
+        DrawSceneFrame(scene, frame);       // Draw scene, stream textures and swap buffers
+#endif
         PollInputEvents();                  // Register input events (keyboard, mouse)
         SyncFrame();                        // Wait required time to target framerate
+        
+        // Hardware probe: presets are drawn from most expensive one until frame time target is met,
+        // selected preset is saved to config file and vsync and framerate limit are restored
+        // NOTE: Settings are applied when next frame is drawn, with render thread frame time is bounded
+        // by render thread drawing (one frame behind at most)
+        if (probe.active)
+        {
+            bool presetChanged = UpdateQualityProbe(&probe, (float)frameTime*1000.0f);
+            
+            if (presetChanged || !probe.active)
+            {
+                settings = GetQualityPreset(probe.preset, screenWidth, screenHeight);
+                settings.vsync = !probe.active;
+                
+                matProjection = MatrixPerspective(camera.fovy*DEG2RAD, (double)screenWidth/(double)screenHeight, 0.01, settings.drawDistance);
+                
+                if (!probe.active)
+                {
+                    SaveQualitySettings(QUALITY_SETTINGS_FILE, settings);
+                    SetTargetFPS(60);
+                }
+            }
+        }
         //----------------------------------------------------------------------------------
     }
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+#if defined(RENDER_THREAD)
+    StopRenderThread(&renderThread);    // Last frame is drawn, OpenGL context is back on this thread
+#endif
+    UnloadImageDataView(imMap, mapPixels);  // Unload map pixel data (only if converted)
+    UnloadImage(imMap);             // Unload map image data
+#if defined(VOXEL_MAZE)
+    UnloadVoxelMap(voxelMap);       // Unload voxel map cells
+#endif
+    
+    EndLoadImages(&streamLoader);   // Wait for streamed textures levels generation (if still running)
+    for (int i = 0; i < 2; i++) UnloadTextureStream(&texStreams[i]);   // Unload levels not streamed yet (RAM)
+    
     UnloadModel(modelMap);         // Unload model data (includes texture unloading)
     UnloadModel(modelTower);         // Unload model data (includes texture unloading)
+    UnloadOcclusionQuery(towerQuery);   // Unload tower occlusion query
+    UnloadInstanceBounds(propInstances);    // Unload props instances bounds
+    UnloadAABBTree(sceneTree);          // Unload scene tree nodes
+    free(visibleProps);
 
     CloseWindow();
+    
+    TraceLog(LOG_INFO, "STATS: Frame time p50: %.2f ms, p99: %.2f ms, max: %.2f ms, memory: %li KB", 
+             frameStats.p50, frameStats.p99, frameStats.maxTime, GetMemoryUsage()/1024);
+    TraceLog(LOG_INFO, "STATS: Driver performance messages: %i (peak %i per frame), errors: %i", 
+             frameStats.perfMessages, frameStats.perfMessagesPeak, frameStats.errorMessages);
+    
+#if defined(SOAK_TEST)
+    if (soakFile != NULL) fclose(soakFile);
+    
+    TraceLog(LOG_INFO, "SOAK: Test finished, %i samples recorded, %i regressions detected", frameStats.sampleCount, soakRegressions);
+    
+    return (soakRegressions > 0)? 1 : 0;
+#endif
     //--------------------------------------------------------------------------------------
     
     return 0;
@@ -416,6 +1257,12 @@ static void MouseCursorPosCallback(GLFWwindow *window, double x, double y)
     //mousePosition.y = (float)y;
 }
 
+// GLFW3: Window refresh callback, window contents damaged (exposed or resized)
+static void WindowRefreshCallback(GLFWwindow *window)
+{
+    windowRefresh = true;
+}
+
 // Show trace log messages (LOG_INFO, LOG_WARNING, LOG_ERROR, LOG_DEBUG)
 void TraceLog(int msgType, const char *text, ...)
 {
@@ -450,12 +1297,17 @@ static void InitWindow(int width, int height)
     if (!glfwInit()) TraceLog(LOG_WARNING, "GLFW3: Can not initialize GLFW");
     else TraceLog(LOG_INFO, "GLFW3: GLFW initialized successfully");
     
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_SAMPLES, 0);               // Anti-aliasing is applied on scene render target (quality settings)
     glfwWindowHint(GLFW_DEPTH_BITS, 16);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#if !defined(NDEBUG)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);     // Debug context, release builds (-DNDEBUG) use a regular context
+#endif
+#if defined(SOAK_TEST)
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);         // Soak test runs headless, window is never shown
+#endif
    
     window = glfwCreateWindow(width, height, "CHALLENGE 03: 3D MAZE GAME", NULL, NULL);
     
@@ -467,6 +1319,7 @@ static void InitWindow(int width, int height)
     glfwSetKeyCallback(window, KeyCallback);                    // Track keyboard events
     glfwSetMouseButtonCallback(window, MouseButtonCallback);    // Track mouse button events
     glfwSetCursorPosCallback(window, MouseCursorPosCallback);   // Track mouse position changes
+    glfwSetWindowRefreshCallback(window, WindowRefreshCallback);    // Track window contents damage (exposed, resized)
     
     //glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);// Disable cursor for first person camera
     
@@ -481,6 +1334,34 @@ static void InitGraphicsDevice(int width, int height)
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) TraceLog(LOG_WARNING, "GLAD: Cannot load OpenGL extensions");
     else TraceLog(LOG_INFO, "GLAD: OpenGL extensions loaded successfully");
     
+    // Install driver debug messages callback (debug context only)
+    InitDebugOutput();
+    
+    // Load multi-draw indirect entry point (OpenGL 4.3), chunked meshes are drawn with per-chunk draw calls if not available
+    int versionMajor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR);
+    int versionMinor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MINOR);
+    
+    if ((versionMajor > 4) || ((versionMajor == 4) && (versionMinor >= 3)) || glfwExtensionSupported("GL_ARB_multi_draw_indirect"))
+    {
+        multiDrawArraysIndirect = (PFNMULTIDRAWARRAYSINDIRECTPROC)glfwGetProcAddress("glMultiDrawArraysIndirect");
+        multiDrawElementsIndirect = (PFNMULTIDRAWELEMENTSINDIRECTPROC)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        
+        if (multiDrawElementsIndirect == NULL) multiDrawArraysIndirect = NULL;
+    }
+    
+    if (multiDrawArraysIndirect != NULL) TraceLog(LOG_INFO, "GPU: Multi-draw indirect supported");
+    else TraceLog(LOG_INFO, "GPU: Multi-draw indirect not supported, using per-chunk draw calls");
+    
+    // Get quality settings limits: multisample samples and textures anisotropy
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    
+    if (glfwExtensionSupported("GL_EXT_texture_filter_anisotropic") || glfwExtensionSupported("GL_ARB_texture_filter_anisotropic"))
+    {
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+    }
+    
+    TraceLog(LOG_INFO, "GPU: Max MSAA samples: %i, max anisotropy: %.0fx", maxSamples, maxAnisotropy);
+    
     // Print current OpenGL and GLSL version
     TraceLog(LOG_INFO, "GPU: Vendor:   %s", glGetString(GL_VENDOR));
     TraceLog(LOG_INFO, "GPU: Renderer: %s", glGetString(GL_RENDERER));
@@ -525,6 +1406,16 @@ static void CloseWindow(void)
     // LESSON 03: Unload default shader
     glUseProgram(0);
     glDeleteProgram(shdrDefault.id);
+    
+    // Unload per-frame uniform buffer
+    glDeleteBuffers(1, &frameDataUbo);
+    
+    // Unload occlusion queries bounding box proxy
+    glDeleteBuffers(1, &occlusionBoxVbo);
+    glDeleteVertexArrays(1, &occlusionBoxVao);
+    
+    // Unload scene render target
+    UnloadSceneTarget(sceneTarget);
 
     glfwDestroyWindow(window);      // Close window
     glfwTerminate();                // Free GLFW3 resources
@@ -544,6 +1435,9 @@ static void SyncFrame(void)
     currentTime = glfwGetTime();
     frameTime = currentTime - previousTime;
     previousTime = currentTime;
+    
+    // Register frame time before waiting, it measures the frame work time
+    UpdateFrameStats((float)frameTime*1000.0f);
 
     // Wait for some milliseconds...
     if (frameTime < targetTime)
@@ -562,11 +1456,40 @@ static void SyncFrame(void)
     }
 }
 
+// Check if window is unfocused or iconified (idle mode)
+static bool IsWindowIdle(void)
+{
+#if defined(SOAK_TEST)
+    return false;       // Soak test window is hidden, it never gets focus
+#else
+    return (!glfwGetWindowAttrib(window, GLFW_FOCUSED) || glfwGetWindowAttrib(window, GLFW_ICONIFIED));
+#endif
+}
+
+// Wait for window events while idle, returns true if a redraw is required
+// NOTE: Thread sleeps until an event arrives or wait time ends, idle time is not registered as frame time
+static bool WaitIdleEvents(void)
+{
+    glfwWaitEventsTimeout(glfwGetWindowAttrib(window, GLFW_ICONIFIED)? IDLE_WAIT_TIME_ICONIFIED : IDLE_WAIT_TIME_UNFOCUSED);
+    
+    PollInputEvents();
+    
+    previousTime = glfwGetTime();
+    
+    bool redraw = windowRefresh && !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+    windowRefresh = false;
+    
+    return redraw;
+}
+
 // LESSON 02: Inputs management (keyboard and mouse)
 //----------------------------------------------------------------------------------
 // Detect if a key is being pressed (key held down)
 static bool IsKeyDown(int key)
 {
+#if defined(SOAK_TEST)
+    if (botKeyState[key]) return true;      // Key held down by autoplay bot
+#endif
     return glfwGetKey(window, key);
 }
 
@@ -602,6 +1525,11 @@ static Vector2 GetMousePosition(void)
     mousePosition.x = (float)mouseX;
     mousePosition.y = (float)mouseY;
     
+#if defined(SOAK_TEST)
+    mousePosition.x += botMousePosition.x;  // Mouse movement from autoplay bot
+    mousePosition.y += botMousePosition.y;
+#endif
+    
     return mousePosition;
 }
 
@@ -635,12 +1563,19 @@ static Shader LoadShaderDefault(void)
         "in vec3 vertexNormal;              \n"
         "out vec2 fragTexCoord;             \n"
         "out vec3 fragNormal;               \n"
-        "uniform mat4 mvp;                  \n"
+        "layout(std140) uniform FrameData   \n"
+        "{                                  \n"
+        "    mat4 matView;                  \n"
+        "    mat4 matProjection;            \n"
+        "    mat4 matViewProjection;        \n"
+        "    float time;                    \n"
+        "};                                 \n"
+        "uniform mat4 matModel;             \n"
         "void main()                        \n"
         "{                                  \n"
         "    fragTexCoord = vertexTexCoord; \n"
         "    fragNormal = vertexNormal;     \n"
-        "    gl_Position = mvp*vec4(vertexPosition, 1.0); \n"
+        "    gl_Position = matViewProjection*matModel*vec4(vertexPosition, 1.0); \n"
         "}                                  \n";
 
     // Fragment shader directly defined, no external file required
@@ -714,16 +1649,58 @@ static Shader LoadShaderDefault(void)
         shader.normalLoc = glGetAttribLocation(shader.id, "vertexNormal");
 
         // Get handles to GLSL uniform locations (vertex shader)
-        shader.mvpLoc  = glGetUniformLocation(shader.id, "mvp");
+        shader.modelLoc = glGetUniformLocation(shader.id, "matModel");
 
         // Get handles to GLSL uniform locations (fragment shader)
         shader.colorLoc = glGetUniformLocation(shader.id, "colDiffuse");
         shader.mapTextureLoc = glGetUniformLocation(shader.id, "texture0");
+        
+        // Bind per-frame uniform block to its binding point
+        // NOTE: GLSL 330 does not support layout(binding), it must be set after linking
+        unsigned int frameDataIndex = glGetUniformBlockIndex(shader.id, "FrameData");
+        if (frameDataIndex != GL_INVALID_INDEX) glUniformBlockBinding(shader.id, frameDataIndex, FRAME_DATA_BINDING);
+        
+        // Diffuse texture always fits in texture unit 0, set it once
+        glUseProgram(shader.id);
+        glUniform1i(shader.mapTextureLoc, 0);
+        glUseProgram(0);
     }
 
     return shader;
 }
 
+// Load per-frame uniform buffer and bind it to binding point
+// NOTE: Buffer is bound once, all shaders with FrameData block read from it
+static void InitFrameData(void)
+{
+    glGenBuffers(1, &frameDataUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameDataUbo);
+    glBufferData(GL_UNIFORM_BUFFER, FRAME_DATA_SIZE, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, frameDataUbo);
+    
+    vramUsage += FRAME_DATA_SIZE;
+    
+    TraceLog(LOG_INFO, "[UBO ID %i] Per-frame uniform buffer loaded successfully", frameDataUbo);
+}
+
+// Update per-frame uniform buffer data
+// NOTE: Data is uploaded with std140 layout: view, projection, view-projection, time
+static void UpdateFrameData(Matrix view, Matrix projection, float time)
+{
+    float data[16*3 + 4] = { 0 };
+    
+    memcpy(data, MatrixToFloat(view), 16*sizeof(float));
+    memcpy(data + 16, MatrixToFloat(projection), 16*sizeof(float));
+    memcpy(data + 32, MatrixToFloat(MatrixMultiply(view, projection)), 16*sizeof(float));
+    data[48] = time;
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, frameDataUbo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, FRAME_DATA_SIZE, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 // Load image data to CPU memory (RAM)
 // NOTE: We use stb_image library to support multiple fileformats
 static Image LoadImage(const char *fileName)
@@ -749,8 +1726,33 @@ static Image LoadImage(const char *fileName)
             
             if (imFile != NULL)
             {
-                // NOTE: Using stb_image to load images (Supports: BMP, TGA, PNG, JPG, ...)
-                image.data = stbi_load_from_file(imFile, &imgWidth, &imgHeight, &imgBpp, 4);
+                if (strcmp(fileExt, ".png") == 0)
+                {
+                    // NOTE: PNG images are decoded from memory with fast inflate and SIMD unfiltering,
+                    // stb_image is used for PNG variants not supported (bit depth other than 8, interlaced)
+                    fseek(imFile, 0, SEEK_END);
+                    int dataSize = (int)ftell(imFile);
+                    fseek(imFile, 0, SEEK_SET);
+                    
+                    unsigned char *fileData = (unsigned char *)malloc(dataSize);
+                    
+                    if (fread(fileData, 1, dataSize, imFile) == (size_t)dataSize)
+                    {
+                        image = LoadImagePNG(fileData, dataSize);
+                        
+                        imgWidth = image.width;
+                        imgHeight = image.height;
+                        
+                        if (image.data == NULL) image.data = stbi_load_from_memory(fileData, dataSize, &imgWidth, &imgHeight, &imgBpp, 4);
+                    }
+                    
+                    free(fileData);
+                }
+                else
+                {
+                    // NOTE: Using stb_image to load images (Supports: BMP, TGA, JPG, ...)
+                    image.data = stbi_load_from_file(imFile, &imgWidth, &imgHeight, &imgBpp, 4);
+                }
                 
                 fclose(imFile);
 
@@ -772,1068 +1774,4959 @@ static void UnloadImage(Image image)
     if (image.data != NULL) free(image.data);
 }
 
-// Get pixel data from image as Color array
-static Color *GetImageData(Image image)
+// Start decoding images on worker threads
+// NOTE: Images are available once EndLoadImages() returns; one worker thread per image is
+// used up to MAX_IMAGE_LOADER_THREADS, images are decoded on calling thread if threads can't be created
+static void BeginLoadImages(ImageLoader *loader, const char **fileNames, Image *images, int count)
 {
-    Color *pixels = (Color *)malloc(image.width*image.height*sizeof(Color));
+    loader->fileNames = fileNames;
+    loader->images = images;
+    loader->count = count;
+    loader->next = 0;
+    loader->threadCount = 0;
+    
+    pthread_mutex_init(&loader->mutex, NULL);
+    
+    for (int i = 0; (i < count) && (i < MAX_IMAGE_LOADER_THREADS); i++)
+    {
+        if (pthread_create(&loader->threads[loader->threadCount], NULL, LoadImagesWorker, loader) == 0) loader->threadCount++;
+        else break;
+    }
+    
+    if (loader->threadCount == 0)
+    {
+        TraceLog(LOG_WARNING, "Image loader threads could not be created, decoding on main thread");
+        LoadImagesWorker(loader);
+    }
+}
 
-    int k = 0;
+// Wait for all images to be decoded
+static void EndLoadImages(ImageLoader *loader)
+{
+    for (int i = 0; i < loader->threadCount; i++) pthread_join(loader->threads[i], NULL);
+    
+    loader->threadCount = 0;
+    pthread_mutex_destroy(&loader->mutex);
+}
 
-    for (int i = 0; i < image.width*image.height; i++)
+// Image loader worker thread: decode images until none left
+// NOTE: stb_image decoding functions are reentrant (only failure reason is kept in a global)
+static void *LoadImagesWorker(void *data)
+{
+    ImageLoader *loader = (ImageLoader *)data;
+    
+    while (true)
     {
-        switch (image.format)
+        pthread_mutex_lock(&loader->mutex);
+        int index = loader->next++;
+        pthread_mutex_unlock(&loader->mutex);
+        
+        if (index >= loader->count) break;
+        
+        Image image = LoadImage(loader->fileNames[index]);
+        
+        if (loader->streams != NULL)
         {
-            case UNCOMPRESSED_GRAYSCALE:
-            {
-                pixels[i].r = ((unsigned char *)image.data)[k];
-                pixels[i].g = ((unsigned char *)image.data)[k];
-                pixels[i].b = ((unsigned char *)image.data)[k];
-                pixels[i].a = 255;
-
-                k++;
-            } break;
-            case UNCOMPRESSED_GRAY_ALPHA:
-            {
-                pixels[i].r = ((unsigned char *)image.data)[k];
-                pixels[i].g = ((unsigned char *)image.data)[k];
-                pixels[i].b = ((unsigned char *)image.data)[k];
-                pixels[i].a = ((unsigned char *)image.data)[k + 1];
-
-                k += 2;
-            } break;
-            case UNCOMPRESSED_R5G5B5A1:
-            {
-                unsigned short pixel = ((unsigned short *)image.data)[k];
-
-                pixels[i].r = (unsigned char)((float)((pixel & 0b1111100000000000) >> 11)*(255/31));
-                pixels[i].g = (unsigned char)((float)((pixel & 0b0000011111000000) >> 6)*(255/31));
-                pixels[i].b = (unsigned char)((float)((pixel & 0b0000000000111110) >> 1)*(255/31));
-                pixels[i].a = (unsigned char)((pixel & 0b0000000000000001)*255);
-
-                k++;
-            } break;
-            case UNCOMPRESSED_R5G6B5:
-            {
-                unsigned short pixel = ((unsigned short *)image.data)[k];
-
-                pixels[i].r = (unsigned char)((float)((pixel & 0b1111100000000000) >> 11)*(255/31));
-                pixels[i].g = (unsigned char)((float)((pixel & 0b0000011111100000) >> 5)*(255/63));
-                pixels[i].b = (unsigned char)((float)(pixel & 0b0000000000011111)*(255/31));
-                pixels[i].a = 255;
-
-                k++;
-            } break;
-            case UNCOMPRESSED_R4G4B4A4:
-            {
-                unsigned short pixel = ((unsigned short *)image.data)[k];
-
-                pixels[i].r = (unsigned char)((float)((pixel & 0b1111000000000000) >> 12)*(255/15));
-                pixels[i].g = (unsigned char)((float)((pixel & 0b0000111100000000) >> 8)*(255/15));
-                pixels[i].b = (unsigned char)((float)((pixel & 0b0000000011110000) >> 4)*(255/15));
-                pixels[i].a = (unsigned char)((float)(pixel & 0b0000000000001111)*(255/15));
-
-                k++;
-            } break;
-            case UNCOMPRESSED_R8G8B8A8:
-            {
-                pixels[i].r = ((unsigned char *)image.data)[k];
-                pixels[i].g = ((unsigned char *)image.data)[k + 1];
-                pixels[i].b = ((unsigned char *)image.data)[k + 2];
-                pixels[i].a = ((unsigned char *)image.data)[k + 3];
-
-                k += 4;
-            } break;
-            case UNCOMPRESSED_R8G8B8:
-            {
-                pixels[i].r = (unsigned char)((unsigned char *)image.data)[k];
-                pixels[i].g = (unsigned char)((unsigned char *)image.data)[k + 1];
-                pixels[i].b = (unsigned char)((unsigned char *)image.data)[k + 2];
-                pixels[i].a = 255;
-
-                k += 3;
-            } break;
-            default: TraceLog(LOG_WARNING, "Format not supported for pixel data retrieval"); break;
+            // Generate streamed texture levels, decoded image is not required anymore
+            GenTextureStreamLevels(&loader->streams[index], image);
+            UnloadImage(image);
+            
+            pthread_mutex_lock(&loader->mutex);
+            loader->streams[index].loaded = true;
+            pthread_mutex_unlock(&loader->mutex);
         }
+        else loader->images[index] = image;
     }
-
-    return pixels;
+    
+    return NULL;
 }
 
-// Load texture data in GPU memory (VRAM)
-static Texture2D LoadTexture(unsigned char *data, int width, int height, int format)
+// Load streamed textures with placeholder mip tail, start decoding and levels generation on worker threads
+// NOTE: Textures size is read from image file header, textures can be drawn while levels are generated;
+// mip tail is uploaded by UpdateLoadTextureStreams() once available, worker threads are joined with EndLoadImages()
+static void BeginLoadTextureStreams(ImageLoader *loader, const char **fileNames, StreamTexture *streams, int count)
 {
-    Texture2D texture = { 0 };
+    for (int i = 0; i < count; i++)
+    {
+        int width = 1;
+        int height = 1;
+        int components = 0;
+        
+        if (!stbi_info(fileNames[i], &width, &height, &components)) TraceLog(LOG_WARNING, "[%s] Texture stream image size could not be read", fileNames[i]);
+        
+        streams[i] = LoadTextureStream(width, height);
+    }
     
-    // NOTE: Texture2D struct is defined inside rlgl
-    texture.width = width;
-    texture.height = height;
-    texture.format = UNCOMPRESSED_R8G8B8A8;
-    texture.mipmaps = 1;
-    
-    glBindTexture(GL_TEXTURE_2D, 0);    // Free any old binding
-
-    glGenTextures(1, &texture.id);              // Generate Pointer to the texture
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+    loader->streams = streams;
+    BeginLoadImages(loader, fileNames, NULL, count);
+}
 
-    switch (format)
+// Upload mip tail of streamed textures with levels already generated by worker threads
+// NOTE: Placeholder mip tail is replaced, higher levels are uploaded by UpdateTextureStreaming()
+static void UpdateLoadTextureStreams(ImageLoader *loader)
+{
+    for (int i = 0; i < loader->count; i++)
     {
-        case UNCOMPRESSED_GRAYSCALE:
+        StreamTexture *stream = &loader->streams[i];
+        
+        if (!stream->loading) continue;
+        
+        pthread_mutex_lock(&loader->mutex);
+        bool loaded = stream->loaded;
+        pthread_mutex_unlock(&loader->mutex);
+        
+        if (!loaded) continue;
+        
+        stream->loading = false;
+        
+        if (stream->levels[0] == NULL)
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, (unsigned char *)data);
-
-            // With swizzleMask we define how a one channel texture will be mapped to RGBA
-            // Required GL >= 3.3 or EXT_texture_swizzle/ARB_texture_swizzle
-            GLint swizzleMask[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
-            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
+            TraceLog(LOG_WARNING, "[TEX ID %i] Texture stream levels could not be generated, placeholder kept", stream->texture.id);
+            continue;
+        }
+        
+        glBindTexture(GL_TEXTURE_2D, stream->texture.id);
+        
+        for (int level = stream->residentLevel; level < stream->texture.mipmaps; level++)
+        {
+            int levelWidth = stream->texture.width >> level, levelHeight = stream->texture.height >> level;
+            if (levelWidth < 1) levelWidth = 1;
+            if (levelHeight < 1) levelHeight = 1;
+            
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight, GL_RGBA, GL_UNSIGNED_BYTE, stream->levels[level]);
+            
+            free(stream->levels[level]);
+            stream->levels[level] = NULL;
+        }
+        
+        glBindTexture(GL_TEXTURE_2D, 0);
+        
+        TraceLog(LOG_INFO, "[TEX ID %i] Texture stream mip tail loaded (level %i resident)", stream->texture.id, stream->residentLevel);
+    }
+}
 
-            TraceLog(LOG_INFO, "[TEX ID %i] Grayscale texture loaded and swizzled", texture.id);
-        } break;
-        case UNCOMPRESSED_GRAY_ALPHA:
+#if defined(IMAGE_DECODE_BENCHMARK)
+// Measure images decoding throughput (MB/s), sequential and parallel
+// NOTE: Throughput is measured over compressed input data (file size) and decoded output data (RGBA)
+static void BenchmarkImageDecoding(const char **fileNames, int count, int iterations)
+{
+    long inputSize = 0;
+    long outputSize = 0;
+    
+    for (int i = 0; i < count; i++)
+    {
+        FILE *imFile = fopen(fileNames[i], "rb");
+        
+        if (imFile != NULL)
+        {
+            fseek(imFile, 0, SEEK_END);
+            inputSize += ftell(imFile);
+            fclose(imFile);
+        }
+    }
+    
+    Image *images = (Image *)calloc(count, sizeof(Image));
+    
+    // NOTE: Modes: stb_image only (reference), sequential and parallel (PNG fast path)
+    const char *modeNames[3] = { "stb_image", "sequential", "parallel" };
+    
+    for (int mode = 0; mode < 3; mode++)
+    {
+        double startTime = glfwGetTime();
+        
+        for (int n = 0; n < iterations; n++)
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width, height, 0, GL_RG, GL_UNSIGNED_BYTE, (unsigned char *)data);
+            if (mode == 0)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    int imgWidth = 0, imgHeight = 0, imgBpp = 0;
+                    
+                    images[i].data = stbi_load(fileNames[i], &imgWidth, &imgHeight, &imgBpp, 4);
+                    images[i].width = imgWidth;
+                    images[i].height = imgHeight;
+                }
+            }
+            else if (mode == 1) for (int i = 0; i < count; i++) images[i] = LoadImage(fileNames[i]);
+            else
+            {
+                ImageLoader loader = { 0 };
+                BeginLoadImages(&loader, fileNames, images, count);
+                EndLoadImages(&loader);
+            }
+            
+            outputSize = 0;
+            for (int i = 0; i < count; i++)
+            {
+                outputSize += images[i].width*images[i].height*4;
+                UnloadImage(images[i]);
+            }
+        }
+        
+        double elapsedTime = glfwGetTime() - startTime;
+        
+        TraceLog(LOG_INFO, "BENCHMARK: Image decoding (%s): %i images x %i iterations in %.3f s, input: %.2f MB/s, output: %.2f MB/s", 
+                 modeNames[mode], count, iterations, elapsedTime, 
+                 (double)inputSize*iterations/(1024*1024)/elapsedTime, (double)outputSize*iterations/(1024*1024)/elapsedTime);
+    }
+    
+    free(images);
+}
+#endif
 
-            GLint swizzleMask[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
-            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
-        } break;
-        case UNCOMPRESSED_R5G6B5: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB565, width, height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, (unsigned short *)data); break;
-        case UNCOMPRESSED_R8G8B8: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, (unsigned char *)data); break;
-        case UNCOMPRESSED_R5G5B5A1: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, (unsigned short *)data); break;
-        case UNCOMPRESSED_R4G4B4A4: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA4, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, (unsigned short *)data); break;
-        case UNCOMPRESSED_R8G8B8A8: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (unsigned char *)data); break;
-        default: TraceLog(LOG_WARNING, "Texture format not recognized"); break;
-    }
-    
-    // Configure texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);       // Set texture to repeat on x-axis
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);       // Set texture to repeat on y-axis
-    // Magnification and minification filters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Alternative: GL_LINEAR
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);  // Alternative: GL_LINEAR
-    
-    // Unbind current texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+// Get pixel data from image as Color array
+// NOTE: Returned data must be freed by user, conversion kernel is selected once per image
+static Color *GetImageData(Image image)
+{
+    int pixelCount = image.width*image.height;
+    Color *pixels = (Color *)malloc(pixelCount*sizeof(Color));
 
-    if (texture.id > 0) TraceLog(LOG_INFO, "[TEX ID %i] Texture created successfully (%ix%i)", texture.id, width, height);
-    else TraceLog(LOG_WARNING, "Texture could not be created");
+    switch (image.format)
+    {
+        case UNCOMPRESSED_GRAYSCALE: ConvertGrayscale(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_GRAY_ALPHA: ConvertGrayAlpha(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_R5G6B5: ConvertR5G6B5(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_R8G8B8: ConvertR8G8B8(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_R5G5B5A1: ConvertR5G5B5A1(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_R4G4B4A4: ConvertR4G4B4A4(image.data, pixels, pixelCount); break;
+        case UNCOMPRESSED_R8G8B8A8: memcpy(pixels, image.data, pixelCount*sizeof(Color)); break;
+        default: TraceLog(LOG_WARNING, "Format not supported for pixel data retrieval"); break;
+    }
 
-    return texture;
+    return pixels;
 }
 
-// Unload texture data from GPU memory (VRAM)
-static void UnloadTexture(Texture2D texture)
+// Get pixel data from image as Color array, no copy if not required
+// NOTE: R8G8B8A8 image data is returned directly (valid while image is loaded),
+// other formats are converted; data must be unloaded with UnloadImageDataView()
+static Color *GetImageDataView(Image image)
 {
-    if (texture.id > 0) glDeleteTextures(1, &texture.id);
+    if (image.format == UNCOMPRESSED_R8G8B8A8) return (Color *)image.data;
+    else return GetImageData(image);
 }
 
-// Draw texture in screen position coordinates
-static void DrawTexture(Texture2D texture, Vector2 position, Color tint)
+// Unload pixel data returned by GetImageDataView()
+static void UnloadImageDataView(Image image, Color *pixels)
 {
-    glUseProgram(shdrDefault.id);
-
-    // Define translation matrix to translate quad to screen center
-    matModelview = MatrixTranslate(position.x, position.y, 0);
+    if ((pixels != NULL) && (pixels != (Color *)image.data)) free(pixels);
+}
 
-    // Create modelview-projection matrix
-    Matrix matMVP = MatrixMultiply(matModelview, matProjection);
+// Convert UNCOMPRESSED_GRAYSCALE pixels to R8G8B8A8
+static void ConvertGrayscale(const unsigned char *src, Color *dst, int count)
+{
+    int i = 0;
 
-    glUniformMatrix4fv(shdrDefault.mvpLoc, 1, false, MatrixToFloat(matMVP));
-    glUniform4f(shdrDefault.colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
-    glUniform1i(shdrDefault.mapTextureLoc, 0);
+#if defined(__SSE2__)
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+    
+    // Process 16 pixels per iteration: gray values are interleaved to (g, g) and (g, a) pairs
+    for (; (i + 16) <= count; i += 16)
+    {
+        __m128i gray = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i grayLo = _mm_unpacklo_epi8(gray, gray);
+        __m128i grayHi = _mm_unpackhi_epi8(gray, gray);
+        __m128i alphaLo = _mm_unpacklo_epi8(gray, alpha);
+        __m128i alphaHi = _mm_unpackhi_epi8(gray, alpha);
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(grayLo, alphaLo));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(grayLo, alphaLo));
+        _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(grayHi, alphaHi));
+        _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(grayHi, alphaHi));
+    }
+#endif
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glBindVertexArray(quadId);
-                
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            
-    glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
-    glBindVertexArray(0);               // Unbind VAO
-    glUseProgram(0);                    // Unbind shader program
+    for (; i < count; i++) dst[i] = (Color){ src[i], src[i], src[i], 255 };
 }
 
-// Load a quad to draw a texture
-// NOTE: We need to define positions, coordinates and normals (optional)
-static unsigned int LoadQuad(float width, float height)
+// Convert UNCOMPRESSED_GRAY_ALPHA pixels to R8G8B8A8
+static void ConvertGrayAlpha(const unsigned char *src, Color *dst, int count)
 {
-    unsigned int quadVAO = 0;       // Quad VAO id
-    unsigned int quadVBO = 0;       // Quad VBO id for individual buffer
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i lowMask = _mm_set1_epi16(0x00ff);
     
-    float vertices[] = {
-        // Positions - Texture Coords
-        0.0f,    0.0f, 0.0f,   0.0f, 0.0f,
-        0.0f,  height, 0.0f,   0.0f, 1.0f,
-        width,   0.0f, 0.0f,   1.0f, 0.0f,
-        width, height, 0.0f,   1.0f, 1.0f,
-    };
+    // Process 8 pixels per iteration: every 16bit lane holds one (g, a) pixel
+    for (; (i + 8) <= count; i += 8)
+    {
+        __m128i grayAlpha = _mm_loadu_si128((const __m128i *)(src + i*2));
+        __m128i gray = _mm_and_si128(grayAlpha, lowMask);
+        gray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(gray, grayAlpha));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(gray, grayAlpha));
+    }
+#endif
 
-    // Generate quad VAO/VBO ids
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
-    glBindVertexArray(quadVAO);
+    for (; i < count; i++) dst[i] = (Color){ src[i*2], src[i*2], src[i*2], src[i*2 + 1] };
+}
 
-    // Fill VBO buffer
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
+// Convert UNCOMPRESSED_R5G6B5 pixels to R8G8B8A8
+static void ConvertR5G6B5(const unsigned char *src, Color *dst, int count)
+{
+    const unsigned short *pixels = (const unsigned short *)src;
+    int i = 0;
 
-    // Link vertex attributes
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void *)(3*sizeof(float)));
+#if defined(__AVX2__)
+    // Process 16 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 16) <= count; i += 16)
+    {
+        __m256i pixel = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i r = _mm256_srli_epi16(pixel, 11);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixel, 5), _mm256_set1_epi16(0x3f));
+        __m256i b = _mm256_and_si256(pixel, _mm256_set1_epi16(0x1f));
+        
+        r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+        g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+        b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+        
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, _mm256_set1_epi16((short)0xff00));
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);     // Pixels 0..3, 8..11
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);     // Pixels 4..7, 12..15
+        
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+#endif
+#if defined(__SSE2__)
+    // Process 8 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 8) <= count; i += 8)
+    {
+        __m128i pixel = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i r = _mm_srli_epi16(pixel, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(pixel, 5), _mm_set1_epi16(0x3f));
+        __m128i b = _mm_and_si128(pixel, _mm_set1_epi16(0x1f));
+        
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+        
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, _mm_set1_epi16((short)0xff00));
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+#endif
 
-    return quadVAO;
+    for (; i < count; i++)
+    {
+        unsigned char r = (pixels[i] >> 11) & 0x1f;
+        unsigned char g = (pixels[i] >> 5) & 0x3f;
+        unsigned char b = pixels[i] & 0x1f;
+        
+        dst[i] = (Color){ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255 };
+    }
 }
-// LESSON 04: Model loading, vertex buffer creation
-//----------------------------------------------------------------------------------
-// Load static mesh from OBJ file (RAM)
-static Mesh LoadOBJ(const char *fileName)
+
+// Convert UNCOMPRESSED_R8G8B8 pixels to R8G8B8A8
+static void ConvertR8G8B8(const unsigned char *src, Color *dst, int count)
 {
-    Mesh mesh = { 0 };
+    int i = 0;
 
-    char dataType;
-    char comments[200];
+#if defined(__SSSE3__)
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    
+    // Process 4 pixels per iteration (loading 16 bytes, so 2 extra pixels must be available)
+    for (; (i + 6) <= count; i += 4)
+    {
+        __m128i rgb = _mm_loadu_si128((const __m128i *)(src + i*3));
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+    }
+#endif
 
-    int vertexCount = 0;
-    int normalCount = 0;
-    int texcoordCount = 0;
-    int triangleCount = 0;
+    for (; i < count; i++) dst[i] = (Color){ src[i*3], src[i*3 + 1], src[i*3 + 2], 255 };
+}
 
-    FILE *objFile = fopen(fileName, "rt");
+// Convert UNCOMPRESSED_R5G5B5A1 pixels to R8G8B8A8
+static void ConvertR5G5B5A1(const unsigned char *src, Color *dst, int count)
+{
+    const unsigned short *pixels = (const unsigned short *)src;
+    int i = 0;
 
-    if (objFile == NULL)
+#if defined(__AVX2__)
+    // Process 16 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 16) <= count; i += 16)
     {
-        TraceLog(LOG_WARNING, "[%s] OBJ file could not be opened", fileName);
-        return mesh;
+        __m256i pixel = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i r = _mm256_srli_epi16(pixel, 11);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixel, 6), _mm256_set1_epi16(0x1f));
+        __m256i b = _mm256_and_si256(_mm256_srli_epi16(pixel, 1), _mm256_set1_epi16(0x1f));
+        __m256i a = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_and_si256(pixel, _mm256_set1_epi16(0x01)));    // 0 or 0xffff
+        
+        r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+        g = _mm256_or_si256(_mm256_slli_epi16(g, 3), _mm256_srli_epi16(g, 2));
+        b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+        
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, _mm256_slli_epi16(a, 8));
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);     // Pixels 0..3, 8..11
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);     // Pixels 4..7, 12..15
+        
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
     }
-
-    // First reading pass: Get vertexCount, normalCount, texcoordCount, triangleCount
-    // NOTE: vertex, texcoords and normals could be optimized (to be used indexed on faces definition)
-    // NOTE: faces MUST be defined as TRIANGLES (3 vertex per face)
-    while (!feof(objFile))
+#endif
+#if defined(__SSE2__)
+    // Process 8 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 8) <= count; i += 8)
     {
-        dataType = '\0';
-        fscanf(objFile, "%c", &dataType);
-
-        switch (dataType)
-        {
-            case '#':   // Comments
-            case 'o':   // Object name (One OBJ file can contain multible named meshes)
-            case 'g':   // Group name
-            case 's':   // Smoothing level
-            case 'm':   // mtllib [external .mtl file name]
-            case 'u':   // usemtl [material name]
-            {
-                fgets(comments, 200, objFile);
-            } break;
-            case 'v':
-            {
-                fscanf(objFile, "%c", &dataType);
-
-                if (dataType == 't')    // Read texCoord
-                {
-                    texcoordCount++;
-                    fgets(comments, 200, objFile);
-                }
-                else if (dataType == 'n')    // Read normals
-                {
-                    normalCount++;
-                    fgets(comments, 200, objFile);
-                }
-                else    // Read vertex
-                {
-                    vertexCount++;
-                    fgets(comments, 200, objFile);
-                }
-            } break;
-            case 'f':
-            {
-                triangleCount++;
-                fgets(comments, 200, objFile);
-            } break;
-            default: break;
-        }
+        __m128i pixel = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i r = _mm_srli_epi16(pixel, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(pixel, 6), _mm_set1_epi16(0x1f));
+        __m128i b = _mm_and_si128(_mm_srli_epi16(pixel, 1), _mm_set1_epi16(0x1f));
+        __m128i a = _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(pixel, _mm_set1_epi16(0x01)));    // 0 or 0xffff
+        
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+        
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
     }
+#endif
 
-    TraceLog(LOG_DEBUG, "[%s] Mesh vertices: %i", fileName, vertexCount);
-    TraceLog(LOG_DEBUG, "[%s] Mesh texcoords: %i", fileName, texcoordCount);
-    TraceLog(LOG_DEBUG, "[%s] Mesh normals: %i", fileName, normalCount);
-    TraceLog(LOG_DEBUG, "[%s] Mesh triangles: %i", fileName, triangleCount);
-
-    // Once we know the number of vertices to store, we create required arrays
-    Vector3 *midVertices = (Vector3 *)malloc(vertexCount*sizeof(Vector3));
-    Vector3 *midNormals = NULL;
-    if (normalCount > 0) midNormals = (Vector3 *)malloc(normalCount*sizeof(Vector3));
-    Vector2 *midTexCoords = NULL;
-    if (texcoordCount > 0) midTexCoords = (Vector2 *)malloc(texcoordCount*sizeof(Vector2));
-
-    int countVertex = 0;
-    int countNormals = 0;
-    int countTexCoords = 0;
+    for (; i < count; i++)
+    {
+        unsigned char r = (pixels[i] >> 11) & 0x1f;
+        unsigned char g = (pixels[i] >> 6) & 0x1f;
+        unsigned char b = (pixels[i] >> 1) & 0x1f;
+        
+        dst[i] = (Color){ (r << 3) | (r >> 2), (g << 3) | (g >> 2), (b << 3) | (b >> 2), (pixels[i] & 0x01)? 255 : 0 };
+    }
+}
 
-    rewind(objFile);        // Return to the beginning of the file, to read again
+// Convert UNCOMPRESSED_R4G4B4A4 pixels to R8G8B8A8
+static void ConvertR4G4B4A4(const unsigned char *src, Color *dst, int count)
+{
+    const unsigned short *pixels = (const unsigned short *)src;
+    int i = 0;
 
-    // Second reading pass: Get vertex data to fill intermediate arrays
-    // NOTE: This second pass is required in case of multiple meshes defined in same OBJ
-    while (!feof(objFile))
+#if defined(__AVX2__)
+    // Process 16 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 16) <= count; i += 16)
     {
-        fscanf(objFile, "%c", &dataType);
-
-        switch (dataType)
-        {
-            case '#': case 'o': case 'g': case 's': case 'm': case 'u': case 'f': fgets(comments, 200, objFile); break;
-            case 'v':
-            {
-                fscanf(objFile, "%c", &dataType);
+        __m256i pixel = _mm256_loadu_si256((const __m256i *)(pixels + i));
+        __m256i mask = _mm256_set1_epi16(0x0f);
+        __m256i r = _mm256_srli_epi16(pixel, 12);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(pixel, 8), mask);
+        __m256i b = _mm256_and_si256(_mm256_srli_epi16(pixel, 4), mask);
+        __m256i a = _mm256_and_si256(pixel, mask);
+        
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, _mm256_slli_epi16(a, 8));
+        rg = _mm256_or_si256(rg, _mm256_slli_epi16(rg, 4));     // 4bit expansion: x*17
+        ba = _mm256_or_si256(ba, _mm256_slli_epi16(ba, 4));
+        
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);     // Pixels 0..3, 8..11
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);     // Pixels 4..7, 12..15
+        
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+#endif
+#if defined(__SSE2__)
+    // Process 8 pixels per iteration, channels expanded in 16bit lanes
+    for (; (i + 8) <= count; i += 8)
+    {
+        __m128i pixel = _mm_loadu_si128((const __m128i *)(pixels + i));
+        __m128i mask = _mm_set1_epi16(0x0f);
+        __m128i r = _mm_srli_epi16(pixel, 12);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(pixel, 8), mask);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(pixel, 4), mask);
+        __m128i a = _mm_and_si128(pixel, mask);
+        
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        rg = _mm_or_si128(rg, _mm_slli_epi16(rg, 4));     // 4bit expansion: x*17
+        ba = _mm_or_si128(ba, _mm_slli_epi16(ba, 4));
+        
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+#endif
 
-                if (dataType == 't')    // Read texCoord
-                {
-                    fscanf(objFile, "%f %f%*[^\n]s\n", &midTexCoords[countTexCoords].x, &midTexCoords[countTexCoords].y);
-                    countTexCoords++;
+    for (; i < count; i++)
+    {
+        unsigned char r = (pixels[i] >> 12) & 0x0f;
+        unsigned char g = (pixels[i] >> 8) & 0x0f;
+        unsigned char b = (pixels[i] >> 4) & 0x0f;
+        unsigned char a = pixels[i] & 0x0f;
+        
+        dst[i] = (Color){ r*17, g*17, b*17, a*17 };
+    }
+}
 
-                    fscanf(objFile, "%c", &dataType);
-                }
-                else if (dataType == 'n')    // Read normals
-                {
-                    fscanf(objFile, "%f %f %f", &midNormals[countNormals].x, &midNormals[countNormals].y, &midNormals[countNormals].z);
-                    countNormals++;
-
-                    fscanf(objFile, "%c", &dataType);
-                }
-                else    // Read vertex
-                {
-                    fscanf(objFile, "%f %f %f", &midVertices[countVertex].x, &midVertices[countVertex].y, &midVertices[countVertex].z);
-                    countVertex++;
-
-                    fscanf(objFile, "%c", &dataType);
-                }
-            } break;
-            default: break;
+// Load PNG image from memory (8bit, non-interlaced), returns empty image if not supported
+// NOTE: Image data is inflated in a single pass (all IDAT chunks joined), scanlines are unfiltered
+// and converted to R8G8B8A8; chunks CRC is not checked
+static Image LoadImagePNG(const unsigned char *fileData, int dataSize)
+{
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    
+    Image image = { 0 };
+    
+    if ((dataSize < 8) || (memcmp(fileData, signature, 8) != 0)) return image;
+    
+    int width = 0;
+    int height = 0;
+    int bitDepth = 0;
+    int colorType = 0;
+    int interlace = 1;
+    bool colorKey = false;              // Transparent color defined (tRNS on grayscale/RGB images)
+    
+    Color palette[256];
+    for (int i = 0; i < 256; i++) palette[i] = (Color){ 0, 0, 0, 255 };
+    
+    unsigned char *idat = NULL;         // Joined IDAT chunks (zlib stream)
+    int idatSize = 0;
+    int idatCapacity = 0;
+    
+    const unsigned char *chunk = fileData + 8;
+    const unsigned char *dataEnd = fileData + dataSize;
+    
+    while ((dataEnd - chunk) >= 12)
+    {
+        unsigned int length = ((unsigned int)chunk[0] << 24) | (chunk[1] << 16) | (chunk[2] << 8) | chunk[3];
+        const unsigned char *type = chunk + 4;
+        const unsigned char *data = chunk + 8;
+        
+        if (length > (unsigned int)(dataEnd - chunk - 12)) break;   // Truncated chunk
+        
+        if ((memcmp(type, "IHDR", 4) == 0) && (length >= 13))
+        {
+            width = (int)(((unsigned int)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+            height = (int)(((unsigned int)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7]);
+            bitDepth = data[8];
+            colorType = data[9];
+            interlace = ((data[10] != 0) || (data[11] != 0))? 1 : data[12];    // Compression and filter methods must be 0
+        }
+        else if (memcmp(type, "PLTE", 4) == 0)
+        {
+            for (unsigned int i = 0; (i < length/3) && (i < 256); i++) palette[i] = (Color){ data[i*3], data[i*3 + 1], data[i*3 + 2], 255 };
+        }
+        else if (memcmp(type, "tRNS", 4) == 0)
+        {
+            if (colorType == 3) for (unsigned int i = 0; (i < length) && (i < 256); i++) palette[i].a = data[i];
+            else colorKey = true;
+        }
+        else if ((memcmp(type, "IDAT", 4) == 0) && (length > 0))
+        {
+            if ((idatSize + (int)length) > idatCapacity)
+            {
+                idatCapacity = (idatCapacity == 0)? (int)length : idatCapacity;
+                while (idatCapacity < (idatSize + (int)length)) idatCapacity *= 2;
+                idat = (unsigned char *)realloc(idat, idatCapacity);
+            }
+            
+            memcpy(idat + idatSize, data, length);
+            idatSize += length;
         }
+        else if (memcmp(type, "IEND", 4) == 0) break;
+        
+        chunk += length + 12;
     }
-
-    // At this point all vertex data (v, vt, vn) has been gathered on midVertices, midTexCoords, midNormals
-    // Now we can organize that data into our Mesh struct
-
-    mesh.vertexCount = triangleCount*3;
-
-    // Additional arrays to store vertex data as floats
-    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
-    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
-    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
-
-    int vCounter = 0;       // Used to count vertices float by float
-    int tcCounter = 0;      // Used to count texcoords float by float
-    int nCounter = 0;       // Used to count normals float by float
-
-    int vCount[3], vtCount[3], vnCount[3];    // Used to store triangle indices for v, vt, vn
-
-    rewind(objFile);        // Return to the beginning of the file, to read again
-
-    if (normalCount == 0) TraceLog(LOG_INFO, "[%s] No normals data on OBJ, normals will be generated from faces data", fileName);
-
-    // Third reading pass: Get faces (triangles) data and fill VertexArray
-    while (!feof(objFile))
+    
+    // Channels per pixel by color type: grayscale (0), RGB (2), palette (3), grayscale-alpha (4), RGBA (6)
+    static const int channelsCount[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    int channels = ((colorType >= 0) && (colorType <= 6))? channelsCount[colorType] : 0;
+    
+    // NOTE: Other bit depths, interlaced images and color keys are not supported, stb_image is used
+    if ((idat == NULL) || (bitDepth != 8) || (interlace != 0) || (channels == 0) || colorKey || 
+        (width <= 0) || (height <= 0) || (width > 16384) || (height > 16384))
     {
-        fscanf(objFile, "%c", &dataType);
-
-        switch (dataType)
+        free(idat);
+        return image;
+    }
+    
+    int stride = width*channels;
+    int rawSize = (stride + 1)*height;      // Every scanline is prefixed by its filter type
+    unsigned char *raw = (unsigned char *)malloc(rawSize);
+    unsigned char *pixels = (unsigned char *)malloc(stride*height);
+    unsigned char *zeroRow = (unsigned char *)calloc(stride, 1);
+    bool success = (Inflate(idat, idatSize, raw, rawSize) == rawSize);
+    
+    for (int y = 0; success && (y < height); y++)
+    {
+        const unsigned char *scanline = raw + y*(stride + 1);
+        
+        if (scanline[0] > 4) success = false;
+        else UnfilterScanline(pixels + y*stride, scanline + 1, (y == 0)? zeroRow : pixels + (y - 1)*stride, stride, channels, scanline[0]);
+    }
+    
+    free(zeroRow);
+    free(raw);
+    free(idat);
+    
+    if (!success)
+    {
+        free(pixels);
+        return image;
+    }
+    
+    if (colorType == 6) image.data = pixels;
+    else
+    {
+        Color *colors = (Color *)malloc(width*height*sizeof(Color));
+        
+        switch (colorType)
         {
-            case '#': case 'o': case 'g': case 's': case 'm': case 'u': case 'v': fgets(comments, 200, objFile); break;
-            case 'f':
-            {
-                // NOTE: It could be that OBJ does not have normals or texcoords defined!
-
-                if ((normalCount == 0) && (texcoordCount == 0)) fscanf(objFile, "%i %i %i", &vCount[0], &vCount[1], &vCount[2]);
-                else if (normalCount == 0) fscanf(objFile, "%i/%i %i/%i %i/%i", &vCount[0], &vtCount[0], &vCount[1], &vtCount[1], &vCount[2], &vtCount[2]);
-                else if (texcoordCount == 0) fscanf(objFile, "%i//%i %i//%i %i//%i", &vCount[0], &vnCount[0], &vCount[1], &vnCount[1], &vCount[2], &vnCount[2]);
-                else fscanf(objFile, "%i/%i/%i %i/%i/%i %i/%i/%i", &vCount[0], &vtCount[0], &vnCount[0], &vCount[1], &vtCount[1], &vnCount[1], &vCount[2], &vtCount[2], &vnCount[2]);
-
-                mesh.vertices[vCounter] = midVertices[vCount[0]-1].x;
-                mesh.vertices[vCounter + 1] = midVertices[vCount[0]-1].y;
-                mesh.vertices[vCounter + 2] = midVertices[vCount[0]-1].z;
-                vCounter += 3;
-                mesh.vertices[vCounter] = midVertices[vCount[1]-1].x;
-                mesh.vertices[vCounter + 1] = midVertices[vCount[1]-1].y;
-                mesh.vertices[vCounter + 2] = midVertices[vCount[1]-1].z;
-                vCounter += 3;
-                mesh.vertices[vCounter] = midVertices[vCount[2]-1].x;
-                mesh.vertices[vCounter + 1] = midVertices[vCount[2]-1].y;
-                mesh.vertices[vCounter + 2] = midVertices[vCount[2]-1].z;
-                vCounter += 3;
-
-                if (normalCount > 0)
-                {
-                    mesh.normals[nCounter] = midNormals[vnCount[0]-1].x;
-                    mesh.normals[nCounter + 1] = midNormals[vnCount[0]-1].y;
-                    mesh.normals[nCounter + 2] = midNormals[vnCount[0]-1].z;
-                    nCounter += 3;
-                    mesh.normals[nCounter] = midNormals[vnCount[1]-1].x;
-                    mesh.normals[nCounter + 1] = midNormals[vnCount[1]-1].y;
-                    mesh.normals[nCounter + 2] = midNormals[vnCount[1]-1].z;
-                    nCounter += 3;
-                    mesh.normals[nCounter] = midNormals[vnCount[2]-1].x;
-                    mesh.normals[nCounter + 1] = midNormals[vnCount[2]-1].y;
-                    mesh.normals[nCounter + 2] = midNormals[vnCount[2]-1].z;
-                    nCounter += 3;
-                }
-                else
-                {
-                    // If normals not defined, they are calculated from the 3 vertices [N = (V2 - V1) x (V3 - V1)]
-                    Vector3 norm = Vector3CrossProduct(Vector3Subtract(midVertices[vCount[1]-1], midVertices[vCount[0]-1]), Vector3Subtract(midVertices[vCount[2]-1], midVertices[vCount[0]-1]));
-                    norm = Vector3Normalize(norm);
-
-                    mesh.normals[nCounter] = norm.x;
-                    mesh.normals[nCounter + 1] = norm.y;
-                    mesh.normals[nCounter + 2] = norm.z;
-                    nCounter += 3;
-                    mesh.normals[nCounter] = norm.x;
-                    mesh.normals[nCounter + 1] = norm.y;
-                    mesh.normals[nCounter + 2] = norm.z;
-                    nCounter += 3;
-                    mesh.normals[nCounter] = norm.x;
-                    mesh.normals[nCounter + 1] = norm.y;
-                    mesh.normals[nCounter + 2] = norm.z;
-                    nCounter += 3;
-                }
-
-                if (texcoordCount > 0)
-                {
-                    // NOTE: If using negative texture coordinates with a texture filter of GL_CLAMP_TO_EDGE doesn't work!
-                    // NOTE: Texture coordinates are Y flipped upside-down
-                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[0]-1].x;
-                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[0]-1].y;
-                    tcCounter += 2;
-                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[1]-1].x;
-                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[1]-1].y;
-                    tcCounter += 2;
-                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[2]-1].x;
-                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[2]-1].y;
-                    tcCounter += 2;
-                }
-            } break;
+            case 0: ConvertGrayscale(pixels, colors, width*height); break;
+            case 2: ConvertR8G8B8(pixels, colors, width*height); break;
+            case 3: for (int i = 0; i < width*height; i++) colors[i] = palette[pixels[i]]; break;
+            case 4: ConvertGrayAlpha(pixels, colors, width*height); break;
             default: break;
         }
+        
+        free(pixels);
+        image.data = (unsigned char *)colors;
     }
-
-    fclose(objFile);
-
-    // Security check, just in case no normals or no texcoords defined in OBJ
-    if (texcoordCount == 0) for (int i = 0; i < (2*mesh.vertexCount); i++) mesh.texcoords[i] = 0.0f;
-
-    // Now we can free temp mid* arrays
-    free(midVertices);
-    free(midNormals);
-    free(midTexCoords);
-
-    // NOTE: At this point we have all vertex, texcoord, normal data for the model in mesh struct
-    TraceLog(LOG_INFO, "[%s] Mesh loaded successfully in RAM (CPU)", fileName);
     
-    // Upload mesh data into VRAM
-    UploadMeshData(&mesh);
-
-    return mesh;
+    image.width = width;
+    image.height = height;
+    image.format = UNCOMPRESSED_R8G8B8A8;
+    
+    return image;
 }
 
-// Upload mesh data into VRAM
-static void UploadMeshData(Mesh *mesh)
+// Refill inflate bit buffer, at least 56 bits available after refill
+// NOTE: Partially loaded last byte is loaded again on next refill (same bits at same position)
+static void RefillBits(BitReader *reader)
 {
-    GLuint vaoId = 0;           // Vertex Array Objects (VAO)
-    GLuint vboId[3] = { 0 };    // Vertex Buffer Objects (VBOs)
-
-    // Initialize Quads VAO (Buffer A)
-    glGenVertexArrays(1, &vaoId);
-    glBindVertexArray(vaoId);
-
-    // NOTE: Attributes must be uploaded considering default locations points
-
-    // Enable vertex attributes: position (shader-location = 0)
-    glGenBuffers(1, &vboId[0]);
-    glBindBuffer(GL_ARRAY_BUFFER, vboId[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*mesh->vertexCount, mesh->vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
-    glEnableVertexAttribArray(0);
-
-    // Enable vertex attributes: texcoords (shader-location = 1)
-    glGenBuffers(1, &vboId[1]);
-    glBindBuffer(GL_ARRAY_BUFFER, vboId[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*mesh->vertexCount, mesh->texcoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, 0, 0, 0);
-    glEnableVertexAttribArray(1);
-
-    // Enable vertex attributes: normals (shader-location = 2)
-    if (mesh->normals != NULL)
+    if ((reader->end - reader->next) >= 8)
     {
-        glGenBuffers(1, &vboId[2]);
-        glBindBuffer(GL_ARRAY_BUFFER, vboId[2]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*mesh->vertexCount, mesh->normals, GL_STATIC_DRAW);
-        glVertexAttribPointer(2, 3, GL_FLOAT, 0, 0, 0);
-        glEnableVertexAttribArray(2);
+        unsigned long long word = 0;
+        memcpy(&word, reader->next, 8);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        word = __builtin_bswap64(word);
+#endif
+        reader->buffer |= word << reader->count;
+        reader->next += (63 - reader->count) >> 3;
+        reader->count |= 56;
     }
     else
     {
-        // Default normal vertex attribute set 1.0f
-        glVertexAttrib3f(2, 1.0f, 1.0f, 1.0f);
-        glDisableVertexAttribArray(2);
+        while (reader->count <= 56)
+        {
+            if (reader->next < reader->end) reader->buffer |= (unsigned long long)(*reader->next++) << reader->count;
+            else reader->overrun++;
+            
+            reader->count += 8;
+        }
     }
-
-    mesh->vboId[0] = vboId[0];     // Vertex position VBO
-    mesh->vboId[1] = vboId[1];     // Texcoords VBO
-    mesh->vboId[2] = vboId[2];     // Normals VBO
-
-    mesh->vaoId = vaoId;
-    
-    TraceLog(LOG_INFO, "[VAO ID %i] Mesh uploaded successfully to VRAM (GPU)", mesh->vaoId);
 }
 
-// Load model (initialize)
-// NOTE: Default material uses default shader and diffuse texture
-static Model LoadModel(Mesh mesh, Texture2D diffuse)
+// Read bits from inflate bit buffer (bits must be available)
+static unsigned int ReadBits(BitReader *reader, int count)
 {
-    Model model = { 0 };
+    unsigned int value = (unsigned int)(reader->buffer & ((1ULL << count) - 1));
     
-    model.mesh = mesh;
-    model.material.shader = shdrDefault;
-    model.material.texDiffuse = diffuse;
-    model.transform = MatrixIdentity();
+    reader->buffer >>= count;
+    reader->count -= count;
     
-    return model;
+    return value;
 }
 
-// Unload model data from memory (RAM and VRAM)
-// NOTE: Unloads Mesh data and Material shader
-static void UnloadModel(Model model)
+// Decode Huffman symbol from inflate bit buffer (HUFFMAN_MAX_BITS must be available), returns -1 on invalid code
+static int DecodeSymbol(BitReader *reader, const HuffmanTable *table)
 {
-    // Unload mesh data
-    if (model.mesh.vertices != NULL) free(model.mesh.vertices);
-    if (model.mesh.texcoords != NULL) free(model.mesh.texcoords);
-    if (model.mesh.normals != NULL) free(model.mesh.normals);
-
-    if (model.mesh.vboId[0] != 0) glDeleteBuffers(1, &model.mesh.vboId[0]);   // vertex
-    if (model.mesh.vboId[1] != 0) glDeleteBuffers(1, &model.mesh.vboId[1]);   // texcoords
-    if (model.mesh.vboId[2] != 0) glDeleteBuffers(1, &model.mesh.vboId[2]);   // normals
+    unsigned int entry = table->entries[reader->buffer & ((1 << HUFFMAN_FAST_BITS) - 1)];
     
-    if (model.mesh.vaoId != 0) glDeleteVertexArrays(1, &model.mesh.vaoId);
+    if (entry & HUFFMAN_SUBTABLE) entry = table->entries[(entry >> 16) + ((reader->buffer >> HUFFMAN_FAST_BITS) & ((1 << (entry & 0xff)) - 1))];
     
-    // Unload material texture
-    // NOTE: Default shader is unloaded on CloseWindow()
-    if (model.material.texDiffuse.id > 0) glDeleteTextures(1, &model.material.texDiffuse.id);
+    int length = entry & 0xff;
+    
+    reader->buffer >>= length;
+    reader->count -= length;
+    
+    return (length == 0)? -1 : (int)(entry >> 16);
 }
 
-static void DrawModel(Model model, Vector3 position, float scale, Color tint)
+// Decompress zlib stream, returns decompressed size (-1 on error)
+// NOTE: Output size is limited to dstSize, stream Adler-32 checksum is not verified
+static int Inflate(const unsigned char *src, int srcSize, unsigned char *dst, int dstSize)
 {
-    // Calculate transformation matrix from function parameters
-    // Get transform matrix (scale -> translation)
-    Matrix matScale = MatrixScale(scale, scale, scale);
-    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
-    Matrix matTransform = MatrixMultiply(matScale, matTranslation);
-
-    // Combine model transform matrix with matrix generated by function parameters (matTransform)
-    model.transform = MatrixMultiply(model.transform, matTransform);
+    // Length and distance codes base values and extra bits (DEFLATE)
+    static const unsigned short lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const unsigned char lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const unsigned short distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static const unsigned char distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    static const unsigned char codeLengthsOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
     
-    // Combine model transform with modelview matrix (defines camera transformation)
-    model.transform = MatrixMultiply(model.transform, matModelview);
+    // Check zlib header: deflate method, header checksum, no preset dictionary
+    if ((srcSize < 2) || ((src[0] & 0x0f) != 8) || ((((src[0] << 8) | src[1])%31) != 0) || (src[1] & 0x20)) return -1;
     
-    // Calculate model-view-projection matrix (MVP)
-    // NOTE: Camera transformation is already accumulated to model.transform
-    Matrix matMVP = MatrixMultiply(model.transform, matProjection);    // Transform to screen-space coordinates
-
-    model.material.colDiffuse = tint;           // Assign tint as diffuse color
-
-    glUseProgram(model.material.shader.id);     // Bind material shader
-
-    // Upload to shader material.colDiffuse
-    glUniform4f(model.material.shader.colorLoc, 
-                (float)model.material.colDiffuse.r/255, 
-                (float)model.material.colDiffuse.g/255, 
-                (float)model.material.colDiffuse.b/255, 
-                (float)model.material.colDiffuse.a/255);
+    BitReader reader = { src + 2, src + srcSize, 0, 0, 0 };
+    HuffmanTable *tables = (HuffmanTable *)malloc(2*sizeof(HuffmanTable));     // Literal/length and distance tables
+    HuffmanTable *litLenTable = &tables[0];
+    HuffmanTable *distanceTable = &tables[1];
+    
+    unsigned char *out = dst;
+    unsigned char *outEnd = dst + dstSize;
+    bool finalBlock = false;
+    bool success = true;
+    
+    while (success && !finalBlock)
+    {
+        RefillBits(&reader);
+        
+        finalBlock = ReadBits(&reader, 1);
+        int blockType = ReadBits(&reader, 2);
+        
+        if (blockType == 0)
+        {
+            // Stored block: align to byte boundary and return whole bytes in bit buffer to input
+            ReadBits(&reader, reader.count & 7);
+            
+            int bufferedBytes = (reader.count >> 3) - reader.overrun;
+            
+            if (bufferedBytes < 0) { success = false; break; }
+            
+            reader.next -= bufferedBytes;
+            reader.buffer = 0;
+            reader.count = 0;
+            reader.overrun = 0;
+            
+            if ((reader.end - reader.next) < 4) { success = false; break; }
+            
+            int length = reader.next[0] | (reader.next[1] << 8);
+            int lengthCheck = reader.next[2] | (reader.next[3] << 8);
+            reader.next += 4;
+            
+            if ((length != (~lengthCheck & 0xffff)) || (length > (reader.end - reader.next)) || (length > (outEnd - out))) { success = false; break; }
+            
+            memcpy(out, reader.next, length);
+            out += length;
+            reader.next += length;
+            continue;
+        }
+        else if (blockType == 1)
+        {
+            // Fixed Huffman codes
+            unsigned char lengths[288 + 32];
+            
+            memset(lengths, 8, 144);
+            memset(lengths + 144, 9, 112);
+            memset(lengths + 256, 7, 24);
+            memset(lengths + 280, 8, 8);
+            memset(lengths + 288, 5, 32);
+            
+            BuildHuffmanTable(litLenTable, lengths, 288);
+            BuildHuffmanTable(distanceTable, lengths + 288, 32);
+        }
+        else if (blockType == 2)
+        {
+            // Dynamic Huffman codes: code lengths are Huffman coded too (code lengths code)
+            unsigned char lengths[288 + 32] = { 0 };
+            unsigned char codeLengths[19] = { 0 };
+            
+            int litLenCount = ReadBits(&reader, 5) + 257;
+            int distanceCount = ReadBits(&reader, 5) + 1;
+            int codeLengthsCount = ReadBits(&reader, 4) + 4;
+            
+            for (int i = 0; i < codeLengthsCount; i++)
+            {
+                RefillBits(&reader);
+                codeLengths[codeLengthsOrder[i]] = ReadBits(&reader, 3);
+            }
+            
+            // NOTE: Distance table is used to decode code lengths, it's built again later
+            if ((litLenCount > 286) || (distanceCount > 30) || !BuildHuffmanTable(distanceTable, codeLengths, 19)) { success = false; break; }
+            
+            for (int n = 0; n < (litLenCount + distanceCount);)
+            {
+                RefillBits(&reader);
+                
+                int symbol = DecodeSymbol(&reader, distanceTable);
+                int value = 0;
+                int repeat = 0;
+                
+                if ((symbol >= 0) && (symbol < 16)) { value = symbol; repeat = 1; }
+                else if ((symbol == 16) && (n > 0)) { value = lengths[n - 1]; repeat = 3 + ReadBits(&reader, 2); }
+                else if (symbol == 17) repeat = 3 + ReadBits(&reader, 3);
+                else if (symbol == 18) repeat = 11 + ReadBits(&reader, 7);
+                
+                if ((repeat == 0) || ((n + repeat) > (litLenCount + distanceCount))) { success = false; break; }
+                
+                memset(lengths + n, value, repeat);
+                n += repeat;
+            }
+            
+            if (!success || (lengths[256] == 0) || 
+                !BuildHuffmanTable(litLenTable, lengths, litLenCount) || 
+                !BuildHuffmanTable(distanceTable, lengths + litLenCount, distanceCount)) { success = false; break; }
+        }
+        else { success = false; break; }
+        
+        // Decode literals and matches until end of block
+        // NOTE: One refill provides the bits for a full match: length code and extra bits (20),
+        // distance code and extra bits (28)
+        while (true)
+        {
+            RefillBits(&reader);
+            
+            int symbol = DecodeSymbol(&reader, litLenTable);
+            
+            if ((symbol >= 0) && (symbol < 256))
+            {
+                if (out == outEnd) { success = false; break; }
+                *out++ = (unsigned char)symbol;
+            }
+            else if (symbol == 256) break;
+            else if ((symbol > 256) && (symbol < 286))
+            {
+                int length = lengthBase[symbol - 257] + ReadBits(&reader, lengthExtra[symbol - 257]);
+                int distanceSymbol = DecodeSymbol(&reader, distanceTable);
+                
+                if ((distanceSymbol < 0) || (distanceSymbol >= 30)) { success = false; break; }
+                
+                int distance = distanceBase[distanceSymbol] + ReadBits(&reader, distanceExtra[distanceSymbol]);
+                
+                if ((distance > (out - dst)) || (length > (outEnd - out))) { success = false; break; }
+                
+                const unsigned char *from = out - distance;
+                
+                if ((distance >= 8) && ((outEnd - out) >= (length + 8)))
+                {
+                    // Copy 8 bytes per iteration, last copy can write up to 7 bytes past match end
+                    unsigned char *copyEnd = out + length;
+                    
+                    do
+                    {
+                        memcpy(out, from, 8);
+                        out += 8;
+                        from += 8;
+                    } while (out < copyEnd);
+                    
+                    out = copyEnd;
+                }
+                else if (distance == 1)
+                {
+                    memset(out, out[-1], length);
+                    out += length;
+                }
+                else for (int i = 0; i < length; i++) *out++ = *from++;
+            }
+            else { success = false; break; }
+        }
+    }
+    
+    // Check no zero-filled bytes past input end have been consumed (truncated stream)
+    if (success && ((reader.count >> 3) < reader.overrun)) success = false;
+    
+    free(tables);
+    
+    return success? (int)(out - dst) : -1;
+}
 
-    // Set shader textures (diffuse, normal, specular)
-    // NOTE: Diffuse texture fits in active texture unit 0
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, model.material.texDiffuse.id);
-    glUniform1i(model.material.shader.mapTextureLoc, 0);
+// Build Huffman decoding table from code lengths (canonical Huffman codes)
+// NOTE: Incomplete codes are allowed (unused entries decode as invalid), over-subscribed codes fail
+static bool BuildHuffmanTable(HuffmanTable *table, const unsigned char *lengths, int count)
+{
+    int lengthCount[HUFFMAN_MAX_BITS + 1] = { 0 };
+    int nextCode[HUFFMAN_MAX_BITS + 1] = { 0 };
+    int maxLength = 0;
+    
+    for (int i = 0; i < count; i++)
+    {
+        lengthCount[lengths[i]]++;
+        if (lengths[i] > maxLength) maxLength = lengths[i];
+    }
+    
+    lengthCount[0] = 0;
+    
+    // Check codes space is not over-subscribed and compute first code of every length
+    int codesLeft = 1;
+    int code = 0;
+    
+    for (int length = 1; length <= HUFFMAN_MAX_BITS; length++)
+    {
+        codesLeft = (codesLeft << 1) - lengthCount[length];
+        if (codesLeft < 0) return false;
+        
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+    
+    int subtableBits = (maxLength > HUFFMAN_FAST_BITS)? (maxLength - HUFFMAN_FAST_BITS) : 0;
+    int subtableOffset = 1 << HUFFMAN_FAST_BITS;
+    
+    memset(table->entries, 0, (1 << HUFFMAN_FAST_BITS)*sizeof(unsigned int));
+    
+    for (int symbol = 0; symbol < count; symbol++)
+    {
+        int length = lengths[symbol];
+        
+        if (length == 0) continue;
+        
+        // Codes are read least significant bit first, table is indexed by bit-reversed codes
+        int reversed = 0;
+        code = nextCode[length]++;
+        
+        for (int i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+        
+        unsigned int entry = (symbol << 16) | length;
+        
+        if (length <= HUFFMAN_FAST_BITS)
+        {
+            for (int i = reversed; i < (1 << HUFFMAN_FAST_BITS); i += (1 << length)) table->entries[i] = entry;
+        }
+        else
+        {
+            unsigned int *link = &table->entries[reversed & ((1 << HUFFMAN_FAST_BITS) - 1)];
+            
+            if (!(*link & HUFFMAN_SUBTABLE))
+            {
+                memset(&table->entries[subtableOffset], 0, (1 << subtableBits)*sizeof(unsigned int));
+                *link = (subtableOffset << 16) | HUFFMAN_SUBTABLE | subtableBits;
+                subtableOffset += (1 << subtableBits);
+            }
+            
+            unsigned int *subtable = &table->entries[*link >> 16];
+            
+            for (int i = (reversed >> HUFFMAN_FAST_BITS); i < (1 << subtableBits); i += (1 << (length - HUFFMAN_FAST_BITS))) subtable[i] = entry;
+        }
+    }
+    
+    return true;
+}
 
-    // Bind mesh VAO (vertex array objects)
-    glBindVertexArray(model.mesh.vaoId);
+#if defined(__SSE2__)
+// Load 4 bytes into SSE2 register lowest lane
+// NOTE: Used on 3 and 4 bytes per pixel scanlines, for 3 bytes pixels the extra byte belongs to next pixel
+static __m128i LoadPixel4(const unsigned char *data)
+{
+    int value = 0;
+    memcpy(&value, data, 4);
     
-    // Send combined model-view-matProjection matrix to shader
-    glUniformMatrix4fv(model.material.shader.mvpLoc, 1, false, MatrixToFloat(matMVP));
+    return _mm_cvtsi32_si128(value);
+}
 
-    // Draw call!
-    glDrawArrays(GL_TRIANGLES, 0, model.mesh.vertexCount);
+// Store SSE2 register lowest lane (4 bytes)
+static void StorePixel4(unsigned char *data, __m128i pixel)
+{
+    int value = _mm_cvtsi128_si32(pixel);
+    memcpy(data, &value, 4);
+}
+#endif
 
-    glActiveTexture(GL_TEXTURE0);       // Set shader active texture to default 0
-    glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
-    glBindVertexArray(0);               // Unbind VAO
-    glUseProgram(0);                    // Unbind shader program
+// Reconstruct PNG filtered scanline: None (0), Sub (1), Up (2), Average (3), Paeth (4)
+// NOTE: Sub, Average and Paeth filters depend on previous pixel, SSE2 processes one pixel per iteration
+// (3 and 4 bytes per pixel), Up filter processes 16 bytes per iteration; prior is previous reconstructed scanline
+static void UnfilterScanline(unsigned char *dst, const unsigned char *src, const unsigned char *prior, int size, int bpp, int filter)
+{
+    int i = 0;
+    
+    switch (filter)
+    {
+        case 0: memcpy(dst, src, size); break;
+        case 1:
+        {
+#if defined(__SSE2__)
+            if ((bpp == 3) || (bpp == 4))
+            {
+                __m128i a = _mm_setzero_si128();
+                
+                for (; (i + 4) <= size; i += bpp)
+                {
+                    a = _mm_add_epi8(a, LoadPixel4(src + i));
+                    StorePixel4(dst + i, a);
+                }
+            }
+#endif
+            for (; i < bpp; i++) dst[i] = src[i];
+            for (; i < size; i++) dst[i] = src[i] + dst[i - bpp];
+        } break;
+        case 2:
+        {
+#if defined(__SSE2__)
+            for (; (i + 16) <= size; i += 16)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+                __m128i b = _mm_loadu_si128((const __m128i *)(prior + i));
+                
+                _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi8(x, b));
+            }
+#endif
+            for (; i < size; i++) dst[i] = src[i] + prior[i];
+        } break;
+        case 3:
+        {
+#if defined(__SSE2__)
+            if ((bpp == 3) || (bpp == 4))
+            {
+                const __m128i one = _mm_set1_epi8(1);
+                __m128i a = _mm_setzero_si128();
+                
+                for (; (i + 4) <= size; i += bpp)
+                {
+                    __m128i b = LoadPixel4(prior + i);
+                    
+                    // Truncated average: _mm_avg_epu8() rounds up, subtract 1 when (a + b) is odd
+                    __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+                    
+                    a = _mm_add_epi8(LoadPixel4(src + i), average);
+                    StorePixel4(dst + i, a);
+                }
+            }
+#endif
+            for (; i < bpp; i++) dst[i] = src[i] + (prior[i] >> 1);
+            for (; i < size; i++) dst[i] = src[i] + ((dst[i - bpp] + prior[i]) >> 1);
+        } break;
+        case 4:
+        {
+#if defined(__SSE2__)
+            if ((bpp == 3) || (bpp == 4))
+            {
+                // Predictor computed in 16bit lanes: pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+                const __m128i zero = _mm_setzero_si128();
+                __m128i a = zero;
+                __m128i c = zero;
+                
+                for (; (i + 4) <= size; i += bpp)
+                {
+                    __m128i b = _mm_unpacklo_epi8(LoadPixel4(prior + i), zero);
+                    __m128i x = _mm_unpacklo_epi8(LoadPixel4(src + i), zero);
+                    
+                    __m128i pa = _mm_sub_epi16(b, c);
+                    __m128i pb = _mm_sub_epi16(a, c);
+                    __m128i pc = _mm_add_epi16(pa, pb);
+                    
+                    pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+                    pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+                    pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+                    
+                    // Nearest of a, b, c (ties resolved in that order)
+                    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+                    __m128i useA = _mm_cmpeq_epi16(smallest, pa);
+                    __m128i useB = _mm_cmpeq_epi16(smallest, pb);
+                    __m128i nearest = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+                    nearest = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, nearest));
+                    
+                    a = _mm_and_si128(_mm_add_epi16(nearest, x), _mm_set1_epi16(0xff));
+                    c = b;
+                    StorePixel4(dst + i, _mm_packus_epi16(a, a));
+                }
+            }
+#endif
+            for (; i < bpp; i++) dst[i] = src[i] + prior[i];
+            for (; i < size; i++)
+            {
+                int a = dst[i - bpp];
+                int b = prior[i];
+                int c = prior[i - bpp];
+                int pa = abs(b - c);
+                int pb = abs(a - c);
+                int pc = abs(a + b - 2*c);
+                
+                dst[i] = src[i] + (((pa <= pb) && (pa <= pc))? a : (pb <= pc)? b : c);
+            }
+        } break;
+        default: break;
+    }
 }
 
-// LESSON 05: Cubicmap generation, loading and drawing
-//----------------------------------------------------------------------------------
-// Generate cubicmap mesh from image data
-static Mesh GenMeshCubicmap(Image cubicmap, float cubeSize)
+// Unload texture data from GPU memory (VRAM)
+static void UnloadTexture(Texture2D texture)
 {
-    Mesh mesh = { 0 };
+    if (texture.id > 0) 
+    {
+        glDeleteTextures(1, &texture.id);
+        
+        // NOTE: Streamed textures allocate all mipmap levels storage on load
+        for (int i = 0; i < texture.mipmaps; i++)
+        {
+            int width = texture.width >> i, height = texture.height >> i;
+            vramUsage -= ((width > 0)? width : 1)*((height > 0)? height : 1)*4;
+        }
+    }
+}
 
-    Color *cubicmapPixels = GetImageData(cubicmap);
+// Load texture storage in GPU memory with placeholder mip tail
+// NOTE: Storage for all levels is allocated, levels up to STREAM_MIP_TAIL_SIZE are filled with a flat
+// color until levels are generated with GenTextureStreamLevels(); levels not uploaded yet are hidden
+// by GL_TEXTURE_BASE_LEVEL clamping
+static StreamTexture LoadTextureStream(int width, int height)
+{
+    StreamTexture stream = { 0 };
+    
+    int levelCount = 1;
+    while ((((width >> levelCount) > 0) || ((height >> levelCount) > 0)) && (levelCount < MAX_STREAM_MIP_LEVELS)) levelCount++;
+    
+    stream.texture.width = width;
+    stream.texture.height = height;
+    stream.texture.mipmaps = levelCount;
+    stream.texture.format = UNCOMPRESSED_R8G8B8A8;
+    stream.residentLevel = levelCount - 1;
+    stream.loading = true;
+    
+    Color *placeholder = (Color *)malloc(STREAM_MIP_TAIL_SIZE*STREAM_MIP_TAIL_SIZE*sizeof(Color));
+    for (int i = 0; i < STREAM_MIP_TAIL_SIZE*STREAM_MIP_TAIL_SIZE; i++) placeholder[i] = (Color){ 128, 128, 128, 255 };
+    
+    glGenTextures(1, &stream.texture.id);
+    glBindTexture(GL_TEXTURE_2D, stream.texture.id);
+    
+    // Allocate all levels storage, fill mip tail with placeholder
+    for (int i = 0; i < levelCount; i++)
+    {
+        int levelWidth = width >> i, levelHeight = height >> i;
+        if (levelWidth < 1) levelWidth = 1;
+        if (levelHeight < 1) levelHeight = 1;
+        
+        if ((levelWidth <= STREAM_MIP_TAIL_SIZE) && (levelHeight <= STREAM_MIP_TAIL_SIZE))
+        {
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+            if (i < stream.residentLevel) stream.residentLevel = i;
+        }
+        else glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        
+        vramUsage += levelWidth*levelHeight*4;
+    }
+    
+    free(placeholder);
+    
+    // Hide not resident levels
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, stream.residentLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);  // Levels blending required for fade in
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    if (stream.texture.id > 0) TraceLog(LOG_INFO, "[TEX ID %i] Texture stream created successfully (%ix%i, %i levels, level %i resident)", 
+                                        stream.texture.id, width, height, levelCount, stream.residentLevel);
+    else TraceLog(LOG_WARNING, "Texture stream could not be created");
+    
+    return stream;
+}
 
-    int mapWidth = cubicmap.width;
-    int mapHeight = cubicmap.height;
+// Generate streamed texture mipmap levels from image (RAM)
+// NOTE: Called from loader threads (no GL calls), levels are generated with a 2x2 box filter as R8G8B8A8;
+// no level is generated if image size does not match texture size
+static void GenTextureStreamLevels(StreamTexture *stream, Image image)
+{
+    if ((image.data == NULL) || (image.width != (unsigned int)stream->texture.width) || (image.height != (unsigned int)stream->texture.height)) return;
+    
+    int width = image.width;
+    int height = image.height;
+    
+    stream->levels[0] = (unsigned char *)GetImageData(image);
+    
+    // Generate mipmap levels, every level from previous one
+    for (int level = 1; level < stream->texture.mipmaps; level++)
+    {
+        int levelWidth = (width > 1)? width/2 : 1;
+        int levelHeight = (height > 1)? height/2 : 1;
+        
+        Color *src = (Color *)stream->levels[level - 1];
+        Color *dst = (Color *)malloc(levelWidth*levelHeight*sizeof(Color));
+        
+        for (int y = 0; y < levelHeight; y++)
+        {
+            // NOTE: Odd sizes (and 1 pixel sides) reuse last row/column
+            int y0 = 2*y, y1 = (2*y + 1 < height)? 2*y + 1 : height - 1;
+            
+            for (int x = 0; x < levelWidth; x++)
+            {
+                int x0 = 2*x, x1 = (2*x + 1 < width)? 2*x + 1 : width - 1;
+                
+                Color c0 = src[y0*width + x0], c1 = src[y0*width + x1];
+                Color c2 = src[y1*width + x0], c3 = src[y1*width + x1];
+                
+                dst[y*levelWidth + x] = (Color){ (c0.r + c1.r + c2.r + c3.r + 2)/4, (c0.g + c1.g + c2.g + c3.g + 2)/4,
+                                                 (c0.b + c1.b + c2.b + c3.b + 2)/4, (c0.a + c1.a + c2.a + c3.a + 2)/4 };
+            }
+        }
+        
+        stream->levels[level] = (unsigned char *)dst;
+        width = levelWidth;
+        height = levelHeight;
+    }
+}
 
-    // NOTE: Max possible number of triangles numCubes * (12 triangles by cube)
-    int maxTriangles = cubicmap.width*cubicmap.height*12;
+// Unload streamed texture levels not uploaded yet (RAM)
+// NOTE: Texture is unloaded from VRAM with UnloadTexture()
+static void UnloadTextureStream(StreamTexture *stream)
+{
+    for (int i = 0; i < MAX_STREAM_MIP_LEVELS; i++)
+    {
+        free(stream->levels[i]);
+        stream->levels[i] = NULL;
+    }
+}
 
-    int vCounter = 0;       // Used to count vertices
-    int tcCounter = 0;      // Used to count texcoords
-    int nCounter = 0;       // Used to count normals
+// Upload next mipmap levels of streamed textures, highest priority first
+// NOTE: New resident level is faded in from previous one, GL_TEXTURE_MIN_LOD is relative to base level
+static int UpdateTextureStreaming(StreamTexture *streams, int count, int budget)
+{
+    int uploadedBytes = 0;
+    
+    // Fade in last uploaded levels
+    for (int i = 0; i < count; i++)
+    {
+        if (streams[i].minLod > 0.0f)
+        {
+            streams[i].minLod -= STREAM_FADE_STEP;
+            if (streams[i].minLod < 0.0f) streams[i].minLod = 0.0f;
+            
+            glBindTexture(GL_TEXTURE_2D, streams[i].texture.id);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, streams[i].minLod);
+        }
+    }
+    
+    // NOTE: At least one level is uploaded per frame, even if over budget
+    while (uploadedBytes < budget)
+    {
+        StreamTexture *stream = NULL;
+        
+        for (int i = 0; i < count; i++)
+        {
+            // NOTE: Textures still loading or with levels not generated (load failed) are skipped
+            if (!streams[i].loading && (streams[i].residentLevel > 0) && (streams[i].levels[streams[i].residentLevel - 1] != NULL) && 
+                ((stream == NULL) || (streams[i].priority > stream->priority))) stream = &streams[i];
+        }
+        
+        if (stream == NULL) break;      // All textures fully resident
+        
+        int level = stream->residentLevel - 1;
+        int levelWidth = stream->texture.width >> level, levelHeight = stream->texture.height >> level;
+        if (levelWidth < 1) levelWidth = 1;
+        if (levelHeight < 1) levelHeight = 1;
+        
+        glBindTexture(GL_TEXTURE_2D, stream->texture.id);
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight, GL_RGBA, GL_UNSIGNED_BYTE, stream->levels[level]);
+        
+        free(stream->levels[level]);
+        stream->levels[level] = NULL;
+        
+        // Make level resident, keeping sampled level until faded in
+        stream->residentLevel = level;
+        stream->minLod += 1.0f;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, stream->minLod);
+        
+        uploadedBytes += levelWidth*levelHeight*4;
+        
+        if (level == 0) TraceLog(LOG_INFO, "[TEX ID %i] Texture stream fully resident (%ix%i)", stream->texture.id, stream->texture.width, stream->texture.height);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    return uploadedBytes;
+}
 
-    float w = cubeSize;
-    float h = cubeSize;
-    float h2 = cubeSize;
+// Draw texture in screen position coordinates
+static void DrawTexture(Texture2D texture, Vector2 position, Color tint)
+{
+    glUseProgram(shdrDefault.id);
 
-    Vector3 *mapVertices = (Vector3 *)malloc(maxTriangles*3*sizeof(Vector3));
-    Vector2 *mapTexcoords = (Vector2 *)malloc(maxTriangles*3*sizeof(Vector2));
-    Vector3 *mapNormals = (Vector3 *)malloc(maxTriangles*3*sizeof(Vector3));
+    // Define translation matrix to translate quad to screen position
+    // NOTE: View-projection is taken from per-frame data, 2D drawing requires an orthographic projection
+    Matrix matModel = MatrixTranslate(position.x, position.y, 0);
 
-    // Define the 6 normals of the cube, we will combine them accordingly later...
-    Vector3 n1 = { 1.0f, 0.0f, 0.0f };
-    Vector3 n2 = { -1.0f, 0.0f, 0.0f };
-    Vector3 n3 = { 0.0f, 1.0f, 0.0f };
-    Vector3 n4 = { 0.0f, -1.0f, 0.0f };
-    Vector3 n5 = { 0.0f, 0.0f, 1.0f };
-    Vector3 n6 = { 0.0f, 0.0f, -1.0f };
+    glUniformMatrix4fv(shdrDefault.modelLoc, 1, false, MatrixToFloat(matModel));
+    glUniform4f(shdrDefault.colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
 
-    // NOTE: We use texture rectangles to define different textures for top-bottom-front-back-right-left (6)
-    typedef struct RectangleF {
-        float x;
-        float y;
-        float width;
-        float height;
-    } RectangleF;
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glBindVertexArray(quadId);
+                
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            
+    glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
+    glBindVertexArray(0);               // Unbind VAO
+    glUseProgram(0);                    // Unbind shader program
+}
 
-    RectangleF rightTexUV = { 0.0f, 0.0f, 0.5f, 0.5f };
-    RectangleF leftTexUV = { 0.5f, 0.0f, 0.5f, 0.5f };
-    RectangleF frontTexUV = { 0.0f, 0.0f, 0.5f, 0.5f };
-    RectangleF backTexUV = { 0.5f, 0.0f, 0.5f, 0.5f };
-    RectangleF topTexUV = { 0.0f, 0.5f, 0.5f, 0.5f };
-    RectangleF bottomTexUV = { 0.5f, 0.5f, 0.5f, 0.5f };
+// Load a quad to draw a texture
+// NOTE: We need to define positions, coordinates and normals (optional)
+static unsigned int LoadQuad(float width, float height)
+{
+    unsigned int quadVAO = 0;       // Quad VAO id
+    unsigned int quadVBO = 0;       // Quad VBO id for individual buffer
+    
+    float vertices[] = {
+        // Positions - Texture Coords
+        0.0f,    0.0f, 0.0f,   0.0f, 0.0f,
+        0.0f,  height, 0.0f,   0.0f, 1.0f,
+        width,   0.0f, 0.0f,   1.0f, 0.0f,
+        width, height, 0.0f,   1.0f, 1.0f,
+    };
 
-    for (int z = 0; z < mapHeight; ++z)
+    // Generate quad VAO/VBO ids
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glBindVertexArray(quadVAO);
+
+    // Fill VBO buffer
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
+
+    // Link vertex attributes
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(float), (void *)(3*sizeof(float)));
+
+    return quadVAO;
+}
+// LESSON 04: Model loading, vertex buffer creation
+//----------------------------------------------------------------------------------
+// Load static mesh from OBJ file (RAM)
+static Mesh LoadOBJ(const char *fileName)
+{
+    Mesh mesh = { 0 };
+
+    char dataType;
+    char comments[200];
+
+    int vertexCount = 0;
+    int normalCount = 0;
+    int texcoordCount = 0;
+    int triangleCount = 0;
+
+    FILE *objFile = fopen(fileName, "rt");
+
+    if (objFile == NULL)
     {
-        for (int x = 0; x < mapWidth; ++x)
+        TraceLog(LOG_WARNING, "[%s] OBJ file could not be opened", fileName);
+        return mesh;
+    }
+
+    // First reading pass: Get vertexCount, normalCount, texcoordCount, triangleCount
+    // NOTE: vertex, texcoords and normals could be optimized (to be used indexed on faces definition)
+    // NOTE: faces MUST be defined as TRIANGLES (3 vertex per face)
+    while (!feof(objFile))
+    {
+        dataType = '\0';
+        fscanf(objFile, "%c", &dataType);
+
+        switch (dataType)
         {
-            // Define the 8 vertex of the cube, we will combine them accordingly later...
-            Vector3 v1 = { w*(x - 0.5f), h2, h*(z - 0.5f) };
-            Vector3 v2 = { w*(x - 0.5f), h2, h*(z + 0.5f) };
-            Vector3 v3 = { w*(x + 0.5f), h2, h*(z + 0.5f) };
-            Vector3 v4 = { w*(x + 0.5f), h2, h*(z - 0.5f) };
-            Vector3 v5 = { w*(x + 0.5f), 0, h*(z - 0.5f) };
-            Vector3 v6 = { w*(x - 0.5f), 0, h*(z - 0.5f) };
-            Vector3 v7 = { w*(x - 0.5f), 0, h*(z + 0.5f) };
-            Vector3 v8 = { w*(x + 0.5f), 0, h*(z + 0.5f) };
+            case '#':   // Comments
+            case 'o':   // Object name (One OBJ file can contain multible named meshes)
+            case 'g':   // Group name
+            case 's':   // Smoothing level
+            case 'm':   // mtllib [external .mtl file name]
+            case 'u':   // usemtl [material name]
+            {
+                fgets(comments, 200, objFile);
+            } break;
+            case 'v':
+            {
+                fscanf(objFile, "%c", &dataType);
 
-            // We check pixel color to be WHITE, we will full cubes
-            if ((cubicmapPixels[z*cubicmap.width + x].r == 255) &&
-                (cubicmapPixels[z*cubicmap.width + x].g == 255) &&
-                (cubicmapPixels[z*cubicmap.width + x].b == 255))
+                if (dataType == 't')    // Read texCoord
+                {
+                    texcoordCount++;
+                    fgets(comments, 200, objFile);
+                }
+                else if (dataType == 'n')    // Read normals
+                {
+                    normalCount++;
+                    fgets(comments, 200, objFile);
+                }
+                else    // Read vertex
+                {
+                    vertexCount++;
+                    fgets(comments, 200, objFile);
+                }
+            } break;
+            case 'f':
             {
-                // Define triangles (Checking Collateral Cubes!)
-                //----------------------------------------------
+                triangleCount++;
+                fgets(comments, 200, objFile);
+            } break;
+            default: break;
+        }
+    }
 
-                // Define top triangles (2 tris, 6 vertex --> v1-v2-v3, v1-v3-v4)
-                mapVertices[vCounter] = v1;
-                mapVertices[vCounter + 1] = v2;
-                mapVertices[vCounter + 2] = v3;
-                mapVertices[vCounter + 3] = v1;
-                mapVertices[vCounter + 4] = v3;
-                mapVertices[vCounter + 5] = v4;
-                vCounter += 6;
+    TraceLog(LOG_DEBUG, "[%s] Mesh vertices: %i", fileName, vertexCount);
+    TraceLog(LOG_DEBUG, "[%s] Mesh texcoords: %i", fileName, texcoordCount);
+    TraceLog(LOG_DEBUG, "[%s] Mesh normals: %i", fileName, normalCount);
+    TraceLog(LOG_DEBUG, "[%s] Mesh triangles: %i", fileName, triangleCount);
 
-                mapNormals[nCounter] = n3;
-                mapNormals[nCounter + 1] = n3;
-                mapNormals[nCounter + 2] = n3;
-                mapNormals[nCounter + 3] = n3;
-                mapNormals[nCounter + 4] = n3;
-                mapNormals[nCounter + 5] = n3;
-                nCounter += 6;
+    // Once we know the number of vertices to store, we create required arrays
+    Vector3 *midVertices = (Vector3 *)malloc(vertexCount*sizeof(Vector3));
+    Vector3 *midNormals = NULL;
+    if (normalCount > 0) midNormals = (Vector3 *)malloc(normalCount*sizeof(Vector3));
+    Vector2 *midTexCoords = NULL;
+    if (texcoordCount > 0) midTexCoords = (Vector2 *)malloc(texcoordCount*sizeof(Vector2));
 
-                mapTexcoords[tcCounter] = (Vector2){ topTexUV.x, topTexUV.y };
-                mapTexcoords[tcCounter + 1] = (Vector2){ topTexUV.x, topTexUV.y + topTexUV.height };
-                mapTexcoords[tcCounter + 2] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
-                mapTexcoords[tcCounter + 3] = (Vector2){ topTexUV.x, topTexUV.y };
-                mapTexcoords[tcCounter + 4] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
-                mapTexcoords[tcCounter + 5] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y };
-                tcCounter += 6;
+    int countVertex = 0;
+    int countNormals = 0;
+    int countTexCoords = 0;
 
-                // Define bottom triangles (2 tris, 6 vertex --> v6-v8-v7, v6-v5-v8)
-                mapVertices[vCounter] = v6;
-                mapVertices[vCounter + 1] = v8;
-                mapVertices[vCounter + 2] = v7;
-                mapVertices[vCounter + 3] = v6;
-                mapVertices[vCounter + 4] = v5;
-                mapVertices[vCounter + 5] = v8;
-                vCounter += 6;
+    rewind(objFile);        // Return to the beginning of the file, to read again
 
-                mapNormals[nCounter] = n4;
-                mapNormals[nCounter + 1] = n4;
-                mapNormals[nCounter + 2] = n4;
-                mapNormals[nCounter + 3] = n4;
-                mapNormals[nCounter + 4] = n4;
-                mapNormals[nCounter + 5] = n4;
-                nCounter += 6;
+    // Second reading pass: Get vertex data to fill intermediate arrays
+    // NOTE: This second pass is required in case of multiple meshes defined in same OBJ
+    while (!feof(objFile))
+    {
+        fscanf(objFile, "%c", &dataType);
 
-                mapTexcoords[tcCounter] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
-                mapTexcoords[tcCounter + 1] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
-                mapTexcoords[tcCounter + 2] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y + bottomTexUV.height };
-                mapTexcoords[tcCounter + 3] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
-                mapTexcoords[tcCounter + 4] = (Vector2){ bottomTexUV.x, bottomTexUV.y };
-                mapTexcoords[tcCounter + 5] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
-                tcCounter += 6;
+        switch (dataType)
+        {
+            case '#': case 'o': case 'g': case 's': case 'm': case 'u': case 'f': fgets(comments, 200, objFile); break;
+            case 'v':
+            {
+                fscanf(objFile, "%c", &dataType);
 
-                if (((z < cubicmap.height - 1) &&
-                (cubicmapPixels[(z + 1)*cubicmap.width + x].r == 0) &&
-                (cubicmapPixels[(z + 1)*cubicmap.width + x].g == 0) &&
-                (cubicmapPixels[(z + 1)*cubicmap.width + x].b == 0)) || (z == cubicmap.height - 1))
+                if (dataType == 't')    // Read texCoord
                 {
-                    // Define front triangles (2 tris, 6 vertex) --> v2 v7 v3, v3 v7 v8
-                    // NOTE: Collateral occluded faces are not generated
-                    mapVertices[vCounter] = v2;
-                    mapVertices[vCounter + 1] = v7;
-                    mapVertices[vCounter + 2] = v3;
-                    mapVertices[vCounter + 3] = v3;
-                    mapVertices[vCounter + 4] = v7;
-                    mapVertices[vCounter + 5] = v8;
-                    vCounter += 6;
-
-                    mapNormals[nCounter] = n6;
-                    mapNormals[nCounter + 1] = n6;
-                    mapNormals[nCounter + 2] = n6;
-                    mapNormals[nCounter + 3] = n6;
-                    mapNormals[nCounter + 4] = n6;
-                    mapNormals[nCounter + 5] = n6;
-                    nCounter += 6;
+                    fscanf(objFile, "%f %f%*[^\n]s\n", &midTexCoords[countTexCoords].x, &midTexCoords[countTexCoords].y);
+                    countTexCoords++;
 
-                    mapTexcoords[tcCounter] = (Vector2){ frontTexUV.x, frontTexUV.y };
-                    mapTexcoords[tcCounter + 1] = (Vector2){ frontTexUV.x, frontTexUV.y + frontTexUV.height };
-                    mapTexcoords[tcCounter + 2] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y };
-                    mapTexcoords[tcCounter + 3] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y };
-                    mapTexcoords[tcCounter + 4] = (Vector2){ frontTexUV.x, frontTexUV.y + frontTexUV.height };
-                    mapTexcoords[tcCounter + 5] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y + frontTexUV.height };
-                    tcCounter += 6;
+                    fscanf(objFile, "%c", &dataType);
                 }
-
-                if (((z > 0) &&
-                (cubicmapPixels[(z - 1)*cubicmap.width + x].r == 0) &&
-                (cubicmapPixels[(z - 1)*cubicmap.width + x].g == 0) &&
-                (cubicmapPixels[(z - 1)*cubicmap.width + x].b == 0)) || (z == 0))
+                else if (dataType == 'n')    // Read normals
                 {
-                    // Define back triangles (2 tris, 6 vertex) --> v1 v5 v6, v1 v4 v5
-                    // NOTE: Collateral occluded faces are not generated
-                    mapVertices[vCounter] = v1;
-                    mapVertices[vCounter + 1] = v5;
-                    mapVertices[vCounter + 2] = v6;
-                    mapVertices[vCounter + 3] = v1;
-                    mapVertices[vCounter + 4] = v4;
-                    mapVertices[vCounter + 5] = v5;
-                    vCounter += 6;
+                    fscanf(objFile, "%f %f %f", &midNormals[countNormals].x, &midNormals[countNormals].y, &midNormals[countNormals].z);
+                    countNormals++;
 
-                    mapNormals[nCounter] = n5;
-                    mapNormals[nCounter + 1] = n5;
-                    mapNormals[nCounter + 2] = n5;
-                    mapNormals[nCounter + 3] = n5;
-                    mapNormals[nCounter + 4] = n5;
-                    mapNormals[nCounter + 5] = n5;
-                    nCounter += 6;
+                    fscanf(objFile, "%c", &dataType);
+                }
+                else    // Read vertex
+                {
+                    fscanf(objFile, "%f %f %f", &midVertices[countVertex].x, &midVertices[countVertex].y, &midVertices[countVertex].z);
+                    countVertex++;
 
-                    mapTexcoords[tcCounter] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y };
-                    mapTexcoords[tcCounter + 1] = (Vector2){ backTexUV.x, backTexUV.y + backTexUV.height };
-                    mapTexcoords[tcCounter + 2] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y + backTexUV.height };
-                    mapTexcoords[tcCounter + 3] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y };
-                    mapTexcoords[tcCounter + 4] = (Vector2){ backTexUV.x, backTexUV.y };
-                    mapTexcoords[tcCounter + 5] = (Vector2){ backTexUV.x, backTexUV.y + backTexUV.height };
-                    tcCounter += 6;
+                    fscanf(objFile, "%c", &dataType);
                 }
+            } break;
+            default: break;
+        }
+    }
 
-                if (((x < cubicmap.width - 1) &&
-                (cubicmapPixels[z*cubicmap.width + (x + 1)].r == 0) &&
-                (cubicmapPixels[z*cubicmap.width + (x + 1)].g == 0) &&
-                (cubicmapPixels[z*cubicmap.width + (x + 1)].b == 0)) || (x == cubicmap.width - 1))
-                {
-                    // Define right triangles (2 tris, 6 vertex) --> v3 v8 v4, v4 v8 v5
-                    // NOTE: Collateral occluded faces are not generated
-                    mapVertices[vCounter] = v3;
-                    mapVertices[vCounter + 1] = v8;
-                    mapVertices[vCounter + 2] = v4;
-                    mapVertices[vCounter + 3] = v4;
-                    mapVertices[vCounter + 4] = v8;
-                    mapVertices[vCounter + 5] = v5;
-                    vCounter += 6;
+    // At this point all vertex data (v, vt, vn) has been gathered on midVertices, midTexCoords, midNormals
+    // Now we can organize that data into our Mesh struct
 
-                    mapNormals[nCounter] = n1;
-                    mapNormals[nCounter + 1] = n1;
-                    mapNormals[nCounter + 2] = n1;
-                    mapNormals[nCounter + 3] = n1;
-                    mapNormals[nCounter + 4] = n1;
-                    mapNormals[nCounter + 5] = n1;
-                    nCounter += 6;
+    mesh.vertexCount = triangleCount*3;
 
-                    mapTexcoords[tcCounter] = (Vector2){ rightTexUV.x, rightTexUV.y };
-                    mapTexcoords[tcCounter + 1] = (Vector2){ rightTexUV.x, rightTexUV.y + rightTexUV.height };
-                    mapTexcoords[tcCounter + 2] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y };
-                    mapTexcoords[tcCounter + 3] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y };
-                    mapTexcoords[tcCounter + 4] = (Vector2){ rightTexUV.x, rightTexUV.y + rightTexUV.height };
-                    mapTexcoords[tcCounter + 5] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y + rightTexUV.height };
-                    tcCounter += 6;
-                }
+    // Additional arrays to store vertex data as floats
+    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
+    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
 
-                if (((x > 0) &&
-                (cubicmapPixels[z*cubicmap.width + (x - 1)].r == 0) &&
-                (cubicmapPixels[z*cubicmap.width + (x - 1)].g == 0) &&
-                (cubicmapPixels[z*cubicmap.width + (x - 1)].b == 0)) || (x == 0))
-                {
-                    // Define left triangles (2 tris, 6 vertex) --> v1 v7 v2, v1 v6 v7
-                    // NOTE: Collateral occluded faces are not generated
-                    mapVertices[vCounter] = v1;
-                    mapVertices[vCounter + 1] = v7;
-                    mapVertices[vCounter + 2] = v2;
-                    mapVertices[vCounter + 3] = v1;
-                    mapVertices[vCounter + 4] = v6;
-                    mapVertices[vCounter + 5] = v7;
-                    vCounter += 6;
+    int vCounter = 0;       // Used to count vertices float by float
+    int tcCounter = 0;      // Used to count texcoords float by float
+    int nCounter = 0;       // Used to count normals float by float
 
-                    mapNormals[nCounter] = n2;
-                    mapNormals[nCounter + 1] = n2;
-                    mapNormals[nCounter + 2] = n2;
-                    mapNormals[nCounter + 3] = n2;
-                    mapNormals[nCounter + 4] = n2;
-                    mapNormals[nCounter + 5] = n2;
-                    nCounter += 6;
+    int vCount[3], vtCount[3], vnCount[3];    // Used to store triangle indices for v, vt, vn
 
-                    mapTexcoords[tcCounter] = (Vector2){ leftTexUV.x, leftTexUV.y };
-                    mapTexcoords[tcCounter + 1] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y + leftTexUV.height };
-                    mapTexcoords[tcCounter + 2] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y };
-                    mapTexcoords[tcCounter + 3] = (Vector2){ leftTexUV.x, leftTexUV.y };
-                    mapTexcoords[tcCounter + 4] = (Vector2){ leftTexUV.x, leftTexUV.y + leftTexUV.height };
-                    mapTexcoords[tcCounter + 5] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y + leftTexUV.height };
-                    tcCounter += 6;
-                }
-            }
-            // We check pixel color to be BLACK, we will only draw floor and roof
-            else if  ((cubicmapPixels[z*cubicmap.width + x].r == 0) &&
-                      (cubicmapPixels[z*cubicmap.width + x].g == 0) &&
-                      (cubicmapPixels[z*cubicmap.width + x].b == 0))
+    rewind(objFile);        // Return to the beginning of the file, to read again
+
+    if (normalCount == 0) TraceLog(LOG_INFO, "[%s] No normals data on OBJ, normals will be generated from faces data", fileName);
+
+    // Third reading pass: Get faces (triangles) data and fill VertexArray
+    while (!feof(objFile))
+    {
+        fscanf(objFile, "%c", &dataType);
+
+        switch (dataType)
+        {
+            case '#': case 'o': case 'g': case 's': case 'm': case 'u': case 'v': fgets(comments, 200, objFile); break;
+            case 'f':
             {
-                // Define top triangles (2 tris, 6 vertex --> v1-v2-v3, v1-v3-v4)
-                mapVertices[vCounter] = v1;
-                mapVertices[vCounter + 1] = v3;
-                mapVertices[vCounter + 2] = v2;
-                mapVertices[vCounter + 3] = v1;
-                mapVertices[vCounter + 4] = v4;
-                mapVertices[vCounter + 5] = v3;
-                vCounter += 6;
+                // NOTE: It could be that OBJ does not have normals or texcoords defined!
 
-                mapNormals[nCounter] = n4;
-                mapNormals[nCounter + 1] = n4;
-                mapNormals[nCounter + 2] = n4;
-                mapNormals[nCounter + 3] = n4;
-                mapNormals[nCounter + 4] = n4;
-                mapNormals[nCounter + 5] = n4;
-                nCounter += 6;
+                if ((normalCount == 0) && (texcoordCount == 0)) fscanf(objFile, "%i %i %i", &vCount[0], &vCount[1], &vCount[2]);
+                else if (normalCount == 0) fscanf(objFile, "%i/%i %i/%i %i/%i", &vCount[0], &vtCount[0], &vCount[1], &vtCount[1], &vCount[2], &vtCount[2]);
+                else if (texcoordCount == 0) fscanf(objFile, "%i//%i %i//%i %i//%i", &vCount[0], &vnCount[0], &vCount[1], &vnCount[1], &vCount[2], &vnCount[2]);
+                else fscanf(objFile, "%i/%i/%i %i/%i/%i %i/%i/%i", &vCount[0], &vtCount[0], &vnCount[0], &vCount[1], &vtCount[1], &vnCount[1], &vCount[2], &vtCount[2], &vnCount[2]);
 
-                mapTexcoords[tcCounter] = (Vector2){ topTexUV.x, topTexUV.y };
-                mapTexcoords[tcCounter + 1] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
-                mapTexcoords[tcCounter + 2] = (Vector2){ topTexUV.x, topTexUV.y + topTexUV.height };
-                mapTexcoords[tcCounter + 3] = (Vector2){ topTexUV.x, topTexUV.y };
-                mapTexcoords[tcCounter + 4] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y };
-                mapTexcoords[tcCounter + 5] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
-                tcCounter += 6;
+                mesh.vertices[vCounter] = midVertices[vCount[0]-1].x;
+                mesh.vertices[vCounter + 1] = midVertices[vCount[0]-1].y;
+                mesh.vertices[vCounter + 2] = midVertices[vCount[0]-1].z;
+                vCounter += 3;
+                mesh.vertices[vCounter] = midVertices[vCount[1]-1].x;
+                mesh.vertices[vCounter + 1] = midVertices[vCount[1]-1].y;
+                mesh.vertices[vCounter + 2] = midVertices[vCount[1]-1].z;
+                vCounter += 3;
+                mesh.vertices[vCounter] = midVertices[vCount[2]-1].x;
+                mesh.vertices[vCounter + 1] = midVertices[vCount[2]-1].y;
+                mesh.vertices[vCounter + 2] = midVertices[vCount[2]-1].z;
+                vCounter += 3;
 
-                // Define bottom triangles (2 tris, 6 vertex --> v6-v8-v7, v6-v5-v8)
-                mapVertices[vCounter] = v6;
-                mapVertices[vCounter + 1] = v7;
-                mapVertices[vCounter + 2] = v8;
-                mapVertices[vCounter + 3] = v6;
-                mapVertices[vCounter + 4] = v8;
-                mapVertices[vCounter + 5] = v5;
-                vCounter += 6;
+                if (normalCount > 0)
+                {
+                    mesh.normals[nCounter] = midNormals[vnCount[0]-1].x;
+                    mesh.normals[nCounter + 1] = midNormals[vnCount[0]-1].y;
+                    mesh.normals[nCounter + 2] = midNormals[vnCount[0]-1].z;
+                    nCounter += 3;
+                    mesh.normals[nCounter] = midNormals[vnCount[1]-1].x;
+                    mesh.normals[nCounter + 1] = midNormals[vnCount[1]-1].y;
+                    mesh.normals[nCounter + 2] = midNormals[vnCount[1]-1].z;
+                    nCounter += 3;
+                    mesh.normals[nCounter] = midNormals[vnCount[2]-1].x;
+                    mesh.normals[nCounter + 1] = midNormals[vnCount[2]-1].y;
+                    mesh.normals[nCounter + 2] = midNormals[vnCount[2]-1].z;
+                    nCounter += 3;
+                }
+                else
+                {
+                    // If normals not defined, they are calculated from the 3 vertices [N = (V2 - V1) x (V3 - V1)]
+                    Vector3 norm = Vector3CrossProduct(Vector3Subtract(midVertices[vCount[1]-1], midVertices[vCount[0]-1]), Vector3Subtract(midVertices[vCount[2]-1], midVertices[vCount[0]-1]));
+                    norm = Vector3Normalize(norm);
 
-                mapNormals[nCounter] = n3;
-                mapNormals[nCounter + 1] = n3;
-                mapNormals[nCounter + 2] = n3;
-                mapNormals[nCounter + 3] = n3;
-                mapNormals[nCounter + 4] = n3;
-                mapNormals[nCounter + 5] = n3;
-                nCounter += 6;
+                    mesh.normals[nCounter] = norm.x;
+                    mesh.normals[nCounter + 1] = norm.y;
+                    mesh.normals[nCounter + 2] = norm.z;
+                    nCounter += 3;
+                    mesh.normals[nCounter] = norm.x;
+                    mesh.normals[nCounter + 1] = norm.y;
+                    mesh.normals[nCounter + 2] = norm.z;
+                    nCounter += 3;
+                    mesh.normals[nCounter] = norm.x;
+                    mesh.normals[nCounter + 1] = norm.y;
+                    mesh.normals[nCounter + 2] = norm.z;
+                    nCounter += 3;
+                }
 
-                mapTexcoords[tcCounter] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
-                mapTexcoords[tcCounter + 1] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y + bottomTexUV.height };
-                mapTexcoords[tcCounter + 2] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
-                mapTexcoords[tcCounter + 3] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
-                mapTexcoords[tcCounter + 4] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
-                mapTexcoords[tcCounter + 5] = (Vector2){ bottomTexUV.x, bottomTexUV.y };
-                tcCounter += 6;
-            }
+                if (texcoordCount > 0)
+                {
+                    // NOTE: If using negative texture coordinates with a texture filter of GL_CLAMP_TO_EDGE doesn't work!
+                    // NOTE: Texture coordinates are Y flipped upside-down
+                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[0]-1].x;
+                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[0]-1].y;
+                    tcCounter += 2;
+                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[1]-1].x;
+                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[1]-1].y;
+                    tcCounter += 2;
+                    mesh.texcoords[tcCounter] = midTexCoords[vtCount[2]-1].x;
+                    mesh.texcoords[tcCounter + 1] = 1.0f - midTexCoords[vtCount[2]-1].y;
+                    tcCounter += 2;
+                }
+            } break;
+            default: break;
         }
     }
 
-    // Move data from mapVertices temp arays to vertices float array
-    mesh.vertexCount = vCounter;
+    fclose(objFile);
 
-    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
-    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
-    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
+    // Security check, just in case no normals or no texcoords defined in OBJ
+    if (texcoordCount == 0) for (int i = 0; i < (2*mesh.vertexCount); i++) mesh.texcoords[i] = 0.0f;
 
-    int fCounter = 0;
+    // Now we can free temp mid* arrays
+    free(midVertices);
+    free(midNormals);
+    free(midTexCoords);
 
-    // Move vertices data
-    for (int i = 0; i < vCounter; i++)
+    // NOTE: At this point we have all vertex, texcoord, normal data for the model in mesh struct
+    TraceLog(LOG_INFO, "[%s] Mesh loaded successfully in RAM (CPU)", fileName);
+    
+    // Upload mesh data into VRAM
+    UploadMeshData(&mesh);
+
+    return mesh;
+}
+
+// Upload mesh data into VRAM
+static void UploadMeshData(Mesh *mesh)
+{
+    GLuint vaoId = 0;           // Vertex Array Objects (VAO)
+    GLuint vboId[3] = { 0 };    // Vertex Buffer Objects (VBOs)
+    
+    // Compute mesh bounds while vertex data is available in RAM
+    // NOTE: Bounding sphere is centered on bounding box, radius is max vertex distance to center
+    mesh->bounds = GetMeshBoundingBox(*mesh);
+    mesh->sphereCenter = Vector3Scale(Vector3Add(mesh->bounds.min, mesh->bounds.max), 0.5f);
+    mesh->sphereRadius = 0.0f;
+    
+    for (int i = 0; i < mesh->vertexCount; i++)
+    {
+        Vector3 vertex = { mesh->vertices[i*3], mesh->vertices[i*3 + 1], mesh->vertices[i*3 + 2] };
+        float distance = Vector3Distance(vertex, mesh->sphereCenter);
+        
+        if (distance > mesh->sphereRadius) mesh->sphereRadius = distance;
+    }
+
+    // Initialize Quads VAO (Buffer A)
+    glGenVertexArrays(1, &vaoId);
+    glBindVertexArray(vaoId);
+
+    // NOTE: Attributes must be uploaded considering default locations points
+
+    // Enable vertex attributes: position (shader-location = 0)
+    glGenBuffers(1, &vboId[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, vboId[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*mesh->vertexCount, mesh->vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
+    glEnableVertexAttribArray(0);
+
+    // Enable vertex attributes: texcoords (shader-location = 1)
+    glGenBuffers(1, &vboId[1]);
+    glBindBuffer(GL_ARRAY_BUFFER, vboId[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*mesh->vertexCount, mesh->texcoords, GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, 0, 0, 0);
+    glEnableVertexAttribArray(1);
+
+    // Enable vertex attributes: normals (shader-location = 2)
+    if (mesh->normals != NULL)
+    {
+        glGenBuffers(1, &vboId[2]);
+        glBindBuffer(GL_ARRAY_BUFFER, vboId[2]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*mesh->vertexCount, mesh->normals, GL_STATIC_DRAW);
+        glVertexAttribPointer(2, 3, GL_FLOAT, 0, 0, 0);
+        glEnableVertexAttribArray(2);
+    }
+    else
+    {
+        // Default normal vertex attribute set 1.0f
+        glVertexAttrib3f(2, 1.0f, 1.0f, 1.0f);
+        glDisableVertexAttribArray(2);
+    }
+
+    mesh->vboId[0] = vboId[0];     // Vertex position VBO
+    mesh->vboId[1] = vboId[1];     // Texcoords VBO
+    mesh->vboId[2] = vboId[2];     // Normals VBO
+    
+    // Indices buffer, bound to VAO
+    if (mesh->indices != NULL)
+    {
+        glGenBuffers(1, &mesh->vboId[3]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->vboId[3]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int)*3*mesh->triangleCount, mesh->indices, GL_STATIC_DRAW);
+        
+        vramUsage += mesh->triangleCount*3*sizeof(unsigned int);
+    }
+    
+    glBindVertexArray(0);
+
+    mesh->vaoId = vaoId;
+    
+    vramUsage += mesh->vertexCount*(3 + 2 + ((mesh->normals != NULL)? 3 : 0))*sizeof(float);
+    
+    // Chunked meshes: draw indirect buffer, filled with visible chunks draw commands every frame
+    if ((mesh->chunkCount > 0) && (multiDrawArraysIndirect != NULL))
+    {
+        glGenBuffers(1, &mesh->indirectId);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mesh->indirectId);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, mesh->chunkCount*sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        
+        vramUsage += mesh->chunkCount*sizeof(DrawElementsIndirectCommand);
+    }
+    
+    TraceLog(LOG_INFO, "[VAO ID %i] Mesh uploaded successfully to VRAM (GPU)", mesh->vaoId);
+}
+
+// Load model (initialize)
+// NOTE: Default material uses default shader and diffuse texture
+static Model LoadModel(Mesh mesh, Texture2D diffuse)
+{
+    Model model = { 0 };
+    
+    model.mesh = mesh;
+    model.material.shader = shdrDefault;
+    model.material.texDiffuse = diffuse;
+    model.transform = MatrixIdentity();
+    
+    return model;
+}
+
+// Unload model data from memory (RAM and VRAM)
+// NOTE: Unloads Mesh data and Material shader
+static void UnloadModel(Model model)
+{
+    // Unload mesh data
+    if (model.mesh.vertices != NULL) free(model.mesh.vertices);
+    if (model.mesh.texcoords != NULL) free(model.mesh.texcoords);
+    if (model.mesh.normals != NULL) free(model.mesh.normals);
+    if (model.mesh.indices != NULL) free(model.mesh.indices);
+    if (model.mesh.clusters != NULL) free(model.mesh.clusters);
+
+    if (model.mesh.vboId[0] != 0) glDeleteBuffers(1, &model.mesh.vboId[0]);   // vertex
+    if (model.mesh.vboId[1] != 0) glDeleteBuffers(1, &model.mesh.vboId[1]);   // texcoords
+    if (model.mesh.vboId[2] != 0) glDeleteBuffers(1, &model.mesh.vboId[2]);   // normals
+    if (model.mesh.vboId[3] != 0) glDeleteBuffers(1, &model.mesh.vboId[3]);   // indices
+    
+    if (model.mesh.vaoId != 0) glDeleteVertexArrays(1, &model.mesh.vaoId);
+    
+    vramUsage -= model.mesh.vertexCount*(3 + 2 + ((model.mesh.vboId[2] != 0)? 3 : 0))*sizeof(float);
+    if (model.mesh.vboId[3] != 0) vramUsage -= model.mesh.triangleCount*3*sizeof(unsigned int);
+    
+    // Unload mesh chunks data
+    if (model.mesh.chunks != NULL) free(model.mesh.chunks);
+    
+    if (model.mesh.indirectId != 0)
+    {
+        glDeleteBuffers(1, &model.mesh.indirectId);
+        vramUsage -= model.mesh.chunkCount*sizeof(DrawElementsIndirectCommand);
+    }
+    
+    // Unload material texture
+    // NOTE: Default shader is unloaded on CloseWindow()
+    UnloadTexture(model.material.texDiffuse);
+}
+
+static void DrawModel(Model model, Vector3 position, float scale, Color tint)
+{
+    // Calculate transformation matrix from function parameters
+    // Get transform matrix (scale -> translation)
+    Matrix matScale = MatrixScale(scale, scale, scale);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix matTransform = MatrixMultiply(matScale, matTranslation);
+
+    // Combine model transform matrix with matrix generated by function parameters (matTransform)
+    // NOTE: View and projection transformations are applied in shader from per-frame data
+    model.transform = MatrixMultiply(model.transform, matTransform);
+
+    model.material.colDiffuse = tint;           // Assign tint as diffuse color
+
+    glUseProgram(model.material.shader.id);     // Bind material shader
+
+    // Upload to shader material.colDiffuse
+    glUniform4f(model.material.shader.colorLoc, 
+                (float)model.material.colDiffuse.r/255, 
+                (float)model.material.colDiffuse.g/255, 
+                (float)model.material.colDiffuse.b/255, 
+                (float)model.material.colDiffuse.a/255);
+
+    // Set shader textures (diffuse, normal, specular)
+    // NOTE: Diffuse texture fits in active texture unit 0
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, model.material.texDiffuse.id);
+
+    // Bind mesh VAO (vertex array objects)
+    glBindVertexArray(model.mesh.vaoId);
+    
+    // Send model matrix to shader
+    glUniformMatrix4fv(model.material.shader.modelLoc, 1, false, MatrixToFloat(model.transform));
+
+    // Draw call!
+    if (model.mesh.indices != NULL) glDrawElements(GL_TRIANGLES, model.mesh.triangleCount*3, GL_UNSIGNED_INT, 0);
+    else glDrawArrays(GL_TRIANGLES, 0, model.mesh.vertexCount);
+
+    glActiveTexture(GL_TEXTURE0);       // Set shader active texture to default 0
+    glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
+    glBindVertexArray(0);               // Unbind VAO
+    glUseProgram(0);                    // Unbind shader program
+}
+
+// Mesh optimization: vertex cache and overdraw triangles ordering
+//----------------------------------------------------------------------------------
+// Index mesh vertices and reorder triangles for vertex cache and overdraw (before upload)
+// NOTE: Duplicated vertices (same position, texcoords and normal) are merged; triangles are reordered
+// inside every chunk range (chunks become index ranges), overdraw ordering is only applied to
+// not chunked meshes (props seen from outside), ACMR/ATVR are reported before and after
+static void OptimizeMesh(Mesh *mesh)
+{
+    if ((mesh->indices != NULL) || (mesh->vertexCount < 3)) return;
+    
+    int triangleCount = mesh->vertexCount/3;
+    int stride = (mesh->normals != NULL)? 8 : 5;
+    
+    unsigned int *indices = (unsigned int *)malloc(triangleCount*3*sizeof(unsigned int));
+    float *attribs = (float *)malloc(mesh->vertexCount*stride*sizeof(float));   // Unique vertices interleaved attributes
+    int vertexCount = 0;
+    
+    // Merge duplicated vertices, hash table with linear probing
+    int tableSize = 1;
+    while (tableSize < mesh->vertexCount*2) tableSize *= 2;
+    
+    int *table = (int *)malloc(tableSize*sizeof(int));
+    for (int i = 0; i < tableSize; i++) table[i] = -1;
+    
+    for (int i = 0; i < triangleCount*3; i++)
+    {
+        float vertex[8] = { mesh->vertices[i*3], mesh->vertices[i*3 + 1], mesh->vertices[i*3 + 2], mesh->texcoords[i*2], mesh->texcoords[i*2 + 1] };
+        if (mesh->normals != NULL) { vertex[5] = mesh->normals[i*3]; vertex[6] = mesh->normals[i*3 + 1]; vertex[7] = mesh->normals[i*3 + 2]; }
+        
+        // FNV-1a hash of vertex attributes
+        unsigned int hash = 2166136261u;
+        for (int k = 0; k < stride*(int)sizeof(float); k++) hash = (hash ^ ((unsigned char *)vertex)[k])*16777619u;
+        
+        int slot = hash & (tableSize - 1);
+        
+        while ((table[slot] != -1) && (memcmp(&attribs[table[slot]*stride], vertex, stride*sizeof(float)) != 0)) slot = (slot + 1) & (tableSize - 1);
+        
+        if (table[slot] == -1)
+        {
+            memcpy(&attribs[vertexCount*stride], vertex, stride*sizeof(float));
+            table[slot] = vertexCount++;
+        }
+        
+        indices[i] = table[slot];
+    }
+    
+    free(table);
+    
+    float acmrBefore = GetVertexCacheMissRatio(indices, triangleCount, VERTEX_CACHE_SIM_SIZE);
+    
+    // Reorder triangles inside every range (whole mesh or chunk), using range local vertex indices
+    int *localIndex = (int *)malloc(vertexCount*sizeof(int));
+    unsigned int *globalIndex = (unsigned int *)malloc(vertexCount*sizeof(unsigned int));
+    unsigned int *rangeIndices = (unsigned int *)malloc(triangleCount*3*sizeof(unsigned int));
+    for (int i = 0; i < vertexCount; i++) localIndex[i] = -1;
+    
+    int rangeCount = (mesh->chunkCount > 0)? mesh->chunkCount : 1;
+    
+    for (int r = 0; r < rangeCount; r++)
+    {
+        int first = (mesh->chunkCount > 0)? mesh->chunks[r].firstVertex : 0;
+        int count = (mesh->chunkCount > 0)? mesh->chunks[r].vertexCount : triangleCount*3;
+        int localCount = 0;
+        
+        for (int i = 0; i < count; i++)
+        {
+            unsigned int index = indices[first + i];
+            
+            if (localIndex[index] == -1)
+            {
+                localIndex[index] = localCount;
+                globalIndex[localCount++] = index;
+            }
+            
+            rangeIndices[i] = localIndex[index];
+        }
+        
+        OptimizeVertexCache(rangeIndices, count/3, localCount);
+        
+        for (int i = 0; i < count; i++) indices[first + i] = globalIndex[rangeIndices[i]];
+        for (int i = 0; i < localCount; i++) localIndex[globalIndex[i]] = -1;
+    }
+    
+    free(localIndex);
+    free(globalIndex);
+    free(rangeIndices);
+    
+    // Replace vertex data by unique vertices
+    free(mesh->vertices);
+    free(mesh->texcoords);
+    if (mesh->normals != NULL) free(mesh->normals);
+    
+    mesh->vertices = (float *)malloc(vertexCount*3*sizeof(float));
+    mesh->texcoords = (float *)malloc(vertexCount*2*sizeof(float));
+    if (stride == 8) mesh->normals = (float *)malloc(vertexCount*3*sizeof(float));
+    
+    for (int i = 0; i < vertexCount; i++)
+    {
+        memcpy(&mesh->vertices[i*3], &attribs[i*stride], 3*sizeof(float));
+        memcpy(&mesh->texcoords[i*2], &attribs[i*stride + 3], 2*sizeof(float));
+        if (stride == 8) memcpy(&mesh->normals[i*3], &attribs[i*stride + 5], 3*sizeof(float));
+    }
+    
+    free(attribs);
+    
+    if (mesh->chunkCount == 0) OptimizeOverdraw(indices, triangleCount, mesh->vertices);
+    
+    float acmrAfter = GetVertexCacheMissRatio(indices, triangleCount, VERTEX_CACHE_SIM_SIZE);
+    
+    TraceLog(LOG_INFO, "Mesh optimized (vertices: %i -> %i, ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f)", mesh->vertexCount, vertexCount, 
+             acmrBefore, acmrAfter, acmrBefore*triangleCount/vertexCount, acmrAfter*triangleCount/vertexCount);
+    
+    mesh->vertexCount = vertexCount;
+    mesh->triangleCount = triangleCount;
+    mesh->indices = indices;
+}
+
+// Reorder triangles for vertex cache locality (Forsyth)
+// NOTE: Next triangle is the best scored one using vertices in cache, vertices score favours recently used
+// vertices and vertices with few triangles left; if no candidate is found, next triangle in order is used
+static void OptimizeVertexCache(unsigned int *indices, int triangleCount, int vertexCount)
+{
+    if (triangleCount == 0) return;
+    
+    // Vertices triangles adjacency (compressed lists)
+    int *valence = (int *)calloc(vertexCount, sizeof(int));
+    int *adjacencyOffset = (int *)malloc((vertexCount + 1)*sizeof(int));
+    int *adjacency = (int *)malloc(triangleCount*3*sizeof(int));
+    
+    for (int i = 0; i < triangleCount*3; i++) valence[indices[i]]++;
+    
+    adjacencyOffset[0] = 0;
+    for (int v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+    
+    for (int v = 0; v < vertexCount; v++) valence[v] = 0;
+    for (int i = 0; i < triangleCount*3; i++) 
+    {
+        int v = indices[i];
+        adjacency[adjacencyOffset[v] + valence[v]++] = i/3;
+    }
+    
+    // NOTE: valence becomes remaining triangles per vertex, adjacency lists keep remaining triangles first
+    int *cachePosition = (int *)malloc(vertexCount*sizeof(int));
+    float *vertexScore = (float *)malloc(vertexCount*sizeof(float));
+    float *triangleScore = (float *)malloc(triangleCount*sizeof(float));
+    bool *triangleAdded = (bool *)calloc(triangleCount, sizeof(bool));
+    unsigned int *output = (unsigned int *)malloc(triangleCount*3*sizeof(unsigned int));
+    
+    for (int v = 0; v < vertexCount; v++)
+    {
+        cachePosition[v] = -1;
+        vertexScore[v] = GetForsythVertexScore(-1, valence[v]);
+    }
+    
+    int bestTriangle = 0;
+    
+    for (int t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = vertexScore[indices[t*3]] + vertexScore[indices[t*3 + 1]] + vertexScore[indices[t*3 + 2]];
+        if (triangleScore[t] > triangleScore[bestTriangle]) bestTriangle = t;
+    }
+    
+    int cache[VERTEX_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    int nextTriangle = 0;       // Next triangle in order, used when no candidate found
+    
+    for (int n = 0; n < triangleCount; n++)
+    {
+        if (bestTriangle < 0)
+        {
+            while (triangleAdded[nextTriangle]) nextTriangle++;
+            bestTriangle = nextTriangle;
+        }
+        
+        // Add best triangle to output, remove it from vertices adjacency
+        triangleAdded[bestTriangle] = true;
+        
+        for (int k = 0; k < 3; k++)
+        {
+            int v = indices[bestTriangle*3 + k];
+            output[n*3 + k] = v;
+            
+            int *list = &adjacency[adjacencyOffset[v]];
+            int j = 0;
+            while (list[j] != bestTriangle) j++;
+            list[j] = list[valence[v] - 1];
+            list[valence[v] - 1] = bestTriangle;
+            valence[v]--;
+        }
+        
+        // Update cache: triangle vertices moved to front (LRU)
+        int newCache[VERTEX_CACHE_SIZE + 3];
+        int newCount = 0;
+        
+        for (int k = 0; k < 3; k++) newCache[newCount++] = indices[bestTriangle*3 + k];
+        
+        for (int i = 0; i < cacheCount; i++)
+        {
+            int v = cache[i];
+            if ((v != newCache[0]) && (v != newCache[1]) && (v != newCache[2])) newCache[newCount++] = v;
+        }
+        
+        // Update cache vertices scores (evicted vertices are out of cache)
+        for (int i = 0; i < newCount; i++)
+        {
+            int v = newCache[i];
+            cachePosition[v] = (i < VERTEX_CACHE_SIZE)? i : -1;
+            
+            float score = GetForsythVertexScore(cachePosition[v], valence[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            
+            for (int j = 0; j < valence[v]; j++) triangleScore[adjacency[adjacencyOffset[v] + j]] += delta;
+        }
+        
+        cacheCount = (newCount < VERTEX_CACHE_SIZE)? newCount : VERTEX_CACHE_SIZE;
+        for (int i = 0; i < cacheCount; i++) cache[i] = newCache[i];
+        
+        // Next best triangle, only triangles using cached vertices are candidates
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        
+        for (int i = 0; i < cacheCount; i++)
+        {
+            int v = cache[i];
+            
+            for (int j = 0; j < valence[v]; j++)
+            {
+                int t = adjacency[adjacencyOffset[v] + j];
+                
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+    
+    memcpy(indices, output, triangleCount*3*sizeof(unsigned int));
+    
+    free(valence);
+    free(adjacencyOffset);
+    free(adjacency);
+    free(cachePosition);
+    free(vertexScore);
+    free(triangleScore);
+    free(triangleAdded);
+    free(output);
+}
+
+// Reorder triangles clusters, outer facing clusters first
+// NOTE: Vertex cache optimized sequence is split in clusters where all triangle vertices miss the cache,
+// clusters are sorted by how much they face outwards from mesh center: for meshes seen from outside,
+// outer clusters are drawn first and occlude inner ones on early depth test
+static void OptimizeOverdraw(unsigned int *indices, int triangleCount, const float *vertices)
+{
+    typedef struct Cluster {
+        int firstTriangle;
+        int triangleCount;
+        float sortKey;
+    } Cluster;
+    
+    Cluster *clusters = (Cluster *)malloc(triangleCount*sizeof(Cluster));
+    int clusterCount = 0;
+    
+    // Split sequence in clusters (FIFO cache simulation)
+    int cache[VERTEX_CACHE_SIM_SIZE];
+    int cacheCount = 0, cacheHead = 0;
+    
+    for (int t = 0; t < triangleCount; t++)
+    {
+        int misses = 0;
+        
+        for (int k = 0; k < 3; k++)
+        {
+            int v = indices[t*3 + k];
+            int i = 0;
+            
+            while ((i < cacheCount) && (cache[i] != v)) i++;
+            
+            if (i == cacheCount)
+            {
+                misses++;
+                
+                if (cacheCount < VERTEX_CACHE_SIM_SIZE) cache[cacheCount++] = v;
+                else
+                {
+                    cache[cacheHead] = v;
+                    cacheHead = (cacheHead + 1)%VERTEX_CACHE_SIM_SIZE;
+                }
+            }
+        }
+        
+        if ((clusterCount == 0) || ((misses == 3) && (clusters[clusterCount - 1].triangleCount >= OVERDRAW_CLUSTER_SIZE)))
+        {
+            clusters[clusterCount] = (Cluster){ t, 0, 0.0f };
+            clusterCount++;
+        }
+        
+        clusters[clusterCount - 1].triangleCount++;
+    }
+    
+    // Mesh centroid
+    Vector3 meshCenter = Vector3Zero();
+    
+    for (int i = 0; i < triangleCount*3; i++) meshCenter = Vector3Add(meshCenter, (Vector3){ vertices[indices[i]*3], vertices[indices[i]*3 + 1], vertices[indices[i]*3 + 2] });
+    meshCenter = Vector3Scale(meshCenter, 1.0f/(triangleCount*3));
+    
+    // Clusters sort key: cluster area-weighted normal dot cluster centroid direction from mesh centroid
+    for (int c = 0; c < clusterCount; c++)
+    {
+        Vector3 center = Vector3Zero();
+        Vector3 normal = Vector3Zero();
+        
+        for (int t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].triangleCount; t++)
+        {
+            Vector3 v0 = { vertices[indices[t*3]*3], vertices[indices[t*3]*3 + 1], vertices[indices[t*3]*3 + 2] };
+            Vector3 v1 = { vertices[indices[t*3 + 1]*3], vertices[indices[t*3 + 1]*3 + 1], vertices[indices[t*3 + 1]*3 + 2] };
+            Vector3 v2 = { vertices[indices[t*3 + 2]*3], vertices[indices[t*3 + 2]*3 + 1], vertices[indices[t*3 + 2]*3 + 2] };
+            
+            center = Vector3Add(center, Vector3Scale(Vector3Add(Vector3Add(v0, v1), v2), 1.0f/3.0f));
+            normal = Vector3Add(normal, Vector3CrossProduct(Vector3Subtract(v1, v0), Vector3Subtract(v2, v0)));
+        }
+        
+        center = Vector3Scale(center, 1.0f/clusters[c].triangleCount);
+        
+        float length = Vector3Length(normal);
+        if (length > 0.0f) normal = Vector3Scale(normal, 1.0f/length);
+        
+        clusters[c].sortKey = Vector3DotProduct(Vector3Subtract(center, meshCenter), normal);
+    }
+    
+    // Sort clusters by key, descending (insertion sort, clusters are few)
+    for (int i = 1; i < clusterCount; i++)
+    {
+        Cluster cluster = clusters[i];
+        int j = i - 1;
+        
+        while ((j >= 0) && (clusters[j].sortKey < cluster.sortKey))
+        {
+            clusters[j + 1] = clusters[j];
+            j--;
+        }
+        
+        clusters[j + 1] = cluster;
+    }
+    
+    unsigned int *output = (unsigned int *)malloc(triangleCount*3*sizeof(unsigned int));
+    int outputCount = 0;
+    
+    for (int c = 0; c < clusterCount; c++)
+    {
+        memcpy(&output[outputCount], &indices[clusters[c].firstTriangle*3], clusters[c].triangleCount*3*sizeof(unsigned int));
+        outputCount += clusters[c].triangleCount*3;
+    }
+    
+    memcpy(indices, output, triangleCount*3*sizeof(unsigned int));
+    
+    free(output);
+    free(clusters);
+}
+
+// Get vertex score from cache position and triangles left
+// NOTE: Scoring parameters from Tom Forsyth "Linear-speed vertex cache optimisation"
+static float GetForsythVertexScore(int cachePosition, int remainingValence)
+{
+    if (remainingValence == 0) return -1.0f;    // No triangles left using vertex
+    
+    float score = 0.0f;
+    
+    if (cachePosition >= 0)
+    {
+        // Vertices used by last triangle get a fixed score, so it doesn't matter which one was the last one
+        if (cachePosition < 3) score = 0.75f;
+        else score = powf(1.0f - (float)(cachePosition - 3)/(VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+    
+    // Boost vertices with few triangles left, so they are not left alone
+    score += 2.0f*powf((float)remainingValence, -0.5f);
+    
+    return score;
+}
+
+// Get ACMR, vertex cache misses per triangle (FIFO)
+// NOTE: ATVR (misses per vertex) can be computed as ACMR*triangleCount/vertexCount
+static float GetVertexCacheMissRatio(const unsigned int *indices, int triangleCount, int cacheSize)
+{
+    if (triangleCount == 0) return 0.0f;
+    
+    int *cache = (int *)malloc(cacheSize*sizeof(int));
+    int cacheCount = 0, cacheHead = 0;
+    int misses = 0;
+    
+    for (int i = 0; i < triangleCount*3; i++)
+    {
+        int v = indices[i];
+        int k = 0;
+        
+        while ((k < cacheCount) && (cache[k] != v)) k++;
+        
+        if (k == cacheCount)
+        {
+            misses++;
+            
+            if (cacheCount < cacheSize) cache[cacheCount++] = v;
+            else
+            {
+                cache[cacheHead] = v;
+                cacheHead = (cacheHead + 1)%cacheSize;
+            }
+        }
+    }
+    
+    free(cache);
+    
+    return (float)misses/triangleCount;
+}
+
+// Mesh clusters: partitioning and cone culling
+//----------------------------------------------------------------------------------
+// Split large indexed mesh into clusters with bounds and normal cone (before upload)
+// NOTE: Triangles are grouped in index order (vertex cache optimized, so neighbour triangles are
+// close in sequence), a new cluster is started when triangles or unique vertices limit is reached
+static void GenMeshClusters(Mesh *mesh)
+{
+    if ((mesh->indices == NULL) || (mesh->chunkCount > 0) || (mesh->triangleCount < MESH_CLUSTER_MIN_TRIANGLES)) return;
+    
+    int *vertexCluster = (int *)malloc(mesh->vertexCount*sizeof(int));     // Last cluster using every vertex
+    for (int i = 0; i < mesh->vertexCount; i++) vertexCluster[i] = -1;
+    
+    MeshCluster *clusters = (MeshCluster *)malloc(mesh->triangleCount*sizeof(MeshCluster));
+    int clusterCount = 0;
+    int clusterVertices = 0;
+    
+    for (int t = 0; t < mesh->triangleCount; t++)
+    {
+        unsigned int *triangle = &mesh->indices[t*3];
+        int newVertices = 0;
+        
+        for (int k = 0; k < 3; k++) if (vertexCluster[triangle[k]] != (clusterCount - 1)) newVertices++;
+        
+        if ((clusterCount == 0) || (clusters[clusterCount - 1].triangleCount == MESH_CLUSTER_MAX_TRIANGLES) || 
+            ((clusterVertices + newVertices) > MESH_CLUSTER_MAX_VERTICES))
+        {
+            clusters[clusterCount] = (MeshCluster){ t*3, 0 };
+            clusterCount++;
+            clusterVertices = 0;
+        }
+        
+        for (int k = 0; k < 3; k++)
+        {
+            if (vertexCluster[triangle[k]] != (clusterCount - 1))
+            {
+                vertexCluster[triangle[k]] = clusterCount - 1;
+                clusterVertices++;
+            }
+        }
+        
+        clusters[clusterCount - 1].triangleCount++;
+    }
+    
+    free(vertexCluster);
+    
+    // Compute clusters bounding sphere and normal cone
+    for (int c = 0; c < clusterCount; c++)
+    {
+        MeshCluster *cluster = &clusters[c];
+        unsigned int *indices = &mesh->indices[cluster->firstIndex];
+        
+        Vector3 min = { mesh->vertices[indices[0]*3], mesh->vertices[indices[0]*3 + 1], mesh->vertices[indices[0]*3 + 2] };
+        Vector3 max = min;
+        Vector3 axis = Vector3Zero();
+        
+        for (int i = 0; i < cluster->triangleCount*3; i++)
+        {
+            Vector3 vertex = { mesh->vertices[indices[i]*3], mesh->vertices[indices[i]*3 + 1], mesh->vertices[indices[i]*3 + 2] };
+            
+            min = Vector3Min(min, vertex);
+            max = Vector3Max(max, vertex);
+        }
+        
+        cluster->center = Vector3Scale(Vector3Add(min, max), 0.5f);
+        cluster->radius = 0.0f;
+        
+        for (int i = 0; i < cluster->triangleCount*3; i++)
+        {
+            Vector3 vertex = { mesh->vertices[indices[i]*3], mesh->vertices[indices[i]*3 + 1], mesh->vertices[indices[i]*3 + 2] };
+            float distance = Vector3Distance(vertex, cluster->center);
+            
+            if (distance > cluster->radius) cluster->radius = distance;
+        }
+        
+        // Cone axis: average of triangles normals, cone half-angle: max angle between axis and normals
+        Vector3 *normals = (Vector3 *)malloc(cluster->triangleCount*sizeof(Vector3));
+        
+        for (int t = 0; t < cluster->triangleCount; t++)
+        {
+            Vector3 v0 = { mesh->vertices[indices[t*3]*3], mesh->vertices[indices[t*3]*3 + 1], mesh->vertices[indices[t*3]*3 + 2] };
+            Vector3 v1 = { mesh->vertices[indices[t*3 + 1]*3], mesh->vertices[indices[t*3 + 1]*3 + 1], mesh->vertices[indices[t*3 + 1]*3 + 2] };
+            Vector3 v2 = { mesh->vertices[indices[t*3 + 2]*3], mesh->vertices[indices[t*3 + 2]*3 + 1], mesh->vertices[indices[t*3 + 2]*3 + 2] };
+            
+            normals[t] = Vector3CrossProduct(Vector3Subtract(v1, v0), Vector3Subtract(v2, v0));
+            
+            float length = Vector3Length(normals[t]);
+            normals[t] = (length > 0.0f)? Vector3Scale(normals[t], 1.0f/length) : Vector3Zero();   // Degenerate triangles are ignored
+            
+            axis = Vector3Add(axis, normals[t]);
+        }
+        
+        float axisLength = Vector3Length(axis);
+        float minDot = 1.0f;
+        
+        if (axisLength > 0.0f)
+        {
+            axis = Vector3Scale(axis, 1.0f/axisLength);
+            
+            for (int t = 0; t < cluster->triangleCount; t++)
+            {
+                if ((normals[t].x != 0.0f) || (normals[t].y != 0.0f) || (normals[t].z != 0.0f)) minDot = fminf(minDot, Vector3DotProduct(normals[t], axis));
+            }
+        }
+        else minDot = 0.0f;
+        
+        free(normals);
+        
+        cluster->coneAxis = axis;
+        
+        // NOTE: Wide cones (half-angle close to 90 degrees) are almost never back-facing, culling is disabled
+        cluster->coneCutoff = (minDot <= 0.1f)? 1.0f : sqrtf(1.0f - minDot*minDot);
+    }
+    
+    mesh->clusters = (MeshCluster *)realloc(clusters, clusterCount*sizeof(MeshCluster));
+    mesh->clusterCount = clusterCount;
+    
+    TraceLog(LOG_INFO, "Mesh clusters generated (triangles: %i, clusters: %i)", mesh->triangleCount, clusterCount);
+}
+
+// Check if a sphere is (partially) inside frustum
+// NOTE: Frustum planes are not normalized, distance to plane is scaled by plane normal length
+static bool CheckFrustumSphere(Frustum frustum, Vector3 center, float radius)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        float *plane = frustum.planes[i];
+        float length = sqrtf(plane[0]*plane[0] + plane[1]*plane[1] + plane[2]*plane[2]);
+        
+        if ((plane[0]*center.x + plane[1]*center.y + plane[2]*center.z + plane[3]) < -radius*length) return false;
+    }
+    
+    return true;
+}
+
+// Check if cluster is inside frustum and not back-facing
+// NOTE: Cluster sphere is transformed to world space, model transform is uniform scale and translation
+static bool CheckClusterVisible(MeshCluster cluster, Vector3 position, float scale, Frustum frustum, Vector3 viewPosition)
+{
+    Vector3 center = Vector3Add(Vector3Scale(cluster.center, scale), position);
+    float radius = cluster.radius*scale;
+    
+    if (!CheckFrustumSphere(frustum, center, radius)) return false;
+    
+    Vector3 viewToCenter = Vector3Subtract(center, viewPosition);
+    
+    return (Vector3DotProduct(viewToCenter, cluster.coneAxis) < (cluster.coneCutoff*Vector3Length(viewToCenter) + radius));
+}
+
+// Draw model visible clusters, returns clusters drawn
+// NOTE: Clusters are culled by frustum and normal cone (back-facing clusters), contiguous visible
+// clusters are merged in a single index range, all ranges submitted with glMultiDrawElements();
+// cone test requires back-face culling enabled and uniform scale without rotation (as model transform)
+static int DrawModelClusters(Model model, Vector3 position, float scale, Color tint, Frustum frustum, Vector3 viewPosition)
+{
+    if (model.mesh.clusterCount == 0)
+    {
+        DrawModel(model, position, scale, tint);
+        return 1;
+    }
+    
+    GLsizei *counts = (GLsizei *)malloc(model.mesh.clusterCount*sizeof(GLsizei));
+    const void **offsets = (const void **)malloc(model.mesh.clusterCount*sizeof(void *));
+    int drawCount = 0;
+    int clustersDrawn = 0;
+    int rangeEnd = -1;          // Last range end index, used to merge contiguous clusters
+    
+    // Culling pass: frustum and normal cone
+    for (int i = 0; i < model.mesh.clusterCount; i++)
+    {
+        MeshCluster *cluster = &model.mesh.clusters[i];
+        
+        if (!CheckClusterVisible(*cluster, position, scale, frustum, viewPosition)) continue;
+        
+        if (cluster->firstIndex == rangeEnd) counts[drawCount - 1] += cluster->triangleCount*3;
+        else
+        {
+            counts[drawCount] = cluster->triangleCount*3;
+            offsets[drawCount] = (void *)(cluster->firstIndex*sizeof(unsigned int));
+            drawCount++;
+        }
+        
+        rangeEnd = cluster->firstIndex + cluster->triangleCount*3;
+        clustersDrawn++;
+    }
+    
+    if (drawCount > 0)
+    {
+        // Get transform matrix (scale -> translation)
+        Matrix matTransform = MatrixMultiply(MatrixScale(scale, scale, scale), MatrixTranslate(position.x, position.y, position.z));
+        model.transform = MatrixMultiply(model.transform, matTransform);
+        
+        glUseProgram(model.material.shader.id);     // Bind material shader
+        
+        glUniform4f(model.material.shader.colorLoc, (float)tint.r/255, (float)tint.g/255, (float)tint.b/255, (float)tint.a/255);
+        glUniformMatrix4fv(model.material.shader.modelLoc, 1, false, MatrixToFloat(model.transform));
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, model.material.texDiffuse.id);
+        glBindVertexArray(model.mesh.vaoId);
+        
+        glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount);    // Single draw call for all visible ranges
+        
+        glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
+        glBindVertexArray(0);               // Unbind VAO
+        glUseProgram(0);                    // Unbind shader program
+    }
+    
+    free(counts);
+    free(offsets);
+    
+    return clustersDrawn;
+}
+
+// LESSON 05: Cubicmap generation, loading and drawing
+//----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
+// Generate cubicmap mesh from image data
+static Mesh GenMeshCubicmap(Image cubicmap, float cubeSize)
+{
+    Mesh mesh = { 0 };
+
+    Color *cubicmapPixels = GetImageDataView(cubicmap);
+
+    int mapWidth = cubicmap.width;
+    int mapHeight = cubicmap.height;
+
+    // NOTE: Max possible number of triangles numCubes * (12 triangles by cube)
+    int maxTriangles = cubicmap.width*cubicmap.height*12;
+
+    int vCounter = 0;       // Used to count vertices
+    int tcCounter = 0;      // Used to count texcoords
+    int nCounter = 0;       // Used to count normals
+
+    float w = cubeSize;
+    float h = cubeSize;
+    float h2 = cubeSize;
+
+    Vector3 *mapVertices = (Vector3 *)malloc(maxTriangles*3*sizeof(Vector3));
+    Vector2 *mapTexcoords = (Vector2 *)malloc(maxTriangles*3*sizeof(Vector2));
+    Vector3 *mapNormals = (Vector3 *)malloc(maxTriangles*3*sizeof(Vector3));
+
+    // Define the 6 normals of the cube, we will combine them accordingly later...
+    Vector3 n1 = { 1.0f, 0.0f, 0.0f };
+    Vector3 n2 = { -1.0f, 0.0f, 0.0f };
+    Vector3 n3 = { 0.0f, 1.0f, 0.0f };
+    Vector3 n4 = { 0.0f, -1.0f, 0.0f };
+    Vector3 n5 = { 0.0f, 0.0f, 1.0f };
+    Vector3 n6 = { 0.0f, 0.0f, -1.0f };
+
+    // NOTE: We use texture rectangles to define different textures for top-bottom-front-back-right-left (6)
+    typedef struct RectangleF {
+        float x;
+        float y;
+        float width;
+        float height;
+    } RectangleF;
+
+    RectangleF rightTexUV = { 0.0f, 0.0f, 0.5f, 0.5f };
+    RectangleF leftTexUV = { 0.5f, 0.0f, 0.5f, 0.5f };
+    RectangleF frontTexUV = { 0.0f, 0.0f, 0.5f, 0.5f };
+    RectangleF backTexUV = { 0.5f, 0.0f, 0.5f, 0.5f };
+    RectangleF topTexUV = { 0.0f, 0.5f, 0.5f, 0.5f };
+    RectangleF bottomTexUV = { 0.5f, 0.5f, 0.5f, 0.5f };
+
+    for (int z = 0; z < mapHeight; ++z)
+    {
+        for (int x = 0; x < mapWidth; ++x)
+        {
+            // Define the 8 vertex of the cube, we will combine them accordingly later...
+            Vector3 v1 = { w*(x - 0.5f), h2, h*(z - 0.5f) };
+            Vector3 v2 = { w*(x - 0.5f), h2, h*(z + 0.5f) };
+            Vector3 v3 = { w*(x + 0.5f), h2, h*(z + 0.5f) };
+            Vector3 v4 = { w*(x + 0.5f), h2, h*(z - 0.5f) };
+            Vector3 v5 = { w*(x + 0.5f), 0, h*(z - 0.5f) };
+            Vector3 v6 = { w*(x - 0.5f), 0, h*(z - 0.5f) };
+            Vector3 v7 = { w*(x - 0.5f), 0, h*(z + 0.5f) };
+            Vector3 v8 = { w*(x + 0.5f), 0, h*(z + 0.5f) };
+
+            // We check pixel color to be WHITE, we will full cubes
+            if ((cubicmapPixels[z*cubicmap.width + x].r == 255) &&
+                (cubicmapPixels[z*cubicmap.width + x].g == 255) &&
+                (cubicmapPixels[z*cubicmap.width + x].b == 255))
+            {
+                // Define triangles (Checking Collateral Cubes!)
+                //----------------------------------------------
+
+                // Define top triangles (2 tris, 6 vertex --> v1-v2-v3, v1-v3-v4)
+                mapVertices[vCounter] = v1;
+                mapVertices[vCounter + 1] = v2;
+                mapVertices[vCounter + 2] = v3;
+                mapVertices[vCounter + 3] = v1;
+                mapVertices[vCounter + 4] = v3;
+                mapVertices[vCounter + 5] = v4;
+                vCounter += 6;
+
+                mapNormals[nCounter] = n3;
+                mapNormals[nCounter + 1] = n3;
+                mapNormals[nCounter + 2] = n3;
+                mapNormals[nCounter + 3] = n3;
+                mapNormals[nCounter + 4] = n3;
+                mapNormals[nCounter + 5] = n3;
+                nCounter += 6;
+
+                mapTexcoords[tcCounter] = (Vector2){ topTexUV.x, topTexUV.y };
+                mapTexcoords[tcCounter + 1] = (Vector2){ topTexUV.x, topTexUV.y + topTexUV.height };
+                mapTexcoords[tcCounter + 2] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
+                mapTexcoords[tcCounter + 3] = (Vector2){ topTexUV.x, topTexUV.y };
+                mapTexcoords[tcCounter + 4] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
+                mapTexcoords[tcCounter + 5] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y };
+                tcCounter += 6;
+
+                // Define bottom triangles (2 tris, 6 vertex --> v6-v8-v7, v6-v5-v8)
+                mapVertices[vCounter] = v6;
+                mapVertices[vCounter + 1] = v8;
+                mapVertices[vCounter + 2] = v7;
+                mapVertices[vCounter + 3] = v6;
+                mapVertices[vCounter + 4] = v5;
+                mapVertices[vCounter + 5] = v8;
+                vCounter += 6;
+
+                mapNormals[nCounter] = n4;
+                mapNormals[nCounter + 1] = n4;
+                mapNormals[nCounter + 2] = n4;
+                mapNormals[nCounter + 3] = n4;
+                mapNormals[nCounter + 4] = n4;
+                mapNormals[nCounter + 5] = n4;
+                nCounter += 6;
+
+                mapTexcoords[tcCounter] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
+                mapTexcoords[tcCounter + 1] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
+                mapTexcoords[tcCounter + 2] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y + bottomTexUV.height };
+                mapTexcoords[tcCounter + 3] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
+                mapTexcoords[tcCounter + 4] = (Vector2){ bottomTexUV.x, bottomTexUV.y };
+                mapTexcoords[tcCounter + 5] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
+                tcCounter += 6;
+
+                if (((z < cubicmap.height - 1) &&
+                (cubicmapPixels[(z + 1)*cubicmap.width + x].r == 0) &&
+                (cubicmapPixels[(z + 1)*cubicmap.width + x].g == 0) &&
+                (cubicmapPixels[(z + 1)*cubicmap.width + x].b == 0)) || (z == cubicmap.height - 1))
+                {
+                    // Define front triangles (2 tris, 6 vertex) --> v2 v7 v3, v3 v7 v8
+                    // NOTE: Collateral occluded faces are not generated
+                    mapVertices[vCounter] = v2;
+                    mapVertices[vCounter + 1] = v7;
+                    mapVertices[vCounter + 2] = v3;
+                    mapVertices[vCounter + 3] = v3;
+                    mapVertices[vCounter + 4] = v7;
+                    mapVertices[vCounter + 5] = v8;
+                    vCounter += 6;
+
+                    mapNormals[nCounter] = n6;
+                    mapNormals[nCounter + 1] = n6;
+                    mapNormals[nCounter + 2] = n6;
+                    mapNormals[nCounter + 3] = n6;
+                    mapNormals[nCounter + 4] = n6;
+                    mapNormals[nCounter + 5] = n6;
+                    nCounter += 6;
+
+                    mapTexcoords[tcCounter] = (Vector2){ frontTexUV.x, frontTexUV.y };
+                    mapTexcoords[tcCounter + 1] = (Vector2){ frontTexUV.x, frontTexUV.y + frontTexUV.height };
+                    mapTexcoords[tcCounter + 2] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y };
+                    mapTexcoords[tcCounter + 3] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y };
+                    mapTexcoords[tcCounter + 4] = (Vector2){ frontTexUV.x, frontTexUV.y + frontTexUV.height };
+                    mapTexcoords[tcCounter + 5] = (Vector2){ frontTexUV.x + frontTexUV.width, frontTexUV.y + frontTexUV.height };
+                    tcCounter += 6;
+                }
+
+                if (((z > 0) &&
+                (cubicmapPixels[(z - 1)*cubicmap.width + x].r == 0) &&
+                (cubicmapPixels[(z - 1)*cubicmap.width + x].g == 0) &&
+                (cubicmapPixels[(z - 1)*cubicmap.width + x].b == 0)) || (z == 0))
+                {
+                    // Define back triangles (2 tris, 6 vertex) --> v1 v5 v6, v1 v4 v5
+                    // NOTE: Collateral occluded faces are not generated
+                    mapVertices[vCounter] = v1;
+                    mapVertices[vCounter + 1] = v5;
+                    mapVertices[vCounter + 2] = v6;
+                    mapVertices[vCounter + 3] = v1;
+                    mapVertices[vCounter + 4] = v4;
+                    mapVertices[vCounter + 5] = v5;
+                    vCounter += 6;
+
+                    mapNormals[nCounter] = n5;
+                    mapNormals[nCounter + 1] = n5;
+                    mapNormals[nCounter + 2] = n5;
+                    mapNormals[nCounter + 3] = n5;
+                    mapNormals[nCounter + 4] = n5;
+                    mapNormals[nCounter + 5] = n5;
+                    nCounter += 6;
+
+                    mapTexcoords[tcCounter] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y };
+                    mapTexcoords[tcCounter + 1] = (Vector2){ backTexUV.x, backTexUV.y + backTexUV.height };
+                    mapTexcoords[tcCounter + 2] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y + backTexUV.height };
+                    mapTexcoords[tcCounter + 3] = (Vector2){ backTexUV.x + backTexUV.width, backTexUV.y };
+                    mapTexcoords[tcCounter + 4] = (Vector2){ backTexUV.x, backTexUV.y };
+                    mapTexcoords[tcCounter + 5] = (Vector2){ backTexUV.x, backTexUV.y + backTexUV.height };
+                    tcCounter += 6;
+                }
+
+                if (((x < cubicmap.width - 1) &&
+                (cubicmapPixels[z*cubicmap.width + (x + 1)].r == 0) &&
+                (cubicmapPixels[z*cubicmap.width + (x + 1)].g == 0) &&
+                (cubicmapPixels[z*cubicmap.width + (x + 1)].b == 0)) || (x == cubicmap.width - 1))
+                {
+                    // Define right triangles (2 tris, 6 vertex) --> v3 v8 v4, v4 v8 v5
+                    // NOTE: Collateral occluded faces are not generated
+                    mapVertices[vCounter] = v3;
+                    mapVertices[vCounter + 1] = v8;
+                    mapVertices[vCounter + 2] = v4;
+                    mapVertices[vCounter + 3] = v4;
+                    mapVertices[vCounter + 4] = v8;
+                    mapVertices[vCounter + 5] = v5;
+                    vCounter += 6;
+
+                    mapNormals[nCounter] = n1;
+                    mapNormals[nCounter + 1] = n1;
+                    mapNormals[nCounter + 2] = n1;
+                    mapNormals[nCounter + 3] = n1;
+                    mapNormals[nCounter + 4] = n1;
+                    mapNormals[nCounter + 5] = n1;
+                    nCounter += 6;
+
+                    mapTexcoords[tcCounter] = (Vector2){ rightTexUV.x, rightTexUV.y };
+                    mapTexcoords[tcCounter + 1] = (Vector2){ rightTexUV.x, rightTexUV.y + rightTexUV.height };
+                    mapTexcoords[tcCounter + 2] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y };
+                    mapTexcoords[tcCounter + 3] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y };
+                    mapTexcoords[tcCounter + 4] = (Vector2){ rightTexUV.x, rightTexUV.y + rightTexUV.height };
+                    mapTexcoords[tcCounter + 5] = (Vector2){ rightTexUV.x + rightTexUV.width, rightTexUV.y + rightTexUV.height };
+                    tcCounter += 6;
+                }
+
+                if (((x > 0) &&
+                (cubicmapPixels[z*cubicmap.width + (x - 1)].r == 0) &&
+                (cubicmapPixels[z*cubicmap.width + (x - 1)].g == 0) &&
+                (cubicmapPixels[z*cubicmap.width + (x - 1)].b == 0)) || (x == 0))
+                {
+                    // Define left triangles (2 tris, 6 vertex) --> v1 v7 v2, v1 v6 v7
+                    // NOTE: Collateral occluded faces are not generated
+                    mapVertices[vCounter] = v1;
+                    mapVertices[vCounter + 1] = v7;
+                    mapVertices[vCounter + 2] = v2;
+                    mapVertices[vCounter + 3] = v1;
+                    mapVertices[vCounter + 4] = v6;
+                    mapVertices[vCounter + 5] = v7;
+                    vCounter += 6;
+
+                    mapNormals[nCounter] = n2;
+                    mapNormals[nCounter + 1] = n2;
+                    mapNormals[nCounter + 2] = n2;
+                    mapNormals[nCounter + 3] = n2;
+                    mapNormals[nCounter + 4] = n2;
+                    mapNormals[nCounter + 5] = n2;
+                    nCounter += 6;
+
+                    mapTexcoords[tcCounter] = (Vector2){ leftTexUV.x, leftTexUV.y };
+                    mapTexcoords[tcCounter + 1] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y + leftTexUV.height };
+                    mapTexcoords[tcCounter + 2] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y };
+                    mapTexcoords[tcCounter + 3] = (Vector2){ leftTexUV.x, leftTexUV.y };
+                    mapTexcoords[tcCounter + 4] = (Vector2){ leftTexUV.x, leftTexUV.y + leftTexUV.height };
+                    mapTexcoords[tcCounter + 5] = (Vector2){ leftTexUV.x + leftTexUV.width, leftTexUV.y + leftTexUV.height };
+                    tcCounter += 6;
+                }
+            }
+            // We check pixel color to be BLACK, we will only draw floor and roof
+            else if  ((cubicmapPixels[z*cubicmap.width + x].r == 0) &&
+                      (cubicmapPixels[z*cubicmap.width + x].g == 0) &&
+                      (cubicmapPixels[z*cubicmap.width + x].b == 0))
+            {
+                // Define top triangles (2 tris, 6 vertex --> v1-v2-v3, v1-v3-v4)
+                mapVertices[vCounter] = v1;
+                mapVertices[vCounter + 1] = v3;
+                mapVertices[vCounter + 2] = v2;
+                mapVertices[vCounter + 3] = v1;
+                mapVertices[vCounter + 4] = v4;
+                mapVertices[vCounter + 5] = v3;
+                vCounter += 6;
+
+                mapNormals[nCounter] = n4;
+                mapNormals[nCounter + 1] = n4;
+                mapNormals[nCounter + 2] = n4;
+                mapNormals[nCounter + 3] = n4;
+                mapNormals[nCounter + 4] = n4;
+                mapNormals[nCounter + 5] = n4;
+                nCounter += 6;
+
+                mapTexcoords[tcCounter] = (Vector2){ topTexUV.x, topTexUV.y };
+                mapTexcoords[tcCounter + 1] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
+                mapTexcoords[tcCounter + 2] = (Vector2){ topTexUV.x, topTexUV.y + topTexUV.height };
+                mapTexcoords[tcCounter + 3] = (Vector2){ topTexUV.x, topTexUV.y };
+                mapTexcoords[tcCounter + 4] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y };
+                mapTexcoords[tcCounter + 5] = (Vector2){ topTexUV.x + topTexUV.width, topTexUV.y + topTexUV.height };
+                tcCounter += 6;
+
+                // Define bottom triangles (2 tris, 6 vertex --> v6-v8-v7, v6-v5-v8)
+                mapVertices[vCounter] = v6;
+                mapVertices[vCounter + 1] = v7;
+                mapVertices[vCounter + 2] = v8;
+                mapVertices[vCounter + 3] = v6;
+                mapVertices[vCounter + 4] = v8;
+                mapVertices[vCounter + 5] = v5;
+                vCounter += 6;
+
+                mapNormals[nCounter] = n3;
+                mapNormals[nCounter + 1] = n3;
+                mapNormals[nCounter + 2] = n3;
+                mapNormals[nCounter + 3] = n3;
+                mapNormals[nCounter + 4] = n3;
+                mapNormals[nCounter + 5] = n3;
+                nCounter += 6;
+
+                mapTexcoords[tcCounter] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
+                mapTexcoords[tcCounter + 1] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y + bottomTexUV.height };
+                mapTexcoords[tcCounter + 2] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
+                mapTexcoords[tcCounter + 3] = (Vector2){ bottomTexUV.x + bottomTexUV.width, bottomTexUV.y };
+                mapTexcoords[tcCounter + 4] = (Vector2){ bottomTexUV.x, bottomTexUV.y + bottomTexUV.height };
+                mapTexcoords[tcCounter + 5] = (Vector2){ bottomTexUV.x, bottomTexUV.y };
+                tcCounter += 6;
+            }
+        }
+    }
+
+    // Move data from mapVertices temp arays to vertices float array
+    mesh.vertexCount = vCounter;
+
+    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
+
+    int fCounter = 0;
+
+    // Move vertices data
+    for (int i = 0; i < vCounter; i++)
+    {
+        mesh.vertices[fCounter] = mapVertices[i].x;
+        mesh.vertices[fCounter + 1] = mapVertices[i].y;
+        mesh.vertices[fCounter + 2] = mapVertices[i].z;
+        fCounter += 3;
+    }
+
+    fCounter = 0;
+
+    // Move normals data
+    for (int i = 0; i < nCounter; i++)
+    {
+        mesh.normals[fCounter] = mapNormals[i].x;
+        mesh.normals[fCounter + 1] = mapNormals[i].y;
+        mesh.normals[fCounter + 2] = mapNormals[i].z;
+        fCounter += 3;
+    }
+
+    fCounter = 0;
+
+    // Move texcoords data
+    for (int i = 0; i < tcCounter; i++)
+    {
+        mesh.texcoords[fCounter] = mapTexcoords[i].x;
+        mesh.texcoords[fCounter + 1] = mapTexcoords[i].y;
+        fCounter += 2;
+    }
+
+    free(mapVertices);
+    free(mapNormals);
+    free(mapTexcoords);
+
+    UnloadImageDataView(cubicmap, cubicmapPixels);  // Free image pixel data (only if converted)
+    
+    TraceLog(LOG_INFO, "Mesh generated successfully (vertexCount: %i)", mesh.vertexCount);
+
+    return mesh;
+}
+#endif
+
+#if defined(VOXEL_MAZE)
+// Voxel maps: 3D cells grid, chunked meshing and collisions
+//----------------------------------------------------------------------------------
+// Load voxel map from layer images (bottom to top), white pixels are solid
+// NOTE: All layers must have the same size, uniform chunks are compacted (cells not stored),
+// so memory usage is proportional to map surface instead of volume
+static VoxelMap LoadVoxelMap(Image *layers, int layerCount)
+{
+    VoxelMap map = { 0 };
+    
+    for (int i = 1; i < layerCount; i++)
+    {
+        if ((layers[i].width != layers[0].width) || (layers[i].height != layers[0].height))
+        {
+            TraceLog(LOG_WARNING, "Voxel map layers size mismatch (layer %i), layers not loaded", i);
+            return map;
+        }
+    }
+    
+    map.width = layers[0].width;
+    map.height = layerCount;
+    map.depth = layers[0].height;
+    map.chunkCountX = (map.width + VOXEL_CHUNK_SIZE - 1)/VOXEL_CHUNK_SIZE;
+    map.chunkCountY = (map.height + VOXEL_CHUNK_SIZE - 1)/VOXEL_CHUNK_SIZE;
+    map.chunkCountZ = (map.depth + VOXEL_CHUNK_SIZE - 1)/VOXEL_CHUNK_SIZE;
+    map.chunks = (VoxelChunk *)calloc(map.chunkCountX*map.chunkCountY*map.chunkCountZ, sizeof(VoxelChunk));
+    
+    // Layers pixel data, one layer per map level
+    Color **pixels = (Color **)malloc(layerCount*sizeof(Color *));
+    for (int y = 0; y < layerCount; y++) pixels[y] = GetImageDataView(layers[y]);
+    
+    // Chunks cells are filled from layers pixels into a scratch buffer and classified,
+    // cells storage is only allocated for non-uniform chunks
+    unsigned char cells[VOXEL_CHUNK_SIZE*VOXEL_CHUNK_SIZE*VOXEL_CHUNK_SIZE];
+    int uniformCount = 0;
+    
+    for (int cy = 0; cy < map.chunkCountY; cy++)
+    {
+        for (int cz = 0; cz < map.chunkCountZ; cz++)
+        {
+            for (int cx = 0; cx < map.chunkCountX; cx++)
+            {
+                VoxelChunk *chunk = &map.chunks[(cy*map.chunkCountZ + cz)*map.chunkCountX + cx];
+                bool uniform = true;
+                
+                for (int y = 0; y < VOXEL_CHUNK_SIZE; y++)
+                {
+                    for (int z = 0; z < VOXEL_CHUNK_SIZE; z++)
+                    {
+                        for (int x = 0; x < VOXEL_CHUNK_SIZE; x++)
+                        {
+                            int mapX = cx*VOXEL_CHUNK_SIZE + x;
+                            int mapY = cy*VOXEL_CHUNK_SIZE + y;
+                            int mapZ = cz*VOXEL_CHUNK_SIZE + z;
+                            unsigned char value = VOXEL_SOLID;      // Cells outside map are solid
+                            
+                            if ((mapX < map.width) && (mapY < map.height) && (mapZ < map.depth))
+                            {
+                                Color pixel = pixels[mapY][mapZ*map.width + mapX];
+                                value = ((pixel.r == 255) && (pixel.g == 255) && (pixel.b == 255))? VOXEL_SOLID : VOXEL_EMPTY;
+                            }
+                            
+                            int index = (y*VOXEL_CHUNK_SIZE + z)*VOXEL_CHUNK_SIZE + x;
+                            
+                            cells[index] = value;
+                            if (value != cells[0]) uniform = false;
+                        }
+                    }
+                }
+                
+                if (uniform)
+                {
+                    chunk->value = cells[0];
+                    uniformCount++;
+                }
+                else
+                {
+                    chunk->cells = (unsigned char *)malloc(sizeof(cells));
+                    memcpy(chunk->cells, cells, sizeof(cells));
+                }
+            }
+        }
+    }
+    
+    for (int y = 0; y < layerCount; y++) UnloadImageDataView(layers[y], pixels[y]);
+    free(pixels);
+    
+    TraceLog(LOG_INFO, "Voxel map loaded successfully (%ix%ix%i, %i chunks, %i uniform)", map.width, map.height, map.depth, 
+             map.chunkCountX*map.chunkCountY*map.chunkCountZ, uniformCount);
+    
+    return map;
+}
+
+// Unload voxel map data
+static void UnloadVoxelMap(VoxelMap map)
+{
+    for (int i = 0; i < map.chunkCountX*map.chunkCountY*map.chunkCountZ; i++) free(map.chunks[i].cells);
+    
+    free(map.chunks);
+}
+
+// Get voxel map cell value (solid outside map)
+static unsigned char GetVoxel(VoxelMap map, int x, int y, int z)
+{
+    if ((x < 0) || (y < 0) || (z < 0) || (x >= map.width) || (y >= map.height) || (z >= map.depth)) return VOXEL_SOLID;
+    
+    VoxelChunk *chunk = &map.chunks[((y/VOXEL_CHUNK_SIZE)*map.chunkCountZ + z/VOXEL_CHUNK_SIZE)*map.chunkCountX + x/VOXEL_CHUNK_SIZE];
+    
+    if (chunk->cells == NULL) return chunk->value;
+    
+    return chunk->cells[((y%VOXEL_CHUNK_SIZE)*VOXEL_CHUNK_SIZE + z%VOXEL_CHUNK_SIZE)*VOXEL_CHUNK_SIZE + x%VOXEL_CHUNK_SIZE];
+}
+
+// Generate voxel map mesh, one mesh chunk per voxel chunk
+// NOTE: Faces are generated only between empty and solid cells (all six neighbours checked, across chunks),
+// mesh chunks can be frustum culled and drawn with DrawModelChunks()
+static Mesh GenMeshVoxelMap(VoxelMap map, float cubeSize)
+{
+    Mesh mesh = { 0 };
+    
+    int chunkCount = map.chunkCountX*map.chunkCountY*map.chunkCountZ;
+    int *chunkVertexCount = (int *)calloc(chunkCount, sizeof(int));
+    
+    // First pass: count chunks faces vertices
+    for (int i = 0; i < chunkCount; i++)
+    {
+        chunkVertexCount[i] = GenVoxelChunkFaces(map, i%map.chunkCountX, i/(map.chunkCountX*map.chunkCountZ), 
+                                                 (i/map.chunkCountX)%map.chunkCountZ, cubeSize, NULL, NULL, NULL);
+        mesh.vertexCount += chunkVertexCount[i];
+    }
+    
+    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
+    mesh.normals = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.chunks = (MeshChunk *)malloc(MAX_MESH_CHUNKS*sizeof(MeshChunk));
+    
+    // Second pass: generate chunks faces, empty chunks are skipped
+    int vertexOffset = 0;
+    
+    for (int i = 0; i < chunkCount; i++)
+    {
+        if (chunkVertexCount[i] == 0) continue;
+        
+        int chunkX = i%map.chunkCountX;
+        int chunkY = i/(map.chunkCountX*map.chunkCountZ);
+        int chunkZ = (i/map.chunkCountX)%map.chunkCountZ;
+        
+        GenVoxelChunkFaces(map, chunkX, chunkY, chunkZ, cubeSize, mesh.vertices + vertexOffset*3, 
+                           mesh.texcoords + vertexOffset*2, mesh.normals + vertexOffset*3);
+        
+        if (mesh.chunkCount < MAX_MESH_CHUNKS)
+        {
+            MeshChunk *chunk = &mesh.chunks[mesh.chunkCount];
+            
+            chunk->firstVertex = vertexOffset;
+            chunk->vertexCount = chunkVertexCount[i];
+            chunk->bounds.min = (Vector3){ (chunkX*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize, chunkY*VOXEL_CHUNK_SIZE*cubeSize, (chunkZ*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize };
+            chunk->bounds.max = Vector3Add(chunk->bounds.min, (Vector3){ VOXEL_CHUNK_SIZE*cubeSize, VOXEL_CHUNK_SIZE*cubeSize, VOXEL_CHUNK_SIZE*cubeSize });
+            mesh.chunkCount++;
+        }
+        else 
+        {
+            // NOTE: Chunks over the limit are merged into last chunk (vertex ranges are contiguous)
+            MeshChunk *chunk = &mesh.chunks[mesh.chunkCount - 1];
+            
+            chunk->vertexCount = vertexOffset + chunkVertexCount[i] - chunk->firstVertex;
+            chunk->bounds.max = Vector3Max(chunk->bounds.max, (Vector3){ ((chunkX + 1)*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize, 
+                                           (chunkY + 1)*VOXEL_CHUNK_SIZE*cubeSize, ((chunkZ + 1)*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize });
+            chunk->bounds.min = Vector3Min(chunk->bounds.min, (Vector3){ (chunkX*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize, 
+                                           chunkY*VOXEL_CHUNK_SIZE*cubeSize, (chunkZ*VOXEL_CHUNK_SIZE - 0.5f)*cubeSize });
+        }
+        
+        vertexOffset += chunkVertexCount[i];
+    }
+    
+    free(chunkVertexCount);
+    
+    TraceLog(LOG_INFO, "Voxel mesh generated successfully (vertexCount: %i, chunks: %i)", mesh.vertexCount, mesh.chunkCount);
+    
+    return mesh;
+}
+
+// Generate chunk visible faces, returns vertices count
+// NOTE: Faces are generated from empty cells towards solid neighbours, facing the empty cell;
+// if vertices is NULL, faces are only counted
+static int GenVoxelChunkFaces(VoxelMap map, int chunkX, int chunkY, int chunkZ, float cubeSize, float *vertices, float *texcoords, float *normals)
+{
+    VoxelChunk *chunk = &map.chunks[(chunkY*map.chunkCountZ + chunkZ)*map.chunkCountX + chunkX];
+    
+    if ((chunk->cells == NULL) && (chunk->value == VOXEL_SOLID)) return 0;     // No empty cells
+    
+    // Atlas texture rectangles: walls (x and z faces), floor (faces looking up), ceiling (faces looking down)
+    const Rectangle wallTexUV[2] = { { 0.0f, 0.0f, 0.5f, 0.5f }, { 0.5f, 0.0f, 0.5f, 0.5f } };
+    const Rectangle floorTexUV = { 0.5f, 0.5f, 0.5f, 0.5f };
+    const Rectangle ceilingTexUV = { 0.0f, 0.5f, 0.5f, 0.5f };
+    
+    // Face quad corners (counter-clockwise) on tangent axes
+    const float quad[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+    const int triangles[6] = { 0, 1, 2, 0, 2, 3 };
+    
+    int vertexCount = 0;
+    
+    int maxX = (chunkX + 1)*VOXEL_CHUNK_SIZE; if (maxX > map.width) maxX = map.width;
+    int maxY = (chunkY + 1)*VOXEL_CHUNK_SIZE; if (maxY > map.height) maxY = map.height;
+    int maxZ = (chunkZ + 1)*VOXEL_CHUNK_SIZE; if (maxZ > map.depth) maxZ = map.depth;
+    
+    for (int y = chunkY*VOXEL_CHUNK_SIZE; y < maxY; y++)
+    {
+        for (int z = chunkZ*VOXEL_CHUNK_SIZE; z < maxZ; z++)
+        {
+            for (int x = chunkX*VOXEL_CHUNK_SIZE; x < maxX; x++)
+            {
+                if (GetVoxel(map, x, y, z) != VOXEL_EMPTY) continue;
+                
+                int cell[3] = { x, y, z };
+                
+                // Check six neighbours: axis (X, Y, Z) and side (-1, +1)
+                for (int face = 0; face < 6; face++)
+                {
+                    int axis = face/2;
+                    int side = (face%2 == 0)? -1 : 1;
+                    
+                    int neighbour[3] = { x, y, z };
+                    neighbour[axis] += side;
+                    
+                    if (GetVoxel(map, neighbour[0], neighbour[1], neighbour[2]) != VOXEL_SOLID) continue;
+                    
+                    if (vertices != NULL)
+                    {
+                        int tangentU = (axis + 1)%3;
+                        int tangentV = (axis + 2)%3;
+                        
+                        Rectangle texUV = (axis == 1)? ((side < 0)? floorTexUV : ceilingTexUV) : wallTexUV[(side < 0)? 1 : 0];
+                        
+                        for (int k = 0; k < 6; k++)
+                        {
+                            // NOTE: Face normal points into empty cell, winding is reversed for positive side faces
+                            int corner = (side < 0)? triangles[k] : triangles[5 - k];
+                            
+                            float local[3] = { 0 };
+                            local[axis] = (side < 0)? 0.0f : 1.0f;
+                            local[tangentU] = quad[corner][0];
+                            local[tangentV] = quad[corner][1];
+                            
+                            vertices[vertexCount*3] = (cell[0] - 0.5f + local[0])*cubeSize;
+                            vertices[vertexCount*3 + 1] = (cell[1] + local[1])*cubeSize;
+                            vertices[vertexCount*3 + 2] = (cell[2] - 0.5f + local[2])*cubeSize;
+                            
+                            // Walls texture is upright, floor and ceiling texture is mapped on XZ plane
+                            float u = (axis == 1)? local[0] : local[(axis == 0)? 2 : 0];
+                            float v = (axis == 1)? local[2] : 1.0f - local[1];
+                            
+                            texcoords[vertexCount*2] = texUV.x + u*texUV.width;
+                            texcoords[vertexCount*2 + 1] = texUV.y + v*texUV.height;
+                            
+                            normals[vertexCount*3] = 0.0f;
+                            normals[vertexCount*3 + 1] = 0.0f;
+                            normals[vertexCount*3 + 2] = 0.0f;
+                            normals[vertexCount*3 + axis] = (float)-side;
+                            
+                            vertexCount++;
+                        }
+                    }
+                    else vertexCount += 6;
+                }
+            }
+        }
+    }
+    
+    return vertexCount;
+}
+
+// Check collision between voxel map solid cells and a bounding box
+// NOTE: Only cells overlapped by the box are checked (touching cells are not), box is defined in map space
+static bool CheckCollisionVoxelMap(VoxelMap map, float cubeSize, BoundingBox box)
+{
+    int minX = (int)floorf(box.min.x/cubeSize + 0.5f);
+    int maxX = (int)ceilf(box.max.x/cubeSize + 0.5f) - 1;
+    int minY = (int)floorf(box.min.y/cubeSize);
+    int maxY = (int)ceilf(box.max.y/cubeSize) - 1;
+    int minZ = (int)floorf(box.min.z/cubeSize + 0.5f);
+    int maxZ = (int)ceilf(box.max.z/cubeSize + 0.5f) - 1;
+    
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int z = minZ; z <= maxZ; z++)
+        {
+            for (int x = minX; x <= maxX; x++)
+            {
+                if (GetVoxel(map, x, y, z) == VOXEL_SOLID) return true;
+            }
+        }
+    }
+    
+    return false;
+}
+#endif
+
+// Chunked meshes: frustum culling and multi-draw indirect submission
+//----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
+// Sort mesh triangles into chunks along XZ plane
+// NOTE: Triangles are assigned to chunks by centroid and vertex data is reordered so every
+// chunk is a contiguous vertex range; it must be called before uploading mesh data
+static void GenMeshChunks(Mesh *mesh, float chunkSize)
+{
+    int triangleCount = mesh->vertexCount/3;
+    
+    if (triangleCount == 0) return;
+    
+    // Get mesh bounds on XZ plane to define chunks grid
+    Vector3 min = { mesh->vertices[0], mesh->vertices[1], mesh->vertices[2] };
+    Vector3 max = min;
+    
+    for (int i = 1; i < mesh->vertexCount; i++)
+    {
+        min = Vector3Min(min, (Vector3){ mesh->vertices[i*3], mesh->vertices[i*3 + 1], mesh->vertices[i*3 + 2] });
+        max = Vector3Max(max, (Vector3){ mesh->vertices[i*3], mesh->vertices[i*3 + 1], mesh->vertices[i*3 + 2] });
+    }
+    
+    int gridWidth = (int)((max.x - min.x)/chunkSize) + 1;
+    int gridDepth = (int)((max.z - min.z)/chunkSize) + 1;
+    int cellCount = gridWidth*gridDepth;
+    
+    int *triangleCells = (int *)malloc(triangleCount*sizeof(int));
+    int *cellOffsets = (int *)calloc(cellCount + 1, sizeof(int));
+    
+    // Assign every triangle to a grid cell (by centroid) and count triangles per cell
+    for (int t = 0; t < triangleCount; t++)
+    {
+        float *v = mesh->vertices + t*9;
+        int cellX = (int)(((v[0] + v[3] + v[6])/3.0f - min.x)/chunkSize);
+        int cellZ = (int)(((v[2] + v[5] + v[8])/3.0f - min.z)/chunkSize);
+        
+        triangleCells[t] = cellZ*gridWidth + cellX;
+        cellOffsets[triangleCells[t] + 1]++;
+    }
+    
+    int chunkCount = 0;
+    for (int c = 0; c < cellCount; c++) 
+    {
+        if (cellOffsets[c + 1] > 0) chunkCount++;
+        cellOffsets[c + 1] += cellOffsets[c];
+    }
+    
+    if (chunkCount > MAX_MESH_CHUNKS)
+    {
+        TraceLog(LOG_WARNING, "Mesh chunks exceed limit (%i > %i), mesh is not chunked", chunkCount, MAX_MESH_CHUNKS);
+        free(triangleCells);
+        free(cellOffsets);
+        return;
+    }
+    
+    // Reorder vertex data by cell (counting sort, triangles order inside a cell is kept)
+    float *vertices = (float *)malloc(mesh->vertexCount*3*sizeof(float));
+    float *texcoords = (float *)malloc(mesh->vertexCount*2*sizeof(float));
+    float *normals = (mesh->normals != NULL)? (float *)malloc(mesh->vertexCount*3*sizeof(float)) : NULL;
+    int *cellCounters = (int *)malloc(cellCount*sizeof(int));
+    
+    memcpy(cellCounters, cellOffsets, cellCount*sizeof(int));
+    
+    for (int t = 0; t < triangleCount; t++)
+    {
+        int dest = cellCounters[triangleCells[t]]++;
+        
+        memcpy(vertices + dest*9, mesh->vertices + t*9, 9*sizeof(float));
+        memcpy(texcoords + dest*6, mesh->texcoords + t*6, 6*sizeof(float));
+        if (normals != NULL) memcpy(normals + dest*9, mesh->normals + t*9, 9*sizeof(float));
+    }
+    
+    free(mesh->vertices);
+    free(mesh->texcoords);
+    if (mesh->normals != NULL) free(mesh->normals);
+    
+    mesh->vertices = vertices;
+    mesh->texcoords = texcoords;
+    mesh->normals = normals;
+    
+    // Define chunks from non-empty cells, computing chunk bounds
+    mesh->chunks = (MeshChunk *)malloc(chunkCount*sizeof(MeshChunk));
+    mesh->chunkCount = 0;
+    
+    for (int c = 0; c < cellCount; c++)
+    {
+        if (cellOffsets[c + 1] == cellOffsets[c]) continue;
+        
+        MeshChunk chunk = { 0 };
+        chunk.firstVertex = cellOffsets[c]*3;
+        chunk.vertexCount = (cellOffsets[c + 1] - cellOffsets[c])*3;
+        
+        float *v = mesh->vertices + chunk.firstVertex*3;
+        chunk.bounds.min = (Vector3){ v[0], v[1], v[2] };
+        chunk.bounds.max = chunk.bounds.min;
+        
+        for (int i = 1; i < chunk.vertexCount; i++)
+        {
+            chunk.bounds.min = Vector3Min(chunk.bounds.min, (Vector3){ v[i*3], v[i*3 + 1], v[i*3 + 2] });
+            chunk.bounds.max = Vector3Max(chunk.bounds.max, (Vector3){ v[i*3], v[i*3 + 1], v[i*3 + 2] });
+        }
+        
+        mesh->chunks[mesh->chunkCount++] = chunk;
+    }
+    
+    free(triangleCells);
+    free(cellOffsets);
+    free(cellCounters);
+    
+    TraceLog(LOG_INFO, "Mesh split into %i chunks (%ix%i grid)", mesh->chunkCount, gridWidth, gridDepth);
+}
+#endif
+
+// Extract frustum planes from view-projection matrix
+// NOTE: Planes are obtained combining clip-space matrix rows (Gribb-Hartmann method)
+static Frustum ExtractFrustum(Matrix viewProjection)
+{
+    Frustum frustum = { 0 };
+    float16 m = MatrixToFloatV(viewProjection);
+    
+    for (int i = 0; i < 4; i++)
+    {
+        // Matrix is column-major: row i is (m[i], m[i + 4], m[i + 8], m[i + 12])
+        float row0 = m.v[i*4], row1 = m.v[i*4 + 1], row2 = m.v[i*4 + 2], row3 = m.v[i*4 + 3];
+        
+        frustum.planes[0][i] = row3 + row0;     // Left
+        frustum.planes[1][i] = row3 - row0;     // Right
+        frustum.planes[2][i] = row3 + row1;     // Bottom
+        frustum.planes[3][i] = row3 - row1;     // Top
+        frustum.planes[4][i] = row3 + row2;     // Near
+        frustum.planes[5][i] = row3 - row2;     // Far
+    }
+    
+    return frustum;
+}
+
+// Check if a bounding box is (partially) inside frustum
+// NOTE: Box is outside if its most positive corner (along plane normal) is behind any plane
+static bool CheckFrustumBox(Frustum frustum, BoundingBox box)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        float *plane = frustum.planes[i];
+        
+        float x = (plane[0] >= 0.0f)? box.max.x : box.min.x;
+        float y = (plane[1] >= 0.0f)? box.max.y : box.min.y;
+        float z = (plane[2] >= 0.0f)? box.max.z : box.min.z;
+        
+        if ((plane[0]*x + plane[1]*y + plane[2]*z + plane[3]) < 0.0f) return false;
+    }
+    
+    return true;
+}
+
+// Compute mesh bounding box (model space)
+// NOTE: Mesh vertices must be available in RAM
+static BoundingBox GetMeshBoundingBox(Mesh mesh)
+{
+    BoundingBox box = { 0 };
+    
+    if (mesh.vertexCount > 0)
+    {
+        box.min = (Vector3){ mesh.vertices[0], mesh.vertices[1], mesh.vertices[2] };
+        box.max = box.min;
+        
+        for (int i = 1; i < mesh.vertexCount; i++)
+        {
+            Vector3 vertex = { mesh.vertices[i*3], mesh.vertices[i*3 + 1], mesh.vertices[i*3 + 2] };
+            box.min = Vector3Min(box.min, vertex);
+            box.max = Vector3Max(box.max, vertex);
+        }
+    }
+    
+    return box;
+}
+
+// Draw model visible chunks
+// NOTE: Culling pass writes one draw command per visible chunk; on OpenGL 4.3 all of them are
+// submitted with a single glMultiDrawArraysIndirect() call, on OpenGL 3.3 one draw call per chunk is used
+static int DrawModelChunks(Model model, Vector3 position, float scale, Color tint, Frustum frustum)
+{
+    if (model.mesh.chunkCount == 0)
+    {
+        DrawModel(model, position, scale, tint);
+        return 1;
+    }
+    
+    DrawArraysIndirectCommand commands[MAX_MESH_CHUNKS];
+    int drawCount = 0;
+    
+    // Culling pass: chunk bounds transformed to world space and checked against frustum
+    for (int i = 0; i < model.mesh.chunkCount; i++)
+    {
+        BoundingBox bounds = { Vector3Add(Vector3Scale(model.mesh.chunks[i].bounds.min, scale), position),
+                               Vector3Add(Vector3Scale(model.mesh.chunks[i].bounds.max, scale), position) };
+        
+        if (CheckFrustumBox(frustum, bounds))
+        {
+            commands[drawCount] = (DrawArraysIndirectCommand){ model.mesh.chunks[i].vertexCount, 1, model.mesh.chunks[i].firstVertex, 0 };
+            drawCount++;
+        }
+    }
+    
+    if (drawCount == 0) return 0;
+    
+    // Get transform matrix (scale -> translation)
+    Matrix matTransform = MatrixMultiply(MatrixScale(scale, scale, scale), MatrixTranslate(position.x, position.y, position.z));
+    model.transform = MatrixMultiply(model.transform, matTransform);
+    
+    glUseProgram(model.material.shader.id);     // Bind material shader
+    
+    glUniform4f(model.material.shader.colorLoc, (float)tint.r/255, (float)tint.g/255, (float)tint.b/255, (float)tint.a/255);
+    glUniformMatrix4fv(model.material.shader.modelLoc, 1, false, MatrixToFloat(model.transform));
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, model.material.texDiffuse.id);
+    glBindVertexArray(model.mesh.vaoId);
+    
+    if (model.mesh.indices != NULL)
+    {
+        // Indexed mesh: chunks are index ranges
+        if (model.mesh.indirectId != 0)
+        {
+            DrawElementsIndirectCommand elementsCommands[MAX_MESH_CHUNKS];
+            
+            for (int i = 0; i < drawCount; i++) elementsCommands[i] = (DrawElementsIndirectCommand){ commands[i].count, 1, commands[i].first, 0, 0 };
+            
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, model.mesh.indirectId);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, drawCount*sizeof(DrawElementsIndirectCommand), elementsCommands);
+            
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, drawCount, 0);     // Single draw call for all visible chunks
+            
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+        else
+        {
+            for (int i = 0; i < drawCount; i++) glDrawElements(GL_TRIANGLES, commands[i].count, GL_UNSIGNED_INT, (void *)(commands[i].first*sizeof(unsigned int)));
+        }
+    }
+    else if (model.mesh.indirectId != 0)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, model.mesh.indirectId);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, drawCount*sizeof(DrawArraysIndirectCommand), commands);
+        
+        multiDrawArraysIndirect(GL_TRIANGLES, 0, drawCount, 0);     // Single draw call for all visible chunks
+        
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        for (int i = 0; i < drawCount; i++) glDrawArrays(GL_TRIANGLES, commands[i].first, commands[i].count);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, 0);    // Unbind textures
+    glBindVertexArray(0);               // Unbind VAO
+    glUseProgram(0);                    // Unbind shader program
+    
+    return drawCount;
+}
+
+// Instances culling: bounding spheres frustum culling (SoA, AVX)
+//----------------------------------------------------------------------------------
+// Load instances bounds arrays (RAM)
+static InstanceBounds LoadInstanceBounds(int count)
+{
+    InstanceBounds instances = { 0 };
+    
+    instances.count = count;
+    instances.capacity = (count + 7) & ~7;
+    
+    // NOTE: Padding instances are zero-initialized, they are masked out on culling
+    instances.x = (float *)calloc(instances.capacity, sizeof(float));
+    instances.y = (float *)calloc(instances.capacity, sizeof(float));
+    instances.z = (float *)calloc(instances.capacity, sizeof(float));
+    instances.radius = (float *)calloc(instances.capacity, sizeof(float));
+    
+    return instances;
+}
+
+// Unload instances bounds arrays
+static void UnloadInstanceBounds(InstanceBounds instances)
+{
+    free(instances.x);
+    free(instances.y);
+    free(instances.z);
+    free(instances.radius);
+}
+
+// Set instance bounds from mesh bounding sphere and transform (scale -> translation)
+static void SetInstanceBounds(InstanceBounds *instances, int index, Mesh mesh, Vector3 position, float scale)
+{
+    instances->x[index] = mesh.sphereCenter.x*scale + position.x;
+    instances->y[index] = mesh.sphereCenter.y*scale + position.y;
+    instances->z[index] = mesh.sphereCenter.z*scale + position.z;
+    instances->radius[index] = mesh.sphereRadius*scale;
+}
+
+// Cull instances against frustum, returns visible instances (indices in visible)
+// NOTE: Planes are normalized once, every batch of 8 spheres is tested against 6 planes
+// with AVX (8 lanes) when available; visible array must hold instances capacity
+static int CullInstances(InstanceBounds instances, Frustum frustum, int *visible)
+{
+    float planes[6][4];
+    
+    for (int p = 0; p < 6; p++)
+    {
+        float length = sqrtf(frustum.planes[p][0]*frustum.planes[p][0] + frustum.planes[p][1]*frustum.planes[p][1] + frustum.planes[p][2]*frustum.planes[p][2]);
+        for (int k = 0; k < 4; k++) planes[p][k] = frustum.planes[p][k]/length;
+    }
+    
+    int visibleCount = 0;
+    
+    for (int i = 0; i < instances.count; i += 8)
+    {
+        int mask = 0;
+        
+#if defined(__AVX__)
+        __m256 x = _mm256_loadu_ps(&instances.x[i]);
+        __m256 y = _mm256_loadu_ps(&instances.y[i]);
+        __m256 z = _mm256_loadu_ps(&instances.z[i]);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&instances.radius[i]));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        
+        for (int p = 0; p < 6; p++)
+        {
+            // Sphere is outside if center signed distance to any plane is lower than -radius
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes[p][0])), _mm256_mul_ps(y, _mm256_set1_ps(planes[p][1]))),
+                                            _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(planes[p][2])), _mm256_set1_ps(planes[p][3])));
+            
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+        
+        mask = _mm256_movemask_ps(inside);
+#else
+        for (int j = 0; j < 8; j++)
+        {
+            bool inside = true;
+            
+            for (int p = 0; (p < 6) && inside; p++)
+            {
+                float distance = planes[p][0]*instances.x[i + j] + planes[p][1]*instances.y[i + j] + planes[p][2]*instances.z[i + j] + planes[p][3];
+                if (distance < -instances.radius[i + j]) inside = false;
+            }
+            
+            if (inside) mask |= (1 << j);
+        }
+#endif
+        // Padding instances on last batch are discarded
+        if ((instances.count - i) < 8) mask &= (1 << (instances.count - i)) - 1;
+        
+        for (int j = 0; j < 8; j++) if (mask & (1 << j)) visible[visibleCount++] = i + j;
+    }
+    
+    return visibleCount;
+}
+
+#if defined(CULLING_BENCHMARK)
+// Measure instances culling time (ms)
+// NOTE: Random spheres are spread around camera in a 200x200 units area, camera looks at origin
+static void BenchmarkInstanceCulling(int count, int iterations)
+{
+    InstanceBounds instances = LoadInstanceBounds(count);
+    int *visible = (int *)malloc(instances.capacity*sizeof(int));
+    
+    for (int i = 0; i < count; i++)
+    {
+        instances.x[i] = (float)(rand()%20000)/100.0f - 100.0f;
+        instances.y[i] = (float)(rand()%1000)/100.0f;
+        instances.z[i] = (float)(rand()%20000)/100.0f - 100.0f;
+        instances.radius[i] = 0.5f + (float)(rand()%100)/100.0f;
+    }
+    
+    Matrix view = MatrixLookAt((Vector3){ 0.0f, 2.0f, -10.0f }, Vector3Zero(), (Vector3){ 0.0f, 1.0f, 0.0f });
+    Frustum frustum = ExtractFrustum(MatrixMultiply(view, matProjection));
+    
+    int visibleCount = 0;
+    double startTime = glfwGetTime();
+    
+    for (int n = 0; n < iterations; n++) visibleCount = CullInstances(instances, frustum, visible);
+    
+    double elapsedTime = glfwGetTime() - startTime;
+    
+#if defined(__AVX__)
+    const char *mode = "AVX";
+#else
+    const char *mode = "scalar";
+#endif
+
+    TraceLog(LOG_INFO, "BENCHMARK: Instances culling (%s): %i instances, %i visible, %.3f ms per pass", 
+             mode, count, visibleCount, elapsedTime*1000.0/iterations);
+    
+    UnloadInstanceBounds(instances);
+    free(visible);
+}
+#endif
+
+#if defined(CLUSTER_BENCHMARK)
+// Generate UV sphere mesh (non-indexed), triangles counter-clockwise seen from outside
+// NOTE: Mesh is indexed by OptimizeMesh(), poles triangles are degenerate
+static Mesh GenMeshSphere(float radius, int rings, int slices)
+{
+    Mesh mesh = { 0 };
+    
+    mesh.vertexCount = rings*slices*6;
+    mesh.vertices = (float *)malloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = (float *)malloc(mesh.vertexCount*2*sizeof(float));
+    
+    int v = 0;
+    
+    for (int i = 0; i < rings; i++)
+    {
+        for (int j = 0; j < slices; j++)
+        {
+            // Quad corners (ring, slice) offsets, two triangles per quad
+            const int corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            
+            for (int k = 0; k < 6; k++)
+            {
+                float u = (float)(j + corners[k][1])/slices;
+                float t = (float)(i + corners[k][0])/rings;
+                float phi = t*PI;
+                float theta = u*2.0f*PI;
+                
+                mesh.vertices[v*3] = radius*sinf(phi)*cosf(theta);
+                mesh.vertices[v*3 + 1] = radius*cosf(phi);
+                mesh.vertices[v*3 + 2] = -radius*sinf(phi)*sinf(theta);
+                mesh.texcoords[v*2] = u;
+                mesh.texcoords[v*2 + 1] = t;
+                v++;
+            }
+        }
+    }
+    
+    return mesh;
+}
+
+// Measure mesh clusters culling time (ms) and culled clusters
+// NOTE: Sphere is clustered as loaded models (optimized and clustered), camera orbits around it at
+// two distances: far (whole sphere in frustum, back half cone culled) and near (partially frustum culled)
+static void BenchmarkClusterCulling(int rings, int slices, int iterations)
+{
+    Mesh mesh = GenMeshSphere(1.0f, rings, slices);
+    OptimizeMesh(&mesh);
+    GenMeshClusters(&mesh);
+    
+    if (mesh.clusterCount == 0) TraceLog(LOG_WARNING, "BENCHMARK: Sphere mesh not clustered (triangles: %i)", mesh.triangleCount);
+    
+    const int viewCount = 16;
+    int visibleCount = 0;
+    int frustumCulledCount = 0;
+    double elapsedTime = 0.0;
+    
+    for (int v = 0; v < viewCount; v++)
+    {
+        float angle = (float)v/viewCount*2.0f*PI;
+        float distance = (v%2 == 0)? 4.0f : 1.5f;
+        
+        Vector3 viewPosition = { distance*cosf(angle), 0.5f*sinf(angle*2.0f), distance*sinf(angle) };
+        Matrix view = MatrixLookAt(viewPosition, Vector3Zero(), (Vector3){ 0.0f, 1.0f, 0.0f });
+        Frustum frustum = ExtractFrustum(MatrixMultiply(view, matProjection));
+        
+        for (int i = 0; i < mesh.clusterCount; i++)
+        {
+            if (!CheckFrustumSphere(frustum, mesh.clusters[i].center, mesh.clusters[i].radius)) frustumCulledCount++;
+        }
+        
+        int visible = 0;
+        double startTime = glfwGetTime();
+        
+        for (int n = 0; n < iterations; n++)
+        {
+            visible = 0;
+            for (int i = 0; i < mesh.clusterCount; i++) if (CheckClusterVisible(mesh.clusters[i], Vector3Zero(), 1.0f, frustum, viewPosition)) visible++;
+        }
+        
+        elapsedTime += glfwGetTime() - startTime;
+        visibleCount += visible;
+    }
+    
+    int totalCount = mesh.clusterCount*viewCount;
+    
+    TraceLog(LOG_INFO, "BENCHMARK: Clusters culling: %i triangles, %i clusters, %.1f%% visible, %.1f%% frustum culled, %.1f%% cone culled, %.4f ms per pass", 
+             mesh.triangleCount, mesh.clusterCount, 100.0f*visibleCount/totalCount, 100.0f*frustumCulledCount/totalCount, 
+             100.0f*(totalCount - visibleCount - frustumCulledCount)/totalCount, elapsedTime*1000.0/(iterations*viewCount));
+    
+    free(mesh.vertices);
+    free(mesh.texcoords);
+    free(mesh.indices);
+    free(mesh.clusters);
+}
+#endif
+
+// Scene queries: dynamic AABB tree and grid ray casts
+//----------------------------------------------------------------------------------
+// Load dynamic AABB tree with initial nodes capacity
+static AABBTree LoadAABBTree(int capacity)
+{
+    AABBTree tree = { 0 };
+    
+    tree.root = AABB_TREE_NULL_NODE;
+    tree.freeList = AABB_TREE_NULL_NODE;
+    tree.capacity = 0;
+    tree.nodes = NULL;
+    
+    // Pool is filled by first allocation
+    if (capacity > 0)
+    {
+        tree.nodes = (AABBTreeNode *)malloc(capacity*sizeof(AABBTreeNode));
+        tree.capacity = capacity;
+        
+        for (int i = 0; i < capacity; i++)
+        {
+            tree.nodes[i].parent = (i < (capacity - 1))? (i + 1) : AABB_TREE_NULL_NODE;
+            tree.nodes[i].height = -1;
+        }
+        
+        tree.freeList = 0;
+    }
+    
+    return tree;
+}
+
+// Unload dynamic AABB tree nodes
+static void UnloadAABBTree(AABBTree tree)
+{
+    free(tree.nodes);
+}
+
+// Insert object box in tree, returns proxy id
+// NOTE: Stored box is enlarged by AABB_TREE_FAT_MARGIN, queries results may include objects near the query shape
+static int CreateAABBTreeProxy(AABBTree *tree, BoundingBox box, int userData)
+{
+    int proxyId = AllocateAABBTreeNode(tree);
+    
+    Vector3 margin = { AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN };
+    
+    tree->nodes[proxyId].box = (BoundingBox){ Vector3Subtract(box.min, margin), Vector3Add(box.max, margin) };
+    tree->nodes[proxyId].userData = userData;
+    tree->nodes[proxyId].height = 0;
+    
+    InsertAABBTreeLeaf(tree, proxyId);
+    
+    return proxyId;
+}
+
+// Get objects overlapping box, returns objects count
+// NOTE: Objects are tested by their fat boxes, results may include objects near box
+static int QueryAABBTreeBox(AABBTree tree, BoundingBox box, int *results, int maxResults)
+{
+    int stack[AABB_TREE_STACK_SIZE];
+    int stackCount = 0;
+    int resultCount = 0;
+    
+    if (tree.root != AABB_TREE_NULL_NODE) stack[stackCount++] = tree.root;
+    
+    while ((stackCount > 0) && (resultCount < maxResults))
+    {
+        AABBTreeNode *node = &tree.nodes[stack[--stackCount]];
+        
+        if ((node->box.min.x > box.max.x) || (node->box.max.x < box.min.x) ||
+            (node->box.min.y > box.max.y) || (node->box.max.y < box.min.y) ||
+            (node->box.min.z > box.max.z) || (node->box.max.z < box.min.z)) continue;
+        
+        if (node->left == AABB_TREE_NULL_NODE) results[resultCount++] = node->userData;
+        else if (stackCount < (AABB_TREE_STACK_SIZE - 1))
+        {
+            stack[stackCount++] = node->left;
+            stack[stackCount++] = node->right;
+        }
+    }
+    
+    return resultCount;
+}
+
+// Get nearest object hit by ray, returns object id (-1 if none)
+// NOTE: Subtrees farther than nearest hit found are skipped, hit distance is measured to fat box
+static int RaycastAABBTree(AABBTree tree, Ray ray, float maxDistance, float *hitDistance)
+{
+    int stack[AABB_TREE_STACK_SIZE];
+    int stackCount = 0;
+    int hitObject = -1;
+    float nearestDistance = maxDistance;
+    
+    if (tree.root != AABB_TREE_NULL_NODE) stack[stackCount++] = tree.root;
+    
+    while (stackCount > 0)
+    {
+        AABBTreeNode *node = &tree.nodes[stack[--stackCount]];
+        
+        float distance = GetRayBoxDistance(ray, node->box);
+        
+        if ((distance < 0.0f) || (distance > nearestDistance)) continue;
+        
+        if (node->left == AABB_TREE_NULL_NODE)
+        {
+            nearestDistance = distance;
+            hitObject = node->userData;
+        }
+        else if (stackCount < (AABB_TREE_STACK_SIZE - 1))
+        {
+            stack[stackCount++] = node->left;
+            stack[stackCount++] = node->right;
+        }
+    }
+    
+    if ((hitObject != -1) && (hitDistance != NULL)) *hitDistance = nearestDistance;
+    
+    return hitObject;
+}
+
+// Get ray distance to first cubicmap wall (grid DDA), -1 if none
+// NOTE: Ray walks map cells on XZ plane in order (Amanatides-Woo), only crossed cells are checked;
+// walls are [0, cubeSize] high over map position, a wall cell is hit if ray height range along the
+// cell (entry to exit) overlaps the wall, rays passing over or under walls continue
+static float GetRayCubicmapDistance(Ray ray, Color *mapPixels, int mapWidth, int mapHeight, Vector3 mapPosition, float cubeSize, float maxDistance, int *cellX, int *cellY)
+{
+    // Cell (x, y) occupies [x - 0.5, x + 0.5]x[y - 0.5, y + 0.5] on XZ plane (scaled by cube size)
+    int x = (int)floorf((ray.position.x - mapPosition.x)/cubeSize + 0.5f);
+    int y = (int)floorf((ray.position.z - mapPosition.z)/cubeSize + 0.5f);
+    
+    int stepX = (ray.direction.x >= 0.0f)? 1 : -1;
+    int stepY = (ray.direction.z >= 0.0f)? 1 : -1;
+    
+    // Ray distance between cells boundaries and to first boundary, along each axis
+    float deltaX = (ray.direction.x != 0.0f)? fabsf(cubeSize/ray.direction.x) : FLT_MAX;
+    float deltaY = (ray.direction.z != 0.0f)? fabsf(cubeSize/ray.direction.z) : FLT_MAX;
+    float nextX = (ray.direction.x != 0.0f)? (mapPosition.x + (x + 0.5f*stepX)*cubeSize - ray.position.x)/ray.direction.x : FLT_MAX;
+    float nextY = (ray.direction.z != 0.0f)? (mapPosition.z + (y + 0.5f*stepY)*cubeSize - ray.position.z)/ray.direction.z : FLT_MAX;
+    
+    float distance = 0.0f;
+    
+    while (distance <= maxDistance)
+    {
+        if ((x >= 0) && (x < mapWidth) && (y >= 0) && (y < mapHeight) && (mapPixels[y*mapWidth + x].r == 255))
+        {
+            float exit = (nextX < nextY)? nextX : nextY;    // Ray distance where it leaves the cell
+            float entryHeight = ray.position.y + ray.direction.y*distance - mapPosition.y;
+            float exitHeight = ray.position.y + ray.direction.y*exit - mapPosition.y;
+            
+            if ((fminf(entryHeight, exitHeight) <= cubeSize) && (fmaxf(entryHeight, exitHeight) >= 0.0f))
+            {
+                // Ray entering over (under) the wall hits it where it crosses wall top (bottom)
+                float hitDistance = distance;
+                
+                if (entryHeight > cubeSize) hitDistance += (cubeSize - entryHeight)/ray.direction.y;
+                else if (entryHeight < 0.0f) hitDistance += -entryHeight/ray.direction.y;
+                
+                if (hitDistance > maxDistance) return -1.0f;
+                
+                if (cellX != NULL) *cellX = x;
+                if (cellY != NULL) *cellY = y;
+                
+                return hitDistance;
+            }
+        }
+        
+        // Step to next cell crossed by ray
+        if (nextX < nextY)
+        {
+            distance = nextX;
+            nextX += deltaX;
+            x += stepX;
+        }
+        else
+        {
+            distance = nextY;
+            nextY += deltaY;
+            y += stepY;
+        }
+    }
+    
+    return -1.0f;
+}
+
+// Get ray distance to box (slabs), -1 if box is not hit
+// NOTE: Distance is 0 if ray starts inside box
+static float GetRayBoxDistance(Ray ray, BoundingBox box)
+{
+    float origin[3] = { ray.position.x, ray.position.y, ray.position.z };
+    float direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+    float min[3] = { box.min.x, box.min.y, box.min.z };
+    float max[3] = { box.max.x, box.max.y, box.max.z };
+    
+    float tMin = 0.0f;
+    float tMax = FLT_MAX;
+    
+    for (int i = 0; i < 3; i++)
+    {
+        if (direction[i] == 0.0f)
+        {
+            if ((origin[i] < min[i]) || (origin[i] > max[i])) return -1.0f;
+        }
+        else
+        {
+            float t1 = (min[i] - origin[i])/direction[i];
+            float t2 = (max[i] - origin[i])/direction[i];
+            
+            if (t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+            
+            if (t1 > tMin) tMin = t1;
+            if (t2 < tMax) tMax = t2;
+            
+            if (tMin > tMax) return -1.0f;
+        }
+    }
+    
+    return tMin;
+}
+
+// Get box containing two boxes
+static BoundingBox GetBoxUnion(BoundingBox box1, BoundingBox box2)
+{
+    return (BoundingBox){ Vector3Min(box1.min, box2.min), Vector3Max(box1.max, box2.max) };
+}
+
+// Get box surface area, used as insertion cost
+static float GetBoxSurfaceArea(BoundingBox box)
+{
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    
+    return 2.0f*(size.x*size.y + size.y*size.z + size.z*size.x);
+}
+
+// Get node from pool (pool may be reallocated)
+// NOTE: Nodes pointers must not be kept across calls to this function
+static int AllocateAABBTreeNode(AABBTree *tree)
+{
+    if (tree->freeList == AABB_TREE_NULL_NODE)
+    {
+        int capacity = (tree->capacity > 0)? tree->capacity*2 : 16;
+        
+        tree->nodes = (AABBTreeNode *)realloc(tree->nodes, capacity*sizeof(AABBTreeNode));
+        
+        for (int i = tree->capacity; i < capacity; i++)
+        {
+            tree->nodes[i].parent = (i < (capacity - 1))? (i + 1) : AABB_TREE_NULL_NODE;
+            tree->nodes[i].height = -1;
+        }
+        
+        tree->freeList = tree->capacity;
+        tree->capacity = capacity;
+    }
+    
+    int node = tree->freeList;
+    tree->freeList = tree->nodes[node].parent;
+    
+    tree->nodes[node] = (AABBTreeNode){ { { 0 } }, AABB_TREE_NULL_NODE, AABB_TREE_NULL_NODE, AABB_TREE_NULL_NODE, 0, -1 };
+    tree->nodeCount++;
+    
+    return node;
+}
+
+// Insert leaf next to its best sibling, balance up to root
+// NOTE: Sibling is searched descending from root, choosing the child with lower surface area cost
+// (new parent box area plus area increase inherited by all ancestors)
+static void InsertAABBTreeLeaf(AABBTree *tree, int leaf)
+{
+    if (tree->root == AABB_TREE_NULL_NODE)
+    {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AABB_TREE_NULL_NODE;
+        return;
+    }
+    
+    BoundingBox leafBox = tree->nodes[leaf].box;
+    int index = tree->root;
+    
+    while (tree->nodes[index].left != AABB_TREE_NULL_NODE)
+    {
+        int left = tree->nodes[index].left;
+        int right = tree->nodes[index].right;
+        
+        float area = GetBoxSurfaceArea(tree->nodes[index].box);
+        float combinedArea = GetBoxSurfaceArea(GetBoxUnion(tree->nodes[index].box, leafBox));
+        
+        float cost = 2.0f*combinedArea;                             // Cost of creating a new parent for this node and leaf
+        float inheritanceCost = 2.0f*(combinedArea - area);         // Minimum cost of pushing leaf further down
+        
+        float costLeft = GetBoxSurfaceArea(GetBoxUnion(leafBox, tree->nodes[left].box)) + inheritanceCost;
+        if (tree->nodes[left].left != AABB_TREE_NULL_NODE) costLeft -= GetBoxSurfaceArea(tree->nodes[left].box);
+        
+        float costRight = GetBoxSurfaceArea(GetBoxUnion(leafBox, tree->nodes[right].box)) + inheritanceCost;
+        if (tree->nodes[right].left != AABB_TREE_NULL_NODE) costRight -= GetBoxSurfaceArea(tree->nodes[right].box);
+        
+        if ((cost < costLeft) && (cost < costRight)) break;
+        
+        index = (costLeft < costRight)? left : right;
+    }
+    
+    int sibling = index;
+    int oldParent = tree->nodes[sibling].parent;
+    int newParent = AllocateAABBTreeNode(tree);
+    
+    tree->nodes[newParent].parent = oldParent;
+    tree->nodes[newParent].box = GetBoxUnion(leafBox, tree->nodes[sibling].box);
+    tree->nodes[newParent].height = tree->nodes[sibling].height + 1;
+    tree->nodes[newParent].left = sibling;
+    tree->nodes[newParent].right = leaf;
+    
+    if (oldParent != AABB_TREE_NULL_NODE)
+    {
+        if (tree->nodes[oldParent].left == sibling) tree->nodes[oldParent].left = newParent;
+        else tree->nodes[oldParent].right = newParent;
+    }
+    else tree->root = newParent;
+    
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+    
+    // Walk back up the tree, balancing and refitting boxes and heights
+    index = tree->nodes[leaf].parent;
+    
+    while (index != AABB_TREE_NULL_NODE)
+    {
+        index = BalanceAABBTree(tree, index);
+        
+        AABBTreeNode *node = &tree->nodes[index];
+        
+        int leftHeight = tree->nodes[node->left].height;
+        int rightHeight = tree->nodes[node->right].height;
+        
+        node->height = 1 + ((leftHeight > rightHeight)? leftHeight : rightHeight);
+        node->box = GetBoxUnion(tree->nodes[node->left].box, tree->nodes[node->right].box);
+        
+        index = node->parent;
+    }
+}
+
+// Rotate node if children heights differ more than 1, returns subtree root
+// NOTE: Higher child is promoted, node takes its lower grandchild (AVL rotation)
+static int BalanceAABBTree(AABBTree *tree, int node)
+{
+    AABBTreeNode *a = &tree->nodes[node];
+    
+    if ((a->left == AABB_TREE_NULL_NODE) || (a->height < 2)) return node;
+    
+    int indexB = a->left;
+    int indexC = a->right;
+    AABBTreeNode *b = &tree->nodes[indexB];
+    AABBTreeNode *c = &tree->nodes[indexC];
+    
+    int balance = c->height - b->height;
+    
+    if ((balance > 1) || (balance < -1))
+    {
+        // Promote higher child (up) over node (down)
+        int indexUp = (balance > 1)? indexC : indexB;
+        int indexOther = (balance > 1)? indexB : indexC;
+        AABBTreeNode *up = &tree->nodes[indexUp];
+        AABBTreeNode *other = &tree->nodes[indexOther];
+        
+        int indexF = up->left;
+        int indexG = up->right;
+        AABBTreeNode *f = &tree->nodes[indexF];
+        AABBTreeNode *g = &tree->nodes[indexG];
+        
+        // Swap node and up
+        up->left = node;
+        up->parent = a->parent;
+        a->parent = indexUp;
+        
+        if (up->parent != AABB_TREE_NULL_NODE)
+        {
+            if (tree->nodes[up->parent].left == node) tree->nodes[up->parent].left = indexUp;
+            else tree->nodes[up->parent].right = indexUp;
+        }
+        else tree->root = indexUp;
+        
+        // Up keeps its higher child, node takes the lower one in place of up
+        int indexKeep = (f->height > g->height)? indexF : indexG;
+        int indexGive = (f->height > g->height)? indexG : indexF;
+        
+        up->right = indexKeep;
+        
+        if (balance > 1) a->right = indexGive;
+        else a->left = indexGive;
+        
+        tree->nodes[indexGive].parent = node;
+        
+        a->box = GetBoxUnion(other->box, tree->nodes[indexGive].box);
+        a->height = 1 + ((other->height > tree->nodes[indexGive].height)? other->height : tree->nodes[indexGive].height);
+        up->box = GetBoxUnion(a->box, tree->nodes[indexKeep].box);
+        up->height = 1 + ((a->height > tree->nodes[indexKeep].height)? a->height : tree->nodes[indexKeep].height);
+        
+        return indexUp;
+    }
+    
+    return node;
+}
+
+// Occlusion culling: bounding box proxies and occlusion queries
+//----------------------------------------------------------------------------------
+// Load unit cube proxy vertex data (VRAM)
+// NOTE: Cube goes from (0, 0, 0) to (1, 1, 1), it's scaled and translated to every bounding box
+static void InitOcclusionProxy(void)
+{
+    // Cube faces corners: 2 triangles per face, 6 faces
+    // NOTE: Corner index bits define corner position: x (bit 0), y (bit 1), z (bit 2)
+    const int corners[36] = { 0, 2, 3, 0, 3, 1,   4, 5, 7, 4, 7, 6,   0, 1, 5, 0, 5, 4,
+                              2, 6, 7, 2, 7, 3,   0, 4, 6, 0, 6, 2,   1, 3, 7, 1, 7, 5 };
+    float vertices[36*3] = { 0 };
+    
+    for (int i = 0; i < 36; i++)
+    {
+        vertices[i*3] = (float)(corners[i] & 1);
+        vertices[i*3 + 1] = (float)((corners[i] >> 1) & 1);
+        vertices[i*3 + 2] = (float)((corners[i] >> 2) & 1);
+    }
+    
+    glGenVertexArrays(1, &occlusionBoxVao);
+    glBindVertexArray(occlusionBoxVao);
+    
+    glGenBuffers(1, &occlusionBoxVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, occlusionBoxVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, 0, 0, 0);
+    glEnableVertexAttribArray(0);
+    
+    glBindVertexArray(0);
+}
+
+// Load occlusion query for a bounding box (world space)
+static OcclusionQuery LoadOcclusionQuery(BoundingBox bounds)
+{
+    OcclusionQuery query = { 0 };
+    
+    glGenQueries(2, query.ids);
+    query.visible = true;       // Visible until first result is read
+    query.bounds = bounds;
+    
+    return query;
+}
+
+// Unload occlusion query
+static void UnloadOcclusionQuery(OcclusionQuery query)
+{
+    glDeleteQueries(2, query.ids);
+}
+
+// Draw model if not occluded, returns true if drawn
+// NOTE: Bounding box proxy is drawn (no color/depth writes) inside current frame query, previous frame
+// query result is read only if available (CPU never waits): model is skipped if it was occluded,
+// otherwise it's drawn conditioned on GPU by current frame query result; occluders must be drawn before
+static bool DrawModelOccluded(Model model, Vector3 position, float scale, Color tint, OcclusionQuery *query, Frustum frustum, Vector3 viewPosition)
+{
+    int current = query->frame%2;
+    int previous = 1 - current;
+    
+    query->frame++;
+    
+    // Read previous frame result, if available
+    if (query->issued[previous])
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(query->ids[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+        
+        if (available)
+        {
+            GLuint samplesPassed = 0;
+            glGetQueryObjectuiv(query->ids[previous], GL_QUERY_RESULT, &samplesPassed);
+            
+            query->visible = (samplesPassed > 0);
+            query->issued[previous] = false;
+        }
+    }
+    
+    // Proxy can be clipped by near plane when viewer is inside (or very close to) the box, model is always drawn
+    const float margin = 0.05f;
+    
+    if ((viewPosition.x > query->bounds.min.x - margin) && (viewPosition.x < query->bounds.max.x + margin) &&
+        (viewPosition.y > query->bounds.min.y - margin) && (viewPosition.y < query->bounds.max.y + margin) &&
+        (viewPosition.z > query->bounds.min.z - margin) && (viewPosition.z < query->bounds.max.z + margin))
+    {
+        query->visible = true;
+        DrawModelClusters(model, position, scale, tint, frustum, viewPosition);
+        return true;
+    }
+    
+    // Issue current frame query: draw bounding box proxy, only depth test is required
+    Vector3 size = Vector3Subtract(query->bounds.max, query->bounds.min);
+    Matrix matProxy = MatrixMultiply(MatrixScale(size.x, size.y, size.z), MatrixTranslate(query->bounds.min.x, query->bounds.min.y, query->bounds.min.z));
+    
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    
+    glUseProgram(shdrDefault.id);
+    glUniformMatrix4fv(shdrDefault.modelLoc, 1, false, MatrixToFloat(matProxy));
+    glBindVertexArray(occlusionBoxVao);
+    
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, query->ids[current]);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    
+    glBindVertexArray(0);
+    glUseProgram(0);
+    
+    glEnable(GL_CULL_FACE);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    
+    query->issued[current] = true;
+    
+    if (!query->visible) return false;     // Occluded on previous frame
+    
+    // Model draw is skipped on GPU if proxy samples did not pass (drawn if result is not ready)
+    if (GLAD_GL_VERSION_3_0) glBeginConditionalRender(query->ids[current], GL_QUERY_BY_REGION_NO_WAIT);
+    DrawModelClusters(model, position, scale, tint, frustum, viewPosition);
+    if (GLAD_GL_VERSION_3_0) glEndConditionalRender();
+    
+    return true;
+}
+
+// LESSON 06: Camera system management (1st person)
+//----------------------------------------------------------------------------------
+static void UpdateCamera(Camera *camera)
+{
+    // Some useful defines
+    #define PLAYER_MOVEMENT_SENSITIVITY                     20.0f
+    #define CAMERA_MOUSE_MOVE_SENSITIVITY                   0.003f
+    #define CAMERA_FIRST_PERSON_FOCUS_DISTANCE              25.0f
+    #define CAMERA_FIRST_PERSON_MIN_CLAMP                   85.0f
+    #define CAMERA_FIRST_PERSON_MAX_CLAMP                  -85.0f
+
+    #define CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER  5.0f
+    #define CAMERA_FIRST_PERSON_STEP_DIVIDER                30.0f
+    #define CAMERA_FIRST_PERSON_WAVING_DIVIDER              200.0f
+    
+    static float playerEyesPosition = 0.6f;              // Default player eyes position from ground (in meters) 
+
+    static int cameraMoveControl[6]  = { 'W', 'S', 'D', 'A', 'E', 'Q' };
+    static int cameraPanControlKey = 2;                   // raylib: MOUSE_MIDDLE_BUTTON
+    static int cameraAltControlKey = 342;                 // raylib: KEY_LEFT_ALT
+    static int cameraSmoothZoomControlKey = 341;          // raylib: KEY_LEFT_CONTROL
+
+    static int swingCounter = 0;    // Used for 1st person swinging movement
+    static Vector2 previousMousePosition = { 0.0f, 0.0f };
+
+    // Mouse movement detection
+    Vector2 mousePositionDelta = { 0.0f, 0.0f };
+    Vector2 mousePosition = GetMousePosition();
+    
+    // Keys input detection
+    bool panKey = IsMouseButtonDown(cameraPanControlKey);
+    bool altKey = IsKeyDown(cameraAltControlKey);
+    bool szoomKey = IsKeyDown(cameraSmoothZoomControlKey);
+    
+    bool direction[6] = { IsKeyDown(cameraMoveControl[MOVE_FRONT]),
+                          IsKeyDown(cameraMoveControl[MOVE_BACK]),
+                          IsKeyDown(cameraMoveControl[MOVE_RIGHT]),
+                          IsKeyDown(cameraMoveControl[MOVE_LEFT]),
+                          IsKeyDown(cameraMoveControl[MOVE_UP]),
+                          IsKeyDown(cameraMoveControl[MOVE_DOWN]) };
+
+    mousePositionDelta.x = mousePosition.x - previousMousePosition.x;
+    mousePositionDelta.y = mousePosition.y - previousMousePosition.y;
+
+    previousMousePosition = mousePosition;
+
+    camera->position.x += (sinf(cameraAngle.x)*direction[MOVE_BACK] -
+                           sinf(cameraAngle.x)*direction[MOVE_FRONT] -
+                           cosf(cameraAngle.x)*direction[MOVE_LEFT] +
+                           cosf(cameraAngle.x)*direction[MOVE_RIGHT])/PLAYER_MOVEMENT_SENSITIVITY;
+                           
+    camera->position.y += (sinf(cameraAngle.y)*direction[MOVE_FRONT] -
+                           sinf(cameraAngle.y)*direction[MOVE_BACK] +
+                           1.0f*direction[MOVE_UP] - 1.0f*direction[MOVE_DOWN])/PLAYER_MOVEMENT_SENSITIVITY;
+                           
+    camera->position.z += (cosf(cameraAngle.x)*direction[MOVE_BACK] -
+                           cosf(cameraAngle.x)*direction[MOVE_FRONT] +
+                           sinf(cameraAngle.x)*direction[MOVE_LEFT] -
+                           sinf(cameraAngle.x)*direction[MOVE_RIGHT])/PLAYER_MOVEMENT_SENSITIVITY;
+
+    bool isMoving = false;  // Required for swinging
+
+    for (int i = 0; i < 6; i++) if (direction[i]) { isMoving = true; break; }
+    
+    // Camera orientation calculation
+    cameraAngle.x += (mousePositionDelta.x*-CAMERA_MOUSE_MOVE_SENSITIVITY);
+    cameraAngle.y += (mousePositionDelta.y*-CAMERA_MOUSE_MOVE_SENSITIVITY);
+    
+    // Angle clamp
+    if (cameraAngle.y > CAMERA_FIRST_PERSON_MIN_CLAMP*DEG2RAD) cameraAngle.y = CAMERA_FIRST_PERSON_MIN_CLAMP*DEG2RAD;
+    else if (cameraAngle.y < CAMERA_FIRST_PERSON_MAX_CLAMP*DEG2RAD) cameraAngle.y = CAMERA_FIRST_PERSON_MAX_CLAMP*DEG2RAD;
+
+    // Camera is always looking at player
+    camera->target.x = camera->position.x - sinf(cameraAngle.x)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
+    camera->target.y = camera->position.y + sinf(cameraAngle.y)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
+    camera->target.z = camera->position.z - cosf(cameraAngle.x)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
+    
+    if (isMoving) swingCounter++;
+
+    // Camera position update
+    // NOTE: On CAMERA_FIRST_PERSON player Y-movement is limited to player 'eyes position'
+    camera->position.y = playerEyesPosition - sinf(swingCounter/CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER)/CAMERA_FIRST_PERSON_STEP_DIVIDER;
+
+    camera->up.x = sinf(swingCounter/(CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER*2))/CAMERA_FIRST_PERSON_WAVING_DIVIDER;
+    camera->up.z = -sinf(swingCounter/(CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER*2))/CAMERA_FIRST_PERSON_WAVING_DIVIDER;
+}
+
+// LESSON 07: Collision detection and resolution
+//----------------------------------------------------------------------------------
+#if !defined(VOXEL_MAZE)
+// Check collision between circle and rectangle
+static bool CheckCollisionCircleRec(Vector2 center, float radius, Rectangle rec)
+{
+    int recCenterX = rec.x + rec.width/2;
+    int recCenterY = rec.y + rec.height/2;
+    
+    float dx = fabsf(center.x - recCenterX);
+    float dy = fabsf(center.y - recCenterY);
+
+    if (dx > ((float)rec.width/2.0f + radius)) { return false; }
+    if (dy > ((float)rec.height/2.0f + radius)) { return false; }
+
+    if (dx <= ((float)rec.width/2.0f)) { return true; }
+    if (dy <= ((float)rec.height/2.0f)) { return true; }
+
+    float cornerDistanceSq = (dx - (float)rec.width/2.0f)*(dx - (float)rec.width/2.0f) + 
+						     (dy - (float)rec.height/2.0f)*(dy - (float)rec.height/2.0f);
+
+    return (cornerDistanceSq <= (radius*radius));
+}
+#endif
+
+// Check collision between two boxes
+static bool CheckCollisionBoxes(BoundingBox box1, BoundingBox box2)
+{
+    if ((box1.max.x < box2.min.x) || (box1.min.x > box2.max.x)) return false;
+    if ((box1.max.y < box2.min.y) || (box1.min.y > box2.max.y)) return false;
+    if ((box1.max.z < box2.min.z) || (box1.min.z > box2.max.z)) return false;
+    
+    return true;
+}
+
+// Scene frame drawing: frames drawn on game thread or on a dedicated render thread
+//----------------------------------------------------------------------------------
+// Draw scene frame, stream textures and swap buffers
+// NOTE: Quality settings are only changed by hardware probe, preset and vsync are compared
+static void DrawSceneFrame(SceneResources scene, SceneFrame frame)
+{
+    if ((frame.quality.preset != quality.preset) || (frame.quality.vsync != quality.vsync)) SetQualitySettings(frame.quality, scene.streams, scene.streamCount);
+    
+    UpdateFrameData(frame.view, frame.projection, frame.time);    // Upload per-frame data, once per frame
+    
+    BeginSceneTarget(sceneTarget);      // Scene is drawn at quality settings resolution and anti-aliasing
+    
+    BeginDebugGroup("Clear");
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);         // Clear used buffers: Color and Depth (Depth is used for 3D)
+    EndDebugGroup();
+    
+    // LESSON 04: Draw loaded 3d models
+    BeginDebugGroup("Draw maze");
+    int chunksDrawn = DrawModelChunks(*scene.modelMap, scene.mapPosition, 1.0f, WHITE, frame.frustum);
+    EndDebugGroup();
+    
+    // NOTE: Props are drawn after maze, walls occlude them
+    BeginDebugGroup("Draw tower");
+    if (frame.towerInFrustum) DrawModelOccluded(*scene.modelTower, scene.towerPosition, scene.towerScale, WHITE, scene.towerQuery, frame.frustum, frame.viewPosition);
+    else scene.towerQuery->visible = true;     // Assume visible when entering frustum again
+    EndDebugGroup();
+    
+    // Update textures streaming priorities: on-screen usage weighted by distance to camera
+    // NOTE: Camera is always inside the maze, map atlas usage (stream 1) is the ratio of chunks drawn
+    if (scene.modelMap->mesh.chunkCount > 0) scene.streams[1].priority = (float)chunksDrawn/scene.modelMap->mesh.chunkCount;
+    else scene.streams[1].priority = 1.0f;
+    
+    if (frame.towerInFrustum && scene.towerQuery->visible)
+    {
+        Vector3 towerCenter = Vector3Scale(Vector3Add(scene.towerQuery->bounds.min, scene.towerQuery->bounds.max), 0.5f);
+        scene.streams[0].priority = 1.0f/(1.0f + Vector3Length(Vector3Subtract(towerCenter, frame.viewPosition)));
+    }
+    else scene.streams[0].priority = 0.0f;
+    
+    // Upload next textures levels, used from next frame
+    BeginDebugGroup("Stream textures");
+    UpdateLoadTextureStreams(scene.streamLoader);
+    UpdateTextureStreaming(scene.streams, scene.streamCount, STREAM_UPLOAD_BUDGET);
+    EndDebugGroup();
+    
+    BeginDebugGroup("Resolve scene");
+    EndSceneTarget(sceneTarget);
+    EndDebugGroup();
+    
+    glfwSwapBuffers(window);            // Swap buffers: show back buffer into front
+    if (frame.finish) glFinish();       // Probe frame time includes all GPU work of the frame
+}
+
+#if defined(RENDER_THREAD)
+// Start render thread, OpenGL context is moved to it
+// NOTE: Resources must be loaded before, only render thread can use OpenGL; if thread can not be
+// created, context is kept on calling thread and frames are drawn on submission
+static void StartRenderThread(RenderThread *renderThread, SceneResources scene)
+{
+    pthread_mutex_init(&renderThread->mutex, NULL);
+    pthread_cond_init(&renderThread->cond, NULL);
+    
+    renderThread->scene = scene;
+    renderThread->pending = false;
+    renderThread->running = true;
+    renderThread->memoryInfo = glfwExtensionSupported("GL_NVX_gpu_memory_info");
+    
+    glfwMakeContextCurrent(NULL);       // Context can only be current on one thread
+    
+    if (pthread_create(&renderThread->thread, NULL, RenderThreadMain, renderThread) != 0)
+    {
+        TraceLog(LOG_WARNING, "Render thread could not be created, frames drawn on game thread");
+        
+        renderThread->running = false;
+        glfwMakeContextCurrent(window);
+    }
+    else TraceLog(LOG_INFO, "Render thread started");
+}
+
+// Stop render thread once last frame is drawn, OpenGL context is moved back
+static void StopRenderThread(RenderThread *renderThread)
+{
+    if (renderThread->running)
+    {
+        pthread_mutex_lock(&renderThread->mutex);
+        renderThread->running = false;
+        pthread_cond_broadcast(&renderThread->cond);
+        pthread_mutex_unlock(&renderThread->mutex);
+        
+        pthread_join(renderThread->thread, NULL);
+        
+        glfwMakeContextCurrent(window);
+    }
+    
+    pthread_cond_destroy(&renderThread->cond);
+    pthread_mutex_destroy(&renderThread->mutex);
+}
+
+// Hand frame to render thread, waits until previous frame has been taken
+// NOTE: Drawn frames counters (debug messages, VRAM) are registered on frame stats here,
+// frame stats are only accessed by game thread
+static void SubmitRenderFrame(RenderThread *renderThread, SceneFrame frame)
+{
+    pthread_mutex_lock(&renderThread->mutex);
+    
+    if (renderThread->running)
+    {
+        // Previous frame must have been taken by render thread, frames are never dropped
+        while (renderThread->pending) pthread_cond_wait(&renderThread->cond, &renderThread->mutex);
+        
+        renderThread->frame = frame;
+        renderThread->pending = true;
+        pthread_cond_broadcast(&renderThread->cond);
+    }
+    else
+    {
+        DrawSceneFrame(renderThread->scene, frame);     // No render thread, frame drawn here
+        UpdateRenderCounters(renderThread);
+    }
+    
+    int perfMessages = renderThread->perfMessages;
+    int errorMessages = renderThread->errorMessages;
+    renderThread->perfMessages = 0;
+    renderThread->errorMessages = 0;
+    
+    frameStats.vramUsage = renderThread->vramUsage;
+    frameStats.vramAvailable = renderThread->vramAvailable;
+    
+    pthread_mutex_unlock(&renderThread->mutex);
+    
+    frameStats.perfMessageCount += perfMessages;
+    frameStats.errorMessageCount += errorMessages;
+    if (perfMessages > frameStats.perfMessagePeak) frameStats.perfMessagePeak = perfMessages;
+}
+
+// Render thread loop: draw submitted frames
+// NOTE: Frames submitted before stop request are drawn before thread exits
+static void *RenderThreadMain(void *arg)
+{
+    RenderThread *renderThread = (RenderThread *)arg;
+    
+    glfwMakeContextCurrent(window);
+    
+    pthread_mutex_lock(&renderThread->mutex);
+    
+    while (true)
+    {
+        while (renderThread->running && !renderThread->pending) pthread_cond_wait(&renderThread->cond, &renderThread->mutex);
+        
+        if (!renderThread->pending) break;      // Stop requested and no frames left
+        
+        SceneFrame frame = renderThread->frame;
+        renderThread->pending = false;
+        pthread_cond_broadcast(&renderThread->cond);
+        pthread_mutex_unlock(&renderThread->mutex);
+        
+        DrawSceneFrame(renderThread->scene, frame);
+        
+        pthread_mutex_lock(&renderThread->mutex);
+        UpdateRenderCounters(renderThread);
+    }
+    
+    pthread_mutex_unlock(&renderThread->mutex);
+    
+    glfwMakeContextCurrent(NULL);
+    
+    return NULL;
+}
+
+// Register drawn frame debug messages and VRAM counters (OpenGL context thread)
+// NOTE: Debug messages are received on thread issuing OpenGL calls (synchronous debug output)
+static void UpdateRenderCounters(RenderThread *renderThread)
+{
+    renderThread->perfMessages += debugPerfMessages;
+    renderThread->errorMessages += debugErrorMessages;
+    renderThread->vramUsage = vramUsage;
+    
+    debugPerfMessages = 0;
+    debugErrorMessages = 0;
+    
+    // NOTE: Driver reported VRAM also tracks memory not allocated by us (driver internals)
+    if (renderThread->memoryInfo)
+    {
+        int availableKB = 0;
+        glGetIntegerv(0x9049, &availableKB);    // GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+        renderThread->vramAvailable = (long)availableKB*1024;
+    }
+}
+#endif
+
+// Quality settings: presets, config file and hardware probe
+//----------------------------------------------------------------------------------
+// Get quality preset settings for a window size
+static QualitySettings GetQualityPreset(int preset, int screenWidth, int screenHeight)
+{
+    // Presets: resolution scale, MSAA samples, textures filter, anisotropy and mipmap level bias, draw distance
+    static const QualitySettings presets[4] = {
+        { 0, 0, QUALITY_LOW, 0.5f, 0, FILTER_POINT, 1, 1.0f, 16.0f, true },
+        { 0, 0, QUALITY_MEDIUM, 0.75f, 0, FILTER_BILINEAR, 1, 0.5f, 32.0f, true },
+        { 0, 0, QUALITY_HIGH, 1.0f, 4, FILTER_TRILINEAR, 4, 0.0f, 64.0f, true },
+        { 0, 0, QUALITY_ULTRA, 1.0f, 8, FILTER_TRILINEAR, 16, 0.0f, 1000.0f, true }
+    };
+    
+    if (preset < QUALITY_LOW) preset = QUALITY_LOW;
+    else if (preset > QUALITY_ULTRA) preset = QUALITY_ULTRA;
+    
+    QualitySettings settings = presets[preset];
+    settings.screenWidth = screenWidth;
+    settings.screenHeight = screenHeight;
+    
+    return settings;
+}
+
+#if !defined(SOAK_TEST)
+// Load quality settings from config file, returns false if not available
+// NOTE: Config file lines are "key = value" (lines starting with '#' are comments), preset is read first
+// and settings found override preset values; window size not found is kept from provided settings
+static bool LoadQualitySettings(const char *fileName, QualitySettings *settings)
+{
+    FILE *configFile = fopen(fileName, "rt");
+    
+    if (configFile == NULL) return false;
+    
+    char line[256] = { 0 };
+    char key[64] = { 0 };
+    float value = 0.0f;
+    int preset = -1;
+    
+    while (fgets(line, 256, configFile) != NULL)
+    {
+        if ((sscanf(line, " %63[a-z_] = %f", key, &value) == 2) && (strcmp(key, "preset") == 0)) preset = (int)value;
+    }
+    
+    if (preset < 0)
+    {
+        TraceLog(LOG_WARNING, "[%s] Quality settings preset not found", fileName);
+        fclose(configFile);
+        return false;
+    }
+    
+    QualitySettings loaded = GetQualityPreset(preset, settings->screenWidth, settings->screenHeight);
+    
+    rewind(configFile);
+    
+    while (fgets(line, 256, configFile) != NULL)
+    {
+        if (sscanf(line, " %63[a-z_] = %f", key, &value) != 2) continue;
+    
+        if ((strcmp(key, "screen_width") == 0) && (value > 0.0f)) loaded.screenWidth = (int)value;
+        else if ((strcmp(key, "screen_height") == 0) && (value > 0.0f)) loaded.screenHeight = (int)value;
+        else if (strcmp(key, "resolution_scale") == 0) loaded.resolutionScale = Clamp(value, 0.25f, 2.0f);
+        else if (strcmp(key, "msaa_samples") == 0) loaded.msaaSamples = (int)value;
+        else if (strcmp(key, "texture_filter") == 0) loaded.textureFilter = (int)value;
+        else if (strcmp(key, "texture_anisotropy") == 0) loaded.textureAnisotropy = (int)value;
+        else if (strcmp(key, "texture_lod_bias") == 0) loaded.textureLodBias = value;
+        else if (strcmp(key, "draw_distance") == 0) loaded.drawDistance = (value > 1.0f)? value : 1.0f;
+        else if (strcmp(key, "vsync") == 0) loaded.vsync = (value != 0.0f);
+    }
+    
+    fclose(configFile);
+    
+    *settings = loaded;
+    
+    TraceLog(LOG_INFO, "[%s] Quality settings loaded successfully (preset %i)", fileName, loaded.preset);
+    
+    return true;
+}
+#endif
+
+// Save quality settings to config file
+static void SaveQualitySettings(const char *fileName, QualitySettings settings)
+{
+    FILE *configFile = fopen(fileName, "wt");
+    
+    if (configFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "[%s] Quality settings could not be saved", fileName);
+        return;
+    }
+    
+    fprintf(configFile, "# Quality settings, delete this file to run hardware probe again on next launch\n");
+    fprintf(configFile, "# preset: 0 - low, 1 - medium, 2 - high, 3 - ultra (settings below override preset values)\n");
+    fprintf(configFile, "preset = %i\n", settings.preset);
+    fprintf(configFile, "screen_width = %i\n", settings.screenWidth);
+    fprintf(configFile, "screen_height = %i\n", settings.screenHeight);
+    fprintf(configFile, "resolution_scale = %.2f\n", settings.resolutionScale);
+    fprintf(configFile, "msaa_samples = %i\n", settings.msaaSamples);
+    fprintf(configFile, "# texture_filter: 0 - point, 1 - bilinear, 2 - trilinear\n");
+    fprintf(configFile, "texture_filter = %i\n", settings.textureFilter);
+    fprintf(configFile, "texture_anisotropy = %i\n", settings.textureAnisotropy);
+    fprintf(configFile, "texture_lod_bias = %.2f\n", settings.textureLodBias);
+    fprintf(configFile, "draw_distance = %.1f\n", settings.drawDistance);
+    fprintf(configFile, "vsync = %i\n", settings.vsync? 1 : 0);
+    
+    fclose(configFile);
+    
+    TraceLog(LOG_INFO, "[%s] Quality settings saved successfully (preset %i)", fileName, settings.preset);
+}
+
+// Apply quality settings: scene target, vsync and textures sampling
+// NOTE: Draw distance is applied by user on projection matrix (camera far plane)
+static void SetQualitySettings(QualitySettings settings, StreamTexture *streams, int count)
+{
+    UnloadSceneTarget(sceneTarget);
+    sceneTarget = LoadSceneTarget(settings.screenWidth, settings.screenHeight, settings.resolutionScale, settings.msaaSamples);
+    
+    glfwSwapInterval(settings.vsync? 1 : 0);
+    
+    for (int i = 0; i < count; i++) SetTextureFilter(streams[i].texture, settings.textureFilter, settings.textureAnisotropy, settings.textureLodBias);
+    
+    quality = settings;
+    
+    TraceLog(LOG_INFO, "QUALITY: Preset %i applied (scene %ix%i, MSAA %ix, filter %i, anisotropy %ix, draw distance %.0f)", settings.preset,
+             sceneTarget.width, sceneTarget.height, sceneTarget.samples, settings.textureFilter, settings.textureAnisotropy, settings.drawDistance);
+}
+
+// Load scene render target (scaled, multisampled)
+// NOTE: Multisampled scene is resolved on a same size framebuffer before upscaling (blits can't do both),
+// not scaled and not multisampled scene requires no render target
+static SceneTarget LoadSceneTarget(int screenWidth, int screenHeight, float scale, int samples)
+{
+    SceneTarget target = { 0 };
+    
+    target.width = (int)(screenWidth*scale);
+    target.height = (int)(screenHeight*scale);
+    target.samples = (samples < maxSamples)? samples : maxSamples;
+    target.screenWidth = screenWidth;
+    target.screenHeight = screenHeight;
+    
+    if (target.width < 1) target.width = 1;
+    if (target.height < 1) target.height = 1;
+    if (target.samples < 0) target.samples = 0;
+    
+    bool scaled = (target.width != screenWidth) || (target.height != screenHeight);
+    
+    if (!scaled && (target.samples == 0)) return target;
+    
+    glGenFramebuffers(1, &target.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    
+    glGenRenderbuffers(1, &target.colorRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colorRbo);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target.samples, GL_RGBA8, target.width, target.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorRbo);
+    
+    glGenRenderbuffers(1, &target.depthRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthRbo);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, target.samples, GL_DEPTH_COMPONENT24, target.width, target.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthRbo);
+    
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    
+    if (complete && scaled && (target.samples > 0))
+    {
+        glGenFramebuffers(1, &target.resolveFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.resolveFbo);
+    
+        glGenRenderbuffers(1, &target.resolveRbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.resolveRbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, target.width, target.height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.resolveRbo);
+    
+        complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    }
+    
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    // NOTE: VRAM usage is registered as 4 bytes per sample (color and depth)
+    vramUsage += target.width*target.height*8*((target.samples > 0)? target.samples : 1);
+    if (target.resolveFbo != 0) vramUsage += target.width*target.height*4;
+    
+    if (!complete)
     {
-        mesh.vertices[fCounter] = mapVertices[i].x;
-        mesh.vertices[fCounter + 1] = mapVertices[i].y;
-        mesh.vertices[fCounter + 2] = mapVertices[i].z;
-        fCounter += 3;
+        TraceLog(LOG_WARNING, "Scene render target could not be created (%ix%i, MSAA %ix), scene drawn to window", target.width, target.height, target.samples);
+    
+        UnloadSceneTarget(target);
+    
+        target = (SceneTarget){ 0 };
+        target.width = target.screenWidth = screenWidth;
+        target.height = target.screenHeight = screenHeight;
     }
+    
+    return target;
+}
 
-    fCounter = 0;
-
-    // Move normals data
-    for (int i = 0; i < nCounter; i++)
+// Unload scene render target (VRAM)
+static void UnloadSceneTarget(SceneTarget target)
+{
+    if (target.fbo == 0) return;
+    
+    glDeleteFramebuffers(1, &target.fbo);
+    glDeleteRenderbuffers(1, &target.colorRbo);
+    glDeleteRenderbuffers(1, &target.depthRbo);
+    
+    vramUsage -= target.width*target.height*8*((target.samples > 0)? target.samples : 1);
+    
+    if (target.resolveFbo != 0)
     {
-        mesh.normals[fCounter] = mapNormals[i].x;
-        mesh.normals[fCounter + 1] = mapNormals[i].y;
-        mesh.normals[fCounter + 2] = mapNormals[i].z;
-        fCounter += 3;
+        glDeleteFramebuffers(1, &target.resolveFbo);
+        glDeleteRenderbuffers(1, &target.resolveRbo);
+    
+        vramUsage -= target.width*target.height*4;
     }
+}
 
-    fCounter = 0;
+// Begin drawing scene into render target
+static void BeginSceneTarget(SceneTarget target)
+{
+    if (target.fbo == 0) return;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, target.width, target.height);
+}
 
-    // Move texcoords data
-    for (int i = 0; i < tcCounter; i++)
+// End drawing scene, resolve and upscale it to window
+// NOTE: Upscaling uses linear filtering, window framebuffer is fully covered (not cleared)
+static void EndSceneTarget(SceneTarget target)
+{
+    if (target.fbo == 0) return;
+    
+    unsigned int source = target.fbo;
+    
+    if (target.resolveFbo != 0)
     {
-        mesh.texcoords[fCounter] = mapTexcoords[i].x;
-        mesh.texcoords[fCounter + 1] = mapTexcoords[i].y;
-        fCounter += 2;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target.fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.resolveFbo);
+        glBlitFramebuffer(0, 0, target.width, target.height, 0, 0, target.width, target.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    
+        source = target.resolveFbo;
     }
+    
+    bool scaled = (target.width != target.screenWidth) || (target.height != target.screenHeight);
+    
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target.width, target.height, 0, 0, target.screenWidth, target.screenHeight, GL_COLOR_BUFFER_BIT, scaled? GL_LINEAR : GL_NEAREST);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, target.screenWidth, target.screenHeight);
+}
 
-    free(mapVertices);
-    free(mapNormals);
-    free(mapTexcoords);
+// Set texture filter mode, anisotropy and mipmap level bias
+// NOTE: Mipmap filters are only used on textures with mipmap levels (streamed textures)
+static void SetTextureFilter(Texture2D texture, int filter, int anisotropy, float lodBias)
+{
+    bool mipmaps = (texture.mipmaps > 1);
+    
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    
+    switch (filter)
+    {
+        case FILTER_BILINEAR:
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR);
+        } break;
+        case FILTER_TRILINEAR:
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        } break;
+        default:
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+        } break;
+    }
+    
+    if (maxAnisotropy > 1.0f) glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, Clamp((float)anisotropy, 1.0f, maxAnisotropy));
+    
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, lodBias);
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    free(cubicmapPixels);   // Free image pixel data
+// Start hardware probe, most expensive preset first
+static void StartQualityProbe(QualityProbe *probe)
+{
+    *probe = (QualityProbe){ 0 };
     
-    TraceLog(LOG_INFO, "Mesh generated successfully (vertexCount: %i)", mesh.vertexCount);
+    probe->active = true;
+    probe->preset = QUALITY_ULTRA;
+    probe->warmupFrames = QUALITY_PROBE_WARMUP_FRAMES;
+    
+    TraceLog(LOG_INFO, "QUALITY: Hardware probe started, frame time target: %.1f ms", QUALITY_PROBE_FRAME_TIME);
+}
 
-    return mesh;
+// Register probe frame time (ms), returns true if probed preset changed
+// NOTE: Every preset is drawn for its share of probe time (less if clearly slower than target), preset is
+// selected if frame times median meets target; lowest preset is selected if none of them does
+static bool UpdateQualityProbe(QualityProbe *probe, float frameTime)
+{
+    if (!probe->active) return false;
+    
+    if (probe->warmupFrames > 0)
+    {
+        probe->warmupFrames--;
+        return false;
+    }
+    
+    if (probe->frameCount < QUALITY_PROBE_MAX_FRAMES) probe->times[probe->frameCount++] = frameTime;
+    probe->totalTime += frameTime;
+    
+    // NOTE: Frame times order is not required, times are sorted in-place
+    float median = GetFrameTimePercentile(probe->times, probe->frameCount, 0.5f);
+    bool slow = (probe->frameCount >= 2) && (median > 2.0f*QUALITY_PROBE_FRAME_TIME);
+    
+    if ((probe->totalTime < QUALITY_PROBE_TIME/(QUALITY_ULTRA + 1)) && !slow) return false;
+    
+    TraceLog(LOG_INFO, "QUALITY: Preset %i probed, frame time median: %.2f ms (%i frames)", probe->preset, median, probe->frameCount);
+    
+    if ((median <= QUALITY_PROBE_FRAME_TIME) || (probe->preset == QUALITY_LOW))
+    {
+        probe->active = false;
+    
+        TraceLog(LOG_INFO, "QUALITY: Hardware probe finished, preset %i selected", probe->preset);
+    
+        return false;
+    }
+    
+    probe->preset--;
+    probe->warmupFrames = QUALITY_PROBE_WARMUP_FRAMES;
+    probe->frameCount = 0;
+    probe->totalTime = 0.0f;
+    
+    return true;
 }
 
-// LESSON 06: Camera system management (1st person)
+// Frame stats: frame times, memory usage and VRAM counters
 //----------------------------------------------------------------------------------
-static void UpdateCamera(Camera *camera)
+// Register frame time (ms), reduce stats at sample end
+static void UpdateFrameStats(float frameTime)
 {
-    // Some useful defines
-    #define PLAYER_MOVEMENT_SENSITIVITY                     20.0f
-    #define CAMERA_MOUSE_MOVE_SENSITIVITY                   0.003f
-    #define CAMERA_FIRST_PERSON_FOCUS_DISTANCE              25.0f
-    #define CAMERA_FIRST_PERSON_MIN_CLAMP                   85.0f
-    #define CAMERA_FIRST_PERSON_MAX_CLAMP                  -85.0f
-
-    #define CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER  5.0f
-    #define CAMERA_FIRST_PERSON_STEP_DIVIDER                30.0f
-    #define CAMERA_FIRST_PERSON_WAVING_DIVIDER              200.0f
+    if (frameStats.frameCount < FRAME_STATS_CAPACITY) frameStats.frameTimes[frameStats.frameCount++] = frameTime;
     
-    static float playerEyesPosition = 0.6f;              // Default player eyes position from ground (in meters) 
-
-    static int cameraMoveControl[6]  = { 'W', 'S', 'D', 'A', 'E', 'Q' };
-    static int cameraPanControlKey = 2;                   // raylib: MOUSE_MIDDLE_BUTTON
-    static int cameraAltControlKey = 342;                 // raylib: KEY_LEFT_ALT
-    static int cameraSmoothZoomControlKey = 341;          // raylib: KEY_LEFT_CONTROL
-
-    static int swingCounter = 0;    // Used for 1st person swinging movement
-    static Vector2 previousMousePosition = { 0.0f, 0.0f };
-
-    // Mouse movement detection
-    Vector2 mousePositionDelta = { 0.0f, 0.0f };
-    Vector2 mousePosition = GetMousePosition();
+#if !defined(RENDER_THREAD)
+    // Register driver debug messages received along the frame
+    // NOTE: With render thread, debug messages and VRAM counters are registered on frames submission
+    frameStats.perfMessageCount += debugPerfMessages;
+    frameStats.errorMessageCount += debugErrorMessages;
+    if (debugPerfMessages > frameStats.perfMessagePeak) frameStats.perfMessagePeak = debugPerfMessages;
     
-    // Keys input detection
-    bool panKey = IsMouseButtonDown(cameraPanControlKey);
-    bool altKey = IsKeyDown(cameraAltControlKey);
-    bool szoomKey = IsKeyDown(cameraSmoothZoomControlKey);
+    debugPerfMessages = 0;
+    debugErrorMessages = 0;
+#endif
     
-    bool direction[6] = { IsKeyDown(cameraMoveControl[MOVE_FRONT]),
-                          IsKeyDown(cameraMoveControl[MOVE_BACK]),
-                          IsKeyDown(cameraMoveControl[MOVE_RIGHT]),
-                          IsKeyDown(cameraMoveControl[MOVE_LEFT]),
-                          IsKeyDown(cameraMoveControl[MOVE_UP]),
-                          IsKeyDown(cameraMoveControl[MOVE_DOWN]) };
-
-    mousePositionDelta.x = mousePosition.x - previousMousePosition.x;
-    mousePositionDelta.y = mousePosition.y - previousMousePosition.y;
-
-    previousMousePosition = mousePosition;
-
-    camera->position.x += (sinf(cameraAngle.x)*direction[MOVE_BACK] -
-                           sinf(cameraAngle.x)*direction[MOVE_FRONT] -
-                           cosf(cameraAngle.x)*direction[MOVE_LEFT] +
-                           cosf(cameraAngle.x)*direction[MOVE_RIGHT])/PLAYER_MOVEMENT_SENSITIVITY;
-                           
-    camera->position.y += (sinf(cameraAngle.y)*direction[MOVE_FRONT] -
-                           sinf(cameraAngle.y)*direction[MOVE_BACK] +
-                           1.0f*direction[MOVE_UP] - 1.0f*direction[MOVE_DOWN])/PLAYER_MOVEMENT_SENSITIVITY;
-                           
-    camera->position.z += (cosf(cameraAngle.x)*direction[MOVE_BACK] -
-                           cosf(cameraAngle.x)*direction[MOVE_FRONT] +
-                           sinf(cameraAngle.x)*direction[MOVE_LEFT] -
-                           sinf(cameraAngle.x)*direction[MOVE_RIGHT])/PLAYER_MOVEMENT_SENSITIVITY;
+    double time = glfwGetTime();
+    
+    if ((time - frameStats.sampleStartTime) >= FRAME_STATS_SAMPLE_TIME)
+    {
+        frameStats.p50 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.50f);
+        frameStats.p95 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.95f);
+        frameStats.p99 = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 0.99f);
+        frameStats.maxTime = GetFrameTimePercentile(frameStats.frameTimes, frameStats.frameCount, 1.0f);
+        
+        frameStats.memoryUsage = GetMemoryUsage();
+#if !defined(RENDER_THREAD)
+        frameStats.vramUsage = vramUsage;
+        
+        // NOTE: Driver reported VRAM also tracks memory not allocated by us (driver internals)
+        if (glfwExtensionSupported("GL_NVX_gpu_memory_info"))
+        {
+            int availableKB = 0;
+            glGetIntegerv(0x9049, &availableKB);    // GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+            frameStats.vramAvailable = (long)availableKB*1024;
+        }
+#endif
+        
+        frameStats.perfMessages = frameStats.perfMessageCount;
+        frameStats.perfMessagesPeak = frameStats.perfMessagePeak;
+        frameStats.errorMessages = frameStats.errorMessageCount;
+        
+        frameStats.sampleCount++;
+        
+#if defined(SOAK_TEST)
+        CheckSoakRegressions();
+#endif
+        frameStats.frameCount = 0;
+        frameStats.perfMessageCount = 0;
+        frameStats.perfMessagePeak = 0;
+        frameStats.errorMessageCount = 0;
+        frameStats.sampleStartTime = time;
+    }
+}
 
-    bool isMoving = false;  // Required for swinging
+// Compare function for frame times sorting
+static int CompareFrameTimes(const void *a, const void *b)
+{
+    float ta = *(const float *)a;
+    float tb = *(const float *)b;
+    
+    return (ta > tb) - (ta < tb);
+}
 
-    for (int i = 0; i < 6; i++) if (direction[i]) { isMoving = true; break; }
+// Get frame times percentile
+// NOTE: Provided times array is sorted in-place
+static float GetFrameTimePercentile(float *times, int count, float percentile)
+{
+    if (count == 0) return 0.0f;
     
-    // Camera orientation calculation
-    cameraAngle.x += (mousePositionDelta.x*-CAMERA_MOUSE_MOVE_SENSITIVITY);
-    cameraAngle.y += (mousePositionDelta.y*-CAMERA_MOUSE_MOVE_SENSITIVITY);
+    qsort(times, count, sizeof(float), CompareFrameTimes);
     
-    // Angle clamp
-    if (cameraAngle.y > CAMERA_FIRST_PERSON_MIN_CLAMP*DEG2RAD) cameraAngle.y = CAMERA_FIRST_PERSON_MIN_CLAMP*DEG2RAD;
-    else if (cameraAngle.y < CAMERA_FIRST_PERSON_MAX_CLAMP*DEG2RAD) cameraAngle.y = CAMERA_FIRST_PERSON_MAX_CLAMP*DEG2RAD;
-
-    // Camera is always looking at player
-    camera->target.x = camera->position.x - sinf(cameraAngle.x)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
-    camera->target.y = camera->position.y + sinf(cameraAngle.y)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
-    camera->target.z = camera->position.z - cosf(cameraAngle.x)*CAMERA_FIRST_PERSON_FOCUS_DISTANCE;
+    int index = (int)(percentile*(count - 1) + 0.5f);
     
-    if (isMoving) swingCounter++;
-
-    // Camera position update
-    // NOTE: On CAMERA_FIRST_PERSON player Y-movement is limited to player 'eyes position'
-    camera->position.y = playerEyesPosition - sinf(swingCounter/CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER)/CAMERA_FIRST_PERSON_STEP_DIVIDER;
+    return times[index];
+}
 
-    camera->up.x = sinf(swingCounter/(CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER*2))/CAMERA_FIRST_PERSON_WAVING_DIVIDER;
-    camera->up.z = -sinf(swingCounter/(CAMERA_FIRST_PERSON_STEP_TRIGONOMETRIC_DIVIDER*2))/CAMERA_FIRST_PERSON_WAVING_DIVIDER;
+// Get process memory usage, resident set size (bytes)
+// NOTE: Only supported on Linux (/proc filesystem), it returns 0 on other platforms
+static long GetMemoryUsage(void)
+{
+    long memoryUsage = 0;
+    
+    FILE *statusFile = fopen("/proc/self/status", "rt");
+    
+    if (statusFile != NULL)
+    {
+        char line[128] = { 0 };
+        
+        while (fgets(line, 128, statusFile) != NULL)
+        {
+            if (strncmp(line, "VmRSS:", 6) == 0) 
+            {
+                memoryUsage = atol(line + 6)*1024;  // Value is provided in KB
+                break;
+            }
+        }
+        
+        fclose(statusFile);
+    }
+    
+    return memoryUsage;
 }
 
-// LESSON 07: Collision detection and resolution
+// Debug output: driver debug messages and debug groups
 //----------------------------------------------------------------------------------
-// Check collision between circle and rectangle
-static bool CheckCollisionCircleRec(Vector2 center, float radius, Rectangle rec)
+// Install driver debug messages callback
+// NOTE: Debug output requires a debug context, it uses KHR_debug (core on OpenGL 4.3)
+// if available or ARB_debug_output (messages only, no debug groups) as fallback
+static void InitDebugOutput(void)
 {
-    int recCenterX = rec.x + rec.width/2;
-    int recCenterY = rec.y + rec.height/2;
+    int contextFlags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
     
-    float dx = fabsf(center.x - recCenterX);
-    float dy = fabsf(center.y - recCenterY);
+    if (!(contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT))
+    {
+        TraceLog(LOG_INFO, "GL: Debug output not available (no debug context)");
+        return;
+    }
+    
+    int versionMajor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR);
+    int versionMinor = glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MINOR);
+    
+    PFNDEBUGMESSAGECALLBACKPROC debugMessageCallback = NULL;
+    
+    if ((versionMajor > 4) || ((versionMajor == 4) && (versionMinor >= 3)) || glfwExtensionSupported("GL_KHR_debug"))
+    {
+        debugMessageCallback = (PFNDEBUGMESSAGECALLBACKPROC)glfwGetProcAddress("glDebugMessageCallback");
+        pushDebugGroup = (PFNPUSHDEBUGGROUPPROC)glfwGetProcAddress("glPushDebugGroup");
+        popDebugGroup = (PFNPOPDEBUGGROUPPROC)glfwGetProcAddress("glPopDebugGroup");
+        
+        if ((pushDebugGroup == NULL) || (popDebugGroup == NULL)) pushDebugGroup = NULL, popDebugGroup = NULL;
+        
+        glEnable(GL_DEBUG_OUTPUT);
+    }
+    
+    if ((debugMessageCallback == NULL) && GLAD_GL_ARB_debug_output) debugMessageCallback = glDebugMessageCallbackARB;
+    
+    if (debugMessageCallback != NULL)
+    {
+        // NOTE: Synchronous output makes messages to be received on the frame (and thread) generating them
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB);
+        debugMessageCallback(DebugMessageCallback, NULL);
+        
+        TraceLog(LOG_INFO, "GL: Debug output enabled (%s)", (pushDebugGroup != NULL)? "KHR_debug" : "ARB_debug_output");
+    }
+    else TraceLog(LOG_WARNING, "GL: Debug output not supported");
+}
 
-    if (dx > ((float)rec.width/2.0f + radius)) { return false; }
-    if (dy > ((float)rec.height/2.0f + radius)) { return false; }
+// Driver debug messages callback
+// NOTE: All messages are counted (performance and errors are registered on frame stats)
+// but only first MAX_DEBUG_MESSAGES_LOGGED messages are logged
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
+{
+    if ((type == GL_DEBUG_TYPE_PUSH_GROUP) || (type == GL_DEBUG_TYPE_POP_GROUP)) return;
+    
+    if (type == GL_DEBUG_TYPE_PERFORMANCE_ARB) debugPerfMessages++;
+    else if (type == GL_DEBUG_TYPE_ERROR_ARB) debugErrorMessages++;
+    
+    if (debugMessagesLogged < MAX_DEBUG_MESSAGES_LOGGED)
+    {
+        // NOTE: LOG_ERROR is not used, it exits the program
+        TraceLog((type == GL_DEBUG_TYPE_ERROR_ARB)? LOG_WARNING : LOG_DEBUG, "GL: [%s %i] %s", 
+                 (type == GL_DEBUG_TYPE_PERFORMANCE_ARB)? "PERFORMANCE" : (type == GL_DEBUG_TYPE_ERROR_ARB)? "ERROR" : "OTHER", id, message);
+        
+        debugMessagesLogged++;
+        
+        if (debugMessagesLogged == MAX_DEBUG_MESSAGES_LOGGED) TraceLog(LOG_DEBUG, "GL: Debug messages log limit reached, next messages are only counted");
+    }
+}
 
-    if (dx <= ((float)rec.width/2.0f)) { return true; }
-    if (dy <= ((float)rec.height/2.0f)) { return true; }
+// Begin debug group, visible on graphics debuggers
+// NOTE: Without KHR_debug support, EXT_debug_marker groups are used (if supported)
+static void BeginDebugGroup(const char *name)
+{
+    if (pushDebugGroup != NULL) pushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+    else if (GLAD_GL_EXT_debug_marker) glPushGroupMarkerEXT(0, name);   // Fallback to EXT_debug_marker groups
+}
 
-    float cornerDistanceSq = (dx - (float)rec.width/2.0f)*(dx - (float)rec.width/2.0f) + 
-						     (dy - (float)rec.height/2.0f)*(dy - (float)rec.height/2.0f);
+// End debug group
+static void EndDebugGroup(void)
+{
+    if (popDebugGroup != NULL) popDebugGroup();
+    else if (GLAD_GL_EXT_debug_marker) glPopGroupMarkerEXT();
+}
 
-    return (cornerDistanceSq <= (radius*radius));
+#if defined(SOAK_TEST)
+// Soak test: autoplay bot and regressions detection
+//----------------------------------------------------------------------------------
+// Update random-walk bot keys and mouse, new direction if blocked
+// NOTE: Bot turns moving the virtual mouse for some frames and then walks forward
+static void UpdateBot(bool blocked)
+{
+    #define BOT_TURNING_FRAMES      15
+    
+    static int framesCounter = 0;
+    static int framesTarget = 0;
+    static float turnSpeed = 0.0f;          // Virtual mouse horizontal movement per frame (pixels)
+    
+    framesCounter++;
+    
+    // Choose a new random direction when blocked by a wall or after some random time walking
+    if (blocked || (framesCounter >= framesTarget))
+    {
+        turnSpeed = (float)(rand()%41 - 20);
+        
+        framesCounter = 0;
+        framesTarget = BOT_TURNING_FRAMES + 30 + rand()%90;
+    }
+    
+    if (framesCounter < BOT_TURNING_FRAMES) botMousePosition.x += turnSpeed;
+    
+    botKeyState['W'] = (framesCounter >= BOT_TURNING_FRAMES);
+    
+    if (glfwGetTime() > SOAK_TEST_DURATION) glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
+// Record last stats sample and check it against baseline
+// NOTE: Memory growth and frame time drift over the baseline are flagged as regressions
+static void CheckSoakRegressions(void)
+{
+    if (soakFile != NULL)
+    {
+        fprintf(soakFile, "%.0f,%li,%li,%li,%.3f,%.3f,%.3f,%.3f,%i,%i,%i\n", glfwGetTime(), frameStats.memoryUsage, frameStats.vramUsage, 
+                frameStats.vramAvailable, frameStats.p50, frameStats.p95, frameStats.p99, frameStats.maxTime, 
+                frameStats.perfMessages, frameStats.perfMessagesPeak, frameStats.errorMessages);
+        fflush(soakFile);
+    }
+    
+    TraceLog(LOG_INFO, "SOAK: [%i] memory: %li KB, vram: %li KB, frame time p50: %.2f ms, p95: %.2f ms, p99: %.2f ms", 
+             frameStats.sampleCount, frameStats.memoryUsage/1024, frameStats.vramUsage/1024, frameStats.p50, frameStats.p95, frameStats.p99);
+    
+    if (frameStats.sampleCount == SOAK_WARMUP_SAMPLES) soakBaseline = frameStats;
+    else if (frameStats.sampleCount > SOAK_WARMUP_SAMPLES)
+    {
+        if ((frameStats.memoryUsage - soakBaseline.memoryUsage) > SOAK_MEMORY_GROWTH)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Memory usage regression: %li KB over baseline", (frameStats.memoryUsage - soakBaseline.memoryUsage)/1024);
+            soakRegressions++;
+        }
+        
+        if (frameStats.vramUsage > soakBaseline.vramUsage)
+        {
+            TraceLog(LOG_WARNING, "SOAK: VRAM usage regression: %li KB over baseline", (frameStats.vramUsage - soakBaseline.vramUsage)/1024);
+            soakRegressions++;
+        }
+        
+        if (frameStats.p99 > soakBaseline.p99*SOAK_FRAMETIME_DRIFT)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Frame time regression: p99 %.2f ms (baseline %.2f ms)", frameStats.p99, soakBaseline.p99);
+            soakRegressions++;
+        }
+        
+        if (frameStats.errorMessages > 0)
+        {
+            TraceLog(LOG_WARNING, "SOAK: Driver reported %i errors", frameStats.errorMessages);
+            soakRegressions++;
+        }
+    }
+}
+#endif